@@ -10,6 +10,7 @@
 #include <linux/hwmon-sysfs.h>
 #include <linux/err.h>
 #include <linux/mutex.h>
+#include <linux/spinlock.h>
 #include <linux/sysfs.h>
 #include <linux/slab.h>
 #include <linux/delay.h>
@@ -47,18 +48,27 @@
 #define I2C_RW_RETRY_COUNT		10
 #define I2C_RW_RETRY_INTERVAL	60 /* ms */
 
+static unsigned int update_interval = 1500;
+module_param(update_interval, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(update_interval, "Telemetry refresh interval in milliseconds");
+
 /* Addresses scanned 
  */
 static const unsigned short normal_i2c[] = { I2C_CLIENT_END };
 
-/* Each client has this additional data 
+/* Register values. The identity registers do not change while the
+ * PSU is plugged in and are read once, the telemetry on every refresh.
  */
-struct accton_i2c_psu_data {
-    struct device      *hwmon_dev;
-    struct mutex        update_lock;
-    char                valid;           /* !=0 if registers are valid */
-    unsigned long       last_updated;    /* In jiffies */
+struct accton_i2c_psu_regs {
+    /* Identity */
     u8   vout_mode;     /* Register value */
+    u8   pmbus_revision; /* Register value */
+    u8   mfr_id[10];	 /* Register value */
+	u8   mfr_model[16]; /* Register value */
+	u8   mfr_revsion[3]; /* Register value */
+	u8   mfr_serial[26]; /* Register value */
+
+    /* Telemetry */
     u16  v_in;          /* Register value */
     u16  v_out;         /* Register value */
     u16  i_in;          /* Register value */
@@ -69,11 +79,18 @@ struct accton_i2c_psu_data {
     u8   fan_fault;     /* Register value */
     u16  fan_duty_cycle[2];  /* Register value */
     u16  fan_speed[2];  /* Register value */
-    u8   pmbus_revision; /* Register value */
-    u8   mfr_id[10];	 /* Register value */
-	u8   mfr_model[16]; /* Register value */
-	u8   mfr_revsion[3]; /* Register value */
-	u8   mfr_serial[26]; /* Register value */
+};
+
+/* Each client has this additional data 
+ */
+struct accton_i2c_psu_data {
+    struct device      *hwmon_dev;
+    struct mutex        update_lock;     /* Serializes PSU access */
+    spinlock_t          lock;            /* Protects the fields below */
+    char                valid;           /* !=0 if registers are valid */
+    char                static_valid;    /* !=0 if identity is valid */
+    unsigned long       last_updated;    /* In jiffies */
+    struct accton_i2c_psu_regs regs;
 };
 
 static ssize_t show_linear(struct device *dev, struct device_attribute *da, char *buf);
@@ -86,7 +103,7 @@ static ssize_t show_byte(struct device *dev, struct device_attribute *da,
 			 char *buf);
 			 			 
 static int accton_i2c_psu_write_word(struct i2c_client *client, u8 reg, u16 value);
-static struct accton_i2c_psu_data *accton_i2c_psu_update_device(struct device *dev);
+static int accton_i2c_psu_update_device(struct device *dev, struct accton_i2c_psu_regs *regs);
 
 enum accton_i2c_psu_sysfs_attributes {
     PSU_V_IN,
@@ -169,8 +186,10 @@ static ssize_t set_fan_duty_cycle(struct device *dev, struct device_attribute *d
         return -EINVAL;
 
     mutex_lock(&data->update_lock);
-    data->fan_duty_cycle[nr] = speed;
-    accton_i2c_psu_write_word(client, PMBUS_REGISTER_FAN_COMMAND_1 + nr, data->fan_duty_cycle[nr]);
+    accton_i2c_psu_write_word(client, PMBUS_REGISTER_FAN_COMMAND_1 + nr, speed);
+    spin_lock(&data->lock);
+    data->regs.fan_duty_cycle[nr] = speed;
+    spin_unlock(&data->lock);
     mutex_unlock(&data->update_lock);
 
     return count;
@@ -180,38 +199,40 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+    struct accton_i2c_psu_regs regs;
 
     u16 value = 0;
     int exponent, mantissa;
     int multiplier = 0;
-    
+
+    accton_i2c_psu_update_device(dev, &regs);
+
     switch (attr->index) {
     case PSU_V_IN:
-        value = data->v_in;
+        value = regs.v_in;
         break;
     case PSU_I_IN:
-        value = data->i_in;
+        value = regs.i_in;
         break;
     case PSU_I_OUT:
-        value = data->i_out;
+        value = regs.i_out;
         break;
     case PSU_P_IN:
-        value = data->p_in;
+        value = regs.p_in;
         break;
     case PSU_P_OUT:
-        value = data->p_out;
+        value = regs.p_out;
         break;
     case PSU_TEMP1_INPUT:
-        value = data->temp_input[0];
+        value = regs.temp_input[0];
         break;
     case PSU_FAN1_DUTY_CYCLE:
         multiplier = 1;
-        value = data->fan_duty_cycle[0];
+        value = regs.fan_duty_cycle[0];
         break;
     case PSU_FAN1_SPEED:
         multiplier = 1;
-        value = data->fan_speed[0];
+        value = regs.fan_speed[0];
         break;
     default:
         break;
@@ -232,21 +253,24 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+    struct accton_i2c_psu_regs regs;
 
     u8 shift = (attr->index == PSU_FAN1_FAULT) ? 7 : 6;
 
-    return sprintf(buf, "%d\n", data->fan_fault >> shift);
+    accton_i2c_psu_update_device(dev, &regs);
+
+    return sprintf(buf, "%d\n", regs.fan_fault >> shift);
 }
 
 static ssize_t show_vout(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
-    int exponent, mantissa;    
+    struct accton_i2c_psu_regs regs;
+    int exponent, mantissa;
 
-    exponent = two_complement_to_int(data->vout_mode, 5, 0x1f);
-    mantissa = data->v_out;
+    accton_i2c_psu_update_device(dev, &regs);
+    exponent = two_complement_to_int(regs.vout_mode, 5, 0x1f);
+    mantissa = regs.v_out;
 
     return (exponent > 0) ? sprintf(buf, "%d\n", (mantissa << exponent) * PMBUS_LITERAL_DATA_MULTIPLIER) :
                             sprintf(buf, "%d\n", (mantissa * PMBUS_LITERAL_DATA_MULTIPLIER) / (1 << -exponent));
@@ -256,13 +280,13 @@ static ssize_t show_byte(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+	struct accton_i2c_psu_regs regs;
 	
-	if (!data->valid) {
+	if (accton_i2c_psu_update_device(dev, &regs) < 0) {
 		return 0;
 	}
 
-	return (attr->index == PSU_PMBUS_REVISION) ? sprintf(buf, "%d\n", data->pmbus_revision) :
+	return (attr->index == PSU_PMBUS_REVISION) ? sprintf(buf, "%d\n", regs.pmbus_revision) :
 								 sprintf(buf, "0\n");
 }
 
@@ -270,25 +294,25 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct accton_i2c_psu_data *data = accton_i2c_psu_update_device(dev);
+	struct accton_i2c_psu_regs regs;
 	u8 *ptr = NULL;
 
-	if (!data->valid) {
+	if (accton_i2c_psu_update_device(dev, &regs) < 0) {
 		return 0;
 	}	
 	switch (attr->index) {
 
 	case PSU_MFR_ID:
-			ptr = data->mfr_id;
+			ptr = regs.mfr_id;
 		break;
 	case PSU_MFR_MODEL:
-			ptr = data->mfr_model;
+			ptr = regs.mfr_model;
 		break;
 	case PSU_MFR_REVISION:
-			ptr = data->mfr_revsion;
+			ptr = regs.mfr_revsion;
 		break;
 	case PSU_MFR_SERIAL:
-		ptr = data->mfr_serial;
+		ptr = regs.mfr_serial;
 		break;
 	default:
 		return 0;
@@ -323,6 +347,7 @@ static int accton_i2c_psu_probe(struct i2c_client *client,
     i2c_set_clientdata(client, data);
     data->valid = 0;
     mutex_init(&data->update_lock);
+    spin_lock_init(&data->lock);
 
     dev_info(&client->dev, "chip found\n");
 
@@ -476,97 +501,174 @@ struct reg_data_word {
     u16 *value;
 };
 
-static struct accton_i2c_psu_data *accton_i2c_psu_update_device(struct device *dev)
+/* Identity, read once after the PSU shows up
+ */
+static int accton_i2c_psu_read_static(struct i2c_client *client, struct accton_i2c_psu_regs *regs)
 {
-    struct i2c_client *client = to_i2c_client(dev);
-    struct accton_i2c_psu_data *data = i2c_get_clientdata(client);
-    
-    mutex_lock(&data->update_lock);
+    int status;
+
+    status = accton_i2c_psu_read_byte(client, PMBUS_REGISTER_VOUT_MODE);
+    if (status < 0) {
+        dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_VOUT_MODE, status);
+        return status;
+    }
+    regs->vout_mode = status;
+
+    /* Read mfr_id */
+    status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_ID, regs->mfr_id,
+                                            ARRAY_SIZE(regs->mfr_id));
+    if (status < 0) {
+        dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_ID, status);
+        return status;
+    }
+    /* Read mfr_model */
+    status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_MODEL, regs->mfr_model,
+                                            ARRAY_SIZE(regs->mfr_model));
+    if (status < 0) {
+        dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_MODEL, status);
+        return status;
+    }
+    /* Read mfr_revsion */
+    status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_REVISION, regs->mfr_revsion,
+                                            ARRAY_SIZE(regs->mfr_revsion));
+    if (status < 0) {
+        dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_REVISION, status);
+        return status;
+    }
+    /* Read mfr_serial */
+    status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_SERIAL, regs->mfr_serial,
+                                            ARRAY_SIZE(regs->mfr_serial));
+    if (status < 0) {
+        dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_SERIAL, status);
+        return status;
+    }
+
+    return 0;
+}
 
-    if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-        || !data->valid) {
-        int i, status, length;
-        u8 command, buf;
-        struct reg_data_byte regs_byte[] = { {PMBUS_REGISTER_VOUT_MODE, &data->vout_mode},
-                                             {PMBUS_REGISTER_STATUS_FAN, &data->fan_fault}};
-        struct reg_data_word regs_word[] = { {PMBUS_REGISTER_READ_VIN, &data->v_in},
-                                             {PMBUS_REGISTER_READ_VOUT, &data->v_out},
-                                             {PMBUS_REGISTER_READ_IIN, &data->i_in},
-                                             {PMBUS_REGISTER_READ_IOUT, &data->i_out},
-                                             {PMBUS_REGISTER_READ_POUT, &data->p_out},
-                                             {PMBUS_REGISTER_READ_PIN, &data->p_in},
-                                             {PMBUS_REGISTER_READ_TEMPERATURE_1, &(data->temp_input[0])},
-                                             {PMBUS_REGISTER_READ_TEMPERATURE_2, &(data->temp_input[1])},
-                                             {PMBUS_REGISTER_FAN_COMMAND_1, &(data->fan_duty_cycle[0])},
-                                             {PMBUS_REGISTER_READ_FAN_SPEED_1, &(data->fan_speed[0])},
-                                             {PMBUS_REGISTER_READ_FAN_SPEED_2, &(data->fan_speed[1])},
-                                             };
-
-        dev_dbg(&client->dev, "Starting accton_i2c_psu update\n");
-
-        /* Read byte data */        
-        for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-            status = accton_i2c_psu_read_byte(client, regs_byte[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_byte[i].reg, status);
-            }
-            else {
-                *(regs_byte[i].value) = status;
-            }
+/* Returns non-zero if any register could not be read
+ */
+static int accton_i2c_psu_read_telemetry(struct i2c_client *client, struct accton_i2c_psu_regs *regs)
+{
+    int i, status, failed = 0;
+    struct reg_data_byte regs_byte[] = { {PMBUS_REGISTER_STATUS_FAN, &regs->fan_fault}};
+    struct reg_data_word regs_word[] = { {PMBUS_REGISTER_READ_VIN, &regs->v_in},
+                                         {PMBUS_REGISTER_READ_VOUT, &regs->v_out},
+                                         {PMBUS_REGISTER_READ_IIN, &regs->i_in},
+                                         {PMBUS_REGISTER_READ_IOUT, &regs->i_out},
+                                         {PMBUS_REGISTER_READ_POUT, &regs->p_out},
+                                         {PMBUS_REGISTER_READ_PIN, &regs->p_in},
+                                         {PMBUS_REGISTER_READ_TEMPERATURE_1, &(regs->temp_input[0])},
+                                         {PMBUS_REGISTER_READ_TEMPERATURE_2, &(regs->temp_input[1])},
+                                         {PMBUS_REGISTER_FAN_COMMAND_1, &(regs->fan_duty_cycle[0])},
+                                         {PMBUS_REGISTER_READ_FAN_SPEED_1, &(regs->fan_speed[0])},
+                                         {PMBUS_REGISTER_READ_FAN_SPEED_2, &(regs->fan_speed[1])},
+                                         };
+
+    /* Read byte data */
+    for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
+        status = accton_i2c_psu_read_byte(client, regs_byte[i].reg);
+
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_byte[i].reg, status);
+            failed = 1;
         }
-                    
-        /* Read word data */                    
-        for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-            status = accton_i2c_psu_read_word(client, regs_word[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_word[i].reg, status);
-            }
-            else {
-                *(regs_word[i].value) = status;
-            }
-            
+        else {
+            *(regs_byte[i].value) = status;
         }
-        /* Read mfr_id */
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_ID, data->mfr_id,
-										 ARRAY_SIZE(data->mfr_id));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_ID, status);
-			goto exit;
-		}		
-		/* Read mfr_model */		
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_MODEL, data->mfr_model,
-										 ARRAY_SIZE(data->mfr_model));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_MODEL, status);
-			goto exit;
-		}
-        /* Read mfr_revsion */		
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_REVISION, data->mfr_revsion,
-										 ARRAY_SIZE(data->mfr_revsion));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_REVISION, status);
-			goto exit;
-		}
-		/* Read mfr_serial */
-		status = accton_i2c_psu_read_block_data(client, PMBUS_REGISTER_MFR_SERIAL, data->mfr_serial,
-										 ARRAY_SIZE(data->mfr_serial));
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", PMBUS_REGISTER_MFR_SERIAL, status);
-			goto exit;
-		}
-        
+    }
+
+    /* Read word data */
+    for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+        status = accton_i2c_psu_read_word(client, regs_word[i].reg);
+
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_word[i].reg, status);
+            failed = 1;
+        }
+        else {
+            *(regs_word[i].value) = status;
+        }
+    }
+
+    return failed;
+}
+
+static int accton_i2c_psu_is_stale(struct accton_i2c_psu_data *data)
+{
+    return !data->valid ||
+           time_after(jiffies, data->last_updated + msecs_to_jiffies(update_interval));
+}
+
+/* The output voltage and the mfr_* attributes depend on vout_mode and
+ * the identity strings, so data->valid is only set once they have been
+ * read. A failed telemetry read drops them. The caller holds update_lock.
+ */
+static void accton_i2c_psu_refresh(struct i2c_client *client, struct accton_i2c_psu_data *data)
+{
+    struct accton_i2c_psu_regs regs;
+    char static_valid;
+    int failed;
+
+    spin_lock(&data->lock);
+    if (!accton_i2c_psu_is_stale(data)) {
+        spin_unlock(&data->lock);
+        return;
+    }
+    regs = data->regs;
+    static_valid = data->static_valid;
+    spin_unlock(&data->lock);
+
+    dev_dbg(&client->dev, "Starting accton_i2c_psu update\n");
+
+    failed = accton_i2c_psu_read_telemetry(client, &regs);
+    if (!static_valid && !failed) {
+        static_valid = (accton_i2c_psu_read_static(client, &regs) == 0);
+    }
+
+    spin_lock(&data->lock);
+    data->regs = regs;
+    /* Read the identity again once the PSU answers, it may be a different one */
+    data->static_valid = failed ? 0 : static_valid;
+    if (static_valid) {
         data->last_updated = jiffies;
         data->valid = 1;
     }
+    spin_unlock(&data->lock);
+}
 
-exit:
-    mutex_unlock(&data->update_lock);
+static int accton_i2c_psu_update_device(struct device *dev, struct accton_i2c_psu_regs *regs)
+{
+    struct i2c_client *client = to_i2c_client(dev);
+    struct accton_i2c_psu_data *data = i2c_get_clientdata(client);
+    int stale, valid;
+
+    spin_lock(&data->lock);
+    stale = accton_i2c_psu_is_stale(data);
+    valid = data->valid;
+    spin_unlock(&data->lock);
+
+    if (stale) {
+        if (!valid) {
+            mutex_lock(&data->update_lock);
+        }
+        else if (!mutex_trylock(&data->update_lock)) {
+            /* Refresh in progress; return the published snapshot */
+            goto out;
+        }
+        accton_i2c_psu_refresh(client, data);
+        mutex_unlock(&data->update_lock);
+    }
+
+out:
+    spin_lock(&data->lock);
+    valid = data->valid;
+    *regs = data->regs;
+    spin_unlock(&data->lock);
 
-    return data;
+    return valid ? 0 : -EIO;
 }
 
 static int __init accton_i2c_psu_init(void)
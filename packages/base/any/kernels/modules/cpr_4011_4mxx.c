@@ -28,23 +28,25 @@
 #include <linux/hwmon-sysfs.h>
 #include <linux/err.h>
 #include <linux/mutex.h>
+#include <linux/spinlock.h>
 #include <linux/sysfs.h>
 #include <linux/slab.h>
 #include <linux/version.h>
 
 #define MAX_FAN_DUTY_CYCLE 100
 
+static unsigned int update_interval = 1500;
+module_param(update_interval, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(update_interval, "Telemetry refresh interval in milliseconds");
+
 /* Addresses scanned 
  */
 static const unsigned short normal_i2c[] = { 0x3c, 0x3d, 0x3e, 0x3f, I2C_CLIENT_END };
 
-/* Each client has this additional data 
+/* Register values. VOUT_MODE does not change while the PSU is plugged
+ * in and is read once, the telemetry on every refresh.
  */
-struct cpr_4011_4mxx_data {
-    struct device      *hwmon_dev;
-    struct mutex        update_lock;
-    char                valid;           /* !=0 if registers are valid */
-    unsigned long       last_updated;    /* In jiffies */
+struct cpr_4011_4mxx_regs {
     u8   vout_mode;     /* Register value */
     u16  v_in;          /* Register value */
     u16  v_out;         /* Register value */
@@ -58,12 +60,24 @@ struct cpr_4011_4mxx_data {
     u16  fan_speed[2];  /* Register value */
 };
 
+/* Each client has this additional data 
+ */
+struct cpr_4011_4mxx_data {
+    struct device      *hwmon_dev;
+    struct mutex        update_lock;     /* Serializes PSU access */
+    spinlock_t          lock;            /* Protects the fields below */
+    char                valid;           /* !=0 if registers are valid */
+    char                static_valid;    /* !=0 if vout_mode is valid */
+    unsigned long       last_updated;    /* In jiffies */
+    struct cpr_4011_4mxx_regs regs;
+};
+
 static ssize_t show_linear(struct device *dev, struct device_attribute *da, char *buf);
 static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da, char *buf);
 static ssize_t show_vout(struct device *dev, struct device_attribute *da, char *buf);
 static ssize_t set_fan_duty_cycle(struct device *dev, struct device_attribute *da, const char *buf, size_t count);
 static int cpr_4011_4mxx_write_word(struct i2c_client *client, u8 reg, u16 value);
-static struct cpr_4011_4mxx_data *cpr_4011_4mxx_update_device(struct device *dev);
+static void cpr_4011_4mxx_update_device(struct device *dev, struct cpr_4011_4mxx_regs *regs);
 
 enum cpr_4011_4mxx_sysfs_attributes {
     PSU_V_IN,
@@ -131,8 +145,10 @@ static ssize_t set_fan_duty_cycle(struct device *dev, struct device_attribute *d
         return -EINVAL;
 
     mutex_lock(&data->update_lock);
-    data->fan_duty_cycle[nr] = speed;
-    cpr_4011_4mxx_write_word(client, 0x3B + nr, data->fan_duty_cycle[nr]);
+    cpr_4011_4mxx_write_word(client, 0x3B + nr, speed);
+    spin_lock(&data->lock);
+    data->regs.fan_duty_cycle[nr] = speed;
+    spin_unlock(&data->lock);
     mutex_unlock(&data->update_lock);
 
     return count;
@@ -142,38 +158,40 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev);
+    struct cpr_4011_4mxx_regs regs;
 
     u16 value = 0;
     int exponent, mantissa;
     int multiplier = 1000;
-    
+
+    cpr_4011_4mxx_update_device(dev, &regs);
+
     switch (attr->index) {
     case PSU_V_IN:
-        value = data->v_in;
+        value = regs.v_in;
         break;
     case PSU_I_IN:
-        value = data->i_in;
+        value = regs.i_in;
         break;
     case PSU_I_OUT:
-        value = data->i_out;
+        value = regs.i_out;
         break;
     case PSU_P_IN:
-        value = data->p_in;
+        value = regs.p_in;
         break;
     case PSU_P_OUT:
-        value = data->p_out;
+        value = regs.p_out;
         break;
     case PSU_TEMP1_INPUT:
-        value = data->temp_input[0];
+        value = regs.temp_input[0];
         break;
     case PSU_FAN1_DUTY_CYCLE:
         multiplier = 1;
-        value = data->fan_duty_cycle[0];
+        value = regs.fan_duty_cycle[0];
         break;
     case PSU_FAN1_SPEED:
         multiplier = 1;
-        value = data->fan_speed[0];
+        value = regs.fan_speed[0];
         break;
     default:
         break;
@@ -190,22 +208,25 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev);
+    struct cpr_4011_4mxx_regs regs;
 
     u8 shift = (attr->index == PSU_FAN1_FAULT) ? 7 : 6;
 
-    return sprintf(buf, "%d\n", data->fan_fault >> shift);
+    cpr_4011_4mxx_update_device(dev, &regs);
+
+    return sprintf(buf, "%d\n", regs.fan_fault >> shift);
 }
 
 static ssize_t show_vout(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    struct cpr_4011_4mxx_data *data = cpr_4011_4mxx_update_device(dev);
+    struct cpr_4011_4mxx_regs regs;
     int exponent, mantissa;
     int multiplier = 1000;
 
-    exponent = two_complement_to_int(data->vout_mode, 5, 0x1f);
-    mantissa = data->v_out;
+    cpr_4011_4mxx_update_device(dev, &regs);
+    exponent = two_complement_to_int(regs.vout_mode, 5, 0x1f);
+    mantissa = regs.v_out;
 
     return (exponent > 0) ? sprintf(buf, "%d\n", (mantissa << exponent) * multiplier) :
                             sprintf(buf, "%d\n", (mantissa * multiplier) / (1 << -exponent));
@@ -236,6 +257,7 @@ static int cpr_4011_4mxx_probe(struct i2c_client *client,
     i2c_set_clientdata(client, data);
     data->valid = 0;
     mutex_init(&data->update_lock);
+    spin_lock_init(&data->lock);
 
     dev_info(&client->dev, "chip found\n");
 
@@ -323,66 +345,123 @@ struct reg_data_word {
     u16 *value;
 };
 
-static struct cpr_4011_4mxx_data *cpr_4011_4mxx_update_device(struct device *dev)
+static int cpr_4011_4mxx_is_stale(struct cpr_4011_4mxx_data *data)
+{
+    return !data->valid ||
+           time_after(jiffies, data->last_updated + msecs_to_jiffies(update_interval));
+}
+
+/* vout_mode is the only register which does not change while the PSU
+ * is in place. It is read on the first refresh and after any failed
+ * register read. A register which fails keeps its last value, as it did
+ * before. The caller holds update_lock.
+ */
+static void cpr_4011_4mxx_refresh(struct i2c_client *client, struct cpr_4011_4mxx_data *data)
+{
+    int i, status, failed = 0;
+    char static_valid;
+    struct cpr_4011_4mxx_regs regs;
+    struct reg_data_byte regs_byte[] = { {0x81, &regs.fan_fault}};
+    struct reg_data_word regs_word[] = { {0x88, &regs.v_in},
+                                         {0x8b, &regs.v_out},
+                                         {0x89, &regs.i_in},
+                                         {0x8c, &regs.i_out},
+                                         {0x96, &regs.p_out},
+                                         {0x97, &regs.p_in},
+                                         {0x8d, &(regs.temp_input[0])},
+                                         {0x8e, &(regs.temp_input[1])},
+                                         {0x3b, &(regs.fan_duty_cycle[0])},
+                                         {0x3c, &(regs.fan_duty_cycle[1])},
+                                         {0x90, &(regs.fan_speed[0])},
+                                         {0x91, &(regs.fan_speed[1])}};
+
+    spin_lock(&data->lock);
+    if (!cpr_4011_4mxx_is_stale(data)) {
+        spin_unlock(&data->lock);
+        return;
+    }
+    regs = data->regs;
+    static_valid = data->static_valid;
+    spin_unlock(&data->lock);
+
+    dev_dbg(&client->dev, "Starting cpr_4011_4mxx update\n");
+
+    if (!static_valid) {
+        status = cpr_4011_4mxx_read_byte(client, 0x20);
+
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", 0x20, status);
+        }
+        else {
+            regs.vout_mode = status;
+            static_valid = 1;
+        }
+    }
+
+    /* Read byte data */
+    for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
+        status = cpr_4011_4mxx_read_byte(client, regs_byte[i].reg);
+
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_byte[i].reg, status);
+            failed = 1;
+        }
+        else {
+            *(regs_byte[i].value) = status;
+        }
+    }
+
+    /* Read word data */
+    for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+        status = cpr_4011_4mxx_read_word(client, regs_word[i].reg);
+
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n",
+                    regs_word[i].reg, status);
+            failed = 1;
+        }
+        else {
+            *(regs_word[i].value) = status;
+        }
+    }
+
+    spin_lock(&data->lock);
+    data->regs = regs;
+    /* Read vout_mode again once the PSU answers, it may be a different one */
+    data->static_valid = failed ? 0 : static_valid;
+    data->last_updated = jiffies;
+    data->valid = 1;
+    spin_unlock(&data->lock);
+}
+
+static void cpr_4011_4mxx_update_device(struct device *dev, struct cpr_4011_4mxx_regs *regs)
 {
     struct i2c_client *client = to_i2c_client(dev);
     struct cpr_4011_4mxx_data *data = i2c_get_clientdata(client);
-    
-    mutex_lock(&data->update_lock);
+    int stale, valid;
 
-    if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-        || !data->valid) {
-        int i, status;
-        struct reg_data_byte regs_byte[] = { {0x20, &data->vout_mode},
-                                             {0x81, &data->fan_fault}};
-        struct reg_data_word regs_word[] = { {0x88, &data->v_in},
-                                             {0x8b, &data->v_out},
-                                             {0x89, &data->i_in},
-                                             {0x8c, &data->i_out},
-                                             {0x96, &data->p_out},
-                                             {0x97, &data->p_in},
-                                             {0x8d, &(data->temp_input[0])},
-                                             {0x8e, &(data->temp_input[1])},
-                                             {0x3b, &(data->fan_duty_cycle[0])},
-                                             {0x3c, &(data->fan_duty_cycle[1])},
-                                             {0x90, &(data->fan_speed[0])},
-                                             {0x91, &(data->fan_speed[1])}};
-
-        dev_dbg(&client->dev, "Starting cpr_4011_4mxx update\n");
-
-        /* Read byte data */        
-        for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-            status = cpr_4011_4mxx_read_byte(client, regs_byte[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_byte[i].reg, status);
-            }
-            else {
-                *(regs_byte[i].value) = status;
-            }
+    spin_lock(&data->lock);
+    stale = cpr_4011_4mxx_is_stale(data);
+    valid = data->valid;
+    spin_unlock(&data->lock);
+
+    if (stale) {
+        if (!valid) {
+            mutex_lock(&data->update_lock);
         }
-                    
-        /* Read word data */                    
-        for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-            status = cpr_4011_4mxx_read_word(client, regs_word[i].reg);
-            
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_word[i].reg, status);
-            }
-            else {
-                *(regs_word[i].value) = status;
-            }
+        else if (!mutex_trylock(&data->update_lock)) {
+            /* Refresh in progress; return the published snapshot */
+            goto out;
         }
-        
-        data->last_updated = jiffies;
-        data->valid = 1;
+        cpr_4011_4mxx_refresh(client, data);
+        mutex_unlock(&data->update_lock);
     }
 
-    mutex_unlock(&data->update_lock);
-
-    return data;
+out:
+    spin_lock(&data->lock);
+    *regs = data->regs;
+    spin_unlock(&data->lock);
 }
 
 static int __init cpr_4011_4mxx_init(void)
@@ -29,6 +29,7 @@
 #include <linux/hwmon-sysfs.h>
 #include <linux/err.h>
 #include <linux/mutex.h>
+#include <linux/spinlock.h>
 #include <linux/sysfs.h>
 #include <linux/slab.h>
 #include <linux/delay.h>
@@ -37,6 +38,10 @@
 #define I2C_RW_RETRY_COUNT		10
 #define I2C_RW_RETRY_INTERVAL	60 /* ms */
 
+static unsigned int update_interval = 1500;
+module_param(update_interval, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(update_interval, "Telemetry refresh interval in milliseconds");
+
 /* Addresses scanned
  */
 static const unsigned short normal_i2c[] = { I2C_CLIENT_END };
@@ -45,15 +50,16 @@ enum chips {
 	DPS850
 };
 
-/* Each client has this additional data
+/* Register values. The identity registers do not change while the
+ * PSU is plugged in and are read once, the telemetry on every refresh.
  */
-struct dps850_data {
-	struct device	  *hwmon_dev;
-	struct mutex		update_lock;
-	char				valid;		 /* !=0 if registers are valid */
-	unsigned long	   last_updated;   /* In jiffies */
-	u8	 chip;			/* chip id */
+struct dps850_regs {
+	/* Identity */
 	u8   vout_mode;	 	/* Register value */
+	u8   mfr_model[16]; /* Register value */
+	u8   mfr_serial[16]; /* Register value */
+
+	/* Telemetry */
 	u16  v_in;		  	/* Register value */
 	u16  v_out;		 	/* Register value */
 	u16  i_in;		  	/* Register value */
@@ -62,8 +68,19 @@ struct dps850_data {
 	u16  p_out;		 	/* Register value */
 	u16  temp_input[3]; /* Register value */
 	u16  fan_speed;		/* Register value */
-	u8   mfr_model[16]; /* Register value */
-	u8   mfr_serial[16]; /* Register value */
+};
+
+/* Each client has this additional data
+ */
+struct dps850_data {
+	struct device	  *hwmon_dev;
+	struct mutex		update_lock;	/* Serializes PSU access */
+	spinlock_t			lock;			/* Protects the fields below */
+	char				valid;		 /* !=0 if registers are valid */
+	char				static_valid;	/* !=0 if identity is valid */
+	unsigned long	   last_updated;   /* In jiffies */
+	u8	 chip;			/* chip id */
+	struct dps850_regs	regs;
 };
 
 static ssize_t show_linear(struct device *dev, struct device_attribute *da,
@@ -72,7 +89,7 @@ static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da
 			 char *buf);
 static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 			 char *buf);
-static struct dps850_data *dps850_update_device(struct device *dev);
+static int dps850_update_device(struct device *dev, struct dps850_regs *regs);
 static int dps850_write_word(struct i2c_client *client, u8 reg, u16 value);
 
 enum dps850_sysfs_attributes {
@@ -133,39 +150,39 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
 	struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct dps850_data *data = dps850_update_device(dev);
+	struct dps850_regs regs;
 
 	u16 value = 0;
 	int exponent, mantissa;
 	int multiplier = 1000;
 
-	if (!data->valid) {
+	if (dps850_update_device(dev, &regs) < 0) {
 		return 0;
 	}	
 	
 	switch (attr->index) {
 	case PSU_V_IN:
-		value = data->v_in;
+		value = regs.v_in;
 		break;
 	case PSU_I_IN:
-		value = data->i_in;
+		value = regs.i_in;
 		break;
 	case PSU_I_OUT:
-		value = data->i_out;
+		value = regs.i_out;
 		break;
 	case PSU_P_IN:
-		value = data->p_in;
+		value = regs.p_in;
 		break;
 	case PSU_P_OUT:
-		value = data->p_out;
+		value = regs.p_out;
 		break;
 	case PSU_TEMP1_INPUT:
 	case PSU_TEMP2_INPUT:
 	case PSU_TEMP3_INPUT:
-		value = data->temp_input[attr->index-PSU_TEMP1_INPUT];
+		value = regs.temp_input[attr->index-PSU_TEMP1_INPUT];
 		break;
 	case PSU_FAN1_SPEED:
-		value = data->fan_speed;
+		value = regs.fan_speed;
 		multiplier = 1;
 		break;
 	}
@@ -181,19 +198,19 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
 	struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-	struct dps850_data *data = dps850_update_device(dev);
+	struct dps850_regs regs;
 	u8 *ptr = NULL;
 
-	if (!data->valid) {
+	if (dps850_update_device(dev, &regs) < 0) {
 		return 0;
 	}	
 	
 	switch (attr->index) {
 	case PSU_MFR_MODEL: /* psu_mfr_model */
-		ptr = data->mfr_model + 1; /* The first byte is the length of string. */
+		ptr = regs.mfr_model + 1; /* The first byte is the length of string. */
 		break;
 	case PSU_MFR_SERIAL: /* psu_mfr_serial */
-		ptr = data->mfr_serial + 1; /* The first byte is the length of string. */
+		ptr = regs.mfr_serial + 1; /* The first byte is the length of string. */
 		break;
 	default:
 		return 0;
@@ -205,16 +222,16 @@ static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
 static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da,
 			 char *buf)
 {
-	struct dps850_data *data = dps850_update_device(dev);
+	struct dps850_regs regs;
 	int exponent, mantissa;
 	int multiplier = 1000;
 
-	if (!data->valid) {
+	if (dps850_update_device(dev, &regs) < 0) {
 		return 0;
 	}
 
-	exponent = two_complement_to_int(data->vout_mode, 5, 0x1f);
-	mantissa = data->v_out;
+	exponent = two_complement_to_int(regs.vout_mode, 5, 0x1f);
+	mantissa = regs.v_out;
 
 	return (exponent > 0) ? sprintf(buf, "%d\n", (mantissa << exponent) * multiplier) :
 							sprintf(buf, "%d\n", (mantissa * multiplier) / (1 << -exponent));
@@ -246,6 +263,7 @@ static int dps850_probe(struct i2c_client *client,
 
 	i2c_set_clientdata(client, data);
 	mutex_init(&data->update_lock);
+	spin_lock_init(&data->lock);
 	data->chip = dev_id->driver_data;
 	dev_info(&client->dev, "chip found\n");
 
@@ -381,119 +399,172 @@ static int dps850_read_block(struct i2c_client *client, u8 command, u8 *data,
 	return status;
 }
 
-struct reg_data_byte {
-	u8   reg;
-	u8  *value;
-};
 
 struct reg_data_word {
 	u8   reg;
 	u16 *value;
 };
 
-static struct dps850_data *dps850_update_device(struct device *dev)
+static int dps850_read_string(struct i2c_client *client, u8 command,
+			  u8 *data, int data_len)
 {
-	struct i2c_client *client = to_i2c_client(dev);
-	struct dps850_data *data = i2c_get_clientdata(client);
+	int status, length;
+	u8 buf;
 
-	mutex_lock(&data->update_lock);
-
-	if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-		|| !data->valid) {
-		int i, status, length;
-		u8 command, buf;
-		struct reg_data_byte regs_byte[] = { {0x20, &data->vout_mode}};
-		struct reg_data_word regs_word[] = { {0x88, &data->v_in},
-											 {0x8b, &data->v_out},
-											 {0x89, &data->i_in},
-											 {0x8c, &data->i_out},
-											 {0x96, &data->p_out},
-											 {0x97, &data->p_in},
-											 {0x8d, &(data->temp_input[0])},
-											 {0x8e, &(data->temp_input[1])},
-											 {0x8f, &(data->temp_input[2])},
-											 {0x90, &data->fan_speed}};
-
-		dev_dbg(&client->dev, "Starting dps850 update\n");
-		data->valid = 0;
+	memset(data, 0, data_len);
 
-		/* Read byte data */
-		for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-			status = dps850_read_byte(client, regs_byte[i].reg);
-
-			if (status < 0) {
-				dev_dbg(&client->dev, "reg %d, err %d\n",
-						regs_byte[i].reg, status);
-				goto exit;
-			}
-			else {
-				*(regs_byte[i].value) = status;
-			}
-		}
+	/* Read first byte to determine the length of data */
+	status = dps850_read_block(client, command, &buf, 1);
+	if (status < 0) {
+		dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+		return status;
+	}
 
-		/* Read word data */
-		for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-			status = dps850_read_word(client, regs_word[i].reg);
-
-			if (status < 0) {
-				dev_dbg(&client->dev, "reg %d, err %d\n",
-						regs_word[i].reg, status);
-				goto exit;
-			}
-			else {
-				*(regs_word[i].value) = status;
-			}
-		}
+	length = min(buf + 1, data_len - 1);
+	status = dps850_read_block(client, command, data, length);
+	data[length] = '\0';
 
-		/* Read mfr_model */
-		command = 0x9a;
-		length  = 1;
-		memset(data->mfr_model, 0, sizeof(data->mfr_model));
-		
-		/* Read first byte to determine the length of data */
-		status = dps850_read_block(client, command, &buf, length);
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
-		}
-		
-		status = dps850_read_block(client, command, data->mfr_model, buf+1);
-		data->mfr_model[buf+1] = '\0';
+	if (status < 0) {
+		dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+		return status;
+	}
 
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
-		}
+	return 0;
+}
 
+/* Identity, read once after the PSU shows up
+ */
+static int dps850_read_static(struct i2c_client *client, struct dps850_regs *regs)
+{
+	int status;
 
-		/* Read mfr_serial */
-		command = 0x9e;
-		length  = 1;
-		memset(data->mfr_serial, 0, sizeof(data->mfr_serial));
-		
-		/* Read first byte to determine the length of data */
-		status = dps850_read_block(client, command, &buf, length);
-		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
-		}
-		
- 		status = dps850_read_block(client, command, data->mfr_serial, buf+1);
-		data->mfr_serial[buf+1] = '\0';
+	status = dps850_read_byte(client, 0x20);
+	if (status < 0) {
+		dev_dbg(&client->dev, "reg %d, err %d\n", 0x20, status);
+		return status;
+	}
+	regs->vout_mode = status;
+
+	/* Read mfr_model */
+	status = dps850_read_string(client, 0x9a, regs->mfr_model,
+								ARRAY_SIZE(regs->mfr_model));
+	if (status < 0) {
+		return status;
+	}
+
+	/* Read mfr_serial */
+	return dps850_read_string(client, 0x9e, regs->mfr_serial,
+							  ARRAY_SIZE(regs->mfr_serial));
+}
+
+static int dps850_read_telemetry(struct i2c_client *client, struct dps850_regs *regs)
+{
+	int i, status;
+	struct reg_data_word regs_word[] = { {0x88, &regs->v_in},
+										 {0x8b, &regs->v_out},
+										 {0x89, &regs->i_in},
+										 {0x8c, &regs->i_out},
+										 {0x96, &regs->p_out},
+										 {0x97, &regs->p_in},
+										 {0x8d, &(regs->temp_input[0])},
+										 {0x8e, &(regs->temp_input[1])},
+										 {0x8f, &(regs->temp_input[2])},
+										 {0x90, &regs->fan_speed}};
+
+	for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
+		status = dps850_read_word(client, regs_word[i].reg);
 
 		if (status < 0) {
-			dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-			goto exit;
+			dev_dbg(&client->dev, "reg %d, err %d\n",
+					regs_word[i].reg, status);
+			return status;
 		}
 
+		*(regs_word[i].value) = status;
+	}
+
+	return 0;
+}
+
+static int dps850_is_stale(struct dps850_data *data)
+{
+	return !data->valid ||
+		   time_after(jiffies, data->last_updated + msecs_to_jiffies(update_interval));
+}
+
+/* Refresh the telemetry. The model and serial strings are read on the
+ * first refresh and after a failed one, which is when a different PSU
+ * may have been inserted. The caller holds update_lock.
+ */
+static void dps850_refresh(struct i2c_client *client, struct dps850_data *data)
+{
+	struct dps850_regs regs;
+	char static_valid;
+	int status;
+
+	spin_lock(&data->lock);
+	if (!dps850_is_stale(data)) {
+		spin_unlock(&data->lock);
+		return;
+	}
+	regs = data->regs;
+	static_valid = data->static_valid;
+	spin_unlock(&data->lock);
+
+	dev_dbg(&client->dev, "Starting dps850 update\n");
+
+	status = dps850_read_telemetry(client, &regs);
+	if (status == 0 && !static_valid) {
+		status = dps850_read_static(client, &regs);
+	}
+
+	spin_lock(&data->lock);
+	if (status < 0) {
+		/* Read the identity again once the PSU answers */
+		data->valid = 0;
+		data->static_valid = 0;
+	}
+	else {
+		data->regs = regs;
 		data->last_updated = jiffies;
 		data->valid = 1;
+		data->static_valid = 1;
 	}
+	spin_unlock(&data->lock);
+}
 
-exit:
-	mutex_unlock(&data->update_lock);
+static int dps850_update_device(struct device *dev, struct dps850_regs *regs)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct dps850_data *data = i2c_get_clientdata(client);
+	int stale, valid;
+
+	spin_lock(&data->lock);
+	stale = dps850_is_stale(data);
+	valid = data->valid;
+	spin_unlock(&data->lock);
+
+	if (stale) {
+		if (!valid) {
+			mutex_lock(&data->update_lock);
+		}
+		else if (!mutex_trylock(&data->update_lock)) {
+			/* Refresh in progress; return the published snapshot */
+			goto out;
+		}
+		dps850_refresh(client, data);
+		mutex_unlock(&data->update_lock);
+	}
+
+out:
+	spin_lock(&data->lock);
+	valid = data->valid;
+	if (valid) {
+		*regs = data->regs;
+	}
+	spin_unlock(&data->lock);
 
-	return data;
+	return valid ? 0 : -EIO;
 }
 
 static int __init dps850_init(void)
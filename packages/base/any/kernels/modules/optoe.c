@@ -125,6 +125,7 @@
 #include <linux/sysfs.h>
 #include <linux/jiffies.h>
 #include <linux/i2c.h>
+#include <linux/version.h>
 
 #ifdef EEPROM_CLASS
 #include <linux/eeprom_class.h>
@@ -180,6 +181,19 @@ struct optoe_platform_data {
 #define OPTOE_READ_OP 0
 #define OPTOE_WRITE_OP 1
 #define OPTOE_EOF 0  /* used for access beyond end of device */
+#define OPTOE_PAGE_UNKNOWN (-1)
+
+/* Transaction counters, reported (and cleared) through 'counters' */
+struct optoe_counters {
+	u64 reads;		/* read transactions, including retries */
+	u64 writes;		/* write transactions, including retries */
+	u64 retries;		/* transactions repeated after a failure */
+	u64 errors;		/* transfers which gave up */
+	u64 bytes_read;
+	u64 bytes_written;
+	u64 page_selects;	/* page register writes */
+	u64 page_selects_skipped; /* page already selected */
+};
 
 struct optoe_data {
 	struct optoe_platform_data chip;
@@ -196,6 +210,15 @@ struct optoe_data {
 
 	u8 *writebuf;
 	unsigned int write_max;
+	unsigned int read_max;
+
+	/*
+	 * Page selected on each client, or OPTOE_PAGE_UNKNOWN.
+	 * Only page 0 is left selected between accesses.
+	 */
+	int cur_page[2];
+
+	struct optoe_counters counters;
 
 	unsigned int num_addresses;
 
@@ -217,9 +240,13 @@ struct optoe_data {
  * but the 1/170 second it takes at 400 kHz may be quite reasonable; and
  * at 1 MHz (Fm+) a 1/430 second delay could easily be invisible.
  *
+ * 256 bytes is also the longest run that needs no page change (lower
+ * page plus upper page 00h), so there is no point in going higher.
+ * Reads are further limited by the adapter, see optoe_probe().
+ *
  * This value is forced to be a power of two so that writes align on pages.
  */
-static unsigned int io_limit = OPTOE_PAGE_SIZE;
+static unsigned int io_limit = 2 * OPTOE_PAGE_SIZE;
 
 /*
  * specs often allow 5 msec for a page write, sometimes 20 msec;
@@ -266,9 +293,11 @@ MODULE_DEVICE_TABLE(i2c, optoe_ids);
  *
  *     Callers must not read/write beyond the end of a client or a page
  *     without recomputing the client/page.  Hence offset (within page)
- *     plus length must be less than or equal to 128.  (Note that this
- *     routine does not have access to the length of the call, hence
- *     cannot do the validity check.)
+ *     plus length must be less than or equal to 128, except that the
+ *     lower half and upper page 00h may be accessed together (see
+ *     optoe_segment_end()).  (Note that this routine does not have
+ *     access to the length of the call, hence cannot do the validity
+ *     check.)
  *
  * Offset within Lower Page 00h and Upper Page 00h are not recomputed
  */
@@ -305,6 +334,26 @@ static uint8_t optoe_translate_offset(struct optoe_data *optoe,
 	return page;  /* note also returning client and offset */
 }
 
+/*
+ * Return the end of the run of offsets starting at 'offset' which maps
+ * to a single client and page, ie which can be transferred without
+ * touching the page register.  That is the lower page together with
+ * upper page 00h, or one 128 byte page above that.
+ */
+static loff_t optoe_segment_end(struct optoe_data *optoe, loff_t offset)
+{
+	loff_t base = 0;
+
+	/* SFP: offset 256 and up starts over on i2c addr 0x51 */
+	if (optoe->dev_class == TWO_ADDR && offset >= TWO_ADDR_NO_0X51_SIZE)
+		base = TWO_ADDR_NO_0X51_SIZE;
+
+	if (offset - base < 2 * OPTOE_PAGE_SIZE)
+		return base + 2 * OPTOE_PAGE_SIZE;
+
+	return (offset | (OPTOE_PAGE_SIZE - 1)) + 1;
+}
+
 static ssize_t optoe_eeprom_read(struct optoe_data *optoe,
 		    struct i2c_client *client,
 		    char *buf, unsigned int offset, size_t count)
@@ -313,6 +362,7 @@ static ssize_t optoe_eeprom_read(struct optoe_data *optoe,
 	u8 msgbuf[2];
 	unsigned long timeout, read_time;
 	int status, i;
+	int attempts = 0;
 
 	memset(msg, 0, sizeof(msg));
 
@@ -336,6 +386,9 @@ static ssize_t optoe_eeprom_read(struct optoe_data *optoe,
 		 * io_limit data bytes.  msgbuf is u8 and will cast to our
 		 * needs.
 		 */
+		if (count > optoe->read_max)
+			count = optoe->read_max;
+
 		i = 0;
 		msgbuf[i++] = offset;
 
@@ -357,6 +410,9 @@ static ssize_t optoe_eeprom_read(struct optoe_data *optoe,
 	timeout = jiffies + msecs_to_jiffies(write_timeout);
 	do {
 		read_time = jiffies;
+		if (attempts++)
+			optoe->counters.retries++;
+		optoe->counters.reads++;
 
 		switch (optoe->use_smbus) {
 		case I2C_SMBUS_I2C_BLOCK_DATA:
@@ -388,16 +444,21 @@ static ssize_t optoe_eeprom_read(struct optoe_data *optoe,
 		dev_dbg(&client->dev, "eeprom read %zu@%d --> %d (%ld)\n",
 				count, offset, status, jiffies);
 
-		if (status == count)  /* happy path */
+		if (status == count) {  /* happy path */
+			optoe->counters.bytes_read += count;
 			return count;
+		}
 
-		if (status == -ENXIO) /* no module present */
+		if (status == -ENXIO) { /* no module present */
+			optoe->counters.errors++;
 			return status;
+		}
 
 		/* REVISIT: at HZ=100, this is sloooow */
 		usleep_range(1000, 2000);
 	} while (time_before(read_time, timeout));
 
+	optoe->counters.errors++;
 	return -ETIMEDOUT;
 }
 
@@ -411,6 +472,7 @@ static ssize_t optoe_eeprom_write(struct optoe_data *optoe,
 	unsigned long timeout, write_time;
 	unsigned int next_page_start;
 	int i = 0;
+	int attempts = 0;
 
 	/* write max is at most a page
 	 * (In this driver, write_max is actually one byte!)
@@ -458,6 +520,9 @@ static ssize_t optoe_eeprom_write(struct optoe_data *optoe,
 	timeout = jiffies + msecs_to_jiffies(write_timeout);
 	do {
 		write_time = jiffies;
+		if (attempts++)
+			optoe->counters.retries++;
+		optoe->counters.writes++;
 
 		switch (optoe->use_smbus) {
 		case I2C_SMBUS_I2C_BLOCK_DATA:
@@ -494,17 +559,70 @@ static ssize_t optoe_eeprom_write(struct optoe_data *optoe,
 		dev_dbg(&client->dev, "eeprom write %zu@%d --> %ld (%lu)\n",
 				count, offset, (long int) status, jiffies);
 
-		if (status == count)
+		if (status == count) {
+			optoe->counters.bytes_written += count;
 			return count;
+		}
 
 		/* REVISIT: at HZ=100, this is sloooow */
 		usleep_range(1000, 2000);
 	} while (time_before(write_time, timeout));
 
+	optoe->counters.errors++;
 	return -ETIMEDOUT;
 }
 
 
+/*
+ * Select a page on one client, unless it is selected already.
+ * If the page register can't be written, the page is unknown.
+ */
+static int optoe_select_page(struct optoe_data *optoe, int idx, u8 page)
+{
+	struct i2c_client *client = optoe->client[idx];
+	ssize_t ret;
+
+	if (optoe->cur_page[idx] == page) {
+		optoe->counters.page_selects_skipped++;
+		return 0;
+	}
+
+	optoe->counters.page_selects++;
+	ret = optoe_eeprom_write(optoe, client, &page,
+		OPTOE_PAGE_SELECT_REG, 1);
+	if (ret < 0) {
+		dev_dbg(&client->dev,
+			"Write page register for page %d failed ret:%ld!\n",
+				page, (long int) ret);
+		optoe->cur_page[idx] = OPTOE_PAGE_UNKNOWN;
+		return ret;
+	}
+	optoe->cur_page[idx] = page;
+	return 0;
+}
+
+/*
+ * Return every client to page 0 before giving up the lock, so that
+ * other users of the device (and a freshly inserted module) agree
+ * with the cached page.  Pages left unknown are handled by the next
+ * access, which selects its page explicitly.
+ */
+static void optoe_restore_page(struct optoe_data *optoe)
+{
+	int idx;
+	int ret;
+
+	for (idx = 0; idx < optoe->num_addresses; idx++) {
+		if (optoe->cur_page[idx] <= 0)
+			continue;
+		ret = optoe_select_page(optoe, idx, 0);
+		if (ret < 0)
+			dev_err(&optoe->client[idx]->dev,
+				"Restore page register to 0 failed:%d!\n",
+				ret);
+	}
+}
+
 static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 				char *buf, loff_t off,
 				size_t count, int opcode)
@@ -513,21 +631,30 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 	ssize_t retval = 0;
 	uint8_t page = 0;
 	loff_t phy_offset = off;
+	loff_t phy_start;
+	int idx;
 	int ret = 0;
 
 	page = optoe_translate_offset(optoe, &phy_offset, &client);
+	idx = (client == optoe->client[0]) ? 0 : 1;
+	phy_start = phy_offset;
 	dev_dbg(&client->dev,
 		"%s off %lld  page:%d phy_offset:%lld, count:%ld, opcode:%d\n",
 		__func__, off, page, phy_offset, (long int) count, opcode);
-	if (page > 0) {
-		ret = optoe_eeprom_write(optoe, client, &page,
-			OPTOE_PAGE_SELECT_REG, 1);
-		if (ret < 0) {
-			dev_dbg(&client->dev,
-				"Write page register for page %d failed ret:%d!\n",
-					page, ret);
+
+	/*
+	 * Page 0 is assumed to be selected between accesses (see
+	 * optoe_restore_page()), so it is only written if another page
+	 * is known to be left selected.
+	 * Only paged clients ever get a nonzero page, so A0h of an SFP
+	 * and flat memory modules, where byte 127 is plain EEPROM, are
+	 * never written here.
+	 */
+	if (page > 0 ||
+	    (optoe->cur_page[idx] > 0 && phy_offset + count > OPTOE_PAGE_SIZE)) {
+		ret = optoe_select_page(optoe, idx, page);
+		if (ret < 0)
 			return ret;
-		}
 	}
 
 	while (count) {
@@ -541,6 +668,9 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 				buf, phy_offset, count);
 		}
 		if (status <= 0) {
+			/* maybe no module, or a new one: forget the pages */
+			optoe->cur_page[0] = OPTOE_PAGE_UNKNOWN;
+			optoe->cur_page[1] = OPTOE_PAGE_UNKNOWN;
 			if (retval == 0)
 				retval = status;
 			break;
@@ -551,20 +681,11 @@ static ssize_t optoe_eeprom_update_client(struct optoe_data *optoe,
 		retval += status;
 	}
 
+	/* the caller wrote the page register, whatever it holds now */
+	if (opcode == OPTOE_WRITE_OP && phy_start <= OPTOE_PAGE_SELECT_REG &&
+	    phy_offset > OPTOE_PAGE_SELECT_REG)
+		optoe->cur_page[idx] = OPTOE_PAGE_UNKNOWN;
 
-	if (page > 0) {
-		/* return the page register to page 0 (why?) */
-		page = 0;
-		ret = optoe_eeprom_write(optoe, client, &page,
-			OPTOE_PAGE_SELECT_REG, 1);
-		if (ret < 0) {
-			dev_err(&client->dev,
-				"Restore page register to 0 failed:%d!\n", ret);
-			/* error only if nothing has been transferred */
-			if (retval == 0)
-				retval = ret;
-		}
-	}
 	return retval;
 }
 
@@ -676,12 +797,10 @@ static ssize_t optoe_read_write(struct optoe_data *optoe,
 		char *buf, loff_t off, size_t len, int opcode)
 {
 	struct i2c_client *client = optoe->client[0];
-	int chunk;
 	int status = 0;
 	ssize_t retval;
 	size_t pending_len = 0, chunk_len = 0;
-	loff_t chunk_offset = 0, chunk_start_offset = 0;
-	loff_t chunk_end_offset = 0;
+	loff_t chunk_offset = 0;
 
 	dev_dbg(&client->dev,
 		"%s: off %lld  len:%ld, opcode:%s\n",
@@ -701,55 +820,36 @@ static ssize_t optoe_read_write(struct optoe_data *optoe,
 	 */
 	status = optoe_page_legal(optoe, off, len);
 	if ((status == OPTOE_EOF) || (status < 0)) {
+		if (status < 0) {
+			optoe->cur_page[0] = OPTOE_PAGE_UNKNOWN;
+			optoe->cur_page[1] = OPTOE_PAGE_UNKNOWN;
+		}
 		mutex_unlock(&optoe->lock);
 		return status;
 	}
 	len = status;
 
 	/*
-	 * For each (128 byte) chunk involved in this request, issue a
-	 * separate call to sff_eeprom_update_client(), to
-	 * ensure that each access recalculates the client/page
-	 * and writes the page register as needed.
-	 * Note that chunk to page mapping is confusing, is different for
-	 * QSFP and SFP, and never needs to be done.  Don't try!
+	 * Split the request where the client or page changes, and issue
+	 * a separate call to optoe_eeprom_update_client() for each part,
+	 * which recalculates the client/page and selects the page as
+	 * needed.  The lower page and upper page 00h go together; above
+	 * that, each part is at most one 128 byte page.  Parts are in
+	 * ascending order, so a page is selected at most once, and page
+	 * 0 is restored once at the end rather than after every page.
 	 */
 	pending_len = len; /* amount remaining to transfer */
 	retval = 0;  /* amount transferred */
-	for (chunk = off >> 7; chunk <= (off + len - 1) >> 7; chunk++) {
-
-		/*
-		 * Compute the offset and number of bytes to be read/write
-		 *
-		 * 1. start at an offset not equal to 0 (within the chunk)
-		 *    and read/write less than the rest of the chunk
-		 * 2. start at an offset not equal to 0 and read/write the rest
-		 *    of the chunk
-		 * 3. start at offset 0 (within the chunk) and read/write less
-		 *    than entire chunk
-		 * 4. start at offset 0 (within the chunk), and read/write
-		 *    the entire chunk
-		 */
-		chunk_start_offset = chunk * OPTOE_PAGE_SIZE;
-		chunk_end_offset = chunk_start_offset + OPTOE_PAGE_SIZE;
-
-		if (chunk_start_offset < off) {
-			chunk_offset = off;
-			if ((off + pending_len) < chunk_end_offset)
-				chunk_len = pending_len;
-			else
-				chunk_len = chunk_end_offset - off;
-		} else {
-			chunk_offset = chunk_start_offset;
-			if (pending_len < OPTOE_PAGE_SIZE)
-				chunk_len = pending_len;
-			else
-				chunk_len = OPTOE_PAGE_SIZE;
-		}
+	chunk_offset = off;
+	while (pending_len) {
+		chunk_len = optoe_segment_end(optoe, chunk_offset) -
+				chunk_offset;
+		if (chunk_len > pending_len)
+			chunk_len = pending_len;
 
 		dev_dbg(&client->dev,
-			"sff_r/w: off %lld, len %ld, chunk_start_offset %lld, chunk_offset %lld, chunk_len %ld, pending_len %ld\n",
-			off, (long int) len, chunk_start_offset, chunk_offset,
+			"sff_r/w: off %lld, len %ld, chunk_offset %lld, chunk_len %ld, pending_len %ld\n",
+			off, (long int) len, chunk_offset,
 			(long int) chunk_len, (long int) pending_len);
 
 		/*
@@ -761,8 +861,8 @@ static ssize_t optoe_read_write(struct optoe_data *optoe,
 		if (status != chunk_len) {
 			/* This is another 'no device present' path */
 			dev_dbg(&client->dev,
-			"o_u_c: chunk %d c_offset %lld c_len %ld failed %d!\n",
-			chunk, chunk_offset, (long int) chunk_len, status);
+			"o_u_c: c_offset %lld c_len %ld failed %d!\n",
+			chunk_offset, (long int) chunk_len, status);
 			if (status > 0)
 				retval += status;
 			if (retval == 0)
@@ -770,9 +870,11 @@ static ssize_t optoe_read_write(struct optoe_data *optoe,
 			break;
 		}
 		buf += status;
+		chunk_offset += status;
 		pending_len -= status;
 		retval += status;
 	}
+	optoe_restore_page(optoe);
 	mutex_unlock(&optoe->lock);
 
 	return retval;
@@ -879,6 +981,8 @@ static ssize_t set_dev_class(struct device *dev,
 		optoe->num_addresses = 1;
 	}
 	optoe->dev_class = dev_class;
+	optoe->cur_page[0] = OPTOE_PAGE_UNKNOWN;
+	optoe->cur_page[1] = OPTOE_PAGE_UNKNOWN;
 	mutex_unlock(&optoe->lock);
 
 	return count;
@@ -928,13 +1032,55 @@ static ssize_t set_port_name(struct device *dev,
 static DEVICE_ATTR(port_name,  0644, show_port_name, set_port_name);
 #endif  /* if NOT defined EEPROM_CLASS, the common case */
 
+static ssize_t show_counters(struct device *dev,
+			struct device_attribute *dattr, char *buf)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct optoe_data *optoe = i2c_get_clientdata(client);
+	struct optoe_counters c;
+
+	mutex_lock(&optoe->lock);
+	c = optoe->counters;
+	mutex_unlock(&optoe->lock);
+
+	return sprintf(buf,
+		"reads %llu\n"
+		"writes %llu\n"
+		"retries %llu\n"
+		"errors %llu\n"
+		"bytes_read %llu\n"
+		"bytes_written %llu\n"
+		"page_selects %llu\n"
+		"page_selects_skipped %llu\n",
+		c.reads, c.writes, c.retries, c.errors,
+		c.bytes_read, c.bytes_written,
+		c.page_selects, c.page_selects_skipped);
+}
+
+/* any write clears the counters */
+static ssize_t clear_counters(struct device *dev,
+			struct device_attribute *attr,
+			const char *buf, size_t count)
+{
+	struct i2c_client *client = to_i2c_client(dev);
+	struct optoe_data *optoe = i2c_get_clientdata(client);
+
+	mutex_lock(&optoe->lock);
+	memset(&optoe->counters, 0, sizeof(optoe->counters));
+	mutex_unlock(&optoe->lock);
+
+	return count;
+}
+
 static DEVICE_ATTR(dev_class,  0644, show_dev_class, set_dev_class);
+static DEVICE_ATTR(counters,  0644, show_counters, clear_counters);
 
 static struct attribute *optoe_attrs[] = {
 #ifndef EEPROM_CLASS
 	&dev_attr_port_name.attr,
 #endif
 	&dev_attr_dev_class.attr,
+	&dev_attr_counters.attr,
 	NULL,
 };
 
@@ -1015,6 +1161,8 @@ static int optoe_probe(struct i2c_client *client,
 	}
 
 	mutex_init(&optoe->lock);
+	optoe->cur_page[0] = OPTOE_PAGE_UNKNOWN;
+	optoe->cur_page[1] = OPTOE_PAGE_UNKNOWN;
 
 	/* determine whether this is a one-address or two-address module */
 	if ((strcmp(client->name, "optoe1") == 0) ||
@@ -1041,6 +1189,19 @@ static int optoe_probe(struct i2c_client *client,
 
 	dev_dbg(&client->dev, "dev_class: %d\n", optoe->dev_class);
 	optoe->use_smbus = use_smbus;
+	optoe->read_max = io_limit;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4, 1, 0)
+	/* the data is the second message of a combined transfer */
+	if (client->adapter->quirks) {
+		const struct i2c_adapter_quirks *q = client->adapter->quirks;
+
+		if (q->max_read_len && optoe->read_max > q->max_read_len)
+			optoe->read_max = q->max_read_len;
+		if (q->max_comb_2nd_msg_len &&
+		    optoe->read_max > q->max_comb_2nd_msg_len)
+			optoe->read_max = q->max_comb_2nd_msg_len;
+	}
+#endif
 	optoe->chip = chip;
 	optoe->num_addresses = num_addresses;
 	memcpy(optoe->port_name, port_name, MAX_PORT_NAME_LEN);
@@ -29,6 +29,7 @@
 #include <linux/hwmon-sysfs.h>
 #include <linux/err.h>
 #include <linux/mutex.h>
+#include <linux/spinlock.h>
 #include <linux/sysfs.h>
 #include <linux/slab.h>
 #include <linux/delay.h>
@@ -41,6 +42,10 @@
 
 static int support_i2c_block = 1; // 1: support I2C_FUNC_SMBUS_I2C_BLOCK 0: not support
 
+static unsigned int update_interval = 1500;
+module_param(update_interval, uint, S_IRUGO | S_IWUSR);
+MODULE_PARM_DESC(update_interval, "Telemetry refresh interval in milliseconds");
+
 /* Addresses scanned
  */
 static const unsigned short normal_i2c[] = { I2C_CLIENT_END };
@@ -53,28 +58,14 @@ enum chips {
     YPEB1200AM
 };
 
-/* Each client has this additional data
+/* Register values. The identity and limit registers do not change
+ * while the PSU is plugged in and are read once, the telemetry on every
+ * refresh.
  */
-struct ym2651y_data {
-    struct device     *hwmon_dev;
-    struct mutex        update_lock;
-    char                valid;         /* !=0 if registers are valid */
-    unsigned long      last_updated;    /* In jiffies */
-    u8   chip;          /* chip id */
+struct ym2651y_regs {
+    /* Identity and limits */
     u8   capability;     /* Register value */
-    u16  status_word;   /* Register value */
-    u8   fan_fault;   /* Register value */
-    u8   over_temp;   /* Register value */
-    u16  v_in;        /* Register value */
-    u16  i_in;        /* Register value */
-    u16  p_in;        /* Register value */
-    u16  v_out;       /* Register value */
-    u16  i_out;       /* Register value */
-    u16  p_out;       /* Register value */
     u8   vout_mode;     /* Register value */
-    u16  temp;         /* Register value */
-    u16  fan_speed;   /* Register value */
-    u16  fan_duty_cycle[2];  /* Register value */
     u8   fan_dir[5];     /* Register value */
     u8   pmbus_revision; /* Register value */
     u8   mfr_id[10];     /* Register value */
@@ -90,6 +81,33 @@ struct ym2651y_data {
     u16  mfr_pout_max;   /* Register value */
     u16  mfr_vout_min;   /* Register value */
     u16  mfr_vout_max;   /* Register value */
+
+    /* Telemetry */
+    u16  status_word;   /* Register value */
+    u8   fan_fault;   /* Register value */
+    u8   over_temp;   /* Register value */
+    u16  v_in;        /* Register value */
+    u16  i_in;        /* Register value */
+    u16  p_in;        /* Register value */
+    u16  v_out;       /* Register value */
+    u16  i_out;       /* Register value */
+    u16  p_out;       /* Register value */
+    u16  temp;         /* Register value */
+    u16  fan_speed;   /* Register value */
+    u16  fan_duty_cycle[2];  /* Register value */
+};
+
+/* Each client has this additional data
+ */
+struct ym2651y_data {
+    struct device     *hwmon_dev;
+    struct mutex        update_lock;   /* Serializes PSU access */
+    spinlock_t          lock;          /* Protects the fields below */
+    char                valid;         /* !=0 if registers are valid */
+    char                static_valid;  /* !=0 if identity and limits are valid */
+    unsigned long      last_updated;    /* In jiffies */
+    u8   chip;          /* chip id */
+    struct ym2651y_regs regs;
 };
 
 static ssize_t show_byte(struct device *dev, struct device_attribute *da,
@@ -105,7 +123,7 @@ static ssize_t show_over_temp(struct device *dev, struct device_attribute *da,
              char *buf);
 static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
              char *buf);
-static struct ym2651y_data *ym2651y_update_device(struct device *dev);
+static int ym2651y_update_device(struct device *dev, struct ym2651y_regs *regs);
 static ssize_t set_fan_duty_cycle(struct device *dev, struct device_attribute *da,
              const char *buf, size_t count);
 static int ym2651y_write_word(struct i2c_client *client, u8 reg, u16 value);
@@ -211,13 +229,13 @@ static ssize_t show_byte(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_regs regs;
 
-    if (!data->valid) {
+    if (ym2651y_update_device(dev, &regs) < 0) {
         return 0;
     }
 
-    return (attr->index == PSU_PMBUS_REVISION) ? sprintf(buf, "%d\n", data->pmbus_revision) :
+    return (attr->index == PSU_PMBUS_REVISION) ? sprintf(buf, "%d\n", regs.pmbus_revision) :
                                  sprintf(buf, "0\n");
 }
 
@@ -225,22 +243,22 @@ static ssize_t show_word(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_regs regs;
     u16 status = 0;
 
-    if (!data->valid) {
+    if (ym2651y_update_device(dev, &regs) < 0) {
         return 0;
     }
 
     switch (attr->index) {
     case PSU_POWER_ON: /* psu_power_on, low byte bit 6 of status_word, 0=>ON, 1=>OFF */
-        status = (data->status_word & 0x40) ? 0 : 1;
+        status = (regs.status_word & 0x40) ? 0 : 1;
         break;
     case PSU_TEMP_FAULT: /* psu_temp_fault, low byte bit 2 of status_word, 0=>Normal, 1=>temp fault */
-        status = (data->status_word & 0x4) >> 2;
+        status = (regs.status_word & 0x4) >> 2;
         break;
     case PSU_POWER_GOOD: /* psu_power_good, high byte bit 3 of status_word, 0=>OK, 1=>FAIL */
-        status = (data->status_word & 0x800) ? 0 : 1;
+        status = (regs.status_word & 0x800) ? 0 : 1;
         break;
     default:
         return 0;
@@ -275,8 +293,10 @@ static ssize_t set_fan_duty_cycle(struct device *dev, struct device_attribute *d
         return -EINVAL;
 
     mutex_lock(&data->update_lock);
-    data->fan_duty_cycle[nr] = speed;
-    ym2651y_write_word(client, 0x3B + nr, data->fan_duty_cycle[nr]);
+    ym2651y_write_word(client, 0x3B + nr, speed);
+    spin_lock(&data->lock);
+    data->regs.fan_duty_cycle[nr] = speed;
+    spin_unlock(&data->lock);
     mutex_unlock(&data->update_lock);
 
     return count;
@@ -286,80 +306,81 @@ static ssize_t show_linear(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_regs regs;
     u8 *ptr = NULL;
 
     u16 value = 0;
     int exponent, mantissa;
     int multiplier = 1000;
-    ptr = data->mfr_model + 1; /* The first byte is the count byte of string. */
 
-    if (!data->valid) {
+    if (ym2651y_update_device(dev, &regs) < 0) {
         return 0;
     }
 
+    ptr = regs.mfr_model + 1; /* The first byte is the count byte of string. */
+
     switch (attr->index) {
     case PSU_V_IN:
         if ((strncmp(ptr, "DPS-850A", strlen("DPS-850A")) == 0)||
             (strncmp(ptr, "YM-2851J", strlen("YM-2851J")) == 0)) {
-            value = data->v_in;
+            value = regs.v_in;
         }
         break;
     case PSU_I_IN:
         if ((strncmp(ptr, "DPS-850A", strlen("DPS-850A")) == 0)||
             (strncmp(ptr, "YM-2851J", strlen("YM-2851J")) == 0)) {
-            value = data->i_in;
+            value = regs.i_in;
         }
         break;
     case PSU_P_IN:
         if ((strncmp(ptr, "DPS-850A", strlen("DPS-850A")) == 0)||
             (strncmp(ptr, "YM-2851J", strlen("YM-2851J")) == 0)) {
-            value = data->p_in;
+            value = regs.p_in;
         }
         break;
     case PSU_V_OUT:
-        value = data->v_out;
+        value = regs.v_out;
         break;
     case PSU_I_OUT:
-        value = data->i_out;
+        value = regs.i_out;
         break;
     case PSU_P_OUT:
-        value = data->p_out;
+        value = regs.p_out;
         break;
     case PSU_TEMP1_INPUT:
-        value = data->temp;
+        value = regs.temp;
         break;
     case PSU_FAN1_SPEED:
-        value = data->fan_speed;
+        value = regs.fan_speed;
         multiplier = 1;
         break;
     case PSU_FAN1_DUTY_CYCLE:
-        value = data->fan_duty_cycle[0];
+        value = regs.fan_duty_cycle[0];
         multiplier = 1;
         break;
     case PSU_MFR_VIN_MIN:
-        value = data->mfr_vin_min;
+        value = regs.mfr_vin_min;
         break;
     case PSU_MFR_VIN_MAX:
-        value = data->mfr_vin_max;
+        value = regs.mfr_vin_max;
         break;
     case PSU_MFR_VOUT_MIN:
-        value = data->mfr_vout_min;
+        value = regs.mfr_vout_min;
         break;
     case PSU_MFR_VOUT_MAX:
-        value = data->mfr_vout_max;
+        value = regs.mfr_vout_max;
         break;
     case PSU_MFR_PIN_MAX:
-        value = data->mfr_pin_max;
+        value = regs.mfr_pin_max;
         break;
     case PSU_MFR_POUT_MAX:
-        value = data->mfr_pout_max;
+        value = regs.mfr_pout_max;
         break;
     case PSU_MFR_IOUT_MAX:
-        value = data->mfr_iout_max;
+        value = regs.mfr_iout_max;
         break;
     case PSU_MFR_IIN_MAX:
-        value = data->mfr_iin_max;
+        value = regs.mfr_iin_max;
         break;
     default:
         return 0;
@@ -376,70 +397,70 @@ static ssize_t show_fan_fault(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_regs regs;
     u8 shift;
 
-    if (!data->valid) {
+    if (ym2651y_update_device(dev, &regs) < 0) {
         return 0;
     }
 
     shift = (attr->index == PSU_FAN1_FAULT) ? 7 : 6;
 
-    return sprintf(buf, "%d\n", data->fan_fault >> shift);
+    return sprintf(buf, "%d\n", regs.fan_fault >> shift);
 }
 
 static ssize_t show_over_temp(struct device *dev, struct device_attribute *da,
              char *buf)
 {
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_regs regs;
 
-    if (!data->valid) {
+    if (ym2651y_update_device(dev, &regs) < 0) {
         return 0;
     }
 
-    return sprintf(buf, "%d\n", data->over_temp >> 7);
+    return sprintf(buf, "%d\n", regs.over_temp >> 7);
 }
 
 static ssize_t show_ascii(struct device *dev, struct device_attribute *da,
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_regs regs;
     u8 *ptr = NULL;
 
-    if (!data->valid) {
+    if (ym2651y_update_device(dev, &regs) < 0) {
         return 0;
     }
 
     switch (attr->index) {
     case PSU_FAN_DIRECTION: /* psu_fan_dir */
-        ptr = data->fan_dir + 1;  /* Skip the first byte since it is the length of string. */
+        ptr = regs.fan_dir + 1;  /* Skip the first byte since it is the length of string. */
         /* FAN direction for PTT1600's PSU, depends on 
         4th and 3rd bit of return value of 0xC3 command */
-        if (strncmp((data->mfr_model + 1),"PTT1600", strlen("PTT1600")) == 0) {
+        if (strncmp((regs.mfr_model + 1),"PTT1600", strlen("PTT1600")) == 0) {
             /* Check if 4th bit is '1' and 3rd bit is '0' for "F2B (AFO)" FAN direction */
-            if((((data->fan_dir[0] >> 3) & 1) == 0) && (((data->fan_dir[0] >> 4) & 1) == 1)) {
+            if((((regs.fan_dir[0] >> 3) & 1) == 0) && (((regs.fan_dir[0] >> 4) & 1) == 1)) {
                 strcpy(ptr,"AFO");
             }/* Check if 4th bit is '0' and 3rd bit is '1' for "B2F (AFI)" FAN direction */
-            else if ((((data->fan_dir[0] >> 3) & 1) == 1) && (((data->fan_dir[0] >> 4) & 1) == 0)) {
+            else if ((((regs.fan_dir[0] >> 3) & 1) == 1) && (((regs.fan_dir[0] >> 4) & 1) == 0)) {
                 strcpy(ptr,"AFI");
             }
         }
         break;
     case PSU_MFR_ID: /* psu_mfr_id */
-            ptr = data->mfr_id + 1; /* The first byte is the count byte of string. */;
+            ptr = regs.mfr_id + 1; /* The first byte is the count byte of string. */;
         break;
     case PSU_MFR_MODEL: /* psu_mfr_model */
-            ptr = data->mfr_model + 1; /* The first byte is the count byte of string. */
+            ptr = regs.mfr_model + 1; /* The first byte is the count byte of string. */
         break;
     case PSU_MFR_MODEL_OPTION: /* psu_mfr_model_opt */
-            ptr = data->mfr_model_opt + 1; /* The first byte is the count byte of string. */
+            ptr = regs.mfr_model_opt + 1; /* The first byte is the count byte of string. */
         break;
     case PSU_MFR_REVISION: /* psu_mfr_revision */
-            ptr = data->mfr_revsion + 1; /* The first byte is the count byte of string. */
+            ptr = regs.mfr_revsion + 1; /* The first byte is the count byte of string. */
         break;
     case PSU_MFR_SERIAL: /* psu_mfr_serial */
-        ptr = data->mfr_serial + 1; /* The first byte is the count byte of string. */
+        ptr = regs.mfr_serial + 1; /* The first byte is the count byte of string. */
         break;
     default:
         return 0;
@@ -452,24 +473,24 @@ static ssize_t show_vout_by_mode(struct device *dev, struct device_attribute *da
              char *buf)
 {
     struct sensor_device_attribute *attr = to_sensor_dev_attr(da);
-    struct ym2651y_data *data = ym2651y_update_device(dev);
+    struct ym2651y_regs regs;
     int exponent, mantissa;
     int multiplier = 1000;
 
-    if (!data->valid) {
+    if (ym2651y_update_device(dev, &regs) < 0) {
         return 0;
     }
 
-    exponent = two_complement_to_int(data->vout_mode, 5, 0x1f);
+    exponent = two_complement_to_int(regs.vout_mode, 5, 0x1f);
     switch (attr->index) {
     case PSU_MFR_VOUT_MIN:
-        mantissa = data->mfr_vout_min;
+        mantissa = regs.mfr_vout_min;
         break;
     case PSU_MFR_VOUT_MAX:
-        mantissa = data->mfr_vout_max;
+        mantissa = regs.mfr_vout_max;
         break;
     case PSU_V_OUT:
-        mantissa = data->v_out;
+        mantissa = regs.v_out;
         break;
     default:
         return 0;
@@ -484,9 +505,14 @@ static ssize_t show_vout(struct device *dev, struct device_attribute *da,
 {
     struct i2c_client *client = to_i2c_client(dev);
     struct ym2651y_data *data = i2c_get_clientdata(client);
+    struct ym2651y_regs regs;
     u8 *ptr = NULL;
 
-    ptr = data->mfr_model + 1; /* The first byte is the count byte of string. */
+    if (ym2651y_update_device(dev, &regs) < 0) {
+        return 0;
+    }
+
+    ptr = regs.mfr_model + 1; /* The first byte is the count byte of string. */
     if (data->chip == YM2401) {
         return show_vout_by_mode(dev, da, buf);
     }
@@ -529,6 +555,7 @@ static int ym2651y_probe(struct i2c_client *client,
 
     i2c_set_clientdata(client, data);
     mutex_init(&data->update_lock);
+    spin_lock_init(&data->lock);
     data->chip = dev_id->driver_data;
     dev_info(&client->dev, "chip found\n");
 
@@ -678,174 +705,253 @@ struct reg_data_word {
     u16 *value;
 };
 
-static struct ym2651y_data *ym2651y_update_device(struct device *dev)
+static int ym2651y_read_byte_regs(struct i2c_client *client,
+                                  struct reg_data_byte *regs, int count)
 {
-    struct i2c_client *client = to_i2c_client(dev);
-    struct ym2651y_data *data = i2c_get_clientdata(client);
+    int i, status;
 
-    mutex_lock(&data->update_lock);
+    for (i = 0; i < count; i++) {
+        status = ym2651y_read_byte(client, regs[i].reg);
 
-    if (time_after(jiffies, data->last_updated + HZ + HZ / 2)
-        || !data->valid) {
-        int i, status, length;
-        u8 command, buf;
-        struct reg_data_byte regs_byte[] = { {0x19, &data->capability},
-                                             {0x20, &data->vout_mode},
-                                             {0x7d, &data->over_temp},
-                                             {0x81, &data->fan_fault},
-                                             {0x98, &data->pmbus_revision}};
-        struct reg_data_word regs_word[] = { {0x79, &data->status_word},
-                                             {0x88, &data->v_in},
-                                             {0x8b, &data->v_out},
-                                             {0x89, &data->i_in},
-                                             {0x8c, &data->i_out},
-                                             {0x97, &data->p_in},
-                                             {0x96, &data->p_out},
-                                             {0x8d, &data->temp},
-                                             {0x3b, &(data->fan_duty_cycle[0])},
-                                             {0x3c, &(data->fan_duty_cycle[1])},
-                                             {0x90, &data->fan_speed},
-                                             {0xa0, &data->mfr_vin_min},
-                                             {0xa1, &data->mfr_vin_max},
-                                             {0xa2, &data->mfr_iin_max},
-                                             {0xa3, &data->mfr_pin_max},
-                                             {0xa4, &data->mfr_vout_min},
-                                             {0xa5, &data->mfr_vout_max},
-                                             {0xa6, &data->mfr_iout_max},
-                                             {0xa7, &data->mfr_pout_max}};
-
-        dev_dbg(&client->dev, "Starting ym2651 update\n");
-        data->valid = 0;
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", regs[i].reg, status);
+            return status;
+        }
 
-        /* Read byte data */
-        for (i = 0; i < ARRAY_SIZE(regs_byte); i++) {
-            status = ym2651y_read_byte(client, regs_byte[i].reg);
+        *(regs[i].value) = status;
+    }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_byte[i].reg, status);
-                goto exit;
-            }
-            else {
-                *(regs_byte[i].value) = status;
-            }
+    return 0;
+}
+
+static int ym2651y_read_word_regs(struct i2c_client *client,
+                                  struct reg_data_word *regs, int count)
+{
+    int i, status;
+
+    for (i = 0; i < count; i++) {
+        status = ym2651y_read_word(client, regs[i].reg);
+
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", regs[i].reg, status);
+            return status;
         }
 
-        /* Read word data */
-        for (i = 0; i < ARRAY_SIZE(regs_word); i++) {
-            status = ym2651y_read_word(client, regs_word[i].reg);
+        *(regs[i].value) = status;
+    }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n",
-                        regs_word[i].reg, status);
-                goto exit;
-            }
-            else {
-                *(regs_word[i].value) = status;
-            }
+    return 0;
+}
+
+/* Read a block of a fixed size, or of the size given by its first
+ * byte if size is 0. The result is truncated to fit and terminated.
+ */
+static int ym2651y_read_string(struct i2c_client *client, u8 command,
+                               u8 *data, int data_len, int size)
+{
+    int status;
+    u8 buf;
+
+    if (!size) {
+        /* Read first byte to determine the length of data */
+        status = ym2651y_read_block(client, command, &buf, 1);
+        if (status < 0) {
+            dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+            return status;
         }
 
-        if (support_i2c_block) {
+        size = buf + 1;
+    }
 
-            /* Read fan_direction */
-            command = 0xC3;
-            status = ym2651y_read_block(client, command, data->fan_dir,
-                                         ARRAY_SIZE(data->fan_dir)-1);
-            data->fan_dir[ARRAY_SIZE(data->fan_dir)-1] = '\0';
+    size = min(size, data_len - 1);
+    status = ym2651y_read_block(client, command, data, size);
+    data[size] = '\0';
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+    if (status < 0) {
+        dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
+        return status;
+    }
 
-            /* Read mfr_id */
-            command = 0x99;
-            status = ym2651y_read_block(client, command, data->mfr_id,
-                                            ARRAY_SIZE(data->mfr_id)-1);
-            data->mfr_id[ARRAY_SIZE(data->mfr_id)-1] = '\0';
+    return 0;
+}
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+/* Identity and limits, read once after the PSU shows up
+ */
+static int ym2651y_read_static(struct i2c_client *client, struct ym2651y_regs *regs)
+{
+    int status;
+    struct reg_data_byte regs_byte[] = { {0x19, &regs->capability},
+                                         {0x20, &regs->vout_mode},
+                                         {0x98, &regs->pmbus_revision}};
+    struct reg_data_word regs_word[] = { {0xa0, &regs->mfr_vin_min},
+                                         {0xa1, &regs->mfr_vin_max},
+                                         {0xa2, &regs->mfr_iin_max},
+                                         {0xa3, &regs->mfr_pin_max},
+                                         {0xa4, &regs->mfr_vout_min},
+                                         {0xa5, &regs->mfr_vout_max},
+                                         {0xa6, &regs->mfr_iout_max},
+                                         {0xa7, &regs->mfr_pout_max}};
+
+    status = ym2651y_read_byte_regs(client, regs_byte, ARRAY_SIZE(regs_byte));
+    if (status < 0) {
+        return status;
+    }
 
-            /* Read mfr_model */
-            command = 0x9a;
-            length  = 1;
+    status = ym2651y_read_word_regs(client, regs_word, ARRAY_SIZE(regs_word));
+    if (status < 0) {
+        return status;
+    }
 
-            /* Read first byte to determine the length of data */
-            status = ym2651y_read_block(client, command, &buf, length);
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+    if (!support_i2c_block) {
+        return 0;
+    }
 
-            status = ym2651y_read_block(client, command, data->mfr_model, buf+1);
-            data->mfr_model[buf+1] = '\0';
+    /* Read fan_direction */
+    status = ym2651y_read_string(client, 0xC3, regs->fan_dir,
+                                 ARRAY_SIZE(regs->fan_dir), ARRAY_SIZE(regs->fan_dir)-1);
+    if (status < 0) {
+        return status;
+    }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+    /* Read mfr_id */
+    status = ym2651y_read_string(client, 0x99, regs->mfr_id,
+                                 ARRAY_SIZE(regs->mfr_id), ARRAY_SIZE(regs->mfr_id)-1);
+    if (status < 0) {
+        return status;
+    }
 
-            /* Read mfr_model_opt */
-            command = 0xd0;
-            length  = 1;
+    /* Read mfr_model */
+    status = ym2651y_read_string(client, 0x9a, regs->mfr_model,
+                                 ARRAY_SIZE(regs->mfr_model), 0);
+    if (status < 0) {
+        return status;
+    }
 
-            /* Read first byte to determine the length of data */
-            status = ym2651y_read_block(client, command, &buf, length);
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+    /* Read mfr_model_opt */
+    status = ym2651y_read_string(client, 0xd0, regs->mfr_model_opt,
+                                 ARRAY_SIZE(regs->mfr_model_opt), 0);
+    if (status < 0) {
+        return status;
+    }
 
-            status = ym2651y_read_block(client, command, data->mfr_model_opt, buf+1);
-            data->mfr_model_opt[buf+1] = '\0';
+    /* Read mfr_revsion */
+    status = ym2651y_read_string(client, 0x9b, regs->mfr_revsion,
+                                 ARRAY_SIZE(regs->mfr_revsion), ARRAY_SIZE(regs->mfr_revsion)-1);
+    if (status < 0) {
+        return status;
+    }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+    /* Read mfr_serial */
+    return ym2651y_read_string(client, 0x9e, regs->mfr_serial,
+                               ARRAY_SIZE(regs->mfr_serial), 0);
+}
 
-            /* Read mfr_revsion */
-            command = 0x9b;
-            status = ym2651y_read_block(client, command, data->mfr_revsion,
-                                            ARRAY_SIZE(data->mfr_revsion)-1);
-            data->mfr_revsion[ARRAY_SIZE(data->mfr_revsion)-1] = '\0';
+static int ym2651y_read_telemetry(struct i2c_client *client, struct ym2651y_regs *regs)
+{
+    int status;
+    struct reg_data_byte regs_byte[] = { {0x7d, &regs->over_temp},
+                                         {0x81, &regs->fan_fault}};
+    struct reg_data_word regs_word[] = { {0x79, &regs->status_word},
+                                         {0x88, &regs->v_in},
+                                         {0x8b, &regs->v_out},
+                                         {0x89, &regs->i_in},
+                                         {0x8c, &regs->i_out},
+                                         {0x97, &regs->p_in},
+                                         {0x96, &regs->p_out},
+                                         {0x8d, &regs->temp},
+                                         {0x3b, &(regs->fan_duty_cycle[0])},
+                                         {0x3c, &(regs->fan_duty_cycle[1])},
+                                         {0x90, &regs->fan_speed}};
+
+    status = ym2651y_read_byte_regs(client, regs_byte, ARRAY_SIZE(regs_byte));
+    if (status < 0) {
+        return status;
+    }
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+    return ym2651y_read_word_regs(client, regs_word, ARRAY_SIZE(regs_word));
+}
 
-            /* Read mfr_serial */
-            command = 0x9e;
-            length  = 1;
+static int ym2651y_is_stale(struct ym2651y_data *data)
+{
+    return !data->valid ||
+           time_after(jiffies, data->last_updated + msecs_to_jiffies(update_interval));
+}
 
-            /* Read first byte to determine the length of data */
-            status = ym2651y_read_block(client, command, &buf, length);
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
+/* Refresh the telemetry, and the mfr_* strings and limits if they are
+ * not valid yet. The caller holds update_lock. Attribute reads only take
+ * data->lock, so they are not held up by the SMBus reads here.
+ */
+static void ym2651y_refresh(struct i2c_client *client, struct ym2651y_data *data)
+{
+    struct ym2651y_regs regs;
+    char static_valid;
+    int status;
 
-            status = ym2651y_read_block(client, command, data->mfr_serial, buf+1);
-            data->mfr_serial[buf+1] = '\0';
+    spin_lock(&data->lock);
+    if (!ym2651y_is_stale(data)) {
+        spin_unlock(&data->lock);
+        return;
+    }
+    regs = data->regs;
+    static_valid = data->static_valid;
+    spin_unlock(&data->lock);
 
-            if (status < 0) {
-                dev_dbg(&client->dev, "reg %d, err %d\n", command, status);
-                goto exit;
-            }
-        }
+    dev_dbg(&client->dev, "Starting ym2651 update\n");
 
+    status = ym2651y_read_telemetry(client, &regs);
+    if (status == 0 && !static_valid) {
+        status = ym2651y_read_static(client, &regs);
+    }
+
+    spin_lock(&data->lock);
+    if (status < 0) {
+        /* The PSU is gone or not answering. Read its identity again
+         * once it is back, it may be a different one.
+         */
+        data->valid = 0;
+        data->static_valid = 0;
+    }
+    else {
+        data->regs = regs;
         data->last_updated = jiffies;
         data->valid = 1;
+        data->static_valid = 1;
     }
+    spin_unlock(&data->lock);
+}
 
-exit:
-    mutex_unlock(&data->update_lock);
+static int ym2651y_update_device(struct device *dev, struct ym2651y_regs *regs)
+{
+    struct i2c_client *client = to_i2c_client(dev);
+    struct ym2651y_data *data = i2c_get_clientdata(client);
+    int stale, valid;
+
+    spin_lock(&data->lock);
+    stale = ym2651y_is_stale(data);
+    valid = data->valid;
+    spin_unlock(&data->lock);
+
+    if (stale) {
+        if (!valid) {
+            mutex_lock(&data->update_lock);
+        }
+        else if (!mutex_trylock(&data->update_lock)) {
+            /* Refresh in progress; return the published snapshot */
+            goto out;
+        }
+        ym2651y_refresh(client, data);
+        mutex_unlock(&data->update_lock);
+    }
+
+out:
+    spin_lock(&data->lock);
+    valid = data->valid;
+    if (valid) {
+        *regs = data->regs;
+    }
+    spin_unlock(&data->lock);
 
-    return data;
+    return valid ? 0 : -EIO;
 }
 
 static int __init ym2651y_init(void)
@@ -171,6 +171,16 @@
 #define ONLP_SNMP_CONFIG_INCLUDE_LEDS 1
 #endif
 
+/**
+ * ONLP_SNMP_CONFIG_INCLUDE_SFPS
+ *
+ * Include SFP DOM. */
+
+
+#ifndef ONLP_SNMP_CONFIG_INCLUDE_SFPS
+#define ONLP_SNMP_CONFIG_INCLUDE_SFPS 1
+#endif
+
 /**
  * ONLP_SNMP_CONFIG_INCLUDE_PLATFORM
  *
@@ -201,6 +211,16 @@
 #define ONLP_SNMP_CONFIG_RESOURCE_UPDATE_SECONDS 5
 #endif
 
+/**
+ * ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS
+ *
+ * Maximum number of CPUs reported in the per-CPU resource table. */
+
+
+#ifndef ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS
+#define ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS 64
+#endif
+
 
 
 /**
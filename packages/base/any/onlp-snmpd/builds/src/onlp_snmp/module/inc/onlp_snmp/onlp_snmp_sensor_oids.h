@@ -61,6 +61,7 @@
 #define ONLP_SNMP_SENSOR_PSU_OID     ONLP_SNMP_SENSOR_OID_CREATE(PSU)
 #define ONLP_SNMP_SENSOR_LED_OID     ONLP_SNMP_SENSOR_OID_CREATE(LED)
 #define ONLP_SNMP_SENSOR_MISC_OID    ONLP_SNMP_SENSOR_OID_CREATE(MISC)
+#define ONLP_SNMP_SENSOR_SFP_OID     ONLP_SNMP_SENSOR_OID_CREATE(SFP)
 
 /*
  * For legality check only, the sensor oid length from
@@ -102,7 +103,8 @@ typedef enum onlp_snmp_sensor_type_e {
     ONLP_SNMP_SENSOR_TYPE_PSU = 3,
     ONLP_SNMP_SENSOR_TYPE_LED = 4,
     ONLP_SNMP_SENSOR_TYPE_MISC = 5,
-    ONLP_SNMP_SENSOR_TYPE_MAX = 5,
+    ONLP_SNMP_SENSOR_TYPE_SFP = 6,
+    ONLP_SNMP_SENSOR_TYPE_MAX = 6,
 } onlp_snmp_sensor_type_t;
 /* <auto.end.enum(tag:mib).define> */
 
@@ -85,6 +85,11 @@ onlp_snmp_config_settings_t onlp_snmp_config_settings[] =
 #else
 { ONLP_SNMP_CONFIG_INCLUDE_LEDS(__onlp_snmp_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef ONLP_SNMP_CONFIG_INCLUDE_SFPS
+    { __onlp_snmp_config_STRINGIFY_NAME(ONLP_SNMP_CONFIG_INCLUDE_SFPS), __onlp_snmp_config_STRINGIFY_VALUE(ONLP_SNMP_CONFIG_INCLUDE_SFPS) },
+#else
+{ ONLP_SNMP_CONFIG_INCLUDE_SFPS(__onlp_snmp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef ONLP_SNMP_CONFIG_INCLUDE_PLATFORM
     { __onlp_snmp_config_STRINGIFY_NAME(ONLP_SNMP_CONFIG_INCLUDE_PLATFORM), __onlp_snmp_config_STRINGIFY_VALUE(ONLP_SNMP_CONFIG_INCLUDE_PLATFORM) },
 #else
@@ -99,6 +104,11 @@ onlp_snmp_config_settings_t onlp_snmp_config_settings[] =
     { __onlp_snmp_config_STRINGIFY_NAME(ONLP_SNMP_CONFIG_RESOURCE_UPDATE_SECONDS), __onlp_snmp_config_STRINGIFY_VALUE(ONLP_SNMP_CONFIG_RESOURCE_UPDATE_SECONDS) },
 #else
 { ONLP_SNMP_CONFIG_RESOURCE_UPDATE_SECONDS(__onlp_snmp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS
+    { __onlp_snmp_config_STRINGIFY_NAME(ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS), __onlp_snmp_config_STRINGIFY_VALUE(ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS) },
+#else
+{ ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS(__onlp_snmp_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
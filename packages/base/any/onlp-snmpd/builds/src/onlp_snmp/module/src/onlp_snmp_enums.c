@@ -204,6 +204,7 @@ aim_map_si_t onlp_snmp_sensor_type_map[] =
     { "psu", ONLP_SNMP_SENSOR_TYPE_PSU },
     { "led", ONLP_SNMP_SENSOR_TYPE_LED },
     { "misc", ONLP_SNMP_SENSOR_TYPE_MISC },
+    { "sfp", ONLP_SNMP_SENSOR_TYPE_SFP },
     { "max", ONLP_SNMP_SENSOR_TYPE_MAX },
     { NULL, 0 }
 };
@@ -215,6 +216,7 @@ aim_map_si_t onlp_snmp_sensor_type_desc_map[] =
     { "None", ONLP_SNMP_SENSOR_TYPE_PSU },
     { "None", ONLP_SNMP_SENSOR_TYPE_LED },
     { "None", ONLP_SNMP_SENSOR_TYPE_MISC },
+    { "None", ONLP_SNMP_SENSOR_TYPE_SFP },
     { "None", ONLP_SNMP_SENSOR_TYPE_MAX },
     { NULL, 0 }
 };
@@ -26,8 +26,6 @@
 #include "onlp_snmp_log.h"
 
 #include <AIM/aim_time.h>
-#include <cjson/cJSON.h>
-#include <cjson_util/cjson_util.h>
 #include <net-snmp/net-snmp-config.h>
 #include <net-snmp/net-snmp-includes.h>
 #include <net-snmp/agent/net-snmp-agent-includes.h>
@@ -35,6 +33,9 @@
 
 #include <pthread.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <inttypes.h>
 
 static void
 platform_string_register(int index, const char* desc, char* value)
@@ -98,6 +99,15 @@ static pthread_t update_thread_handle;
 typedef struct {
     uint32_t utilization_percent;
     uint32_t idle_percent;
+    uint32_t iowait_percent;
+    uint32_t softirq_percent;
+    uint32_t steal_percent;
+} cpu_resources_t;
+
+typedef struct {
+    cpu_resources_t all;
+    int cpu_count;
+    cpu_resources_t cpu[ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS];
 } resources_t;
 
 #define NUM_RESOURCE_BUFFERS (2)
@@ -125,6 +135,141 @@ swap_curr_next_resources(void)
     curr_resource = next_resource();
 }
 
+/*
+ * CPU accounting from /proc/stat.
+ *
+ * The file is kept open and reread from offset 0 on every update.
+ * Percentages are computed from the jiffy deltas between updates and
+ * scaled by 100, as mpstat reported them.
+ */
+typedef struct {
+    uint64_t total;
+    uint64_t idle;
+    uint64_t iowait;
+    uint64_t softirq;
+    uint64_t steal;
+} cpu_counters_t;
+
+static struct {
+    int fd;
+    cpu_counters_t all;
+    cpu_counters_t cpu[ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS];
+    /* Only the cpu lines at the top of the file are needed. */
+    char buf[(ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS + 2) * 256];
+} proc_stat__ = { -1 };
+
+static int
+proc_stat_read__(void)
+{
+    ssize_t len;
+
+    if(proc_stat__.fd < 0) {
+        proc_stat__.fd = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+        if(proc_stat__.fd < 0) {
+            AIM_LOG_ERROR("failed opening /proc/stat: %{errno}", errno);
+            return -1;
+        }
+    }
+
+    len = pread(proc_stat__.fd, proc_stat__.buf,
+                sizeof(proc_stat__.buf) - 1, 0);
+    if(len <= 0) {
+        AIM_LOG_ERROR("failed reading /proc/stat: %{errno}", errno);
+        close(proc_stat__.fd);
+        proc_stat__.fd = -1;
+        return -1;
+    }
+    proc_stat__.buf[len] = 0;
+    return 0;
+}
+
+static void
+cpu_percent__(cpu_resources_t *r, const cpu_counters_t *now,
+              const cpu_counters_t *last)
+{
+    cpu_counters_t zero = { 0 };
+
+    if(now->total < last->total) {
+        /* CPU went offline and came back. */
+        last = &zero;
+    }
+
+    uint64_t total = now->total - last->total;
+    if(total == 0) {
+        return;
+    }
+
+#define PERCENT_X100(_f) \
+    ((uint32_t)(((now->_f - last->_f) * 10000 + total / 2) / total))
+
+    r->idle_percent = PERCENT_X100(idle);
+    r->iowait_percent = PERCENT_X100(iowait);
+    r->softirq_percent = PERCENT_X100(softirq);
+    r->steal_percent = PERCENT_X100(steal);
+    r->utilization_percent = 100*100 - r->idle_percent;
+
+#undef PERCENT_X100
+}
+
+static int
+cpu_sample__(resources_t *res)
+{
+    char *line, *save = NULL;
+
+    if(proc_stat_read__() < 0) {
+        return -1;
+    }
+
+    /* Keep the previous values for CPUs which are currently offline. */
+    *res = *get_curr_resources();
+
+    for(line = strtok_r(proc_stat__.buf, "\n", &save);
+        line && !strncmp(line, "cpu", 3);
+        line = strtok_r(NULL, "\n", &save)) {
+
+        uint64_t v[8] = { 0 };
+        cpu_counters_t c, *last;
+        cpu_resources_t *r;
+        int cpu = -1;
+
+        if(line[3] != ' ') {
+            cpu = atoi(line + 3);
+            if(cpu < 0 || cpu >= ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS) {
+                continue;
+            }
+        }
+
+        /* user nice system idle iowait irq softirq steal */
+        if(sscanf(line, "%*s %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64
+                  " %" SCNu64 " %" SCNu64 " %" SCNu64 " %" SCNu64,
+                  v+0, v+1, v+2, v+3, v+4, v+5, v+6, v+7) < 4) {
+            continue;
+        }
+
+        c.total = v[0] + v[1] + v[2] + v[3] + v[4] + v[5] + v[6] + v[7];
+        c.idle = v[3];
+        c.iowait = v[4];
+        c.softirq = v[6];
+        c.steal = v[7];
+
+        if(cpu < 0) {
+            last = &proc_stat__.all;
+            r = &res->all;
+        } else {
+            last = &proc_stat__.cpu[cpu];
+            r = &res->cpu[cpu];
+            if(cpu >= res->cpu_count) {
+                res->cpu_count = cpu + 1;
+            }
+        }
+
+        cpu_percent__(r, &c, last);
+        *last = c;
+    }
+
+    return 0;
+}
+
 static void
 resource_update(void)
 {
@@ -133,45 +278,24 @@ resource_update(void)
         (ONLP_SNMP_CONFIG_RESOURCE_UPDATE_SECONDS * 1000 * 1000)) {
         last_resource_update_time = now;
 
-        /* invoke mpstat collection script for json output */
-        FILE *fp = popen("/usr/bin/onl-snmp-mpstat", "r");
-        if (fp == NULL) {
-            AIM_LOG_ERROR("failed invoking onl-snmp-mpstat");
-            return;
-        }
-
-        /* parse json output */
-        char line[1024];
-        while (fgets(line, sizeof(line), fp) != NULL) {
-            cJSON *root = cJSON_Parse(line);
-            int result;
-            int rv = cjson_util_lookup_int(root, &result, "all.%%idle");
-            if (rv == 0) {
-                resources_t *next = get_next_resources();
-                /* save it */
-                next->idle_percent = result;
-                next->utilization_percent = 100*100 - result;
-                /* swap buffers */
-                swap_curr_next_resources();
-            }
-            cJSON_Delete(root);
+        resources_t *next = get_next_resources();
+        if (cpu_sample__(next) == 0) {
+            /* swap buffers */
+            swap_curr_next_resources();
         }
-
-        pclose(fp);
     }
 }
 
 static int
-utilization_handler(netsnmp_mib_handler *handler,
-             netsnmp_handler_registration *reginfo,
-             netsnmp_agent_request_info *reqinfo,
-             netsnmp_request_info *requests)
+resource_gauge_handler__(netsnmp_mib_handler *handler,
+                         netsnmp_handler_registration *reginfo,
+                         netsnmp_agent_request_info *reqinfo,
+                         netsnmp_request_info *requests,
+                         uint32_t *value)
 {
     if (MODE_GET == reqinfo->mode) {
-        resources_t *curr = get_curr_resources();
         snmp_set_var_typed_value(requests->requestvb, ASN_GAUGE,
-                                 (u_char *) &curr->utilization_percent,
-                                 sizeof(curr->utilization_percent));
+                                 (u_char *) value, sizeof(*value));
     } else {
         netsnmp_assert("bad mode in RO handler");
     }
@@ -183,19 +307,91 @@ utilization_handler(netsnmp_mib_handler *handler,
     return SNMP_ERR_NOERROR;
 }
 
+#define RESOURCE_GAUGE_HANDLER(_field)                                  \
+    static int                                                          \
+    _field##_handler(netsnmp_mib_handler *handler,                      \
+                     netsnmp_handler_registration *reginfo,             \
+                     netsnmp_agent_request_info *reqinfo,               \
+                     netsnmp_request_info *requests)                    \
+    {                                                                   \
+        resources_t *curr = get_curr_resources();                       \
+        return resource_gauge_handler__(handler, reginfo, reqinfo,      \
+                                        requests,                       \
+                                        &curr->all._field##_percent);   \
+    }
+
+RESOURCE_GAUGE_HANDLER(utilization)
+RESOURCE_GAUGE_HANDLER(idle)
+RESOURCE_GAUGE_HANDLER(iowait)
+RESOURCE_GAUGE_HANDLER(softirq)
+RESOURCE_GAUGE_HANDLER(steal)
+
+
+/**
+ * Per-CPU resource table.
+ * Rows are indexed by CPU number + 1.
+ */
+#define CPU_TABLE_COLUMN_INDEX       1
+#define CPU_TABLE_COLUMN_NAME        2
+#define CPU_TABLE_COLUMN_UTILIZATION 3
+#define CPU_TABLE_COLUMN_IDLE        4
+#define CPU_TABLE_COLUMN_IOWAIT      5
+#define CPU_TABLE_COLUMN_SOFTIRQ     6
+#define CPU_TABLE_COLUMN_STEAL       7
+
+static uint32_t cpu_table_index__[ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS];
+
 static int
-idle_handler(netsnmp_mib_handler *handler,
-             netsnmp_handler_registration *reginfo,
-             netsnmp_agent_request_info *reqinfo,
-             netsnmp_request_info *requests)
+cpu_table_handler__(netsnmp_mib_handler *handler,
+                    netsnmp_handler_registration *reginfo,
+                    netsnmp_agent_request_info *reqinfo,
+                    netsnmp_request_info *requests)
 {
-    if (MODE_GET == reqinfo->mode) {
-        resources_t *curr = get_curr_resources();
-        snmp_set_var_typed_value(requests->requestvb, ASN_GAUGE,
-                                 (u_char *) &curr->idle_percent,
-                                 sizeof(curr->idle_percent));
-    } else {
-        netsnmp_assert("bad mode in RO handler");
+    netsnmp_request_info *req;
+    resources_t *curr = get_curr_resources();
+
+    if (reqinfo->mode != MODE_GET && reqinfo->mode != MODE_GETNEXT) {
+        return SNMP_ERR_NOERROR;
+    }
+
+    for (req = requests; req; req = req->next) {
+        uint32_t *index = (uint32_t *) netsnmp_tdata_extract_entry(req);
+        netsnmp_table_request_info *table_info =
+            netsnmp_extract_table_info(req);
+        cpu_resources_t *r;
+        char name[16];
+
+        if (index == NULL) {
+            netsnmp_set_request_error(reqinfo, req, SNMP_NOSUCHINSTANCE);
+            continue;
+        }
+        r = &curr->cpu[*index - 1];
+
+        switch (table_info->colnum) {
+        case CPU_TABLE_COLUMN_INDEX:
+            snmp_set_var_typed_integer(req->requestvb, ASN_INTEGER, *index);
+            break;
+        case CPU_TABLE_COLUMN_NAME:
+            snprintf(name, sizeof(name), "cpu%u", *index - 1);
+            snmp_set_var_typed_value(req->requestvb, ASN_OCTET_STR,
+                                     (u_char *) name, strlen(name));
+            break;
+#define CPU_TABLE_GAUGE(_column, _field)                                \
+        case CPU_TABLE_COLUMN_##_column:                                \
+            snmp_set_var_typed_value(req->requestvb, ASN_GAUGE,         \
+                                     (u_char *) &r->_field##_percent,   \
+                                     sizeof(r->_field##_percent));      \
+            break
+        CPU_TABLE_GAUGE(UTILIZATION, utilization);
+        CPU_TABLE_GAUGE(IDLE, idle);
+        CPU_TABLE_GAUGE(IOWAIT, iowait);
+        CPU_TABLE_GAUGE(SOFTIRQ, softirq);
+        CPU_TABLE_GAUGE(STEAL, steal);
+#undef CPU_TABLE_GAUGE
+        default:
+            netsnmp_set_request_error(reqinfo, req, SNMP_NOSUCHINSTANCE);
+            break;
+        }
     }
 
     if (handler->next && handler->next->access_method) {
@@ -205,6 +401,48 @@ idle_handler(netsnmp_mib_handler *handler,
     return SNMP_ERR_NOERROR;
 }
 
+static void
+cpu_table_register__(int cpu_count)
+{
+    oid tree[] = { 1, 3, 6, 1, 4, 1, 42623, 1, 3, 2 };
+    int i;
+
+    netsnmp_tdata *table = netsnmp_tdata_create_table("CpuTable", 0);
+    netsnmp_table_registration_info *table_info =
+        SNMP_MALLOC_TYPEDEF(netsnmp_table_registration_info);
+    if (table == NULL || table_info == NULL) {
+        AIM_LOG_ERROR("failed to create CpuTable");
+        return;
+    }
+
+    netsnmp_table_helper_add_indexes(table_info, ASN_INTEGER, 0);
+    table_info->min_column = CPU_TABLE_COLUMN_INDEX;
+    table_info->max_column = CPU_TABLE_COLUMN_STEAL;
+
+    netsnmp_handler_registration *reg =
+        netsnmp_create_handler_registration("CpuTable", cpu_table_handler__,
+                                            tree, OID_LENGTH(tree),
+                                            HANDLER_CAN_RONLY);
+    if (reg == NULL ||
+        netsnmp_tdata_register(reg, table, table_info) != MIB_REGISTERED_OK) {
+        AIM_LOG_ERROR("failed to register CpuTable");
+        return;
+    }
+
+    for (i = 0; i < cpu_count; i++) {
+        netsnmp_tdata_row *row = netsnmp_tdata_create_row();
+        if (row == NULL) {
+            AIM_LOG_ERROR("failed to allocate table row");
+            return;
+        }
+        cpu_table_index__[i] = i + 1;
+        row->data = &cpu_table_index__[i];
+        netsnmp_tdata_row_add_index(row, ASN_INTEGER, &cpu_table_index__[i],
+                                    sizeof(cpu_table_index__[i]));
+        netsnmp_tdata_add_row(table, row);
+    }
+}
+
 void
 onlp_snmp_platform_init(void)
 {
@@ -246,8 +484,18 @@ onlp_snmp_platform_init(void)
         REGISTER_STR(15, onie_version);
     }
 
+    /* Initial sample: counters since boot. */
+    last_resource_update_time = aim_time_monotonic();
+    if (cpu_sample__(get_next_resources()) == 0) {
+        swap_curr_next_resources();
+    }
+
     resource_int_register(1, "CpuAllPercentUtilization", utilization_handler);
     resource_int_register(2, "CpuAllPercentIdle", idle_handler);
+    resource_int_register(3, "CpuAllPercentIowait", iowait_handler);
+    resource_int_register(4, "CpuAllPercentSoftirq", softirq_handler);
+    resource_int_register(5, "CpuAllPercentSteal", steal_handler);
+    cpu_table_register__(get_curr_resources()->cpu_count);
 }
 
 #define MIN(a,b) ((a)<(b)? (a): (b))
@@ -266,12 +514,42 @@ cpu_utilization_handler__(int fd, void* cookie)
 {
     char svalue[64];
     resources_t *curr = get_curr_resources();
-    sprintf(svalue, "%d", curr->utilization_percent);
+    sprintf(svalue, "%d", curr->all.utilization_percent);
     write(fd, svalue, strlen(svalue));
     close(fd);
     return 0;
 }
 
+static int
+cpu_utilization_detail_handler__(int fd, void* cookie)
+{
+    /*
+     * One line per CPU, "all" first:
+     *   <name> <utilization> <idle> <iowait> <softirq> <steal>
+     */
+    char svalue[64 * (ONLP_SNMP_CONFIG_RESOURCE_MAX_CPUS + 1)];
+    resources_t *curr = get_curr_resources();
+    int len = 0, i;
+
+    for(i = -1; i < curr->cpu_count; i++) {
+        cpu_resources_t *r = (i < 0) ? &curr->all : &curr->cpu[i];
+        char name[16];
+        if(i < 0) {
+            strcpy(name, "all");
+        } else {
+            snprintf(name, sizeof(name), "cpu%d", i);
+        }
+        len += snprintf(svalue + len, sizeof(svalue) - len,
+                        "%s %u %u %u %u %u\n", name,
+                        r->utilization_percent, r->idle_percent,
+                        r->iowait_percent, r->softirq_percent,
+                        r->steal_percent);
+    }
+    write(fd, svalue, len);
+    close(fd);
+    return 0;
+}
+
 static void *
 do_update(void *arg)
 {
@@ -280,6 +558,9 @@ do_update(void *arg)
         onlp_file_uds_add(uds,
                           "/var/run/onl/cpu-utilization",
                           cpu_utilization_handler__, NULL);
+        onlp_file_uds_add(uds,
+                          "/var/run/onl/cpu-utilization-detail",
+                          cpu_utilization_detail_handler__, NULL);
     }
 
     for (;;) {
@@ -38,6 +38,9 @@
 #include <onlp/thermal.h>
 #include <onlp/fan.h>
 #include <onlp/psu.h>
+#include <onlp/sfp.h>
+#include <sff/sff.h>
+#include <sff/dom.h>
 
 #include "onlp_snmp_log.h"
 
@@ -54,6 +57,15 @@ typedef struct sensor_info_s {
 /* for front-back buffers */
 #define NUM_SENSOR_INFO (2)
 
+/*
+ * SFP data is too large to carry in every sensor_info_t,
+ * so SFP sensors keep it in a table of their own.
+ */
+typedef struct sfp_info_s {
+    sff_eeprom_t sff;   /* identification, carried over between updates */
+    sff_dom_info_t dom;
+} sfp_info_t;
+
 /**
  * Individual Sensor Control structure.
  * The valid field in the sensor_info_t structure above
@@ -69,6 +81,7 @@ typedef struct onlp_snmp_sensor_s {
     onlp_snmp_sensor_type_t sensor_type;
     uint32_t index;      /* snmp table column */
     sensor_info_t sensor_info[NUM_SENSOR_INFO];
+    sfp_info_t *sfp_info;  /* SFP sensors only, NUM_SENSOR_INFO entries */
 } onlp_snmp_sensor_t;
 
 static int curr_info;
@@ -87,6 +100,16 @@ get_next_info(onlp_snmp_sensor_t *ss)
 {
     return &ss->sensor_info[next_info()];
 }
+static sfp_info_t *
+get_curr_sfp(onlp_snmp_sensor_t *ss)
+{
+    return &ss->sfp_info[curr_info];
+}
+static sfp_info_t *
+get_next_sfp(onlp_snmp_sensor_t *ss)
+{
+    return &ss->sfp_info[next_info()];
+}
 static void
 swap_curr_next_info(void)
 {
@@ -379,10 +402,18 @@ temp_table_handler__(netsnmp_mib_handler *handler,
 static int
 fan_update_handler__(onlp_snmp_sensor_t *ss)
 {
+    int rv;
+    sensor_info_t *si = get_curr_info(ss);
     onlp_fan_info_t *fi = &get_next_info(ss)->data.fi;
     onlp_oid_t oid = (onlp_oid_t) ss->sensor_id;
 
-    return onlp_fan_info_get(oid, fi);
+    rv = onlp_fan_info_get(oid, fi);
+    if (rv >= 0 && si->valid &&
+        ((si->data.fi.status ^ fi->status) & ONLP_FAN_STATUS_PRESENT)) {
+        /* fan inserted or removed, the OID tree may have changed */
+        onlp_oid_snapshot_invalidate();
+    }
+    return rv;
 }
 
 static void
@@ -579,10 +610,18 @@ fan_table_handler__(netsnmp_mib_handler *handler,
 static int
 psu_update_handler__(onlp_snmp_sensor_t *ss)
 {
+    int rv;
+    sensor_info_t *si = get_curr_info(ss);
     onlp_psu_info_t *pi = &get_next_info(ss)->data.pi;
     onlp_oid_t oid = (onlp_oid_t) ss->sensor_id;
 
-    return onlp_psu_info_get(oid, pi);
+    rv = onlp_psu_info_get(oid, pi);
+    if (rv >= 0 && si->valid &&
+        ((si->data.pi.status ^ pi->status) & ONLP_PSU_STATUS_PRESENT)) {
+        /* psu inserted or removed, the OID tree may have changed */
+        onlp_oid_snapshot_invalidate();
+    }
+    return rv;
 }
 
 static void
@@ -868,6 +907,269 @@ psu_table_handler__(netsnmp_mib_handler *handler,
                            psu_handler_fn__);
 }
 
+/**
+ * SFP DOM Handlers
+ *
+ * The module is identified once after insertion. Subsequent updates
+ * read the DOM page and the vendor, part number and serial number
+ * fields. The EEPROM is parsed again if those fields change, so a
+ * module swapped between two updates is not reported with the
+ * identity of the previous one.
+ */
+#define SFP_IDENT_LEN 64
+
+static int
+sfp_ident_offset__(sff_eeprom_t *sff)
+{
+    /* Vendor name through serial number, A0h for SFP, upper page 00h for QSFP. */
+    return (sff->info.sfp_type == SFF_SFP_TYPE_SFP) ? 20 : 148;
+}
+
+static bool
+sfp_ident_unchanged__(onlp_snmp_sensor_t *ss, sff_eeprom_t *sff)
+{
+    uint8_t ident[SFP_IDENT_LEN];
+    int offset = sfp_ident_offset__(sff);
+
+    if (onlp_sfp_memory_read(ss->sensor_id, 0x50, 0, 0, offset,
+                             sizeof(ident), ident) < 0) {
+        /* Cannot tell. Identify the module again. */
+        return false;
+    }
+    return !memcmp(ident, sff->eeprom + offset, sizeof(ident));
+}
+
+static int
+sfp_update_handler__(onlp_snmp_sensor_t *ss)
+{
+    int rv;
+    uint8_t *eeprom = NULL;
+    uint8_t *dom = NULL;
+    sfp_info_t *curr = get_curr_sfp(ss);
+    sfp_info_t *next = get_next_sfp(ss);
+
+    if (get_curr_info(ss)->valid && curr->sff.identified &&
+        sfp_ident_unchanged__(ss, &curr->sff)) {
+        next->sff = curr->sff;
+    } else {
+        AIM_LOG_VERBOSE("identify %s%s", ss->name, ss->desc);
+        if ((rv = onlp_sfp_eeprom_read(ss->sensor_id, &eeprom)) < 0) {
+            return rv;
+        }
+        rv = sff_eeprom_parse(&next->sff, eeprom);
+        aim_free(eeprom);
+        if (rv < 0 || !next->sff.identified) {
+            return ONLP_STATUS_E_INVALID;
+        }
+    }
+
+    AIM_MEMSET(&next->dom, 0, sizeof(next->dom));
+    if ((rv = onlp_sfp_dom_read(ss->sensor_id, &dom)) < 0) {
+        /* Not all modules support DOM. Report identification only. */
+        return (rv == ONLP_STATUS_E_UNSUPPORTED) ? ONLP_STATUS_OK : rv;
+    }
+
+    /*
+     * SFP DOM lives at A2 and is calibrated from A0.
+     * QSFP DOM lives in the lower page returned by the DOM read.
+     */
+    sff_dom_info_get(&next->dom, &next->sff.info,
+                     (next->sff.info.sfp_type == SFF_SFP_TYPE_SFP) ?
+                     next->sff.eeprom : dom, dom);
+    aim_free(dom);
+    return ONLP_STATUS_OK;
+}
+
+static void
+sfp_index_handler__(netsnmp_request_info *req,
+                    uint32_t index,
+                    onlp_snmp_sensor_t *ss)
+{
+    snmp_set_var_typed_integer(req->requestvb,
+                               ASN_INTEGER,
+                               ss->index);
+}
+
+static void
+sfp_devname_handler__(netsnmp_request_info *req,
+                      uint32_t index,
+                      onlp_snmp_sensor_t *ss)
+{
+    char device_name[ONLP_SNMP_CONFIG_MAX_NAME_LENGTH+ONLP_SNMP_CONFIG_MAX_DESC_LENGTH + 32];
+
+    snprintf(device_name,  sizeof(device_name),
+             "%s %s%s", "SFP", ss->name, ss->desc);
+
+    snmp_set_var_typed_value(req->requestvb,
+                             ASN_OCTET_STR,
+                             (u_char *) device_name,
+                             strlen(device_name));
+}
+
+static void
+sfp_status_handler__(netsnmp_request_info *req,
+                     uint32_t index,
+                     onlp_snmp_sensor_t *ss)
+{
+    sensor_info_t *si = get_curr_info(ss);
+
+    if (!si->valid) {
+        return;
+    }
+
+    /* Rows exist only for present and identified modules. */
+    snmp_set_var_typed_integer(req->requestvb,
+                               ASN_INTEGER,
+                               ONLP_SNMP_SENSOR_STATUS_GOOD);
+}
+
+#define SFP_STRING_HANDLER(_field)                                      \
+    static void                                                         \
+    sfp_##_field##_handler__(netsnmp_request_info *req,                 \
+                             uint32_t index,                            \
+                             onlp_snmp_sensor_t *ss)                    \
+    {                                                                   \
+        sensor_info_t *si = get_curr_info(ss);                          \
+        sff_info_t *info = &get_curr_sfp(ss)->sff.info;                 \
+                                                                        \
+        if (!si->valid) {                                               \
+            return;                                                     \
+        }                                                               \
+                                                                        \
+        snmp_set_var_typed_value(req->requestvb,                        \
+                                 ASN_OCTET_STR,                         \
+                                 (u_char *) info->_field,               \
+                                 strlen(info->_field));                 \
+    }
+
+SFP_STRING_HANDLER(vendor)
+SFP_STRING_HANDLER(model)
+SFP_STRING_HANDLER(serial)
+
+static void
+sfp_temp_handler__(netsnmp_request_info *req,
+                   uint32_t index,
+                   onlp_snmp_sensor_t *ss)
+{
+    sensor_info_t *si = get_curr_info(ss);
+    sff_dom_info_t *dom = &get_curr_sfp(ss)->dom;
+
+    if (!si->valid) {
+        return;
+    }
+
+    /* 1/256 C to milli-C */
+    int value = (dom->fields & SFF_DOM_FIELD_FLAG_TEMP) ?
+        ((int)(int16_t)dom->temp * 1000) / 256 : 0;
+
+    snmp_set_var_typed_integer(req->requestvb,
+                               ASN_INTEGER,
+                               value);
+}
+
+static void
+sfp_vcc_handler__(netsnmp_request_info *req,
+                  uint32_t index,
+                  onlp_snmp_sensor_t *ss)
+{
+    sensor_info_t *si = get_curr_info(ss);
+    sff_dom_info_t *dom = &get_curr_sfp(ss)->dom;
+
+    if (!si->valid) {
+        return;
+    }
+
+    /* 100 uV to mV */
+    uint32_t value = (dom->fields & SFF_DOM_FIELD_FLAG_VOLTAGE) ?
+        dom->voltage / 10 : 0;
+
+    snmp_set_var_typed_value(req->requestvb,
+                             ASN_GAUGE,
+                             (u_char *) &value,
+                             sizeof(value));
+}
+
+/*
+ * Per-lane values, reported in the DOM native units:
+ * bias current in 2 uA, optical power in 0.1 uW.
+ */
+static void
+sfp_lane_handler__(netsnmp_request_info *req,
+                   onlp_snmp_sensor_t *ss,
+                   int lane, uint32_t flag, size_t offset)
+{
+    sensor_info_t *si = get_curr_info(ss);
+    sff_dom_info_t *dom = &get_curr_sfp(ss)->dom;
+    uint32_t value = 0;
+
+    if (!si->valid) {
+        return;
+    }
+
+    if (lane < dom->nchannels && (dom->channels[lane].fields & flag)) {
+        value = *(uint16_t *)((uint8_t *)&dom->channels[lane] + offset);
+    }
+
+    snmp_set_var_typed_value(req->requestvb,
+                             ASN_GAUGE,
+                             (u_char *) &value,
+                             sizeof(value));
+}
+
+#define SFP_LANE_HANDLER(_name, _n, _flag, _field)                      \
+    static void                                                         \
+    sfp_##_name##_lane##_n##_handler__(netsnmp_request_info *req,       \
+                                          uint32_t index,               \
+                                          onlp_snmp_sensor_t *ss)       \
+    {                                                                   \
+        sfp_lane_handler__(req, ss, _n - 1, _flag,                      \
+                           offsetof(sff_dom_channel_info_t, _field));   \
+    }
+
+#define SFP_LANE_HANDLERS(_name, _flag, _field)                         \
+    SFP_LANE_HANDLER(_name, 1, _flag, _field)                           \
+    SFP_LANE_HANDLER(_name, 2, _flag, _field)                           \
+    SFP_LANE_HANDLER(_name, 3, _flag, _field)                           \
+    SFP_LANE_HANDLER(_name, 4, _flag, _field)
+
+SFP_LANE_HANDLERS(bias, SFF_DOM_FIELD_FLAG_BIAS_CUR, bias_cur)
+SFP_LANE_HANDLERS(tx, SFF_DOM_FIELD_FLAG_TX_POWER, tx_power)
+SFP_LANE_HANDLERS(rx, SFF_DOM_FIELD_FLAG_RX_POWER, rx_power)
+
+static onlp_snmp_handler_fn sfp_handler_fn__[] = {
+    NULL,
+    sfp_index_handler__,
+    sfp_devname_handler__,
+    sfp_status_handler__,
+    sfp_vendor_handler__,
+    sfp_model_handler__,
+    sfp_serial_handler__,
+    sfp_temp_handler__,
+    sfp_vcc_handler__,
+    sfp_bias_lane1_handler__,
+    sfp_bias_lane2_handler__,
+    sfp_bias_lane3_handler__,
+    sfp_bias_lane4_handler__,
+    sfp_tx_lane1_handler__,
+    sfp_tx_lane2_handler__,
+    sfp_tx_lane3_handler__,
+    sfp_tx_lane4_handler__,
+    sfp_rx_lane1_handler__,
+    sfp_rx_lane2_handler__,
+    sfp_rx_lane3_handler__,
+    sfp_rx_lane4_handler__,
+};
+
+static int
+sfp_table_handler__(netsnmp_mib_handler *handler,
+                    netsnmp_handler_registration *reg,
+                    netsnmp_agent_request_info *agent_req,
+                    netsnmp_request_info *requests)
+{
+    return table_handler__(handler, reg, agent_req, requests,
+                           sfp_handler_fn__);
+}
+
 
 /*
  * All update handlers
@@ -877,6 +1179,9 @@ static update_handler_fn all_update_handler_fns__[] = {
     temp_update_handler__,
     fan_update_handler__,
     psu_update_handler__,
+    NULL,
+    NULL,
+    sfp_update_handler__,
 };
 
 
@@ -911,6 +1216,9 @@ add_sensor__(int sensor_type, onlp_snmp_sensor_t *new_sensor)
     AIM_TRUE_OR_DIE(ss);
     AIM_MEMCPY(ss, new_sensor, sizeof(*new_sensor));
     ss->sensor_type = sensor_type;
+    if (sensor_type == ONLP_SNMP_SENSOR_TYPE_SFP) {
+        ss->sfp_info = aim_zmalloc(NUM_SENSOR_INFO * sizeof(sfp_info_t));
+    }
     get_next_info(ss)->valid = true;
 
     /* finally add sensor */
@@ -921,10 +1229,10 @@ add_sensor__(int sensor_type, onlp_snmp_sensor_t *new_sensor)
 static int
 collect_sensors__(onlp_oid_t oid, void* cookie)
 {
-    onlp_oid_hdr_t hdr;
+    onlp_oid_desc_t desc = "";
     onlp_snmp_sensor_t s;
 
-    onlp_oid_hdr_get(oid, &hdr);
+    onlp_oid_desc_get(oid, desc);
     AIM_LOG_MSG("collect: %{onlp_oid}", oid);
 
     AIM_MEMSET(&s, 0x0, sizeof(onlp_snmp_sensor_t));
@@ -935,7 +1243,7 @@ collect_sensors__(onlp_oid_t oid, void* cookie)
             s.sensor_id = oid;
             s.index = ONLP_OID_ID_GET(oid);
             sprintf(s.name, "%d - ", ONLP_OID_ID_GET(oid));
-            aim_strlcpy(s.desc, hdr.description, sizeof(s.desc));
+            aim_strlcpy(s.desc, desc, sizeof(s.desc));
             add_sensor__(ONLP_SNMP_SENSOR_TYPE_TEMP, &s);
 #endif
             break;
@@ -945,7 +1253,7 @@ collect_sensors__(onlp_oid_t oid, void* cookie)
             s.sensor_id = oid;
             s.index = ONLP_OID_ID_GET(oid);
             sprintf(s.name, "%d - ", ONLP_OID_ID_GET(oid));
-            aim_strlcpy(s.desc, hdr.description, sizeof(s.desc));
+            aim_strlcpy(s.desc, desc, sizeof(s.desc));
             add_sensor__(ONLP_SNMP_SENSOR_TYPE_FAN, &s);
 #endif
             break;
@@ -956,7 +1264,7 @@ collect_sensors__(onlp_oid_t oid, void* cookie)
             s.sensor_id = oid;
             s.index = ONLP_OID_ID_GET(oid);
             sprintf(s.name, "%d - ", ONLP_OID_ID_GET(oid));
-            aim_strlcpy(s.desc, hdr.description, sizeof(s.desc));
+            aim_strlcpy(s.desc, desc, sizeof(s.desc));
             add_sensor__(ONLP_SNMP_SENSOR_TYPE_PSU, &s);
 #endif
             break;
@@ -972,6 +1280,39 @@ collect_sensors__(onlp_oid_t oid, void* cookie)
 }
 
 
+#if ONLP_SNMP_CONFIG_INCLUDE_SFPS == 1
+/*
+ * SFPs are not part of the OID tree.
+ * Only present ports get a sensor, so the cost of an update
+ * scales with the number of installed modules.
+ */
+static void
+collect_sfps__(void)
+{
+    int port;
+    onlp_sfp_bitmap_t present;
+    onlp_snmp_sensor_t s;
+
+    onlp_sfp_bitmap_t_init(&present);
+    if (onlp_sfp_presence_bitmap_get(&present) < 0) {
+        return;
+    }
+
+    AIM_BITMAP_ITER(&present, port) {
+        if (!AIM_BITMAP_GET(&present, port)) {
+            continue;
+        }
+        AIM_MEMSET(&s, 0x0, sizeof(onlp_snmp_sensor_t));
+        s.sensor_id = port;
+        s.index = port + 1;
+        sprintf(s.name, "%d - ", port);
+        snprintf(s.desc, sizeof(s.desc), "Port %d", port);
+        add_sensor__(ONLP_SNMP_SENSOR_TYPE_SFP, &s);
+    }
+}
+#endif
+
+
 /*
  * sensor table is updated in two parts:
  * 1. sensor update, performed in separate thread by calling update_tables__.
@@ -1015,6 +1356,9 @@ update_tables__(void)
     /* discover new sensors for all tables,
      * writing validity into next_info for all sensors */
     onlp_oid_iterate(ONLP_OID_SYS, 0, collect_sensors__, NULL);
+#if ONLP_SNMP_CONFIG_INCLUDE_SFPS == 1
+    collect_sfps__();
+#endif
 
     /* for each table: update all sensor info */
     for (i = ONLP_SNMP_SENSOR_TYPE_TEMP; i <= ONLP_SNMP_SENSOR_TYPE_MAX; i++) {
@@ -1083,6 +1427,7 @@ restructure_tables__(unsigned int reg, void *clientarg)
                                 ss->index, ctrl->name, ss->name, ss->desc);
                 delete_table_row__(sensor_table__[i], ss->index);
                 list_remove(curr);
+                aim_free(ss->sfp_info);
                 aim_free(ss);
             }
         }
@@ -1138,6 +1483,15 @@ init_all_tables__(void)
             .max_col = AIM_ARRAYSIZE(psu_handler_fn__)-1,
             .handler = psu_table_handler__,
         },
+#if ONLP_SNMP_CONFIG_INCLUDE_SFPS == 1
+        {
+            .type = ONLP_SNMP_SENSOR_TYPE_SFP,
+            .name = "onlSfpTable",
+            .min_col = 1,
+            .max_col = AIM_ARRAYSIZE(sfp_handler_fn__)-1,
+            .handler = sfp_table_handler__,
+        },
+#endif
     };
 
     for (i = 0; i < AIM_ARRAYSIZE(cfgs); i++) {
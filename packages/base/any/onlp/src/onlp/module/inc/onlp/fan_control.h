@@ -0,0 +1,207 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Common Fan Control Engine
+ *
+ * Platforms describe their fan control policy as a table and
+ * register it from onlp_sysi_platform_manage_init(). The
+ * platform manager then runs the policy in place of
+ * onlp_sysi_platform_manage_fans().
+ *
+ ***********************************************************/
+#ifndef __ONLP_FAN_CONTROL_H__
+#define __ONLP_FAN_CONTROL_H__
+
+#include <onlp/onlp_config.h>
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+
+/** Maximum number of sensor groups in a policy. */
+#define ONLP_FAN_CONTROL_GROUPS_MAX 8
+
+/** Maximum number of thermals in a sensor group. */
+#define ONLP_FAN_CONTROL_SENSORS_MAX 16
+
+/** Maximum number of fans in a policy. */
+#define ONLP_FAN_CONTROL_FANS_MAX 32
+
+/**
+ * How the thermals in a group are combined.
+ */
+typedef enum onlp_fan_control_aggregate_e {
+    /** Hottest sensor. */
+    ONLP_FAN_CONTROL_AGGREGATE_MAX,
+    /** Coolest sensor. */
+    ONLP_FAN_CONTROL_AGGREGATE_MIN,
+    /** Average of all sensors. */
+    ONLP_FAN_CONTROL_AGGREGATE_AVG,
+    /** Sum of all sensors. The group is invalid if any sensor fails. */
+    ONLP_FAN_CONTROL_AGGREGATE_SUM,
+} onlp_fan_control_aggregate_t;
+
+/**
+ * How a group maps its aggregate temperature to a fan percentage.
+ */
+typedef enum onlp_fan_control_mode_e {
+    /** Walk a hysteresis ladder one step per tick. */
+    ONLP_FAN_CONTROL_MODE_STEP,
+    /** PID loop around a setpoint. */
+    ONLP_FAN_CONTROL_MODE_PID,
+} onlp_fan_control_mode_t;
+
+/**
+ * One step of a hysteresis ladder.
+ * Temperatures are in the units of the group aggregate (milli-celsius,
+ * or the sum of milli-celsius for ONLP_FAN_CONTROL_AGGREGATE_SUM).
+ */
+typedef struct onlp_fan_control_step_s {
+    /** Fan percentage for this step. */
+    int percentage;
+
+    /** Move to the previous step at or below this temperature. 0 means never. */
+    int down;
+
+    /** Move to the next step at or above this temperature. 0 means never. */
+    int up;
+
+} onlp_fan_control_step_t;
+
+/**
+ * PID parameters.
+ * The error is (aggregate - setpoint) in degrees celsius.
+ */
+typedef struct onlp_fan_control_pid_s {
+    /** Target aggregate temperature. */
+    int setpoint;
+
+    /** Percent per degree. */
+    double kp;
+
+    /** Percent per degree-second. */
+    double ki;
+
+    /** Percent per degree/second. */
+    double kd;
+
+} onlp_fan_control_pid_t;
+
+/**
+ * A group of thermals driving one fan percentage.
+ */
+typedef struct onlp_fan_control_group_s {
+    /** Group name (for logging and replay output). */
+    const char* name;
+
+    /** Thermal OIDs. Terminated by 0. */
+    onlp_oid_t thermals[ONLP_FAN_CONTROL_SENSORS_MAX];
+
+    onlp_fan_control_aggregate_t aggregate;
+
+    onlp_fan_control_mode_t mode;
+
+    /** ONLP_FAN_CONTROL_MODE_STEP ladder, lowest percentage first. */
+    const onlp_fan_control_step_t* steps;
+    int step_count;
+
+    /** Optional ladder used instead of steps when the fans report B2F airflow. */
+    const onlp_fan_control_step_t* steps_b2f;
+    int step_b2f_count;
+
+    /** ONLP_FAN_CONTROL_MODE_PID parameters. */
+    onlp_fan_control_pid_t pid;
+
+} onlp_fan_control_group_t;
+
+/**
+ * Fan percentages forced by failures.
+ * The highest applicable override wins over the group outputs.
+ * 0 disables an override.
+ */
+typedef struct onlp_fan_control_failure_s {
+    /** Any fan reports ONLP_FAN_STATUS_FAILED. */
+    int fan_failed;
+
+    /** Any fan is not present. */
+    int fan_missing;
+
+    /** A group thermal cannot be read or is not present. */
+    int sensor_failed;
+
+    /** A group thermal is at or above its error threshold. */
+    int thermal_error;
+
+} onlp_fan_control_failure_t;
+
+/**
+ * Fan control policy.
+ */
+typedef struct onlp_fan_control_policy_s {
+    /** Sensor groups. The fan percentage is the highest group output. */
+    onlp_fan_control_group_t groups[ONLP_FAN_CONTROL_GROUPS_MAX];
+    int group_count;
+
+    /** Fans monitored for failures and airflow direction. Terminated by 0. */
+    onlp_oid_t fans[ONLP_FAN_CONTROL_FANS_MAX];
+
+    /**
+     * Fans whose percentage is set. Terminated by 0.
+     * If empty, every monitored fan is set.
+     */
+    onlp_oid_t control[ONLP_FAN_CONTROL_FANS_MAX];
+
+    /** Output limits. */
+    int percentage_min;
+    int percentage_max;
+
+    onlp_fan_control_failure_t failure;
+
+} onlp_fan_control_policy_t;
+
+/**
+ * @brief Register the platform fan control policy.
+ * @param policy The policy. It is copied.
+ * @note Call from onlp_sysi_platform_manage_init().
+ * Registering NULL removes the policy.
+ */
+int onlp_fan_control_register(const onlp_fan_control_policy_t* policy);
+
+/**
+ * @brief Run one fan control tick with the registered policy.
+ * @returns ONLP_STATUS_E_UNSUPPORTED if no policy is registered.
+ */
+int onlp_fan_control_manage(void);
+
+/**
+ * @brief Replay a recorded thermal trace through a policy.
+ * @param policy The policy, or NULL for the registered policy.
+ * @param trace The trace file.
+ * @param pvs Receives one line per trace sample.
+ * @note No fans are touched. The trace is CSV. The first
+ * line names the columns: "ms" followed by thermal and fan
+ * OIDs ("thermal-2", "fan-1" or raw 0x... values). Thermal
+ * values are milli-celsius, or "-" for a failed read. Fan
+ * values are "ok", "f2b", "b2f", "failed" or "missing".
+ * Lines starting with '#' are ignored.
+ */
+int onlp_fan_control_replay(const onlp_fan_control_policy_t* policy,
+                            const char* trace, aim_pvs_t* pvs);
+
+#endif /* __ONLP_FAN_CONTROL_H__ */
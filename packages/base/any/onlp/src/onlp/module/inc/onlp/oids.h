@@ -193,6 +193,32 @@ int onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_t type,
  */
 int onlp_oid_hdr_get(onlp_oid_t oid, onlp_oid_hdr_t* hdr);
 
+/**
+ * @brief Get the description of an OID.
+ * @param oid The oid
+ * @param desc [out] Receives the description.
+ * @note This is served from the OID snapshot when possible.
+ */
+int onlp_oid_desc_get(onlp_oid_t oid, onlp_oid_desc_t desc);
+
+/**
+ * @brief Get all OIDs of the given type in the platform tree.
+ * @param type The OID type.
+ * @param table [out] Receives the OIDs, in tree order.
+ * @param size The number of entries in table.
+ * @returns The number of OIDs written.
+ */
+int onlp_oid_type_table_get(onlp_oid_type_t type, onlp_oid_t* table, int size);
+
+/**
+ * @brief Discard the cached OID topology.
+ * @note Call this when the OID tree may have changed. The next OID
+ * walk rebuilds the snapshot. The snapshot also expires after
+ * ONLP_CONFIG_OID_SNAPSHOT_TTL, and is invalidated when
+ * onlp_fan_info_get() or onlp_psu_info_get() see a presence change.
+ */
+void onlp_oid_snapshot_invalidate(void);
+
 
 
 
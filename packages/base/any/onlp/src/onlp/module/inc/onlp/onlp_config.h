@@ -194,6 +194,26 @@
 #define ONLP_CONFIG_CONFIGURATION_ENV "ONLP_CONF"
 #endif
 
+/**
+ * ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE
+ *
+ * Decode the system ONIE, OID and platform information once and reuse it until invalidated. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE
+#define ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE 1
+#endif
+
+/**
+ * ONLP_CONFIG_SYS_INFO_CACHE_FILENAME
+ *
+ * The file used to share the raw ONIE TlvInfo data between processes. Set to NULL to disable. */
+
+
+#ifndef ONLP_CONFIG_SYS_INFO_CACHE_FILENAME
+#define ONLP_CONFIG_SYS_INFO_CACHE_FILENAME "/var/run/onl/onie-data.bin"
+#endif
+
 /**
  * ONLP_CONFIG_INCLUDE_API_LOCK
  *
@@ -224,6 +244,26 @@
 #define ONLP_CONFIG_API_LOCK_TIMEOUT 60000000
 #endif
 
+/**
+ * ONLP_CONFIG_API_LOCK_DOMAINS
+ *
+ * If 1, the API lock is split into per-OID-type reader/writer domains and per-SFP-port-group locks instead of a single exclusive lock. Only used on platforms which return 1 from onlp_sysi_api_lock_domains(). */
+
+
+#ifndef ONLP_CONFIG_API_LOCK_DOMAINS
+#define ONLP_CONFIG_API_LOCK_DOMAINS 0
+#endif
+
+/**
+ * ONLP_CONFIG_API_LOCK_DOMAIN_FILENAME
+ *
+ * The lock file used to share the API lock domains between processes when ONLP_CONFIG_API_LOCK_GLOBAL_SHARED is enabled. */
+
+
+#ifndef ONLP_CONFIG_API_LOCK_DOMAIN_FILENAME
+#define ONLP_CONFIG_API_LOCK_DOMAIN_FILENAME "/var/run/onlp-api.lock"
+#endif
+
 /**
  * ONLP_CONFIG_INFO_STR_MAX
  *
@@ -254,6 +294,136 @@
 #define ONLP_CONFIG_INCLUDE_API_PROFILING 0
 #endif
 
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGE_BACKOFF_MAX
+ *
+ * Maximum factor by which an adaptive platform management callback may back off from its base rate while nothing changes. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGE_BACKOFF_MAX
+#define ONLP_CONFIG_PLATFORM_MANAGE_BACKOFF_MAX 3
+#endif
+
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_MARGIN
+ *
+ * Fan management runs at its minimum rate while any thermal is within this many milli-celsius of its warning threshold. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_MARGIN
+#define ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_MARGIN 5000
+#endif
+
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_HYSTERESIS
+ *
+ * Temperature change (milli-celsius) between fan management calls which returns fan management to its base rate. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_HYSTERESIS
+#define ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_HYSTERESIS 1000
+#endif
+
+/**
+ * ONLP_CONFIG_PLATFORM_MANAGE_SAMPLE_TTL
+ *
+ * Platform management callbacks share thermal, fan and PSU samples younger than this many milliseconds. */
+
+
+#ifndef ONLP_CONFIG_PLATFORM_MANAGE_SAMPLE_TTL
+#define ONLP_CONFIG_PLATFORM_MANAGE_SAMPLE_TTL 1000
+#endif
+
+/**
+ * ONLP_CONFIG_INCLUDE_FAN_CONTROL
+ *
+ * Include the common fan control engine. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_FAN_CONTROL
+#define ONLP_CONFIG_INCLUDE_FAN_CONTROL 1
+#endif
+
+/**
+ * ONLP_CONFIG_FAN_CONTROL_REAPPLY_MS
+ *
+ * Rewrite an unchanged fan control percentage after this many milliseconds, correcting changes made outside the engine. 0 disables. */
+
+
+#ifndef ONLP_CONFIG_FAN_CONTROL_REAPPLY_MS
+#define ONLP_CONFIG_FAN_CONTROL_REAPPLY_MS 30000
+#endif
+
+/**
+ * ONLP_CONFIG_INCLUDE_SFP_NOTIFY
+ *
+ * Include SFP presence and RX_LOS change notifications. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_SFP_NOTIFY
+#define ONLP_CONFIG_INCLUDE_SFP_NOTIFY 1
+#endif
+
+/**
+ * ONLP_CONFIG_SFP_NOTIFY_SCAN_INTERVAL
+ *
+ * SFP notification scan interval (ms) when the platform does not provide presence events. */
+
+
+#ifndef ONLP_CONFIG_SFP_NOTIFY_SCAN_INTERVAL
+#define ONLP_CONFIG_SFP_NOTIFY_SCAN_INTERVAL 1000
+#endif
+
+/**
+ * ONLP_CONFIG_SFP_NOTIFY_EVENT_SCAN_INTERVAL
+ *
+ * SFP notification safety rescan interval (ms) when the platform provides presence events. */
+
+
+#ifndef ONLP_CONFIG_SFP_NOTIFY_EVENT_SCAN_INTERVAL
+#define ONLP_CONFIG_SFP_NOTIFY_EVENT_SCAN_INTERVAL 30000
+#endif
+
+/**
+ * ONLP_CONFIG_SFP_INVENTORY_WORKERS
+ *
+ * Maximum number of threads used by onlp_sfp_inventory_get(). Ports on the same I2C adapter always share a thread. Must be at least 1. */
+
+
+#ifndef ONLP_CONFIG_SFP_INVENTORY_WORKERS
+#define ONLP_CONFIG_SFP_INVENTORY_WORKERS 16
+#endif
+
+/**
+ * ONLP_CONFIG_INCLUDE_OID_SNAPSHOT
+ *
+ * Cache the OID topology in memory. onlp_oid_iterate() walks the snapshot instead of calling hdr_get on every node. */
+
+
+#ifndef ONLP_CONFIG_INCLUDE_OID_SNAPSHOT
+#define ONLP_CONFIG_INCLUDE_OID_SNAPSHOT 1
+#endif
+
+/**
+ * ONLP_CONFIG_OID_SNAPSHOT_TTL
+ *
+ * The OID snapshot is rebuilt after this many milliseconds. 0 keeps it until it is invalidated. */
+
+
+#ifndef ONLP_CONFIG_OID_SNAPSHOT_TTL
+#define ONLP_CONFIG_OID_SNAPSHOT_TTL 60000
+#endif
+
+/**
+ * ONLP_CONFIG_OID_SNAPSHOT_ERROR_TTL
+ *
+ * OIDs whose hdr_get failed are retried after this many milliseconds. The rest of the snapshot is reused. */
+
+
+#ifndef ONLP_CONFIG_OID_SNAPSHOT_ERROR_TTL
+#define ONLP_CONFIG_OID_SNAPSHOT_ERROR_TTL 1000
+#endif
+
 
 
 /**
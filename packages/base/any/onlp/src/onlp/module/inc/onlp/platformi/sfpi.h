@@ -64,6 +64,31 @@ int onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst);
  */
 int onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst);
 
+/**
+ * @brief Return the bitmap of SFP ports on which a control is set.
+ * @param control The control.
+ * @param dst Receives the control bitmap.
+ * @notes Optional. Implement this if one register read returns the
+ * control for several ports. Ports that do not support the control
+ * are reported clear. Return ONLP_STATUS_E_UNSUPPORTED for controls
+ * which are not implemented here; they are then read port by port
+ * through onlp_sfpi_control_get().
+ */
+int onlp_sfpi_control_bitmap_get(onlp_sfp_control_t control, onlp_sfp_bitmap_t* dst);
+
+/**
+ * @brief Get a descriptor which signals SFP presence changes.
+ * @param [out] fd Receives the descriptor.
+ * @notes The descriptor is polled for POLLIN or POLLPRI. It may be a
+ * sysfs attribute updated with sysfs_notify() or a uevent netlink socket.
+ * It is read after every wakeup to re-arm it, and presence is rescanned,
+ * so spurious wakeups are harmless. The platform owns the descriptor.
+ * @notes Optional. Presence is polled periodically if unsupported.
+ * The onlpie simulation platform implements it with a timerfd which
+ * expires at the next scheduled presence change.
+ */
+int onlp_sfpi_presence_notify_fd_get(int* fd);
+
 /**
  * @brief Read the SFP EEPROM.
  * @param port The port number.
@@ -112,6 +137,41 @@ int onlp_sfpi_dev_read(int port, uint8_t devaddr, uint8_t addr, uint8_t* rdata,
  */
 int onlp_sfpi_dev_write(int port, uint8_t devaddr, uint8_t addr, uint8_t* data, int size);
 
+/**
+ * @brief Read a range of the paged memory map of the given SFP port.
+ * @param port The port number.
+ * @param devaddr The device address.
+ * @param bank The bank of the upper page.
+ * @param page The upper page.
+ * @param offset The offset within the device's 256 byte address space.
+ * @param len The number of bytes. offset + len does not exceed 256.
+ * @param data Receives the data.
+ * @notes Bytes 0-127 do not depend on the page and bank.
+ * Arguments have been validated before this is called.
+ * @notes Optional. If unsupported, the page and bank are selected
+ * through bytes 127 and 126 and the memory is read through
+ * onlp_sfpi_dev_read(). Page 0 of devices 0x50 and 0x51 falls back
+ * to onlp_sfpi_eeprom_read() and onlp_sfpi_dom_read().
+ */
+int onlp_sfpi_memory_read(int port, uint8_t devaddr, int bank, int page,
+                          int offset, int len, uint8_t* data);
+
+/**
+ * @brief Write a range of the paged memory map of the given SFP port.
+ * @param port The port number.
+ * @param devaddr The device address.
+ * @param bank The bank of the upper page.
+ * @param page The upper page.
+ * @param offset The offset within the device's 256 byte address space.
+ * @param len The number of bytes. offset + len does not exceed 256.
+ * @param data The data.
+ * @notes Optional. If unsupported, the page and bank are selected
+ * through bytes 127 and 126 and the memory is written through
+ * onlp_sfpi_dev_write().
+ */
+int onlp_sfpi_memory_write(int port, uint8_t devaddr, int bank, int page,
+                           int offset, int len, uint8_t* data);
+
 /**
  * @brief Read the SFP DOM EEPROM.
  * @param port The port number.
@@ -165,6 +225,17 @@ int onlp_sfpi_control_get(int port, onlp_sfp_control_t control, int* value);
  */
 int onlp_sfpi_port_map(int port, int* rport);
 
+/**
+ * @brief Get the I2C bus through which an SFP port is accessed.
+ * @param port The port number.
+ * @param [out] bus Receives the i2c bus number.
+ * @note Optional. Ports on different I2C adapters are locked
+ * separately and read in parallel during inventory collection.
+ * Ports are locked and read one at a time if unsupported.
+ * This is called without the API lock and must not touch hardware.
+ */
+int onlp_sfpi_port_bus_get(int port, int* bus);
+
 /**
  * @brief Deinitialize the SFP driver.
  */
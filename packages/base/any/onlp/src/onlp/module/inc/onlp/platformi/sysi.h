@@ -159,6 +159,18 @@ int onlp_sysi_platform_info_get(onlp_platform_info_t* info);
  */
 void onlp_sysi_platform_info_free(onlp_platform_info_t* info);
 
+/**
+ * @brief Report whether the platform drivers may run concurrently.
+ * @returns 1 if the thermal, fan, PSU, LED and SFP drivers are
+ * reentrant and do not share state (buffers, muxes, consoles)
+ * across those types. SFP ports may run concurrently when they are
+ * on different I2C adapters (see onlp_sfpi_port_bus_get()).
+ * @note Optional. Lock domains (ONLP_CONFIG_API_LOCK_DOMAINS) are
+ * only used on platforms which return 1. Return 1 only once the
+ * drivers have been audited.
+ */
+int onlp_sysi_api_lock_domains(void);
+
 /**
  * @brief Builtin platform debug tool.
  */
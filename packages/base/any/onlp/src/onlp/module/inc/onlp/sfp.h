@@ -172,6 +172,38 @@ int onlp_sfp_dev_readw(int port, uint8_t devaddr, uint8_t addr);
  */
 int onlp_sfp_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value);
 
+/**
+ * @brief Read a range of the paged memory map of the given SFP port.
+ * @param port The port number.
+ * @param devaddr The device address (0x50, or 0x51 for SFF-8472 diagnostics).
+ * @param bank The bank of the upper page (CMIS). Use 0 otherwise.
+ * @param page The upper page, e.g 0x11 for CMIS lane status.
+ * @param offset The offset within the device's 256 byte address space.
+ * Bytes 0-127 do not depend on the page and bank. The upper page
+ * starts at offset 128.
+ * @param len The number of bytes. offset + len must not exceed 256.
+ * @param data Receives the data. No memory is allocated.
+ * @note The module is returned to page 0, bank 0 afterwards.
+ * Upper pages other than page 0 of the 0x50 space return
+ * ONLP_STATUS_E_UNSUPPORTED unless the module is an SFF-8636 or
+ * CMIS module which does not report flat memory.
+ */
+int onlp_sfp_memory_read(int port, uint8_t devaddr, int bank, int page,
+                         int offset, int len, uint8_t* data);
+
+/**
+ * @brief Write a range of the paged memory map of the given SFP port.
+ * @param port The port number.
+ * @param devaddr The device address.
+ * @param bank The bank of the upper page (CMIS). Use 0 otherwise.
+ * @param page The upper page.
+ * @param offset The offset within the device's 256 byte address space.
+ * @param len The number of bytes. offset + len must not exceed 256.
+ * @param data The data.
+ */
+int onlp_sfp_memory_write(int port, uint8_t devaddr, int bank, int page,
+                          int offset, int len, uint8_t* data);
+
 
 
 
@@ -224,6 +256,144 @@ int onlp_sfp_control_get(int port, onlp_sfp_control_t control, int* value);
  */
 int onlp_sfp_control_flags_get(int port, uint32_t* flags);
 
+/**
+ * @brief Get the bitmap of ports on which an SFP control is set.
+ * @param control The control.
+ * @param dst Receives the control bitmap.
+ * @note This is emulated with onlp_sfp_control_get() on the present
+ * ports if the SFPI driver does not support batch collection of the
+ * control. Ports which do not support the control, or cannot be read,
+ * are reported clear.
+ * @returns ONLP_STATUS_E_UNSUPPORTED if no port supports the control.
+ */
+int onlp_sfp_control_bitmap_get(onlp_sfp_control_t control,
+                                onlp_sfp_bitmap_t* dst);
+
+/**
+ * @brief Get the value of all SFP controls on all ports.
+ * @param flags Receives the control flag values of each port, indexed
+ * by port number. See onlp_sfp_control_flags_t
+ * @param status Receives 0 or the first control error of each port,
+ * indexed by port number. May be NULL.
+ * @param count The number of entries in flags and status.
+ * @note This returns the same flags as onlp_sfp_control_flags_get()
+ * but reads each control once for all ports. Controls the SFPI driver
+ * cannot return as a bitmap are read from present ports only, so
+ * empty ports may be reported without flags.
+ */
+int onlp_sfp_control_flags_all_get(uint32_t* flags, int* status, int count);
+
+/**
+ * @brief Get the I2C bus through which an SFP port is accessed.
+ * @param port The port.
+ * @param [out] bus Receives the i2c bus number.
+ */
+int onlp_sfp_port_bus_get(int port, int* bus);
+
+/**
+ * SFP inventory entry.
+ */
+typedef struct onlp_sfp_inventory_entry_s {
+    /** The port number. */
+    int port;
+
+    /** onlp_sfp_is_present() result. */
+    int present;
+
+    /** onlp_sfp_eeprom_read() result. Only read if present. */
+    int eeprom_status;
+    uint8_t eeprom[256];
+
+    /** onlp_sfp_dom_read() result. Only read if present and requested. */
+    int dom_status;
+    uint8_t dom[256];
+
+    /** Control flags. See onlp_sfp_control_flags_t */
+    uint32_t control_flags;
+
+    /** Control read result. */
+    int control_status;
+
+} onlp_sfp_inventory_entry_t;
+
+/** Also read the DOM of every present port. */
+#define ONLP_SFP_INVENTORY_F_DOM 0x1
+
+/**
+ * @brief Collect the inventory of all SFP ports.
+ * @param entries Receives one entry per SFP port, in port order.
+ * @param count The number of entries.
+ * @param flags See ONLP_SFP_INVENTORY_F_*
+ * @returns The number of entries filled in.
+ * @note Ports are grouped by physical I2C adapter using
+ * onlp_sfpi_port_bus_get(). Groups are read in parallel by up to
+ * ONLP_CONFIG_SFP_INVENTORY_WORKERS threads when lock domains are
+ * in use (see onlp_sysi_api_lock_domains()), and one after the
+ * other under the single API lock otherwise.
+ */
+int onlp_sfp_inventory_get(onlp_sfp_inventory_entry_t* entries, int count,
+                           uint32_t flags);
+
+/**
+ * SFP change notifications.
+ *
+ * A single background scan monitors presence and RX_LOS for all
+ * subscribers. It is driven by platform presence events when
+ * available (see onlp_sfpi_presence_notify_fd_get()) and by periodic
+ * scans otherwise.
+ */
+typedef struct onlp_sfp_notify_s onlp_sfp_notify_t;
+
+/**
+ * Changes accumulated since the last onlp_sfp_notify_get().
+ */
+typedef struct onlp_sfp_notify_event_s {
+    /** Current presence. */
+    onlp_sfp_bitmap_t present;
+
+    /** Ports inserted since the last event. */
+    onlp_sfp_bitmap_t inserted;
+
+    /** Ports removed since the last event. */
+    onlp_sfp_bitmap_t removed;
+
+    /** Current RX_LOS. */
+    onlp_sfp_bitmap_t rx_los;
+
+    /** Ports whose RX_LOS has changed since the last event. */
+    onlp_sfp_bitmap_t rx_los_changed;
+
+} onlp_sfp_notify_event_t;
+
+/**
+ * @brief Subscribe to SFP change notifications.
+ * @param rv [out] Receives the subscription.
+ * @note The first event reports all currently present ports as inserted.
+ */
+int onlp_sfp_notify_subscribe(onlp_sfp_notify_t** rv);
+
+/**
+ * @brief Cancel a subscription.
+ * @param notify The subscription.
+ */
+int onlp_sfp_notify_unsubscribe(onlp_sfp_notify_t* notify);
+
+/**
+ * @brief Get the subscription's descriptor.
+ * @param notify The subscription.
+ * @returns A descriptor which is readable (POLLIN) while changes are pending.
+ * @note Do not read or close the descriptor. Use onlp_sfp_notify_get().
+ */
+int onlp_sfp_notify_fd(onlp_sfp_notify_t* notify);
+
+/**
+ * @brief Get and clear the pending changes.
+ * @param notify The subscription.
+ * @param event [out] Receives the changes.
+ * @returns 1 if there were changes, 0 otherwise.
+ */
+int onlp_sfp_notify_get(onlp_sfp_notify_t* notify, onlp_sfp_notify_event_t* event);
+
 /******************************************************************************
  *
  * Enumeration Support Definitions.
@@ -31,6 +31,9 @@
 #include <onlplib/onie.h>
 #include <onlplib/pi.h>
 #include <onlp/oids.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/psu.h>
 
 
 typedef struct onlp_sys_info_s {
@@ -62,6 +65,14 @@ int onlp_sys_info_get(onlp_sys_info_t* rv);
  */
 void onlp_sys_info_free(onlp_sys_info_t* info);
 
+/**
+ * @brief Discard the cached system information.
+ * @note The ONIE, OID and platform information are read once and
+ * reused. Call this if they change (e.g. the system EEPROM is
+ * reprogrammed). The shared ONIE cache file is removed as well.
+ */
+void onlp_sys_info_cache_invalidate(void);
+
 /**
  * @brief Get the system header.
  */
@@ -122,6 +133,132 @@ int onlp_sys_platform_manage_join(void);
 
 void onlp_sys_platform_manage_now(void);
 
+/**
+ * Platform management callback results.
+ * Negative values are errors and return the callback to its base rate.
+ */
+
+/** Nothing changed. The callback rate may back off. */
+#define ONLP_SYS_PLATFORM_MANAGE_IDLE 0
+
+/** Something changed. Return to the base rate. */
+#define ONLP_SYS_PLATFORM_MANAGE_ACTIVE 1
+
+/** A threshold is close. Run all adaptive callbacks at their minimum rates. */
+#define ONLP_SYS_PLATFORM_MANAGE_URGENT 2
+
+/**
+ * Platform management callback.
+ * @param cookie The registration cookie.
+ * @returns ONLP_SYS_PLATFORM_MANAGE_* or a negative error.
+ */
+typedef int (*onlp_sys_platform_manage_f)(void* cookie);
+
+/**
+ * @brief Register a platform management callback.
+ * @param name The callback name. Must be unique.
+ * @param manage The callback.
+ * @param cookie Passed to the callback.
+ * @param rate The base callback rate in microseconds.
+ * @param rate_min The fastest rate used when a callback reports urgency.
+ * @param rate_max The slowest rate used while a callback reports no changes.
+ * @note Set all three rates equal for a fixed rate callback.
+ * This may be called from onlp_sysi_platform_manage_init().
+ */
+int onlp_sys_platform_manage_register(const char* name,
+                                      onlp_sys_platform_manage_f manage,
+                                      void* cookie,
+                                      uint64_t rate,
+                                      uint64_t rate_min,
+                                      uint64_t rate_max);
+
+/**
+ * @brief Unregister a platform management callback.
+ * @param name The callback name.
+ */
+int onlp_sys_platform_manage_unregister(const char* name);
+
+/**
+ * Platform management callback statistics.
+ * All times are in microseconds.
+ */
+typedef struct onlp_sys_platform_manage_stats_s {
+    /** Number of calls. */
+    uint64_t calls;
+
+    /** Number of calls which returned an error. */
+    uint64_t errors;
+
+    /** Number of calls which took longer than the callback rate. */
+    uint64_t overruns;
+
+    /** Duration of the last call. */
+    uint64_t last;
+
+    /** Longest call. */
+    uint64_t max;
+
+    /** Total time spent in the callback. */
+    uint64_t total;
+
+    /** The current callback rate. */
+    uint64_t rate;
+
+} onlp_sys_platform_manage_stats_t;
+
+/**
+ * @brief Get the statistics for a platform management callback.
+ * @param name The callback name.
+ * @param stats [out] Receives the statistics.
+ */
+int onlp_sys_platform_manage_stats_get(const char* name,
+                                       onlp_sys_platform_manage_stats_t* stats);
+
+/**
+ * @brief Show the statistics for all platform management callbacks.
+ * @param pvs The output pvs.
+ */
+void onlp_sys_platform_manage_stats_show(aim_pvs_t* pvs);
+
+/**
+ * Platform management samples.
+ *
+ * Management callbacks read thermals, fans and PSUs through these
+ * calls so that each object is read once per management tick.
+ * A sample younger than ONLP_CONFIG_PLATFORM_MANAGE_SAMPLE_TTL
+ * is returned unless refresh is set.
+ */
+
+/**
+ * @brief Get a thermal sample.
+ * @param oid The thermal OID.
+ * @param info [out] Receives the thermal information.
+ * @param refresh Always read the thermal.
+ */
+int onlp_sys_platform_manage_thermal_get(onlp_oid_t oid,
+                                         onlp_thermal_info_t* info,
+                                         int refresh);
+
+/**
+ * @brief Get a fan sample.
+ * @param oid The fan OID.
+ * @param info [out] Receives the fan information.
+ * @param refresh Always read the fan.
+ */
+int onlp_sys_platform_manage_fan_get(onlp_oid_t oid,
+                                     onlp_fan_info_t* info,
+                                     int refresh);
+
+/**
+ * @brief Get a PSU sample.
+ * @param oid The PSU OID.
+ * @param info [out] Receives the PSU information.
+ * @param refresh Always read the PSU.
+ */
+int onlp_sys_platform_manage_psu_get(onlp_oid_t oid,
+                                     onlp_psu_info_t* info,
+                                     int refresh);
+
 int onlp_sys_debug(aim_pvs_t* pvs, int argc, char** argv);
 
 #endif /* __ONLP_SYS_H_ */
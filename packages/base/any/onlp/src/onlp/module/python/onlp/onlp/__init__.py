@@ -619,6 +619,12 @@ def onlp_sfp_init_prototypes():
     libonlp.onlp_sfp_dev_writew.restype = ctypes.c_int
     libonlp.onlp_sfp_dev_writew.argtypes = (ctypes.c_int, ctypes.c_ubyte, ctypes.c_ubyte, ctypes.c_ushort)
 
+    libonlp.onlp_sfp_memory_read.restype = ctypes.c_int
+    libonlp.onlp_sfp_memory_read.argtypes = (ctypes.c_int, ctypes.c_ubyte, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(ctypes.c_ubyte),)
+
+    libonlp.onlp_sfp_memory_write.restype = ctypes.c_int
+    libonlp.onlp_sfp_memory_write.argtypes = (ctypes.c_int, ctypes.c_ubyte, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.POINTER(ctypes.c_ubyte),)
+
     libonlp.onlp_sfp_dump.restype = None
     libonlp.onlp_sfp_dump.argtypes = (ctypes.POINTER(aim_pvs),)
 
@@ -636,6 +642,12 @@ def onlp_sfp_init_prototypes():
     libonlp.onlp_sfp_control_flags_get.restype = ctypes.c_int
     libonlp.onlp_sfp_control_flags_get.argtyeps = (ctypes.c_int, ctypes.POINTER(ctypes.c_uint32),)
 
+    libonlp.onlp_sfp_control_bitmap_get.restype = ctypes.c_int
+    libonlp.onlp_sfp_control_bitmap_get.argtypes = (onlp_sfp_control, ctypes.POINTER(onlp_sfp_bitmap),)
+
+    libonlp.onlp_sfp_control_flags_all_get.restype = ctypes.c_int
+    libonlp.onlp_sfp_control_flags_all_get.argtypes = (ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(ctypes.c_int), ctypes.c_int,)
+
 # onlp/onlp.h
 
 def init_prototypes():
@@ -25,7 +25,9 @@
 #include <onlp/fan.h>
 #include <onlp/platformi/fani.h>
 #include <onlp/oids.h>
+#include <stddef.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_FAN
 #include "onlp_locks.h"
 #include "onlp_log.h"
 #include "onlp_json.h"
@@ -45,45 +47,28 @@
     } while(0)
 
 
+#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
+static const onlp_json_override_field_t fan_override_fields__[] = {
+    { "status", offsetof(onlp_fan_info_t, status) },
+    { "caps", offsetof(onlp_fan_info_t, caps) },
+    { "rpm", offsetof(onlp_fan_info_t, rpm) },
+    { "percentage", offsetof(onlp_fan_info_t, percentage) },
+    { "mode", offsetof(onlp_fan_info_t, mode) },
+};
+#endif
+
 static int
 onlp_fan_init_locked__(void)
 {
+#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
+    onlp_json_override_register(ONLP_OID_TYPE_FAN, "fan",
+                                fan_override_fields__,
+                                AIM_ARRAYSIZE(fan_override_fields__));
+#endif
     return onlp_fani_init();
 }
 ONLP_LOCKED_API0(onlp_fan_init)
 
-
-#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
-
-static int
-onlp_fani_info_from_json__(cJSON* data, onlp_fan_info_t* fip, int errorcheck)
-{
-    int rv;
-
-    if(data == NULL) {
-        return (errorcheck) ? ONLP_STATUS_E_PARAM : 0;
-    }
-
-    rv = cjson_util_lookup_int(data, (int*) &fip->status, "status");
-    if(rv < 0 && errorcheck) return rv;
-
-    rv = cjson_util_lookup_int(data, (int*) &fip->caps, "caps");
-    if(rv < 0 && errorcheck) return rv;
-
-    rv = cjson_util_lookup_int(data, (int*) &fip->rpm, "rpm");
-    if(rv < 0 && errorcheck) return rv;
-
-    rv = cjson_util_lookup_int(data, (int*) &fip->percentage, "percentage");
-    if(rv < 0 && errorcheck) return rv;
-
-    rv = cjson_util_lookup_int(data, (int*) &fip->mode, "mode");
-    if(rv < 0 && errorcheck) return rv;
-
-    return 0;
-}
-
-#endif
-
 static int
 onlp_fan_info_get_locked__(onlp_oid_t oid, onlp_fan_info_t* fip)
 {
@@ -101,23 +86,20 @@ onlp_fan_info_get_locked__(onlp_oid_t oid, onlp_fan_info_t* fip)
          * Optional override from the config file.
          * This is usually just for testing.
          */
-        int id = ONLP_OID_ID_GET(oid);
-        cJSON* entry = NULL;
-
-
-        cjson_util_lookup(onlp_json_get(0), &entry, "overrides.fan.%d", id);
-        onlp_fani_info_from_json__(entry, fip, 0);
+        onlp_json_override_apply(oid, fip);
 #endif
 
         if(fip->percentage && fip->rpm == 0) {
             /* Approximate RPM based on a 10,000 RPM Maximum */
             fip->rpm = fip->percentage * 100;
         }
+
+        onlp_oid_snapshot_presence_update(oid, fip->status & ONLP_FAN_STATUS_PRESENT);
     }
 
     return rv;
 }
-ONLP_LOCKED_API2(onlp_fan_info_get, onlp_oid_t, oid, onlp_fan_info_t*, fip);
+ONLP_LOCKED_SHARED_API2(onlp_fan_info_get, onlp_oid_t, oid, onlp_fan_info_t*, fip);
 
 static int
 onlp_fan_status_get_locked__(onlp_oid_t oid, uint32_t* status)
@@ -133,7 +115,7 @@ onlp_fan_status_get_locked__(onlp_oid_t oid, uint32_t* status)
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_fan_status_get, onlp_oid_t, oid, uint32_t*, status);
+ONLP_LOCKED_SHARED_API2(onlp_fan_status_get, onlp_oid_t, oid, uint32_t*, status);
 
 static int
 onlp_fan_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
@@ -149,7 +131,7 @@ onlp_fan_hdr_get_locked__(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_fan_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_SHARED_API2(onlp_fan_hdr_get, onlp_oid_t, oid, onlp_oid_hdr_t*, hdr);
 
 static int
 onlp_fan_present__(onlp_oid_t id, onlp_fan_info_t* info)
@@ -0,0 +1,840 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * Common Fan Control Engine.
+ *
+ ***********************************************************/
+#include <onlp/onlp_config.h>
+#include <onlp/fan_control.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/sys.h>
+#include <OS/os_time.h>
+#include <AIM/aim.h>
+#include "onlp_log.h"
+#include "onlp_int.h"
+#include <pthread.h>
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <errno.h>
+
+#if ONLP_CONFIG_INCLUDE_FAN_CONTROL == 1
+
+#define THERMALS_MAX (ONLP_FAN_CONTROL_GROUPS_MAX*ONLP_FAN_CONTROL_SENSORS_MAX)
+
+/* Override reasons */
+#define REASON_FAN_FAILED     0x1
+#define REASON_FAN_MISSING    0x2
+#define REASON_SENSOR_FAILED  0x4
+#define REASON_THERMAL_ERROR  0x8
+
+static const char* reason_names__[] = {
+    "fan-failed", "fan-missing", "sensor-failed", "thermal-error"
+};
+
+/**
+ * Group state.
+ */
+typedef struct group_state_s {
+    /** The ladder in use and the current step. step < 0 is unplaced. */
+    const onlp_fan_control_step_t* steps;
+    int step;
+
+    /** PID state. time == 0 until the first valid sample. */
+    double integral;
+    double error;
+    uint64_t time;
+
+    /** Last aggregate and whether it was valid. */
+    int aggregate;
+    int valid;
+
+    /** Last output. -1 until the first valid sample. */
+    int output;
+
+} group_state_t;
+
+/**
+ * A compiled policy and its state.
+ */
+typedef struct fan_control_s {
+    onlp_fan_control_policy_t policy;
+
+    /** Distinct group thermals. Each is read once per tick. */
+    onlp_oid_t thermals[THERMALS_MAX];
+    int thermal_count;
+
+    /** Index into thermals[] for each group sensor. */
+    int index[ONLP_FAN_CONTROL_GROUPS_MAX][ONLP_FAN_CONTROL_SENSORS_MAX];
+    int sensor_count[ONLP_FAN_CONTROL_GROUPS_MAX];
+
+    int fan_count;
+    int control_count;
+
+    group_state_t state[ONLP_FAN_CONTROL_GROUPS_MAX];
+
+    /** Last applied percentage. -1 forces the next update. */
+    int percentage;
+
+    /** When the percentage was last applied. */
+    uint64_t applied;
+
+    /** Current override reasons. */
+    uint32_t reasons;
+
+} fan_control_t;
+
+/**
+ * One tick of input.
+ */
+typedef struct fan_control_sample_s {
+    /** Sample time in microseconds. */
+    uint64_t time;
+
+    /** Per thermals[] entry. rv < 0 if the thermal failed. */
+    int rv[THERMALS_MAX];
+    int mcelsius[THERMALS_MAX];
+    /** Error threshold, or 0 if unknown. */
+    int error[THERMALS_MAX];
+
+    int fan_failed;
+    int fan_missing;
+    int b2f;
+
+} fan_control_sample_t;
+
+static pthread_mutex_t lock__ = PTHREAD_MUTEX_INITIALIZER;
+static fan_control_t* control__ = NULL;
+
+static int
+percentage_valid__(int p)
+{
+    return p >= 0 && p <= 100;
+}
+
+static int
+steps_valid__(const onlp_fan_control_step_t* steps, int count)
+{
+    int i;
+    if(steps == NULL || count <= 0) {
+        return 0;
+    }
+    for(i = 0; i < count; i++) {
+        if(!percentage_valid__(steps[i].percentage)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int
+fan_control_compile__(const onlp_fan_control_policy_t* policy,
+                      fan_control_t* fc)
+{
+    int g, i, k;
+    const onlp_fan_control_failure_t* f = &policy->failure;
+
+    if(policy->group_count <= 0 ||
+       policy->group_count > ONLP_FAN_CONTROL_GROUPS_MAX ||
+       !percentage_valid__(policy->percentage_min) ||
+       !percentage_valid__(policy->percentage_max) ||
+       policy->percentage_min > policy->percentage_max ||
+       !percentage_valid__(f->fan_failed) ||
+       !percentage_valid__(f->fan_missing) ||
+       !percentage_valid__(f->sensor_failed) ||
+       !percentage_valid__(f->thermal_error)) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    memset(fc, 0, sizeof(*fc));
+    fc->policy = *policy;
+    fc->percentage = -1;
+
+    for(g = 0; g < policy->group_count; g++) {
+        const onlp_fan_control_group_t* grp = policy->groups + g;
+
+        switch(grp->mode)
+            {
+            case ONLP_FAN_CONTROL_MODE_STEP:
+                if(!steps_valid__(grp->steps, grp->step_count)) {
+                    return ONLP_STATUS_E_PARAM;
+                }
+                if(grp->steps_b2f &&
+                   !steps_valid__(grp->steps_b2f, grp->step_b2f_count)) {
+                    return ONLP_STATUS_E_PARAM;
+                }
+                break;
+            case ONLP_FAN_CONTROL_MODE_PID:
+                break;
+            default:
+                return ONLP_STATUS_E_PARAM;
+            }
+
+        if(grp->aggregate < ONLP_FAN_CONTROL_AGGREGATE_MAX ||
+           grp->aggregate > ONLP_FAN_CONTROL_AGGREGATE_SUM) {
+            return ONLP_STATUS_E_PARAM;
+        }
+
+        for(i = 0; i < ONLP_FAN_CONTROL_SENSORS_MAX && grp->thermals[i]; i++) {
+            onlp_oid_t oid = grp->thermals[i];
+            if(!ONLP_OID_IS_THERMAL(oid)) {
+                return ONLP_STATUS_E_PARAM;
+            }
+            for(k = 0; k < fc->thermal_count; k++) {
+                if(fc->thermals[k] == oid) {
+                    break;
+                }
+            }
+            if(k == fc->thermal_count) {
+                fc->thermals[fc->thermal_count++] = oid;
+            }
+            fc->index[g][i] = k;
+        }
+        if(i == 0) {
+            return ONLP_STATUS_E_PARAM;
+        }
+        fc->sensor_count[g] = i;
+
+        fc->state[g].step = -1;
+        fc->state[g].output = -1;
+    }
+
+    for(i = 0; i < ONLP_FAN_CONTROL_FANS_MAX && policy->fans[i]; i++) {
+        if(!ONLP_OID_IS_FAN(policy->fans[i])) {
+            return ONLP_STATUS_E_PARAM;
+        }
+    }
+    fc->fan_count = i;
+
+    for(i = 0; i < ONLP_FAN_CONTROL_FANS_MAX && policy->control[i]; i++) {
+        if(!ONLP_OID_IS_FAN(policy->control[i])) {
+            return ONLP_STATUS_E_PARAM;
+        }
+    }
+    fc->control_count = i;
+
+    if(fc->fan_count == 0 && fc->control_count == 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    return ONLP_STATUS_OK;
+}
+
+static int
+step_output__(const onlp_fan_control_group_t* grp, group_state_t* st,
+              int b2f, int agg)
+{
+    const onlp_fan_control_step_t* steps = grp->steps;
+    int count = grp->step_count;
+    int i;
+
+    if(b2f && grp->steps_b2f) {
+        steps = grp->steps_b2f;
+        count = grp->step_b2f_count;
+    }
+
+    if(st->steps != steps) {
+        /* First sample or the airflow changed. */
+        st->steps = steps;
+        st->step = -1;
+    }
+
+    i = st->step;
+    if(i < 0) {
+        /* Start on the step whose band contains the aggregate. */
+        for(i = 0; i < count - 1; i++) {
+            if(steps[i].up == 0 || agg < steps[i].up) {
+                break;
+            }
+        }
+    }
+    else if(steps[i].up && agg >= steps[i].up && i < count - 1) {
+        i++;
+    }
+    else if(steps[i].down && agg <= steps[i].down && i > 0) {
+        i--;
+    }
+
+    st->step = i;
+    return steps[i].percentage;
+}
+
+static int
+pid_output__(const onlp_fan_control_policy_t* policy,
+             const onlp_fan_control_group_t* grp, group_state_t* st,
+             uint64_t now, int agg)
+{
+    const onlp_fan_control_pid_t* pid = &grp->pid;
+    double e = (agg - pid->setpoint) / 1000.0;
+    double dt = 0, d = 0, integral, out;
+
+    if(st->time && now > st->time) {
+        dt = (now - st->time) / 1000000.0;
+        d = (e - st->error) / dt;
+    }
+
+    integral = st->integral + e*dt;
+    out = pid->kp*e + pid->ki*integral + pid->kd*d;
+
+    /* Only integrate while unsaturated or winding back. */
+    if(out > policy->percentage_max) {
+        out = policy->percentage_max;
+        if(e < 0) {
+            st->integral = integral;
+        }
+    }
+    else if(out < policy->percentage_min) {
+        out = policy->percentage_min;
+        if(e > 0) {
+            st->integral = integral;
+        }
+    }
+    else {
+        st->integral = integral;
+    }
+
+    st->error = e;
+    st->time = now;
+    return (int)(out + 0.5);
+}
+
+/*
+ * Compute the fan percentage for one sample.
+ * Updates the group states and fc->reasons.
+ */
+static int
+fan_control_evaluate__(fan_control_t* fc, const fan_control_sample_t* s)
+{
+    const onlp_fan_control_policy_t* policy = &fc->policy;
+    const onlp_fan_control_failure_t* f = &policy->failure;
+    uint32_t reasons = 0;
+    int percentage = policy->percentage_min;
+    int override = 0;
+    int g, i;
+
+    for(g = 0; g < policy->group_count; g++) {
+        const onlp_fan_control_group_t* grp = policy->groups + g;
+        group_state_t* st = fc->state + g;
+        int count = 0, failed = 0;
+        int agg = 0;
+
+        for(i = 0; i < fc->sensor_count[g]; i++) {
+            int k = fc->index[g][i];
+            int t = s->mcelsius[k];
+
+            if(s->rv[k] < 0) {
+                failed++;
+                continue;
+            }
+            if(s->error[k] && t >= s->error[k]) {
+                reasons |= REASON_THERMAL_ERROR;
+            }
+
+            switch(grp->aggregate)
+                {
+                case ONLP_FAN_CONTROL_AGGREGATE_MAX:
+                    agg = (count == 0 || t > agg) ? t : agg;
+                    break;
+                case ONLP_FAN_CONTROL_AGGREGATE_MIN:
+                    agg = (count == 0 || t < agg) ? t : agg;
+                    break;
+                case ONLP_FAN_CONTROL_AGGREGATE_AVG:
+                case ONLP_FAN_CONTROL_AGGREGATE_SUM:
+                    agg += t;
+                    break;
+                }
+            count++;
+        }
+
+        if(failed) {
+            reasons |= REASON_SENSOR_FAILED;
+        }
+
+        st->valid = (count > 0) &&
+            !(failed && grp->aggregate == ONLP_FAN_CONTROL_AGGREGATE_SUM);
+
+        if(st->valid) {
+            if(grp->aggregate == ONLP_FAN_CONTROL_AGGREGATE_AVG) {
+                agg /= count;
+            }
+            st->aggregate = agg;
+            if(grp->mode == ONLP_FAN_CONTROL_MODE_PID) {
+                st->output = pid_output__(policy, grp, st, s->time, agg);
+            }
+            else {
+                st->output = step_output__(grp, st, s->b2f, agg);
+            }
+        }
+        else if(st->output < 0) {
+            /* Never had a valid reading. Be safe. */
+            st->output = policy->percentage_max;
+        }
+        /* Otherwise hold the last output. */
+
+        if(st->output > percentage) {
+            percentage = st->output;
+        }
+    }
+
+    if(percentage > policy->percentage_max) {
+        percentage = policy->percentage_max;
+    }
+
+    if(s->fan_failed) {
+        reasons |= REASON_FAN_FAILED;
+    }
+    if(s->fan_missing) {
+        reasons |= REASON_FAN_MISSING;
+    }
+
+    if(reasons & REASON_FAN_FAILED && f->fan_failed > override) {
+        override = f->fan_failed;
+    }
+    if(reasons & REASON_FAN_MISSING && f->fan_missing > override) {
+        override = f->fan_missing;
+    }
+    if(reasons & REASON_SENSOR_FAILED && f->sensor_failed > override) {
+        override = f->sensor_failed;
+    }
+    if(reasons & REASON_THERMAL_ERROR && f->thermal_error > override) {
+        override = f->thermal_error;
+    }
+
+    fc->reasons = reasons;
+    return (override > percentage) ? override : percentage;
+}
+
+static void
+reasons_format__(uint32_t reasons, char* buf, int size)
+{
+    int i, len = 0;
+    buf[0] = 0;
+    for(i = 0; i < AIM_ARRAYSIZE(reason_names__) && len < size; i++) {
+        if(reasons & (1 << i)) {
+            len += snprintf(buf+len, size-len, "%s%s",
+                            len ? "," : "", reason_names__[i]);
+        }
+    }
+}
+
+int
+onlp_fan_control_register(const onlp_fan_control_policy_t* policy)
+{
+    fan_control_t* fc = NULL;
+
+    if(policy) {
+        int rv;
+        fc = aim_zmalloc(sizeof(*fc));
+        if( (rv = fan_control_compile__(policy, fc)) < 0) {
+            AIM_LOG_ERROR("Invalid fan control policy.");
+            aim_free(fc);
+            return rv;
+        }
+    }
+
+    pthread_mutex_lock(&lock__);
+    aim_free(control__);
+    control__ = fc;
+    pthread_mutex_unlock(&lock__);
+    return ONLP_STATUS_OK;
+}
+
+static void
+fan_control_sample_read__(fan_control_t* fc, fan_control_sample_t* s)
+{
+    int i, direction = 0;
+
+    memset(s, 0, sizeof(*s));
+    s->time = os_time_monotonic();
+
+    for(i = 0; i < fc->thermal_count; i++) {
+        onlp_thermal_info_t ti;
+        s->rv[i] = onlp_sys_platform_manage_thermal_get(fc->thermals[i], &ti, 1);
+        if(s->rv[i] >= 0 &&
+           (!(ti.status & ONLP_THERMAL_STATUS_PRESENT) ||
+            !(ti.caps & ONLP_THERMAL_CAPS_GET_TEMPERATURE))) {
+            s->rv[i] = ONLP_STATUS_E_MISSING;
+        }
+        if(s->rv[i] < 0) {
+            continue;
+        }
+        s->mcelsius[i] = ti.mcelsius;
+        if(ti.caps & ONLP_THERMAL_CAPS_GET_ERROR_THRESHOLD) {
+            s->error[i] = ti.thresholds.error;
+        }
+    }
+
+    /* Fans are usually sampled by the fan status pass. */
+    for(i = 0; i < fc->fan_count; i++) {
+        onlp_fan_info_t fi;
+        if(onlp_sys_platform_manage_fan_get(fc->policy.fans[i], &fi, 0) < 0) {
+            s->fan_failed = 1;
+            continue;
+        }
+        if(!(fi.status & ONLP_FAN_STATUS_PRESENT)) {
+            s->fan_missing = 1;
+            continue;
+        }
+        if(fi.status & ONLP_FAN_STATUS_FAILED) {
+            s->fan_failed = 1;
+        }
+        if(!direction) {
+            /* The first present fan decides the airflow. */
+            direction = 1;
+            s->b2f = (fi.status & ONLP_FAN_STATUS_B2F) ? 1 : 0;
+        }
+    }
+}
+
+static int
+fan_control_apply__(fan_control_t* fc, int percentage)
+{
+    const onlp_oid_t* fans = fc->control_count ? fc->policy.control : fc->policy.fans;
+    int count = fc->control_count ? fc->control_count : fc->fan_count;
+    int i, rv = ONLP_STATUS_OK;
+
+    for(i = 0; i < count; i++) {
+        int r = onlp_fan_percentage_set(fans[i], percentage);
+        if(r < 0) {
+            AIM_LOG_ERROR("Failed to set fan %d to %d%%: %d",
+                          ONLP_OID_ID_GET(fans[i]), percentage, r);
+            rv = r;
+        }
+    }
+    return rv;
+}
+
+int
+onlp_fan_control_manage(void)
+{
+    fan_control_sample_t s;
+    uint32_t reasons;
+    int percentage, rv = ONLP_STATUS_OK;
+    fan_control_t* fc;
+
+    pthread_mutex_lock(&lock__);
+
+    if( (fc = control__) == NULL) {
+        pthread_mutex_unlock(&lock__);
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    reasons = fc->reasons;
+    fan_control_sample_read__(fc, &s);
+    percentage = fan_control_evaluate__(fc, &s);
+
+    if(fc->reasons & ~reasons) {
+        char buf[64];
+        reasons_format__(fc->reasons, buf, sizeof(buf));
+        AIM_LOG_ERROR("Fan control override (%s). Setting fans to %d%%.",
+                      buf, percentage);
+    }
+
+    /*
+     * The fans are not read back, so someone else may have changed
+     * them since the last update. Rewrite them now and then.
+     */
+    if(percentage != fc->percentage ||
+       (ONLP_CONFIG_FAN_CONTROL_REAPPLY_MS &&
+        s.time - fc->applied >= ONLP_CONFIG_FAN_CONTROL_REAPPLY_MS*1000ULL)) {
+        if(percentage != fc->percentage) {
+            AIM_LOG_VERBOSE("Fan percentage %d -> %d", fc->percentage, percentage);
+        }
+        rv = fan_control_apply__(fc, percentage);
+        /* Retry on the next tick if the update failed. */
+        fc->percentage = (rv < 0) ? -1 : percentage;
+        fc->applied = s.time;
+    }
+
+    pthread_mutex_unlock(&lock__);
+    return rv;
+}
+
+
+/**************************************************************
+ *
+ * Trace replay.
+ *
+ *************************************************************/
+
+#define TRACE_COLUMNS_MAX 256
+
+static int
+trace_oid_parse__(const char* s, onlp_oid_t* oid)
+{
+    char type[32];
+    const char* dash = strchr(s, '-');
+    onlp_oid_type_t t;
+    int i;
+
+    if(!strncmp(s, "0x", 2)) {
+        *oid = strtoul(s, NULL, 16);
+        return 0;
+    }
+    if(dash == NULL || dash - s >= sizeof(type)) {
+        return -1;
+    }
+    for(i = 0; s + i < dash; i++) {
+        type[i] = toupper((unsigned char)s[i]);
+    }
+    type[i] = 0;
+    if(onlp_oid_type_value(type, &t, 0) < 0) {
+        return -1;
+    }
+    *oid = ONLP_OID_TYPE_CREATE(t, atoi(dash+1));
+    return 0;
+}
+
+static char*
+trace_token__(char** line)
+{
+    char* tok = strsep(line, ",");
+    char* end;
+
+    if(tok == NULL) {
+        return NULL;
+    }
+    while(isspace((unsigned char)*tok)) {
+        tok++;
+    }
+    end = tok + strlen(tok);
+    while(end > tok && isspace((unsigned char)end[-1])) {
+        *--end = 0;
+    }
+    return tok;
+}
+
+static int
+trace_header__(fan_control_t* fc, char* line, int* columns, int* count)
+{
+    char* tok;
+    int c = 0, k;
+
+    tok = trace_token__(&line);
+    if(tok == NULL || strcmp(tok, "ms")) {
+        AIM_LOG_ERROR("trace: the first column must be 'ms'");
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    /*
+     * columns[] holds a thermals[] index, or -(fan index + 2),
+     * or -1 to ignore the column.
+     */
+    while( (tok = trace_token__(&line)) && c < TRACE_COLUMNS_MAX) {
+        onlp_oid_t oid;
+        int i;
+
+        columns[c] = -1;
+        if(trace_oid_parse__(tok, &oid) < 0) {
+            AIM_LOG_ERROR("trace: bad column '%s'", tok);
+            return ONLP_STATUS_E_PARAM;
+        }
+        for(k = 0; k < fc->thermal_count; k++) {
+            if(fc->thermals[k] == oid) {
+                columns[c] = k;
+            }
+        }
+        for(i = 0; i < fc->fan_count; i++) {
+            if(fc->policy.fans[i] == oid) {
+                columns[c] = -(i + 2);
+            }
+        }
+        c++;
+    }
+
+    for(k = 0; k < fc->thermal_count; k++) {
+        int i;
+        for(i = 0; i < c && columns[i] != k; i++);
+        if(i == c) {
+            AIM_LOG_ERROR("trace: no column for thermal %d",
+                          ONLP_OID_ID_GET(fc->thermals[k]));
+            return ONLP_STATUS_E_PARAM;
+        }
+    }
+
+    *count = c;
+    return 0;
+}
+
+static int
+trace_row__(fan_control_t* fc, char* line, const int* columns, int count,
+            fan_control_sample_t* s)
+{
+    char* tok;
+    int c;
+    int direction = 0;
+
+    memset(s, 0, sizeof(*s));
+
+    tok = trace_token__(&line);
+    s->time = strtoull(tok, NULL, 0) * 1000;
+
+    for(c = 0; c < count; c++) {
+        if( (tok = trace_token__(&line)) == NULL) {
+            return ONLP_STATUS_E_PARAM;
+        }
+        if(columns[c] >= 0) {
+            int k = columns[c];
+            if(!strcmp(tok, "-")) {
+                s->rv[k] = ONLP_STATUS_E_MISSING;
+            }
+            else {
+                s->mcelsius[k] = atoi(tok);
+            }
+        }
+        else if(columns[c] < -1) {
+            if(!strcmp(tok, "failed")) {
+                s->fan_failed = 1;
+            }
+            else if(!strcmp(tok, "missing")) {
+                s->fan_missing = 1;
+            }
+            else if(!direction) {
+                direction = 1;
+                s->b2f = !strcmp(tok, "b2f");
+            }
+        }
+    }
+    return 0;
+}
+
+int
+onlp_fan_control_replay(const onlp_fan_control_policy_t* policy,
+                        const char* trace, aim_pvs_t* pvs)
+{
+    int columns[TRACE_COLUMNS_MAX];
+    int count = 0, rv = ONLP_STATUS_OK;
+    int lineno = 0, header = 0, last = -1, g;
+    char line[4096];
+    fan_control_t* fc;
+    FILE* fp;
+
+    if(policy == NULL) {
+        /* The platform registers its policy from its management init. */
+        onlp_sys_platform_manage_init();
+    }
+
+    fc = aim_zmalloc(sizeof(*fc));
+    if(policy) {
+        rv = fan_control_compile__(policy, fc);
+    }
+    else {
+        pthread_mutex_lock(&lock__);
+        if(control__) {
+            /* Replay from a fresh state. */
+            rv = fan_control_compile__(&control__->policy, fc);
+        }
+        else {
+            AIM_LOG_ERROR("No fan control policy is registered.");
+            rv = ONLP_STATUS_E_UNSUPPORTED;
+        }
+        pthread_mutex_unlock(&lock__);
+    }
+    if(rv < 0) {
+        aim_free(fc);
+        return rv;
+    }
+
+    if( (fp = fopen(trace, "r")) == NULL) {
+        AIM_LOG_ERROR("Could not open trace file '%s': %{errno}", trace, errno);
+        aim_free(fc);
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    while(fgets(line, sizeof(line), fp)) {
+        fan_control_sample_t s;
+        char reasons[64];
+        int percentage;
+
+        lineno++;
+        line[strcspn(line, "\r\n")] = 0;
+        if(line[0] == '#' || line[0] == 0) {
+            continue;
+        }
+
+        if(!header) {
+            if( (rv = trace_header__(fc, line, columns, &count)) < 0) {
+                break;
+            }
+            header = 1;
+            aim_printf(pvs, "%10s", "ms");
+            for(g = 0; g < fc->policy.group_count; g++) {
+                const char* name = fc->policy.groups[g].name;
+                aim_printf(pvs, " %12s %4s", name ? name : "group", "%");
+            }
+            aim_printf(pvs, "  %4s  %s\n", "fan%", "override");
+            continue;
+        }
+
+        if(trace_row__(fc, line, columns, count, &s) < 0) {
+            AIM_LOG_ERROR("trace: line %d: too few columns", lineno);
+            rv = ONLP_STATUS_E_PARAM;
+            break;
+        }
+
+        percentage = fan_control_evaluate__(fc, &s);
+        reasons_format__(fc->reasons, reasons, sizeof(reasons));
+
+        aim_printf(pvs, "%10"PRIu64, s.time / 1000);
+        for(g = 0; g < fc->policy.group_count; g++) {
+            if(fc->state[g].valid) {
+                aim_printf(pvs, " %12d %4d", fc->state[g].aggregate,
+                           fc->state[g].output);
+            }
+            else {
+                aim_printf(pvs, " %12s %4d", "-", fc->state[g].output);
+            }
+        }
+        aim_printf(pvs, " %c%4d  %s\n", (percentage != last) ? '*' : ' ',
+                   percentage, reasons);
+        last = percentage;
+    }
+
+    fclose(fp);
+    aim_free(fc);
+    return rv;
+}
+
+#else
+
+int
+onlp_fan_control_register(const onlp_fan_control_policy_t* policy)
+{
+    return ONLP_STATUS_E_UNSUPPORTED;
+}
+
+int
+onlp_fan_control_manage(void)
+{
+    return ONLP_STATUS_E_UNSUPPORTED;
+}
+
+int
+onlp_fan_control_replay(const onlp_fan_control_policy_t* policy,
+                        const char* trace, aim_pvs_t* pvs)
+{
+    return ONLP_STATUS_E_UNSUPPORTED;
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_FAN_CONTROL */
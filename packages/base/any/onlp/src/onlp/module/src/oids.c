@@ -34,6 +34,9 @@
 #include <onlp/led.h>
 #include <onlp/psu.h>
 #include <onlp/sys.h>
+#include <OS/os_time.h>
+#include <pthread.h>
+#include <string.h>
 
 #define OID_TYPE_SHOWDUMP_DEFINE(_TYPE, _type)                          \
     static void                                                         \
@@ -198,18 +201,14 @@ onlp_oid_hdr_get(onlp_oid_t oid, onlp_oid_hdr_t* hdr)
     return ONLP_STATUS_E_INVALID;
 }
 
-int
-onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_t type,
-                 onlp_oid_iterate_f itf, void* cookie)
+static int
+oid_iterate_live__(onlp_oid_t oid, onlp_oid_type_t type,
+                   onlp_oid_iterate_f itf, void* cookie)
 {
     int rv;
     onlp_oid_hdr_t hdr;
     onlp_oid_t* oidp;
 
-    if(oid == 0) {
-        oid = ONLP_OID_SYS;
-    }
-
     rv = onlp_oid_hdr_get(oid, &hdr);
     if(rv < 0) {
         return rv;
@@ -221,7 +220,7 @@ onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_t type,
             if(rv < 0) {
                 return rv;
             }
-            rv = onlp_oid_iterate(*oidp, type, itf, cookie);
+            rv = oid_iterate_live__(*oidp, type, itf, cookie);
             if(rv < 0) {
                 return rv;
             }
@@ -229,3 +228,455 @@ onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_t type,
     }
     return ONLP_STATUS_OK;
 }
+
+#if ONLP_CONFIG_INCLUDE_OID_SNAPSHOT == 1
+
+/**
+ * OID topology snapshot.
+ *
+ * The tree below ONLP_OID_SYS is captured breadth-first into a flat
+ * node array so that the children of every node are contiguous. A
+ * second index array partitions the nodes by OID type (in tree order)
+ * so type lookups never walk the tree.
+ *
+ * The snapshot is rebuilt lazily after onlp_oid_snapshot_invalidate(),
+ * after ONLP_CONFIG_OID_SNAPSHOT_TTL, and when a fan or PSU is seen
+ * to change presence. Nodes whose hdr_get failed are kept with their
+ * error. They are retried after ONLP_CONFIG_OID_SNAPSHOT_ERROR_TTL,
+ * reusing every node which succeeded.
+ */
+
+#define OID_SNAPSHOT_TYPES 256
+
+typedef struct oid_snapshot_node_s {
+    onlp_oid_t oid;
+    /** Index of the parent node, -1 for the root. */
+    int parent;
+    /** Index and number of the children. */
+    int first;
+    int count;
+    /** Result of the hdr_get for this node. */
+    int error;
+    /** Last presence seen by onlp_oid_snapshot_presence_update(), -1 if none. */
+    int present;
+    onlp_oid_desc_t description;
+} oid_snapshot_node_t;
+
+typedef struct oid_snapshot_s {
+    int refs;
+
+    /** Number of nodes whose hdr_get failed. */
+    int errors;
+    /** When the tree was first built and when the errors were last retried. */
+    uint64_t built;
+    uint64_t retried;
+
+    oid_snapshot_node_t* nodes;
+    int count;
+    int size;
+
+    /** Node indices grouped by type. */
+    int* by_type;
+    int type_start[OID_SNAPSHOT_TYPES+1];
+} oid_snapshot_t;
+
+static pthread_mutex_t snapshot_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static oid_snapshot_t* snapshot__ = NULL;
+static uint32_t snapshot_generation__ = 0;
+
+static void
+oid_snapshot_node_add__(oid_snapshot_t* s, onlp_oid_t oid, int parent)
+{
+    oid_snapshot_node_t* n;
+
+    if(s->count == s->size) {
+        s->size = (s->size) ? s->size * 2 : 64;
+        s->nodes = aim_realloc(s->nodes, s->size * sizeof(*s->nodes));
+    }
+    n = s->nodes + s->count++;
+    memset(n, 0, sizeof(*n));
+    n->oid = oid;
+    n->parent = parent;
+    n->present = -1;
+}
+
+static int
+oid_snapshot_ancestor__(oid_snapshot_t* s, int index)
+{
+    int p;
+    for(p = s->nodes[index].parent; p >= 0; p = s->nodes[p].parent) {
+        if(s->nodes[p].oid == s->nodes[index].oid) {
+            return p;
+        }
+    }
+    return -1;
+}
+
+static int oid_snapshot_find__(oid_snapshot_t* s, onlp_oid_t oid);
+
+/*
+ * Build the snapshot below root. Nodes which were read successfully
+ * in prev (if given) are copied from it instead of being read again.
+ */
+static oid_snapshot_t*
+oid_snapshot_build__(onlp_oid_t root, oid_snapshot_t* prev)
+{
+    int i, j, t;
+    int fill[OID_SNAPSHOT_TYPES];
+    onlp_oid_hdr_t hdr;
+    onlp_oid_t* oidp;
+    oid_snapshot_t* s = aim_zmalloc(sizeof(*s));
+
+    s->refs = 1;
+    s->retried = os_time_monotonic();
+    s->built = (prev) ? prev->built : s->retried;
+    oid_snapshot_node_add__(s, root, -1);
+
+    for(i = 0; i < s->count; i++) {
+        int a = oid_snapshot_ancestor__(s, i);
+        if(a >= 0) {
+            /* Cyclic reference. Keep the node but do not expand it. */
+            AIM_LOG_ERROR("OID 0x%x is its own ancestor.", s->nodes[i].oid);
+            memcpy(s->nodes[i].description, s->nodes[a].description,
+                   sizeof(s->nodes[i].description));
+            continue;
+        }
+
+        if(prev && (j = oid_snapshot_find__(prev, s->nodes[i].oid)) >= 0 &&
+           prev->nodes[j].error >= 0) {
+            oid_snapshot_node_t* pn = prev->nodes + j;
+            memcpy(s->nodes[i].description, pn->description,
+                   sizeof(s->nodes[i].description));
+            s->nodes[i].first = s->count;
+            for(j = pn->first; j < pn->first + pn->count; j++) {
+                oid_snapshot_node_add__(s, prev->nodes[j].oid, i);
+            }
+            s->nodes[i].count = s->count - s->nodes[i].first;
+            continue;
+        }
+
+        int rv = onlp_oid_hdr_get(s->nodes[i].oid, &hdr);
+        if(rv < 0) {
+            s->nodes[i].error = rv;
+            s->errors++;
+            continue;
+        }
+
+        memcpy(s->nodes[i].description, hdr.description,
+               sizeof(s->nodes[i].description));
+        s->nodes[i].first = s->count;
+        ONLP_OID_TABLE_ITER(hdr.coids, oidp) {
+            oid_snapshot_node_add__(s, *oidp, i);
+        }
+        s->nodes[i].count = s->count - s->nodes[i].first;
+    }
+
+    /* Stable counting sort of the node indices by type. */
+    memset(s->type_start, 0, sizeof(s->type_start));
+    for(i = 0; i < s->count; i++) {
+        s->type_start[ONLP_OID_TYPE_GET(s->nodes[i].oid) + 1]++;
+    }
+    for(t = 0; t < OID_SNAPSHOT_TYPES; t++) {
+        s->type_start[t+1] += s->type_start[t];
+        fill[t] = s->type_start[t];
+    }
+    s->by_type = aim_zmalloc(s->count * sizeof(*s->by_type));
+    for(i = 0; i < s->count; i++) {
+        s->by_type[fill[ONLP_OID_TYPE_GET(s->nodes[i].oid)]++] = i;
+    }
+
+    AIM_LOG_VERBOSE("oid snapshot: %d nodes, %d errors", s->count, s->errors);
+    return s;
+}
+
+static void
+oid_snapshot_release__(oid_snapshot_t* s)
+{
+    int refs;
+
+    pthread_mutex_lock(&snapshot_lock__);
+    refs = --s->refs;
+    pthread_mutex_unlock(&snapshot_lock__);
+
+    if(refs == 0) {
+        aim_free(s->by_type);
+        aim_free(s->nodes);
+        aim_free(s);
+    }
+}
+
+static oid_snapshot_t*
+oid_snapshot_acquire__(void)
+{
+    uint32_t generation;
+    uint64_t now = os_time_monotonic();
+    oid_snapshot_t* s;
+    oid_snapshot_t* prev = NULL;
+    oid_snapshot_t* replaced = NULL;
+    int retry = 0;
+
+    pthread_mutex_lock(&snapshot_lock__);
+    s = snapshot__;
+    if(s) {
+        s->refs++;
+        if(ONLP_CONFIG_OID_SNAPSHOT_TTL &&
+           now - s->built >= ONLP_CONFIG_OID_SNAPSHOT_TTL * 1000ULL) {
+            prev = s;
+        }
+        else if(s->errors &&
+                now - s->retried >= ONLP_CONFIG_OID_SNAPSHOT_ERROR_TTL * 1000ULL) {
+            prev = s;
+            retry = 1;
+        }
+    }
+    generation = snapshot_generation__;
+    pthread_mutex_unlock(&snapshot_lock__);
+
+    if(s && prev == NULL) {
+        return s;
+    }
+
+    s = oid_snapshot_build__(ONLP_OID_SYS, (retry) ? prev : NULL);
+
+    pthread_mutex_lock(&snapshot_lock__);
+    /*
+     * Do not install a snapshot that raced with an invalidation or
+     * with another rebuild.
+     */
+    if(snapshot__ == prev && generation == snapshot_generation__) {
+        replaced = snapshot__;
+        snapshot__ = s;
+        s->refs++;
+    }
+    pthread_mutex_unlock(&snapshot_lock__);
+
+    if(replaced) {
+        oid_snapshot_release__(replaced);
+    }
+    if(prev) {
+        oid_snapshot_release__(prev);
+    }
+    return s;
+}
+
+static int
+oid_snapshot_find__(oid_snapshot_t* s, onlp_oid_t oid)
+{
+    int i;
+    int t = ONLP_OID_TYPE_GET(oid);
+
+    for(i = s->type_start[t]; i < s->type_start[t+1]; i++) {
+        if(s->nodes[s->by_type[i]].oid == oid) {
+            return s->by_type[i];
+        }
+    }
+    return -1;
+}
+
+static int
+oid_snapshot_iterate__(oid_snapshot_t* s, int index, onlp_oid_type_t type,
+                       onlp_oid_iterate_f itf, void* cookie)
+{
+    int i;
+    oid_snapshot_node_t* n = s->nodes + index;
+
+    if(n->error < 0) {
+        return n->error;
+    }
+
+    for(i = n->first; i < n->first + n->count; i++) {
+        onlp_oid_t oid = s->nodes[i].oid;
+        if(type == 0 || ONLP_OID_IS_TYPE(type, oid)) {
+            int rv = itf(oid, cookie);
+            if(rv < 0) {
+                return rv;
+            }
+            rv = oid_snapshot_iterate__(s, i, type, itf, cookie);
+            if(rv < 0) {
+                return rv;
+            }
+        }
+    }
+    return ONLP_STATUS_OK;
+}
+
+void
+onlp_oid_snapshot_invalidate(void)
+{
+    oid_snapshot_t* s;
+
+    pthread_mutex_lock(&snapshot_lock__);
+    s = snapshot__;
+    snapshot__ = NULL;
+    snapshot_generation__++;
+    pthread_mutex_unlock(&snapshot_lock__);
+
+    if(s) {
+        oid_snapshot_release__(s);
+    }
+}
+
+void
+onlp_oid_snapshot_presence_update(onlp_oid_t oid, int present)
+{
+    int index;
+    int changed = 0;
+
+    present = !!present;
+
+    pthread_mutex_lock(&snapshot_lock__);
+    if(snapshot__ && (index = oid_snapshot_find__(snapshot__, oid)) >= 0) {
+        oid_snapshot_node_t* n = snapshot__->nodes + index;
+        changed = (n->present >= 0 && n->present != present);
+        n->present = present;
+    }
+    pthread_mutex_unlock(&snapshot_lock__);
+
+    if(changed) {
+        AIM_LOG_VERBOSE("OID 0x%x is %s. Invalidating the OID snapshot.",
+                        oid, present ? "present" : "missing");
+        onlp_oid_snapshot_invalidate();
+    }
+}
+
+int
+onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_t type,
+                 onlp_oid_iterate_f itf, void* cookie)
+{
+    int rv;
+    int index;
+    oid_snapshot_t* s;
+
+    if(oid == 0) {
+        oid = ONLP_OID_SYS;
+    }
+
+    s = oid_snapshot_acquire__();
+    index = oid_snapshot_find__(s, oid);
+    if(index >= 0) {
+        rv = oid_snapshot_iterate__(s, index, type, itf, cookie);
+    }
+    else {
+        rv = oid_iterate_live__(oid, type, itf, cookie);
+    }
+    oid_snapshot_release__(s);
+    return rv;
+}
+
+int
+onlp_oid_type_table_get(onlp_oid_type_t type, onlp_oid_t* table, int size)
+{
+    int i, j, count = 0;
+    oid_snapshot_t* s;
+
+    if(type <= 0 || type >= OID_SNAPSHOT_TYPES) {
+        return 0;
+    }
+
+    s = oid_snapshot_acquire__();
+    for(i = s->type_start[type]; i < s->type_start[type+1] && count < size; i++) {
+        onlp_oid_t oid = s->nodes[s->by_type[i]].oid;
+        for(j = 0; j < count && table[j] != oid; j++);
+        if(j == count) {
+            table[count++] = oid;
+        }
+    }
+
+    oid_snapshot_release__(s);
+    return count;
+}
+
+int
+onlp_oid_desc_get(onlp_oid_t oid, onlp_oid_desc_t desc)
+{
+    int rv;
+    int index;
+    oid_snapshot_t* s = oid_snapshot_acquire__();
+
+    index = oid_snapshot_find__(s, oid);
+    if(index >= 0) {
+        rv = s->nodes[index].error;
+        if(rv >= 0) {
+            aim_strlcpy(desc, s->nodes[index].description, sizeof(onlp_oid_desc_t));
+        }
+    }
+    else {
+        onlp_oid_hdr_t hdr;
+        rv = onlp_oid_hdr_get(oid, &hdr);
+        if(rv >= 0) {
+            aim_strlcpy(desc, hdr.description, sizeof(onlp_oid_desc_t));
+        }
+    }
+
+    oid_snapshot_release__(s);
+    return (rv < 0) ? rv : ONLP_STATUS_OK;
+}
+
+#else
+
+void
+onlp_oid_snapshot_invalidate(void)
+{
+}
+
+void
+onlp_oid_snapshot_presence_update(onlp_oid_t oid, int present)
+{
+}
+
+int
+onlp_oid_iterate(onlp_oid_t oid, onlp_oid_type_t type,
+                 onlp_oid_iterate_f itf, void* cookie)
+{
+    if(oid == 0) {
+        oid = ONLP_OID_SYS;
+    }
+    return oid_iterate_live__(oid, type, itf, cookie);
+}
+
+typedef struct oid_type_table_cookie_s {
+    onlp_oid_type_t type;
+    onlp_oid_t* table;
+    int size;
+    int count;
+} oid_type_table_cookie_t;
+
+static int
+oid_type_table_collect__(onlp_oid_t oid, void* cookie)
+{
+    int j;
+    oid_type_table_cookie_t* c = (oid_type_table_cookie_t*)cookie;
+
+    if(ONLP_OID_IS_TYPE(c->type, oid) && c->count < c->size) {
+        for(j = 0; j < c->count && c->table[j] != oid; j++);
+        if(j == c->count) {
+            c->table[c->count++] = oid;
+        }
+    }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_oid_type_table_get(onlp_oid_type_t type, onlp_oid_t* table, int size)
+{
+    oid_type_table_cookie_t c = { type, table, size, 0 };
+
+    if(type == ONLP_OID_TYPE_SYS && size > 0) {
+        table[c.count++] = ONLP_OID_SYS;
+    }
+    oid_iterate_live__(ONLP_OID_SYS, 0, oid_type_table_collect__, &c);
+    return c.count;
+}
+
+int
+onlp_oid_desc_get(onlp_oid_t oid, onlp_oid_desc_t desc)
+{
+    onlp_oid_hdr_t hdr;
+    int rv = onlp_oid_hdr_get(oid, &hdr);
+    if(rv >= 0) {
+        aim_strlcpy(desc, hdr.description, sizeof(onlp_oid_desc_t));
+    }
+    return (rv < 0) ? rv : ONLP_STATUS_OK;
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_OID_SNAPSHOT */
@@ -52,6 +52,9 @@ onlp_init(void)
     onlp_api_lock_init();
 #endif
 
+#if ONLP_CONFIG_INCLUDE_API_PROFILING == 1
+    onlp_api_profile_init();
+#endif
 
     onlp_json_init(cfile);
     onlp_sys_init();
@@ -70,6 +73,7 @@ onlp_denit(void)
     onlp_api_lock_denit();
 #endif
 
+    onlp_oid_snapshot_invalidate();
     onlp_json_denit();
 
     return 0;
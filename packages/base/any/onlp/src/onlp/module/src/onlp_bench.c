@@ -0,0 +1,621 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlp/onlp_config.h>
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+#include <onlp/thermal.h>
+#include <onlp/fan.h>
+#include <onlp/psu.h>
+#include <onlp/led.h>
+#include <onlp/sfp.h>
+#include <AIM/aim.h>
+#include "onlp_log.h"
+#include "onlp_int.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * ONLP API benchmark.
+ *
+ *   onlpdump bench [-t threads] [-p processes] [-d seconds] [-o op,op,...]
+ *
+ * Every thread of every process cycles through the selected operations
+ * until the deadline. Latency is recorded per call in a log-linear
+ * histogram, so results from several processes can be merged.
+ * Run it against the onlpie simulation platform for reproducible
+ * numbers without hardware.
+ */
+
+/** 16 sub-buckets per power of two, about 6% resolution. */
+#define BENCH_SUB_BITS 4
+#define BENCH_BUCKETS (64 << BENCH_SUB_BITS)
+
+typedef struct bench_stats_s {
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint32_t hist[BENCH_BUCKETS];
+} bench_stats_t;
+
+typedef struct bench_targets_s {
+    onlp_oid_t thermals[ONLP_OID_TABLE_SIZE];
+    int thermal_count;
+    onlp_oid_t fans[ONLP_OID_TABLE_SIZE];
+    int fan_count;
+    onlp_oid_t psus[ONLP_OID_TABLE_SIZE];
+    int psu_count;
+    onlp_oid_t leds[ONLP_OID_TABLE_SIZE];
+    int led_count;
+    int ports[256];
+    int port_count;
+} bench_targets_t;
+
+typedef int (*bench_op_f)(bench_targets_t* t, int iteration);
+
+typedef struct bench_op_s {
+    const char* name;
+    bench_op_f op;
+} bench_op_t;
+
+static int
+bench_oid_cb__(onlp_oid_t oid, void* cookie)
+{
+    return 0;
+}
+
+static int
+bench_oid_iterate__(bench_targets_t* t, int i)
+{
+    return onlp_oid_iterate(ONLP_OID_SYS, 0, bench_oid_cb__, NULL);
+}
+
+static int
+bench_thermal__(bench_targets_t* t, int i)
+{
+    onlp_thermal_info_t info;
+    if(t->thermal_count == 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    return onlp_thermal_info_get(t->thermals[i % t->thermal_count], &info);
+}
+
+static int
+bench_fan__(bench_targets_t* t, int i)
+{
+    onlp_fan_info_t info;
+    if(t->fan_count == 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    return onlp_fan_info_get(t->fans[i % t->fan_count], &info);
+}
+
+static int
+bench_psu__(bench_targets_t* t, int i)
+{
+    onlp_psu_info_t info;
+    if(t->psu_count == 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    return onlp_psu_info_get(t->psus[i % t->psu_count], &info);
+}
+
+static int
+bench_led__(bench_targets_t* t, int i)
+{
+    onlp_led_info_t info;
+    if(t->led_count == 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    return onlp_led_info_get(t->leds[i % t->led_count], &info);
+}
+
+static int
+bench_sfp_presence__(bench_targets_t* t, int i)
+{
+    onlp_sfp_bitmap_t bmap;
+    onlp_sfp_bitmap_t_init(&bmap);
+    return onlp_sfp_presence_bitmap_get(&bmap);
+}
+
+static int
+bench_sfp_eeprom__(bench_targets_t* t, int i)
+{
+    int rv;
+    uint8_t* data = NULL;
+    if(t->port_count == 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    rv = onlp_sfp_eeprom_read(t->ports[i % t->port_count], &data);
+    aim_free(data);
+    /* Empty ports are not an error. */
+    return (rv == ONLP_STATUS_E_MISSING) ? 0 : rv;
+}
+
+static int
+bench_sfp_dom__(bench_targets_t* t, int i)
+{
+    int rv;
+    uint8_t* data = NULL;
+    if(t->port_count == 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    rv = onlp_sfp_dom_read(t->ports[i % t->port_count], &data);
+    aim_free(data);
+    return (rv == ONLP_STATUS_E_MISSING || rv == ONLP_STATUS_E_UNSUPPORTED) ? 0 : rv;
+}
+
+static int
+bench_sfp_inventory__(bench_targets_t* t, int i)
+{
+    static __thread onlp_sfp_inventory_entry_t entries[256];
+    int rv = onlp_sfp_inventory_get(entries, AIM_ARRAYSIZE(entries), 0);
+    return (rv < 0) ? rv : 0;
+}
+
+/*
+ * The per-port walk onlp_sfp_inventory_get() replaced: presence,
+ * then EEPROM, then control flags, one port after the other.
+ */
+static int
+bench_sfp_inventory_serial__(bench_targets_t* t, int i)
+{
+    int p, rv;
+    uint32_t flags;
+    uint8_t* data;
+
+    for(p = 0; p < t->port_count; p++) {
+        if((rv = onlp_sfp_is_present(t->ports[p])) < 0) {
+            return rv;
+        }
+        if(rv) {
+            data = NULL;
+            rv = onlp_sfp_eeprom_read(t->ports[p], &data);
+            aim_free(data);
+            if(rv < 0 && rv != ONLP_STATUS_E_MISSING) {
+                return rv;
+            }
+        }
+        onlp_sfp_control_flags_get(t->ports[p], &flags);
+    }
+    return 0;
+}
+
+static bench_op_t bench_ops__[] = {
+    { "oid_iterate", bench_oid_iterate__ },
+    { "thermal", bench_thermal__ },
+    { "fan", bench_fan__ },
+    { "psu", bench_psu__ },
+    { "led", bench_led__ },
+    { "sfp_presence", bench_sfp_presence__ },
+    { "sfp_eeprom", bench_sfp_eeprom__ },
+    { "sfp_dom", bench_sfp_dom__ },
+    { "sfp_inventory", bench_sfp_inventory__ },
+    { "sfp_inventory_serial", bench_sfp_inventory_serial__ },
+};
+
+#define BENCH_OPS_DEFAULT "thermal,fan,psu,sfp_presence,sfp_eeprom"
+
+typedef struct bench_config_s {
+    int threads;
+    int processes;
+    int seconds;
+    int ops[AIM_ARRAYSIZE(bench_ops__)];
+    int op_count;
+} bench_config_t;
+
+typedef struct bench_thread_s {
+    pthread_t thread;
+    bench_config_t* config;
+    bench_targets_t* targets;
+    pthread_barrier_t* start;
+    uint64_t deadline_ns;
+    bench_stats_t* stats;
+} bench_thread_t;
+
+static uint64_t
+bench_now_ns__(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int
+bench_bucket__(uint64_t v)
+{
+    int e;
+    if(v < (1 << BENCH_SUB_BITS)) {
+        return v;
+    }
+    e = 63 - __builtin_clzll(v);
+    return ((e - BENCH_SUB_BITS + 1) << BENCH_SUB_BITS) |
+        ((v >> (e - BENCH_SUB_BITS)) & ((1 << BENCH_SUB_BITS) - 1));
+}
+
+/** Lower bound of a histogram bucket. */
+static uint64_t
+bench_bucket_value__(int b)
+{
+    int e = b >> BENCH_SUB_BITS;
+    uint64_t sub = b & ((1 << BENCH_SUB_BITS) - 1);
+    if(e == 0) {
+        return sub;
+    }
+    e += BENCH_SUB_BITS - 1;
+    return ((uint64_t)1 << e) | (sub << (e - BENCH_SUB_BITS));
+}
+
+static uint64_t
+bench_percentile__(bench_stats_t* s, double p)
+{
+    int b;
+    uint64_t seen = 0;
+    uint64_t want = (uint64_t)(s->calls * p);
+
+    for(b = 0; b < BENCH_BUCKETS; b++) {
+        seen += s->hist[b];
+        if(seen > want) {
+            return bench_bucket_value__(b);
+        }
+    }
+    return s->max_ns;
+}
+
+static void
+bench_merge__(bench_stats_t* dst, bench_stats_t* src)
+{
+    int b;
+    dst->calls += src->calls;
+    dst->errors += src->errors;
+    dst->total_ns += src->total_ns;
+    if(src->max_ns > dst->max_ns) {
+        dst->max_ns = src->max_ns;
+    }
+    for(b = 0; b < BENCH_BUCKETS; b++) {
+        dst->hist[b] += src->hist[b];
+    }
+}
+
+static void*
+bench_thread__(void* arg)
+{
+    bench_thread_t* bt = (bench_thread_t*)arg;
+    bench_config_t* c = bt->config;
+    int i;
+
+    pthread_barrier_wait(bt->start);
+
+    for(i = 0; bench_now_ns__() < bt->deadline_ns; i++) {
+        int o = i % c->op_count;
+        bench_stats_t* s = bt->stats + o;
+        uint64_t start = bench_now_ns__();
+        int rv = bench_ops__[c->ops[o]].op(bt->targets, i / c->op_count);
+        uint64_t ns = bench_now_ns__() - start;
+
+        s->calls++;
+        if(rv < 0) {
+            s->errors++;
+        }
+        s->total_ns += ns;
+        if(ns > s->max_ns) {
+            s->max_ns = ns;
+        }
+        s->hist[bench_bucket__(ns)]++;
+    }
+    return NULL;
+}
+
+static void
+bench_targets_get__(bench_targets_t* t)
+{
+    int p;
+    onlp_sfp_bitmap_t bmap;
+
+    memset(t, 0, sizeof(*t));
+    t->thermal_count = onlp_oid_type_table_get(ONLP_OID_TYPE_THERMAL, t->thermals,
+                                               AIM_ARRAYSIZE(t->thermals));
+    t->fan_count = onlp_oid_type_table_get(ONLP_OID_TYPE_FAN, t->fans,
+                                           AIM_ARRAYSIZE(t->fans));
+    t->psu_count = onlp_oid_type_table_get(ONLP_OID_TYPE_PSU, t->psus,
+                                           AIM_ARRAYSIZE(t->psus));
+    t->led_count = onlp_oid_type_table_get(ONLP_OID_TYPE_LED, t->leds,
+                                           AIM_ARRAYSIZE(t->leds));
+
+    onlp_sfp_bitmap_t_init(&bmap);
+    onlp_sfp_bitmap_get(&bmap);
+    AIM_BITMAP_ITER(&bmap, p) {
+        t->ports[t->port_count++] = p;
+    }
+}
+
+/**
+ * Run all threads of one process and return the per-op statistics.
+ */
+static void
+bench_process__(bench_config_t* c, bench_stats_t* stats)
+{
+    int i;
+    bench_targets_t targets;
+    bench_thread_t* threads;
+    pthread_barrier_t start;
+    uint64_t deadline;
+
+    onlp_init();
+    bench_targets_get__(&targets);
+
+    threads = aim_zmalloc(c->threads * sizeof(*threads));
+    pthread_barrier_init(&start, NULL, c->threads + 1);
+
+    for(i = 0; i < c->threads; i++) {
+        threads[i].config = c;
+        threads[i].targets = &targets;
+        threads[i].start = &start;
+        threads[i].stats = aim_zmalloc(c->op_count * sizeof(bench_stats_t));
+    }
+
+    for(i = 0; i < c->threads; i++) {
+        if(pthread_create(&threads[i].thread, NULL, bench_thread__, threads + i) != 0) {
+            AIM_DIE("Cannot create benchmark thread %d", i);
+        }
+    }
+
+    /* The barrier publishes the deadline to the threads. */
+    deadline = bench_now_ns__() + (uint64_t)c->seconds * 1000000000;
+    for(i = 0; i < c->threads; i++) {
+        threads[i].deadline_ns = deadline;
+    }
+    pthread_barrier_wait(&start);
+
+    for(i = 0; i < c->threads; i++) {
+        int o;
+        pthread_join(threads[i].thread, NULL);
+        for(o = 0; o < c->op_count; o++) {
+            bench_merge__(stats + o, threads[i].stats + o);
+        }
+        aim_free(threads[i].stats);
+    }
+
+    pthread_barrier_destroy(&start);
+    aim_free(threads);
+    onlp_denit();
+}
+
+static int
+bench_write_all__(int fd, void* data, size_t size)
+{
+    uint8_t* p = data;
+    while(size) {
+        ssize_t n = write(fd, p, size);
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        if(n <= 0) {
+            return -1;
+        }
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static int
+bench_read_all__(int fd, void* data, size_t size)
+{
+    uint8_t* p = data;
+    while(size) {
+        ssize_t n = read(fd, p, size);
+        if(n < 0 && errno == EINTR) {
+            continue;
+        }
+        if(n <= 0) {
+            return -1;
+        }
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static void
+bench_report__(bench_config_t* c, bench_stats_t* stats, double seconds)
+{
+    int o;
+    bench_stats_t total;
+
+    memset(&total, 0, sizeof(total));
+
+    aim_printf(&aim_pvs_stdout,
+               "%d process(es) x %d thread(s), %d second(s)\n\n",
+               c->processes, c->threads, c->seconds);
+    aim_printf(&aim_pvs_stdout, "%-16s %12s %8s %12s %10s %10s %10s %10s\n",
+               "op", "calls", "errors", "ops/s", "mean(us)", "p50(us)", "p99(us)", "max(us)");
+
+    for(o = 0; o <= c->op_count; o++) {
+        bench_stats_t* s;
+        const char* name;
+
+        if(o < c->op_count) {
+            s = stats + o;
+            name = bench_ops__[c->ops[o]].name;
+            bench_merge__(&total, s);
+        }
+        else {
+            s = &total;
+            name = "total";
+        }
+
+        aim_printf(&aim_pvs_stdout, "%-16s %12llu %8llu %12.1f %10.1f %10.1f %10.1f %10.1f\n",
+                   name,
+                   (unsigned long long)s->calls,
+                   (unsigned long long)s->errors,
+                   s->calls / seconds,
+                   (s->calls) ? s->total_ns / 1000.0 / s->calls : 0.0,
+                   bench_percentile__(s, 0.50) / 1000.0,
+                   bench_percentile__(s, 0.99) / 1000.0,
+                   s->max_ns / 1000.0);
+    }
+}
+
+static int
+bench_ops_parse__(bench_config_t* c, char* spec)
+{
+    char* saveptr = NULL;
+    char* name;
+
+    c->op_count = 0;
+    for(name = strtok_r(spec, ",", &saveptr); name; name = strtok_r(NULL, ",", &saveptr)) {
+        int o;
+        for(o = 0; o < AIM_ARRAYSIZE(bench_ops__); o++) {
+            if(!strcmp(name, bench_ops__[o].name)) {
+                break;
+            }
+        }
+        if(o == AIM_ARRAYSIZE(bench_ops__) || c->op_count == AIM_ARRAYSIZE(c->ops)) {
+            fprintf(stderr, "unknown or repeated operation '%s'\n", name);
+            return -1;
+        }
+        c->ops[c->op_count++] = o;
+    }
+    return (c->op_count) ? 0 : -1;
+}
+
+static void
+bench_usage__(const char* name)
+{
+    int o;
+    printf("Usage: %s [OPTIONS]\n", name);
+    printf("  -t <n>     Threads per process (default 1).\n");
+    printf("  -p <n>     Processes (default 1).\n");
+    printf("  -d <s>     Duration in seconds (default 5).\n");
+    printf("  -o <ops>   Comma separated operations (default %s).\n", BENCH_OPS_DEFAULT);
+    printf("Operations:");
+    for(o = 0; o < AIM_ARRAYSIZE(bench_ops__); o++) {
+        printf(" %s", bench_ops__[o].name);
+    }
+    printf("\n");
+}
+
+int
+onlp_bench_main(int argc, char* argv[])
+{
+    int c, i;
+    int rv = 0;
+    char ops[256] = BENCH_OPS_DEFAULT;
+    bench_config_t config;
+    bench_stats_t* stats;
+    uint64_t start;
+    pid_t* children;
+    int* fds;
+
+    memset(&config, 0, sizeof(config));
+    config.threads = 1;
+    config.processes = 1;
+    config.seconds = 5;
+
+    optind = 1;
+    while( (c = getopt(argc, argv, "t:p:d:o:h")) != -1) {
+        switch(c)
+            {
+            case 't': config.threads = atoi(optarg); break;
+            case 'p': config.processes = atoi(optarg); break;
+            case 'd': config.seconds = atoi(optarg); break;
+            case 'o': aim_strlcpy(ops, optarg, sizeof(ops)); break;
+            default: bench_usage__(argv[0]); return 1;
+            }
+    }
+
+    if(config.threads < 1 || config.processes < 1 || config.seconds < 1 ||
+       bench_ops_parse__(&config, ops) < 0) {
+        bench_usage__(argv[0]);
+        return 1;
+    }
+
+    stats = aim_zmalloc(config.op_count * sizeof(*stats));
+    start = bench_now_ns__();
+
+    if(config.processes == 1) {
+        bench_process__(&config, stats);
+    }
+    else {
+        children = aim_zmalloc(config.processes * sizeof(*children));
+        fds = aim_zmalloc(config.processes * sizeof(*fds));
+
+        for(i = 0; i < config.processes; i++) {
+            int p[2];
+            if(pipe(p) < 0) {
+                AIM_LOG_ERROR("pipe: %{errno}", errno);
+                children[i] = -1;
+                continue;
+            }
+            children[i] = fork();
+            if(children[i] == 0) {
+                close(p[0]);
+                memset(stats, 0, config.op_count * sizeof(*stats));
+                bench_process__(&config, stats);
+                rv = bench_write_all__(p[1], stats, config.op_count * sizeof(*stats));
+                _exit(rv < 0);
+            }
+            close(p[1]);
+            fds[i] = p[0];
+            if(children[i] < 0) {
+                AIM_LOG_ERROR("fork: %{errno}", errno);
+                close(p[0]);
+            }
+        }
+
+        for(i = 0; i < config.processes; i++) {
+            if(children[i] > 0) {
+                int o;
+                bench_stats_t* cs = aim_zmalloc(config.op_count * sizeof(*cs));
+                if(bench_read_all__(fds[i], cs, config.op_count * sizeof(*cs)) == 0) {
+                    for(o = 0; o < config.op_count; o++) {
+                        bench_merge__(stats + o, cs + o);
+                    }
+                }
+                else {
+                    AIM_LOG_ERROR("No results from benchmark process %d", children[i]);
+                    rv = 1;
+                }
+                aim_free(cs);
+                close(fds[i]);
+                waitpid(children[i], NULL, 0);
+            }
+        }
+        aim_free(children);
+        aim_free(fds);
+    }
+
+    bench_report__(&config, stats, (bench_now_ns__() - start) / 1e9);
+    aim_free(stats);
+    return rv;
+}
@@ -105,6 +105,16 @@ onlp_config_settings_t onlp_config_settings[] =
 #else
 { ONLP_CONFIG_CONFIGURATION_ENV(__onlp_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE) },
+#else
+{ ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SYS_INFO_CACHE_FILENAME
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SYS_INFO_CACHE_FILENAME), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SYS_INFO_CACHE_FILENAME) },
+#else
+{ ONLP_CONFIG_SYS_INFO_CACHE_FILENAME(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef ONLP_CONFIG_INCLUDE_API_LOCK
     { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_API_LOCK), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_API_LOCK) },
 #else
@@ -120,6 +130,16 @@ onlp_config_settings_t onlp_config_settings[] =
 #else
 { ONLP_CONFIG_API_LOCK_TIMEOUT(__onlp_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef ONLP_CONFIG_API_LOCK_DOMAINS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_LOCK_DOMAINS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_LOCK_DOMAINS) },
+#else
+{ ONLP_CONFIG_API_LOCK_DOMAINS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_API_LOCK_DOMAIN_FILENAME
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_API_LOCK_DOMAIN_FILENAME), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_API_LOCK_DOMAIN_FILENAME) },
+#else
+{ ONLP_CONFIG_API_LOCK_DOMAIN_FILENAME(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef ONLP_CONFIG_INFO_STR_MAX
     { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INFO_STR_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INFO_STR_MAX) },
 #else
@@ -134,6 +154,71 @@ onlp_config_settings_t onlp_config_settings[] =
     { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_API_PROFILING), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_API_PROFILING) },
 #else
 { ONLP_CONFIG_INCLUDE_API_PROFILING(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGE_BACKOFF_MAX
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGE_BACKOFF_MAX), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGE_BACKOFF_MAX) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGE_BACKOFF_MAX(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_MARGIN
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_MARGIN), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_MARGIN) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_MARGIN(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_HYSTERESIS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_HYSTERESIS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_HYSTERESIS) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_HYSTERESIS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_PLATFORM_MANAGE_SAMPLE_TTL
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_PLATFORM_MANAGE_SAMPLE_TTL), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_PLATFORM_MANAGE_SAMPLE_TTL) },
+#else
+{ ONLP_CONFIG_PLATFORM_MANAGE_SAMPLE_TTL(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_FAN_CONTROL
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_FAN_CONTROL), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_FAN_CONTROL) },
+#else
+{ ONLP_CONFIG_INCLUDE_FAN_CONTROL(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_FAN_CONTROL_REAPPLY_MS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_FAN_CONTROL_REAPPLY_MS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_FAN_CONTROL_REAPPLY_MS) },
+#else
+{ ONLP_CONFIG_FAN_CONTROL_REAPPLY_MS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_SFP_NOTIFY
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_SFP_NOTIFY), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_SFP_NOTIFY) },
+#else
+{ ONLP_CONFIG_INCLUDE_SFP_NOTIFY(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SFP_NOTIFY_SCAN_INTERVAL
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SFP_NOTIFY_SCAN_INTERVAL), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SFP_NOTIFY_SCAN_INTERVAL) },
+#else
+{ ONLP_CONFIG_SFP_NOTIFY_SCAN_INTERVAL(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SFP_NOTIFY_EVENT_SCAN_INTERVAL
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SFP_NOTIFY_EVENT_SCAN_INTERVAL), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SFP_NOTIFY_EVENT_SCAN_INTERVAL) },
+#else
+{ ONLP_CONFIG_SFP_NOTIFY_EVENT_SCAN_INTERVAL(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_SFP_INVENTORY_WORKERS
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_SFP_INVENTORY_WORKERS), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_SFP_INVENTORY_WORKERS) },
+#else
+{ ONLP_CONFIG_SFP_INVENTORY_WORKERS(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_INCLUDE_OID_SNAPSHOT
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_INCLUDE_OID_SNAPSHOT), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_INCLUDE_OID_SNAPSHOT) },
+#else
+{ ONLP_CONFIG_INCLUDE_OID_SNAPSHOT(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_OID_SNAPSHOT_TTL
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_OID_SNAPSHOT_TTL), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_OID_SNAPSHOT_TTL) },
+#else
+{ ONLP_CONFIG_OID_SNAPSHOT_TTL(__onlp_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLP_CONFIG_OID_SNAPSHOT_ERROR_TTL
+    { __onlp_config_STRINGIFY_NAME(ONLP_CONFIG_OID_SNAPSHOT_ERROR_TTL), __onlp_config_STRINGIFY_VALUE(ONLP_CONFIG_OID_SNAPSHOT_ERROR_TTL) },
+#else
+{ ONLP_CONFIG_OID_SNAPSHOT_ERROR_TTL(__onlp_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
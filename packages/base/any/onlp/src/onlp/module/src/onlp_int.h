@@ -44,4 +44,23 @@ void onlp_oid_show_description(iof_t* iof, onlp_oid_hdr_t* hdr);
 /** Standard message when an OID is missing. */
 void onlp_oid_show_state_missing(iof_t* iof);
 
+/*
+ * The root I2C adapter of an SFP port, or a negative error.
+ * Ports in the same group are serialized by the kernel. This does
+ * not take the API lock.
+ */
+int onlp_sfp_port_group_get(int port);
+
+/*
+ * Record the presence of a fan or PSU. The OID snapshot is
+ * invalidated when it changes, as the tree below it may change.
+ */
+void onlp_oid_snapshot_presence_update(onlp_oid_t oid, int present);
+
+/* Registers the builtin and platform management callbacks (once). */
+void onlp_sys_platform_manage_init(void);
+
+/* The "onlpdump bench" command. See onlp_bench.c */
+int onlp_bench_main(int argc, char* argv[]);
+
 #endif /* __ONLP_INT_H__ */
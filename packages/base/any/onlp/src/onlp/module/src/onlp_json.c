@@ -25,24 +25,38 @@
 #include "onlp_json.h"
 #include "onlp_log.h"
 #include <onlp/onlp.h>
+#include <stdlib.h>
+#include <string.h>
 
 static cJSON* root__ = NULL;
 static char* file__ = NULL;
 
+#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
+static void onlp_json_overrides_compile__(void);
+static void onlp_json_overrides_clear__(void);
+#endif
+
 void
 onlp_json_init(const char* fname)
 {
     int rv;
+    /* fname may be file__ on reload. */
+    char* name = (fname) ? aim_strdup(fname) : NULL;
+
     onlp_json_denit();
 
-    rv = cjson_util_parse_file(fname, &root__);
+    rv = (name) ? cjson_util_parse_file(name, &root__) : -1;
     if(rv < 0 || root__ == NULL) {
         root__ = cJSON_Parse("{}");
+        aim_free(name);
     }
     else {
-        file__ = aim_strdup(fname);
+        file__ = name;
     }
 
+#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
+    onlp_json_overrides_compile__();
+#endif
 }
 
 cJSON*
@@ -65,4 +79,147 @@ onlp_json_denit(void)
         aim_free(file__);
         file__ = NULL;
     }
+#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
+    onlp_json_overrides_clear__();
+#endif
+}
+
+#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
+
+/** Ids above this are ignored to keep the tables dense. */
+#define OVERRIDE_ID_MAX 1024
+
+typedef struct override_entry_s {
+    /** Bit N is set when fields[N] is overridden. */
+    uint32_t mask;
+    int values[ONLP_JSON_OVERRIDE_FIELDS_MAX];
+} override_entry_t;
+
+typedef struct override_type_s {
+    const char* name;
+    const onlp_json_override_field_t* fields;
+    int field_count;
+
+    /** Indexed by OID id. NULL when the type has no overrides. */
+    override_entry_t* entries;
+    int entry_count;
+} override_type_t;
+
+static override_type_t override_types__[ONLP_OID_TYPE_RTC+1];
+
+static void
+onlp_json_override_compile__(override_type_t* ot)
+{
+    int f;
+    cJSON* types = NULL;
+    cJSON* item;
+
+    aim_free(ot->entries);
+    ot->entries = NULL;
+    ot->entry_count = 0;
+
+    if(root__ == NULL ||
+       cjson_util_lookup(root__, &types, "overrides.%s", ot->name) < 0 ||
+       types == NULL) {
+        return;
+    }
+
+    for(item = types->child; item; item = item->next) {
+        int id, value;
+        char* end = NULL;
+        override_entry_t* e;
+
+        if(item->string == NULL) {
+            continue;
+        }
+        id = strtol(item->string, &end, 0);
+        if(end == item->string || *end || id < 0 || id > OVERRIDE_ID_MAX) {
+            AIM_LOG_ERROR("Ignoring override for %s '%s'.", ot->name, item->string);
+            continue;
+        }
+
+        if(id >= ot->entry_count) {
+            ot->entries = aim_realloc(ot->entries, (id+1) * sizeof(*ot->entries));
+            memset(ot->entries + ot->entry_count, 0,
+                   (id + 1 - ot->entry_count) * sizeof(*ot->entries));
+            ot->entry_count = id + 1;
+        }
+
+        e = ot->entries + id;
+        for(f = 0; f < ot->field_count; f++) {
+            if(cjson_util_lookup_int(item, &value, "%s", ot->fields[f].name) == 0) {
+                e->mask |= (1 << f);
+                e->values[f] = value;
+            }
+        }
+    }
+}
+
+static void
+onlp_json_overrides_compile__(void)
+{
+    int t;
+    for(t = 0; t < AIM_ARRAYSIZE(override_types__); t++) {
+        if(override_types__[t].name) {
+            onlp_json_override_compile__(override_types__ + t);
+        }
+    }
+}
+
+static void
+onlp_json_overrides_clear__(void)
+{
+    int t;
+    for(t = 0; t < AIM_ARRAYSIZE(override_types__); t++) {
+        aim_free(override_types__[t].entries);
+        override_types__[t].entries = NULL;
+        override_types__[t].entry_count = 0;
+    }
+}
+
+void
+onlp_json_override_register(onlp_oid_type_t type, const char* name,
+                            const onlp_json_override_field_t* fields,
+                            int count)
+{
+    override_type_t* ot;
+
+    if(type < 0 || type >= AIM_ARRAYSIZE(override_types__) ||
+       count > ONLP_JSON_OVERRIDE_FIELDS_MAX) {
+        AIM_LOG_ERROR("Invalid override registration for %s.", name);
+        return;
+    }
+
+    ot = override_types__ + type;
+    ot->name = name;
+    ot->fields = fields;
+    ot->field_count = count;
+    onlp_json_override_compile__(ot);
 }
+
+void
+onlp_json_override_apply(onlp_oid_t oid, void* info)
+{
+    int f;
+    int type = ONLP_OID_TYPE_GET(oid);
+    int id = ONLP_OID_ID_GET(oid);
+    override_type_t* ot;
+    override_entry_t* e;
+
+    if(type >= AIM_ARRAYSIZE(override_types__)) {
+        return;
+    }
+    ot = override_types__ + type;
+    if(id >= ot->entry_count || ot->entries[id].mask == 0) {
+        return;
+    }
+
+    e = ot->entries + id;
+    for(f = 0; f < ot->field_count; f++) {
+        if(e->mask & (1 << f)) {
+            *(int*)((uint8_t*)info + ot->fields[f].offset) = e->values[f];
+        }
+    }
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES */
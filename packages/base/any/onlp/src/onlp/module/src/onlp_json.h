@@ -44,5 +44,46 @@ cJSON* onlp_json_get(int reload);
 
 void onlp_json_denit(void);
 
+#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
+
+#include <onlp/oids.h>
+
+/**
+ * Platform overrides.
+ *
+ * Entries under "overrides.<name>.<id>" in the configuration file
+ * are compiled into a dense per-type table when the type is
+ * registered and whenever the configuration is reloaded.
+ */
+
+/** The maximum number of override fields per OID type. */
+#define ONLP_JSON_OVERRIDE_FIELDS_MAX 8
+
+/** Override field descriptor. The target must be a 32 bit integer. */
+typedef struct onlp_json_override_field_s {
+    const char* name;
+    int offset;
+} onlp_json_override_field_t;
+
+/**
+ * @brief Register and compile the overrides for an OID type.
+ * @param type The OID type.
+ * @param name The type key in the overrides section.
+ * @param fields The override fields.
+ * @param count The number of fields.
+ */
+void onlp_json_override_register(onlp_oid_type_t type, const char* name,
+                                 const onlp_json_override_field_t* fields,
+                                 int count);
+
+/**
+ * @brief Apply the compiled overrides for an OID.
+ * @param oid The OID.
+ * @param info The info structure described by the registered fields.
+ */
+void onlp_json_override_apply(onlp_oid_t oid, void* info);
+
+#endif /* ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES */
+
 
 #endif /* __ONLP_JSON_H__ */
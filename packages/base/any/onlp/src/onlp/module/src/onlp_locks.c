@@ -26,9 +26,151 @@
 #include <onlp/onlp.h>
 #include "onlp_locks.h"
 
+static const char* domain_names__[] = {
+    "global",
+    "sys",
+    "thermal",
+    "fan",
+    "psu",
+    "led",
+    "sfp",
+};
+
+const char*
+onlp_api_lock_domain_name(int domain)
+{
+    if(domain >= 0 && domain < AIM_ARRAYSIZE(domain_names__)) {
+        return domain_names__[domain];
+    }
+    return "unknown";
+}
+
 #if ONLP_CONFIG_INCLUDE_API_LOCK == 1
 
-#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 0
+#if ONLP_CONFIG_API_LOCK_DOMAINS == 1
+
+#include <onlplib/shlocks.h>
+#include <onlp/platformi/sysi.h>
+#include "onlp_int.h"
+
+/**
+ * The API lock is a set of reader/writer locks.
+ * Indexes [0, ONLP_API_LOCK_DOMAIN_COUNT) are the OID type domains.
+ * The remaining indexes are the SFP port group locks. The first of
+ * those is shared by all ports whose group is unknown.
+ */
+static onlp_shrwlock_t* domain_locks__ = NULL;
+
+/**
+ * Set once at init. Platforms whose drivers are not known to be
+ * reentrant run every call under the global domain.
+ */
+static int domains_enabled__ = 0;
+
+#define DOMAIN_LOCK_COUNT (ONLP_API_LOCK_DOMAIN_COUNT + ONLP_API_LOCK_SFP_PORT_COUNT)
+#define PORT_LOCK_UNKNOWN ONLP_API_LOCK_DOMAIN_COUNT
+
+void
+onlp_api_lock_init(void)
+{
+    const char* fname = NULL;
+
+#if ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 1
+    fname = ONLP_CONFIG_API_LOCK_DOMAIN_FILENAME;
+#endif
+
+    if(domain_locks__ == NULL &&
+       onlp_shrwlock_create(fname, DOMAIN_LOCK_COUNT, &domain_locks__) < 0) {
+        AIM_DIE("The ONLP API lock domains could not be created.");
+    }
+
+    domains_enabled__ = (onlp_sysi_api_lock_domains() == 1);
+    if(!domains_enabled__) {
+        AIM_LOG_VERBOSE("API lock domains are not enabled by the platform.");
+    }
+}
+
+void
+onlp_api_lock_denit(void)
+{
+    onlp_shrwlock_destroy(domain_locks__);
+    domain_locks__ = NULL;
+}
+
+/*
+ * Ports are locked by their I2C adapter group. Ports behind the same
+ * adapter cannot be accessed in parallel anyway, and holding them
+ * under one lock keeps mux channel selects consistent. The groups are
+ * resolved by onlp_sfp_init() while it holds the SFP domain
+ * exclusively, so they are stable while the domain is held shared.
+ * Ports whose group is unknown share one lock.
+ */
+static int
+port_lock_get__(int port)
+{
+    int group = onlp_sfp_port_group_get(port);
+
+    if(group < 0) {
+        return PORT_LOCK_UNKNOWN;
+    }
+    return PORT_LOCK_UNKNOWN + 1 + (group % (ONLP_API_LOCK_SFP_PORT_COUNT - 1));
+}
+
+int
+onlp_api_lock_domain(const char* api, int domain, int port, int mode)
+{
+    int pindex = -1;
+
+    if(!domains_enabled__) {
+        onlp_shrwlock_take(domain_locks__, ONLP_API_LOCK_DOMAIN_GLOBAL,
+                           ONLP_API_LOCK_EXCLUSIVE);
+        return -1;
+    }
+
+    if(port >= ONLP_API_LOCK_SFP_PORT_COUNT) {
+        /* Out of range ports serialize against the entire domain. */
+        port = -1;
+        mode = ONLP_API_LOCK_EXCLUSIVE;
+    }
+
+    /* Domains are always taken before ports. */
+    onlp_shrwlock_take(domain_locks__, domain,
+                       (port < 0) ? mode : ONLP_API_LOCK_SHARED);
+    if(port >= 0) {
+        pindex = port_lock_get__(port);
+        onlp_shrwlock_take(domain_locks__, pindex, 1);
+    }
+    return pindex;
+}
+
+void
+onlp_api_unlock_domain(int domain, int pindex)
+{
+    if(!domains_enabled__) {
+        onlp_shrwlock_give(domain_locks__, ONLP_API_LOCK_DOMAIN_GLOBAL);
+        return;
+    }
+
+    if(pindex >= 0) {
+        onlp_shrwlock_give(domain_locks__, pindex);
+    }
+    onlp_shrwlock_give(domain_locks__, domain);
+}
+
+void
+onlp_api_lock(const char* api)
+{
+    onlp_api_lock_domain(api, ONLP_API_LOCK_DOMAIN_GLOBAL, -1,
+                         ONLP_API_LOCK_EXCLUSIVE);
+}
+
+void
+onlp_api_unlock(void)
+{
+    onlp_api_unlock_domain(ONLP_API_LOCK_DOMAIN_GLOBAL, -1);
+}
+
+#elif ONLP_CONFIG_API_LOCK_GLOBAL_SHARED == 0
 
 #include <OS/os_sem.h>
 
@@ -131,3 +273,86 @@ onlp_api_lock_test(void)
 }
 
 #endif /* ONLP_CONFIG_INCLUDE_API_LOCK */
+
+
+#if ONLP_CONFIG_INCLUDE_API_PROFILING == 1
+
+#include <pthread.h>
+
+/**
+ * Accumulated API timing for each lock domain.
+ */
+typedef struct api_profile_s {
+    uint64_t calls;
+    uint64_t ltime;
+    uint64_t ltime_max;
+    uint64_t ftime;
+    uint64_t ftime_max;
+} api_profile_t;
+
+static api_profile_t profiles__[ONLP_API_LOCK_DOMAIN_COUNT];
+static pthread_mutex_t profile_lock__ = PTHREAD_MUTEX_INITIALIZER;
+
+void
+onlp_api_profile_record(int domain, uint64_t ltime, uint64_t ftime)
+{
+    api_profile_t* p;
+
+    if(domain < 0 || domain >= ONLP_API_LOCK_DOMAIN_COUNT) {
+        return;
+    }
+    p = profiles__ + domain;
+
+    pthread_mutex_lock(&profile_lock__);
+    p->calls++;
+    p->ltime += ltime;
+    p->ftime += ftime;
+    if(ltime > p->ltime_max) {
+        p->ltime_max = ltime;
+    }
+    if(ftime > p->ftime_max) {
+        p->ftime_max = ftime;
+    }
+    pthread_mutex_unlock(&profile_lock__);
+}
+
+void
+onlp_api_profile_show(aim_pvs_t* pvs)
+{
+    int i;
+    api_profile_t snapshot[ONLP_API_LOCK_DOMAIN_COUNT];
+
+    pthread_mutex_lock(&profile_lock__);
+    memcpy(snapshot, profiles__, sizeof(snapshot));
+    pthread_mutex_unlock(&profile_lock__);
+
+    aim_printf(pvs, "Domain     Calls       ltime(us)     ltime max   ftime(us)     ftime max\n");
+    for(i = 0; i < ONLP_API_LOCK_DOMAIN_COUNT; i++) {
+        api_profile_t* p = snapshot + i;
+        if(p->calls == 0) {
+            continue;
+        }
+        aim_printf(pvs, "%-8s  %8"PRIu64"  %12"PRIu64"  %12"PRIu64"  %12"PRIu64"  %12"PRIu64"\n",
+                   onlp_api_lock_domain_name(i), p->calls,
+                   p->ltime, p->ltime_max, p->ftime, p->ftime_max);
+    }
+}
+
+static void
+onlp_api_profile_exit__(void)
+{
+    onlp_api_profile_show(&aim_pvs_stderr);
+}
+
+void
+onlp_api_profile_init(void)
+{
+    static int registered__ = 0;
+    if(!registered__) {
+        /* Report the per-domain totals when the process exits. */
+        atexit(onlp_api_profile_exit__);
+        registered__ = 1;
+    }
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_API_PROFILING */
@@ -26,6 +26,46 @@
 #define __ONLP_LOCKS_H__
 
 #include <onlp/onlp_config.h>
+#include <AIM/aim_pvs.h>
+
+/**
+ * API lock domains.
+ *
+ * When ONLP_CONFIG_API_LOCK_DOMAINS is enabled and the platform
+ * opts in through onlp_sysi_api_lock_domains(), each OID type is
+ * protected by its own reader/writer lock and every SFP port group
+ * (the ports behind one I2C adapter) has an additional exclusive
+ * lock. Otherwise all domains map to the single API lock.
+ *
+ * Each source file selects its domain by defining ONLP_API_LOCK_DOMAIN
+ * before including this header.
+ */
+typedef enum onlp_api_lock_domain_e {
+    ONLP_API_LOCK_DOMAIN_GLOBAL,
+    ONLP_API_LOCK_DOMAIN_SYS,
+    ONLP_API_LOCK_DOMAIN_THERMAL,
+    ONLP_API_LOCK_DOMAIN_FAN,
+    ONLP_API_LOCK_DOMAIN_PSU,
+    ONLP_API_LOCK_DOMAIN_LED,
+    ONLP_API_LOCK_DOMAIN_SFP,
+    ONLP_API_LOCK_DOMAIN_COUNT,
+} onlp_api_lock_domain_t;
+
+/** The number of SFP ports (and port group locks). */
+#define ONLP_API_LOCK_SFP_PORT_COUNT 256
+
+/** Lock modes */
+#define ONLP_API_LOCK_SHARED    0
+#define ONLP_API_LOCK_EXCLUSIVE 1
+
+#ifndef ONLP_API_LOCK_DOMAIN
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_GLOBAL
+#endif
+
+/**
+ * @brief Get the name of a lock domain.
+ */
+const char* onlp_api_lock_domain_name(int domain);
 
 #if ONLP_CONFIG_INCLUDE_API_LOCK == 1
 
@@ -50,11 +90,45 @@ void onlp_api_unlock(void);
 #define ONLP_API_LOCK(_api)      onlp_api_lock(_api)
 #define ONLP_API_UNLOCK()    onlp_api_unlock()
 
+#if ONLP_CONFIG_API_LOCK_DOMAINS == 1
+
+/**
+ * @brief Take an API lock domain.
+ * @param api The calling API.
+ * @param domain The lock domain.
+ * @param port Lock this SFP port's group exclusively, or -1 for the whole domain.
+ * @param mode ONLP_API_LOCK_SHARED or ONLP_API_LOCK_EXCLUSIVE.
+ * @returns The port group lock which was taken, or -1.
+ * Pass it to onlp_api_unlock_domain().
+ */
+int onlp_api_lock_domain(const char* api, int domain, int port, int mode);
+
+/**
+ * @brief Give an API lock domain.
+ * @param domain The lock domain.
+ * @param pindex The onlp_api_lock_domain() result.
+ */
+void onlp_api_unlock_domain(int domain, int pindex);
+
+#define ONLP_API_DOMAIN_LOCK(_api, _port, _mode)                        \
+    onlp_api_lock_domain(_api, ONLP_API_LOCK_DOMAIN, _port, _mode)
+#define ONLP_API_DOMAIN_UNLOCK(_pindex)                 \
+    onlp_api_unlock_domain(ONLP_API_LOCK_DOMAIN, _pindex)
+
+#else
+
+#define ONLP_API_DOMAIN_LOCK(_api, _port, _mode) (ONLP_API_LOCK(_api), -1)
+#define ONLP_API_DOMAIN_UNLOCK(_pindex) ONLP_API_UNLOCK()
+
+#endif /* ONLP_CONFIG_API_LOCK_DOMAINS */
+
 #else
 
 #define ONLP_API_LOCK_INIT()
 #define ONLP_API_LOCK(_api)
 #define ONLP_API_UNLOCK()
+#define ONLP_API_DOMAIN_LOCK(_api, _port, _mode) (-1)
+#define ONLP_API_DOMAIN_UNLOCK(_pindex)
 
 #endif /** ONLP_CONFIG_INCLUDE_API_LOCK */
 
@@ -64,6 +138,12 @@ void onlp_api_unlock(void);
  * These macros are used the instantiate the public (and potentially locked)
  * ONLP API entry points.
  *
+ * ONLP_LOCKED_API*         Exclusive access to the file's lock domain.
+ * ONLP_LOCKED_SHARED_API*  Shared (read) access to the file's lock domain.
+ * ONLP_LOCKED_PORT_API*    Shared access to the domain and exclusive
+ *                          access to the group of the port given as the
+ *                          first argument.
+ *
  ***************************************************************************/
 #include <inttypes.h>
 #include <AIM/aim_time.h>
@@ -73,6 +153,21 @@ void onlp_api_unlock(void);
 
 #if ONLP_CONFIG_INCLUDE_API_PROFILING == 1
 
+/**
+ * @brief Initialize API profiling.
+ */
+void onlp_api_profile_init(void);
+
+/**
+ * @brief Record the lock wait and function time of an API call.
+ */
+void onlp_api_profile_record(int domain, uint64_t ltime, uint64_t ftime);
+
+/**
+ * @brief Show the accumulated lock and function times for each domain.
+ */
+void onlp_api_profile_show(aim_pvs_t* pvs);
+
 #define ONLP_API_T0(_name)                              \
     uint64_t t0, t1, t2; t0 = aim_time_monotonic()
 
@@ -82,7 +177,9 @@ void onlp_api_unlock(void);
 #define ONLP_API_T2(_name)                                              \
     do {                                                                \
         t2 = aim_time_monotonic();                                      \
-        AIM_LOG_MSG("API '%s' : (total=%"PRId64", ltime=%"PRId64" ftime=%"PRId64")", #_name, t2-t0, t1-t0, t2-t1); \
+        AIM_LOG_MSG("API '%s' [%s] : (total=%"PRId64", ltime=%"PRId64" ftime=%"PRId64")", #_name, \
+                    onlp_api_lock_domain_name(ONLP_API_LOCK_DOMAIN), t2-t0, t1-t0, t2-t1); \
+        onlp_api_profile_record(ONLP_API_LOCK_DOMAIN, t1-t0, t2-t1);   \
     } while(0)
 
 #else
@@ -93,143 +190,147 @@ void onlp_api_unlock(void);
 
 #endif
 
-#define ONLP_LOCKED_API0(_name)                            \
-    int _name (void)                                       \
-    {                                                      \
-        ONLP_API_T0(_name);                                \
-        ONLP_API_LOCK(#_name);                             \
-        ONLP_API_T1(_name);                                \
-        int _rv = ONLP_LOCKED_API_NAME(_name)();           \
-        ONLP_API_UNLOCK();                                 \
-        ONLP_API_T2(_name);                                \
-        return _rv;                                        \
-    }
-
-#define ONLP_LOCKED_API1(_name, _t, _v)                         \
-    int _name (_t _v)                                           \
-    {                                                           \
+/*
+ * Common body for all locked entry points.
+ */
+#define ONLP_LOCKED_API_BODY__(_name, _port, _mode, _call)      \
         ONLP_API_T0(_name);                                     \
-        ONLP_API_LOCK(#_name);                                  \
+        int _pindex = ONLP_API_DOMAIN_LOCK(#_name, _port, _mode); \
         ONLP_API_T1(_name);                                     \
-        int _rv = ONLP_LOCKED_API_NAME(_name)(_v);              \
-        ONLP_API_UNLOCK();                                      \
-        ONLP_API_T2(_name);                                     \
-        return _rv;                                             \
+        _call;                                                  \
+        ONLP_API_DOMAIN_UNLOCK(_pindex);                        \
+        (void)_pindex;                                          \
+        ONLP_API_T2(_name);
+
+#define ONLP_LOCKED_API0__(_name, _mode)                                \
+    int _name (void)                                                    \
+    {                                                                   \
+        int _rv;                                                        \
+        ONLP_LOCKED_API_BODY__(_name, -1, _mode,                        \
+                               _rv = ONLP_LOCKED_API_NAME(_name)());    \
+        return _rv;                                                     \
     }
 
-#define ONLP_LOCKED_API2(_name, _t1, _v1, _t2, _v2)                     \
+#define ONLP_LOCKED_API1__(_name, _port, _mode, _t, _v)                 \
+    int _name (_t _v)                                                   \
+    {                                                                   \
+        int _rv;                                                        \
+        ONLP_LOCKED_API_BODY__(_name, _port, _mode,                     \
+                               _rv = ONLP_LOCKED_API_NAME(_name)(_v));  \
+        return _rv;                                                     \
+    }
+
+#define ONLP_LOCKED_API2__(_name, _port, _mode, _t1, _v1, _t2, _v2)     \
     int _name (_t1 _v1, _t2 _v2)                                        \
     {                                                                   \
-        ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
-        ONLP_API_T1(_name);                                             \
-        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2);               \
-        ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
+        int _rv;                                                        \
+        ONLP_LOCKED_API_BODY__(_name, _port, _mode,                     \
+                               _rv = ONLP_LOCKED_API_NAME(_name)(_v1, _v2)); \
         return _rv;                                                     \
     }
 
-#define ONLP_LOCKED_API3(_name, _t1, _v1, _t2, _v2, _t3, _v3)           \
+#define ONLP_LOCKED_API3__(_name, _port, _mode, _t1, _v1, _t2, _v2, _t3, _v3) \
     int _name (_t1 _v1, _t2 _v2, _t3 _v3)                               \
     {                                                                   \
-        ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
-        ONLP_API_T1(_name);                                             \
-        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3);          \
-        ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
+        int _rv;                                                        \
+        ONLP_LOCKED_API_BODY__(_name, _port, _mode,                     \
+                               _rv = ONLP_LOCKED_API_NAME(_name)(_v1, _v2, _v3)); \
         return _rv;                                                     \
     }
 
-#define ONLP_LOCKED_API4(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
+#define ONLP_LOCKED_API4__(_name, _port, _mode, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
     int _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4)                      \
     {                                                                   \
-        ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
-        ONLP_API_T1(_name);                                             \
-        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4);     \
-        ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
+        int _rv;                                                        \
+        ONLP_LOCKED_API_BODY__(_name, _port, _mode,                     \
+                               _rv = ONLP_LOCKED_API_NAME(_name)(_v1, _v2, _v3, _v4)); \
         return _rv;                                                     \
     }
 
-#define ONLP_LOCKED_API5(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
+#define ONLP_LOCKED_API5__(_name, _port, _mode, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
     int _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4, _t5 _v5)             \
     {                                                                   \
-        ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
-        ONLP_API_T1(_name);                                             \
-        int _rv = ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5); \
-        ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
+        int _rv;                                                        \
+        ONLP_LOCKED_API_BODY__(_name, _port, _mode,                     \
+                               _rv = ONLP_LOCKED_API_NAME(_name)(_v1, _v2, _v3, _v4, _v5)); \
         return _rv;                                                     \
     }
 
-#define ONLP_LOCKED_VAPI0(_name)                                 \
-    void _name (void)                                            \
-    {                                                            \
-        ONLP_API_T0(_name);                                      \
-        ONLP_API_LOCK(#_name);                                   \
-        ONLP_API_T1(_name);                                      \
-        ONLP_LOCKED_API_NAME(_name)();                           \
-        ONLP_API_UNLOCK();                                       \
-        ONLP_API_T2(_name);                                      \
+#define ONLP_LOCKED_API7__(_name, _port, _mode, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5, _t6, _v6, _t7, _v7) \
+    int _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4, _t5 _v5, _t6 _v6, _t7 _v7) \
+    {                                                                   \
+        int _rv;                                                        \
+        ONLP_LOCKED_API_BODY__(_name, _port, _mode,                     \
+                               _rv = ONLP_LOCKED_API_NAME(_name)(_v1, _v2, _v3, _v4, _v5, _v6, _v7)); \
+        return _rv;                                                     \
     }
 
-#define ONLP_LOCKED_VAPI1(_name, _t, _v)                  \
-    void _name (_t _v)                                    \
-    {                                                     \
-        ONLP_API_T0(_name);                               \
-        ONLP_API_LOCK(#_name);                            \
-        ONLP_API_T1(_name);                               \
-        ONLP_LOCKED_API_NAME(_name)(_v);                  \
-        ONLP_API_UNLOCK();                                \
-        ONLP_API_T2(_name);                               \
+#define ONLP_LOCKED_API0(_name)                                         \
+    ONLP_LOCKED_API0__(_name, ONLP_API_LOCK_EXCLUSIVE)
+#define ONLP_LOCKED_API1(_name, _t, _v)                                 \
+    ONLP_LOCKED_API1__(_name, -1, ONLP_API_LOCK_EXCLUSIVE, _t, _v)
+#define ONLP_LOCKED_API2(_name, _t1, _v1, _t2, _v2)                     \
+    ONLP_LOCKED_API2__(_name, -1, ONLP_API_LOCK_EXCLUSIVE, _t1, _v1, _t2, _v2)
+#define ONLP_LOCKED_API3(_name, _t1, _v1, _t2, _v2, _t3, _v3)           \
+    ONLP_LOCKED_API3__(_name, -1, ONLP_API_LOCK_EXCLUSIVE, _t1, _v1, _t2, _v2, _t3, _v3)
+#define ONLP_LOCKED_API4(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
+    ONLP_LOCKED_API4__(_name, -1, ONLP_API_LOCK_EXCLUSIVE, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4)
+#define ONLP_LOCKED_API5(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
+    ONLP_LOCKED_API5__(_name, -1, ONLP_API_LOCK_EXCLUSIVE, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5)
+
+#define ONLP_LOCKED_SHARED_API0(_name)                                  \
+    ONLP_LOCKED_API0__(_name, ONLP_API_LOCK_SHARED)
+#define ONLP_LOCKED_SHARED_API1(_name, _t, _v)                          \
+    ONLP_LOCKED_API1__(_name, -1, ONLP_API_LOCK_SHARED, _t, _v)
+#define ONLP_LOCKED_SHARED_API2(_name, _t1, _v1, _t2, _v2)              \
+    ONLP_LOCKED_API2__(_name, -1, ONLP_API_LOCK_SHARED, _t1, _v1, _t2, _v2)
+#define ONLP_LOCKED_SHARED_API3(_name, _t1, _v1, _t2, _v2, _t3, _v3)    \
+    ONLP_LOCKED_API3__(_name, -1, ONLP_API_LOCK_SHARED, _t1, _v1, _t2, _v2, _t3, _v3)
+
+#define ONLP_LOCKED_PORT_API1(_name, _t, _v)                            \
+    ONLP_LOCKED_API1__(_name, _v, ONLP_API_LOCK_EXCLUSIVE, _t, _v)
+#define ONLP_LOCKED_PORT_API2(_name, _t1, _v1, _t2, _v2)                \
+    ONLP_LOCKED_API2__(_name, _v1, ONLP_API_LOCK_EXCLUSIVE, _t1, _v1, _t2, _v2)
+#define ONLP_LOCKED_PORT_API3(_name, _t1, _v1, _t2, _v2, _t3, _v3)      \
+    ONLP_LOCKED_API3__(_name, _v1, ONLP_API_LOCK_EXCLUSIVE, _t1, _v1, _t2, _v2, _t3, _v3)
+#define ONLP_LOCKED_PORT_API4(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
+    ONLP_LOCKED_API4__(_name, _v1, ONLP_API_LOCK_EXCLUSIVE, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4)
+#define ONLP_LOCKED_PORT_API5(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
+    ONLP_LOCKED_API5__(_name, _v1, ONLP_API_LOCK_EXCLUSIVE, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5)
+#define ONLP_LOCKED_PORT_API7(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5, _t6, _v6, _t7, _v7) \
+    ONLP_LOCKED_API7__(_name, _v1, ONLP_API_LOCK_EXCLUSIVE, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5, _t6, _v6, _t7, _v7)
+
+/*
+ * Void entry points are always exclusive.
+ */
+#define ONLP_LOCKED_VAPI_BODY__(_name, _call)                           \
+    {                                                                   \
+        ONLP_LOCKED_API_BODY__(_name, -1, ONLP_API_LOCK_EXCLUSIVE, _call); \
     }
 
-#define ONLP_LOCKED_VAPI2(_name, _t1, _v1, _t2, _v2)              \
-    void _name (_t1 _v1, _t2 _v2)                                 \
-    {                                                             \
-        ONLP_API_T0(_name);                                       \
-        ONLP_API_LOCK(#_name);                                    \
-        ONLP_API_T1(_name);                                       \
-        ONLP_LOCKED_API_NAME(_name) (_v1, _v2);                   \
-        ONLP_API_UNLOCK();                                        \
-        ONLP_API_T2(_name);                                       \
-    }
+#define ONLP_LOCKED_VAPI0(_name)                                        \
+    void _name (void)                                                   \
+    ONLP_LOCKED_VAPI_BODY__(_name, ONLP_LOCKED_API_NAME(_name)())
+
+#define ONLP_LOCKED_VAPI1(_name, _t, _v)                                \
+    void _name (_t _v)                                                  \
+    ONLP_LOCKED_VAPI_BODY__(_name, ONLP_LOCKED_API_NAME(_name)(_v))
+
+#define ONLP_LOCKED_VAPI2(_name, _t1, _v1, _t2, _v2)                    \
+    void _name (_t1 _v1, _t2 _v2)                                       \
+    ONLP_LOCKED_VAPI_BODY__(_name, ONLP_LOCKED_API_NAME(_name)(_v1, _v2))
 
 #define ONLP_LOCKED_VAPI3(_name, _t1, _v1, _t2, _v2, _t3, _v3)          \
     void _name (_t1 _v1, _t2 _v2, _t3 _v3)                              \
-    {                                                                   \
-        ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
-        ONLP_API_T1(_name);                                             \
-        ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3);                    \
-        ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(name);                                              \
-    }
+    ONLP_LOCKED_VAPI_BODY__(_name, ONLP_LOCKED_API_NAME(_name)(_v1, _v2, _v3))
 
 #define ONLP_LOCKED_VAPI4(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4) \
     void _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4)                     \
-    {                                                                   \
-        ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
-        ONLP_API_T1(_name);                                             \
-        ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4);               \
-        ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
-    }
+    ONLP_LOCKED_VAPI_BODY__(_name, ONLP_LOCKED_API_NAME(_name)(_v1, _v2, _v3, _v4))
 
 #define ONLP_LOCKED_VAPI5(_name, _t1, _v1, _t2, _v2, _t3, _v3, _t4, _v4, _t5, _v5) \
     void _name (_t1 _v1, _t2 _v2, _t3 _v3, _t4 _v4, _t5 _v5)            \
-    {                                                                   \
-        ONLP_API_T0(_name);                                             \
-        ONLP_API_LOCK(#_name);                                          \
-        ONLP_API_T1(_name);                                             \
-        ONLP_LOCKED_API_NAME(_name) (_v1, _v2, _v3, _v4, _v5);          \
-        ONLP_API_UNLOCK();                                              \
-        ONLP_API_T2(_name);                                             \
-    }
+    ONLP_LOCKED_VAPI_BODY__(_name, ONLP_LOCKED_API_NAME(_name)(_v1, _v2, _v3, _v4, _v5))
 
 
 
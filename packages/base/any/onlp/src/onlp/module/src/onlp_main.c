@@ -26,12 +26,14 @@
 #include <onlp/oids.h>
 #include <unistd.h>
 #include <onlp/sys.h>
+#include <onlp/fan_control.h>
 #include <onlp/sfp.h>
 #include <sff/sff.h>
 #include <sff/sff_db.h>
 #include <AIM/aim_log_handler.h>
 #include <syslog.h>
 #include <onlp/platformi/sysi.h>
+#include "onlp_int.h"
 
 static void platform_manager_daemon__(const char* pidfile, char** argv);
 
@@ -42,13 +44,13 @@ static void platform_manager_daemon__(const char* pidfile, char** argv);
 static void
 show_inventory__(aim_pvs_t* pvs, int database)
 {
-    int port;
-    onlp_sfp_bitmap_t bitmap;
+    int i, count;
+    onlp_sfp_inventory_entry_t* entries;
 
-    onlp_sfp_bitmap_t_init(&bitmap);
-    onlp_sfp_bitmap_get(&bitmap);
+    entries = aim_zmalloc(sizeof(*entries) * 256);
+    count = onlp_sfp_inventory_get(entries, 256, 0);
 
-    if(AIM_BITMAP_COUNT(&bitmap) == 0) {
+    if(count <= 0) {
         aim_printf(pvs, "No SFPs on this platform.\n");
     }
     else {
@@ -57,35 +59,31 @@ show_inventory__(aim_pvs_t* pvs, int database)
             aim_printf(pvs, "----  --------------  ------  ------  -----  ----------------  ----------------  ----------------\n");
         }
 
-        AIM_BITMAP_ITER(&bitmap, port) {
-            int rv;
-            uint8_t* data;
+        for(i = 0; i < count; i++) {
+            onlp_sfp_inventory_entry_t* e = entries + i;
+            int port = e->port;
 
-            rv = onlp_sfp_is_present(port);
-
-            if(rv == 0) {
+            if(e->present == 0) {
                 if(!database) {
                     aim_printf(pvs, "%4d  NONE\n", port);
                 }
                 continue;
             }
 
-            if(rv < 0) {
-                aim_printf(pvs, "%4d  Error %{onlp_status}\n", port, rv);
+            if(e->present < 0) {
+                aim_printf(pvs, "%4d  Error %{onlp_status}\n", port, e->present);
                 continue;
             }
 
-            rv = onlp_sfp_eeprom_read(port, &data);
-
-            if(rv < 0) {
-                aim_printf(pvs, "%4d  Error %{onlp_status}\n", port, rv);
+            if(e->eeprom_status < 0) {
+                aim_printf(pvs, "%4d  Error %{onlp_status}\n", port, e->eeprom_status);
                 continue;
             }
 
             sff_eeprom_t sff;
             char status_str[32] = {0};
 
-            sff_eeprom_parse(&sff, data);
+            sff_eeprom_parse(&sff, e->eeprom);
 
             if(!sff.identified) {
                 /* Present but unidentified. */
@@ -98,9 +96,8 @@ show_inventory__(aim_pvs_t* pvs, int database)
                 continue;
             }
 
-            uint32_t status = 0;
+            uint32_t status = e->control_flags;
             char* cp = status_str;
-            onlp_sfp_control_flags_get(port, &status);
             if(status & ONLP_SFP_CONTROL_FLAG_RX_LOS) {
                 *cp++ = 'R';
             }
@@ -124,6 +121,8 @@ show_inventory__(aim_pvs_t* pvs, int database)
                        sff.info.serial);
         }
     }
+
+    aim_free(entries);
 }
 
 
@@ -199,6 +198,25 @@ onlpdump_main(int argc, char* argv[])
         }
     }
 
+    /**
+     * benchmark
+     */
+    if(argc > 1 && !strcmp(argv[1], "bench")) {
+        return onlp_bench_main(argc-1, argv+1);
+    }
+
+    /**
+     * fan control trace replay
+     */
+    if(argc > 1 && !strcmp(argv[1], "fan-replay")) {
+        if(argc != 3) {
+            fprintf(stderr, "usage: %s fan-replay <trace.csv>\n", argv[0]);
+            return 1;
+        }
+        onlp_init();
+        return (onlp_fan_control_replay(NULL, argv[2], &aim_pvs_stdout) < 0) ? 1 : 0;
+    }
+
     while( (c = getopt(argc, argv, "srehdojmyM:ipxlSt:O:bJ:")) != -1) {
         switch(c)
             {
@@ -245,6 +263,8 @@ onlpdump_main(int argc, char* argv[])
         printf("  -b   Decode SFP Inventory into SFF database entries.\n");
         printf("  -l   API Lock test.\n");
         printf("  -J   Decode ONIE JSON data.\n");
+        printf("  bench [OPTIONS]  Run the API benchmark. See 'bench -h'.\n");
+        printf("  fan-replay <trace>  Replay a thermal trace through the fan control policy.\n");
         return rv;
     }
 
@@ -364,6 +384,7 @@ onlpdump_main(int argc, char* argv[])
         sleep(600);
         printf("Stopping the platform manager.\n");
         onlp_sys_platform_manage_stop(1);
+        onlp_sys_platform_manage_stats_show(&aim_pvs_stdout);
     }
 
     if(p) {
@@ -25,6 +25,8 @@
 #include <onlp/sys.h>
 #include <onlp/psu.h>
 #include <onlp/fan.h>
+#include <onlp/thermal.h>
+#include <onlp/fan_control.h>
 #include <onlp/platformi/sysi.h>
 #include <onlplib/mmap.h>
 #include <timer_wheel/timer_wheel.h>
@@ -45,16 +47,29 @@ typedef struct management_entry_s {
     timer_wheel_entry_t twe;
 
     /** This is the callback for this timer */
-    int (*manage)(void);
+    onlp_sys_platform_manage_f manage;
 
-    /** This is the callback rate in microseconds */
-    uint64_t rate;
+    /** Callback cookie */
+    void* cookie;
 
     /** The name of this callback (for debugging) */
-    const char* name;
+    char* name;
+
+    /** The base, minimum and maximum callback rates in microseconds */
+    uint64_t rate;
+    uint64_t rate_min;
+    uint64_t rate_max;
+
+    /** Statistics. stats.rate is the current callback rate. */
+    onlp_sys_platform_manage_stats_t stats;
+
+    /** Set while the callback is executing (outside of the wheel). */
+    int running;
+
+    /** Set if unregistered while executing. */
+    int removed;
 
-    /** The number of times this has been called. */
-    int calls;
+    struct management_entry_s* next;
 
 } management_entry_t;
 
@@ -67,83 +82,431 @@ typedef struct management_ctrl_s {
     int eventfd;
     pthread_t thread;
 
+    /** Protects the wheel and the entry list. */
+    pthread_mutex_t lock;
+
+    /** All registered entries. */
+    management_entry_t* entries;
+
 } management_ctrl_t;
 
 /* This is the global control state */
-static management_ctrl_t control__ = { NULL };
+static management_ctrl_t control__ = { NULL, 0, 0, PTHREAD_MUTEX_INITIALIZER };
 
 
 /*
  * Internal notification handler for PSU
  * status changes (all platforms)
  */
-static int platform_psus_notify__(void);
+static int platform_psus_notify__(void* cookie);
 
 
 /*
  * Internal notification handler for FAN
  * status changes (all platforms)
  */
-static int platform_fans_notify__(void);
+static int platform_fans_notify__(void* cookie);
+
+
+/*
+ * Platform fan management.
+ * The rate adapts to the thermal headroom when a
+ * fan control policy is registered.
+ */
+static int platform_manage_fans__(void* cookie);
+
+
+/*
+ * Platform LED management.
+ */
+static int platform_manage_leds__(void* cookie);
 
 
+#define SECONDS(_s) ((uint64_t)(_s)*1000*1000)
 
 /*
- * First Version : Static callback rates.
- * TODO: Allow individual platform callbacks to reregister
- * themselves at whatever rate they want.
+ * Builtin callbacks. Platforms and other modules
+ * may register their own with onlp_sys_platform_manage_register().
  */
-static management_entry_t management_entries[] =
+static struct {
+    const char* name;
+    onlp_sys_platform_manage_f manage;
+    uint64_t rate;
+    uint64_t rate_min;
+    uint64_t rate_max;
+} builtin_entries__[] =
     {
         {
-            { },
-            onlp_sysi_platform_manage_fans,
-            /* Every 10 seconds */
-            10*1000*1000,
-            "Fans",
+            "Fans", platform_manage_fans__,
+            SECONDS(10), SECONDS(2), SECONDS(10)*ONLP_CONFIG_PLATFORM_MANAGE_BACKOFF_MAX,
         },
         {
-            { },
-            onlp_sysi_platform_manage_leds,
-            /* Every 2 seconds */
-            2*1000*1000,
-            "LEDs",
-
+            "LEDs", platform_manage_leds__,
+            SECONDS(2), SECONDS(2), SECONDS(2),
         },
+        /*
+         * Status notifiers run at a fixed rate so that insertions and
+         * failures are always reported within a second.
+         */
         {
-            { },
-            platform_psus_notify__,
-            /* Every second */
-            1*1000*1000,
-            "PSUs",
+            "PSUs", platform_psus_notify__,
+            SECONDS(1), SECONDS(1), SECONDS(1),
         },
         {
-            { },
-            platform_fans_notify__,
-            /* Every second */
-            1*1000*1000,
-            "Fans",
-        }
+            "FanStatus", platform_fans_notify__,
+            SECONDS(1), SECONDS(1), SECONDS(1),
+        },
     };
 
 
+static management_entry_t*
+entry_find__(const char* name)
+{
+    management_entry_t* e;
+    for(e = control__.entries; e; e = e->next) {
+        if(!strcmp(e->name, name)) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void
+entry_free__(management_entry_t* e)
+{
+    aim_free(e->name);
+    aim_free(e);
+}
+
+static void
+entry_unlink__(management_entry_t* e)
+{
+    management_entry_t** pe;
+    for(pe = &control__.entries; *pe; pe = &(*pe)->next) {
+        if(*pe == e) {
+            *pe = e->next;
+            return;
+        }
+    }
+}
+
+static void
+onlp_sys_platform_manage_init__(void)
+{
+    int i;
+
+    for(i = 0; i < AIM_ARRAYSIZE(builtin_entries__); i++) {
+        onlp_sys_platform_manage_register(builtin_entries__[i].name,
+                                          builtin_entries__[i].manage,
+                                          NULL,
+                                          builtin_entries__[i].rate,
+                                          builtin_entries__[i].rate_min,
+                                          builtin_entries__[i].rate_max);
+    }
+
+    /* The platform may register additional entries here. */
+    onlp_sysi_platform_manage_init();
+}
+
 void
 onlp_sys_platform_manage_init(void)
 {
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, onlp_sys_platform_manage_init__);
+}
+
+int
+onlp_sys_platform_manage_register(const char* name,
+                                  onlp_sys_platform_manage_f manage,
+                                  void* cookie,
+                                  uint64_t rate,
+                                  uint64_t rate_min,
+                                  uint64_t rate_max)
+{
+    management_entry_t* e;
+
+    if(name == NULL || manage == NULL || rate == 0 ||
+       rate_min == 0 || rate_min > rate || rate_max < rate) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&control__.lock);
+
     if(control__.tw == NULL) {
-        int i;
-        uint64_t now = os_time_monotonic();
+        control__.tw = timer_wheel_create(4, 512, os_time_monotonic());
+    }
+
+    if(entry_find__(name)) {
+        pthread_mutex_unlock(&control__.lock);
+        AIM_LOG_ERROR("Platform management callback '%s' is already registered.", name);
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    e = aim_zmalloc(sizeof(*e));
+    e->name = aim_strdup(name);
+    e->manage = manage;
+    e->cookie = cookie;
+    e->rate = rate;
+    e->rate_min = rate_min;
+    e->rate_max = rate_max;
+    e->stats.rate = rate;
+    e->next = control__.entries;
+    control__.entries = e;
+
+    timer_wheel_insert(control__.tw, &e->twe, os_time_monotonic() + e->rate);
+
+    pthread_mutex_unlock(&control__.lock);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sys_platform_manage_unregister(const char* name)
+{
+    management_entry_t* e;
+
+    pthread_mutex_lock(&control__.lock);
+
+    if( (e = entry_find__(name)) == NULL) {
+        pthread_mutex_unlock(&control__.lock);
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    entry_unlink__(e);
+    if(e->running) {
+        /* Released by the manager when the callback returns. */
+        e->removed = 1;
+    }
+    else {
+        timer_wheel_remove(control__.tw, &e->twe);
+        entry_free__(e);
+    }
+
+    pthread_mutex_unlock(&control__.lock);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sys_platform_manage_stats_get(const char* name,
+                                   onlp_sys_platform_manage_stats_t* stats)
+{
+    management_entry_t* e;
+    int rv = ONLP_STATUS_E_PARAM;
+
+    pthread_mutex_lock(&control__.lock);
+    if( (e = entry_find__(name)) ) {
+        *stats = e->stats;
+        rv = ONLP_STATUS_OK;
+    }
+    pthread_mutex_unlock(&control__.lock);
+    return rv;
+}
+
+void
+onlp_sys_platform_manage_stats_show(aim_pvs_t* pvs)
+{
+    management_entry_t* e;
+
+    aim_printf(pvs, "%-16s %10s %8s %8s %12s %12s %14s %12s\n",
+               "Name", "Calls", "Errors", "Overruns",
+               "Last(us)", "Max(us)", "Total(us)", "Rate(us)");
+
+    pthread_mutex_lock(&control__.lock);
+    for(e = control__.entries; e; e = e->next) {
+        aim_printf(pvs, "%-16s %10"PRIu64" %8"PRIu64" %8"PRIu64" %12"PRIu64" %12"PRIu64" %14"PRIu64" %12"PRIu64"\n",
+                   e->name, e->stats.calls, e->stats.errors, e->stats.overruns,
+                   e->stats.last, e->stats.max, e->stats.total, e->stats.rate);
+    }
+    pthread_mutex_unlock(&control__.lock);
+}
+
+/**
+ * Management sample cache entry.
+ */
+typedef struct sample_s {
+    onlp_oid_t oid;
+
+    /** When the sample was read. */
+    uint64_t time;
+
+    /** The result of the read. */
+    int rv;
+
+    union {
+        onlp_thermal_info_t thermal;
+        onlp_fan_info_t fan;
+        onlp_psu_info_t psu;
+    } info;
+
+    struct sample_s* next;
+
+} sample_t;
+
+static struct {
+    pthread_mutex_t lock;
+    sample_t* samples;
+} samples__ = { PTHREAD_MUTEX_INITIALIZER, NULL };
+
+typedef int (*sample_read_f)(onlp_oid_t oid, void* info);
+
+static int
+sample_thermal_read__(onlp_oid_t oid, void* info)
+{
+    return onlp_thermal_info_get(oid, info);
+}
+
+static int
+sample_fan_read__(onlp_oid_t oid, void* info)
+{
+    return onlp_fan_info_get(oid, info);
+}
+
+static int
+sample_psu_read__(onlp_oid_t oid, void* info)
+{
+    return onlp_psu_info_get(oid, info);
+}
+
+static sample_t*
+sample_find__(onlp_oid_t oid)
+{
+    sample_t* s;
+    for(s = samples__.samples; s; s = s->next) {
+        if(s->oid == oid) {
+            return s;
+        }
+    }
+    return NULL;
+}
 
-        onlp_sysi_platform_manage_init();
-        control__.tw = timer_wheel_create(4, 512, now);
+static int
+sample_get__(onlp_oid_t oid, void* info, int size, int refresh,
+             sample_read_f read)
+{
+    sample_t* s;
+    int rv;
+    uint64_t now = os_time_monotonic();
+
+    if(!refresh) {
+        pthread_mutex_lock(&samples__.lock);
+        s = sample_find__(oid);
+        if(s && now - s->time < ONLP_CONFIG_PLATFORM_MANAGE_SAMPLE_TTL*1000ULL) {
+            rv = s->rv;
+            memcpy(info, &s->info, size);
+            pthread_mutex_unlock(&samples__.lock);
+            return rv;
+        }
+        pthread_mutex_unlock(&samples__.lock);
+    }
+
+    /* Read outside of the lock. */
+    rv = read(oid, info);
+
+    pthread_mutex_lock(&samples__.lock);
+    if( (s = sample_find__(oid)) == NULL) {
+        s = aim_zmalloc(sizeof(*s));
+        s->oid = oid;
+        s->next = samples__.samples;
+        samples__.samples = s;
+    }
+    s->time = now;
+    s->rv = rv;
+    if(rv >= 0) {
+        memcpy(&s->info, info, size);
+    }
+    pthread_mutex_unlock(&samples__.lock);
+    return rv;
+}
+
+int
+onlp_sys_platform_manage_thermal_get(onlp_oid_t oid,
+                                     onlp_thermal_info_t* info,
+                                     int refresh)
+{
+    return sample_get__(oid, info, sizeof(*info), refresh,
+                        sample_thermal_read__);
+}
+
+int
+onlp_sys_platform_manage_fan_get(onlp_oid_t oid,
+                                 onlp_fan_info_t* info,
+                                 int refresh)
+{
+    return sample_get__(oid, info, sizeof(*info), refresh,
+                        sample_fan_read__);
+}
+
+int
+onlp_sys_platform_manage_psu_get(onlp_oid_t oid,
+                                 onlp_psu_info_t* info,
+                                 int refresh)
+{
+    return sample_get__(oid, info, sizeof(*info), refresh,
+                        sample_psu_read__);
+}
+
+/*
+ * Get a thermal sample without reading the thermal.
+ */
+static int
+sample_thermal_peek__(onlp_oid_t oid, onlp_thermal_info_t* info)
+{
+    sample_t* s;
+    int rv = ONLP_STATUS_E_MISSING;
+    uint64_t now = os_time_monotonic();
+
+    pthread_mutex_lock(&samples__.lock);
+    s = sample_find__(oid);
+    if(s && now - s->time < ONLP_CONFIG_PLATFORM_MANAGE_SAMPLE_TTL*1000ULL) {
+        rv = s->rv;
+        memcpy(info, &s->info, sizeof(*info));
+    }
+    pthread_mutex_unlock(&samples__.lock);
+    return rv;
+}
 
-        for(i = 0; i < AIM_ARRAYSIZE(management_entries); i++) {
-            management_entry_t* e = management_entries+i;
-            timer_wheel_insert(control__.tw,  &e->twe, now + e->rate);
+/*
+ * Run every adaptive entry at its minimum rate.
+ * Entries already scheduled later are pulled in.
+ */
+static void
+entries_tighten__(uint64_t now)
+{
+    management_entry_t* e;
+
+    for(e = control__.entries; e; e = e->next) {
+        if(e->rate_min == e->rate_max) {
+            continue;
+        }
+        e->stats.rate = e->rate_min;
+        if(!e->running && e->twe.deadline > now + e->rate_min) {
+            timer_wheel_remove(control__.tw, &e->twe);
+            timer_wheel_insert(control__.tw, &e->twe, now + e->rate_min);
         }
     }
 }
 
+/*
+ * Update the entry's rate based on the callback result.
+ */
+static void
+entry_adapt__(management_entry_t* e, int rv, uint64_t now)
+{
+    switch(rv)
+        {
+        case ONLP_SYS_PLATFORM_MANAGE_IDLE:
+            e->stats.rate *= 2;
+            if(e->stats.rate > e->rate_max) {
+                e->stats.rate = e->rate_max;
+            }
+            break;
+        case ONLP_SYS_PLATFORM_MANAGE_URGENT:
+            entries_tighten__(now);
+            break;
+        default:
+            e->stats.rate = e->rate;
+            break;
+        }
+}
 
 void
 onlp_sys_platform_manage_now(void)
@@ -152,14 +515,46 @@ onlp_sys_platform_manage_now(void)
 
     onlp_sys_platform_manage_init();
 
+    pthread_mutex_lock(&control__.lock);
+
     while( (e = (management_entry_t*) timer_wheel_next(control__.tw,
                                                        os_time_monotonic())) ) {
-        if(e->manage) {
-            e->manage();
+        int rv;
+        uint64_t start, duration;
+
+        e->running = 1;
+        pthread_mutex_unlock(&control__.lock);
+
+        start = os_time_monotonic();
+        rv = e->manage(e->cookie);
+        duration = os_time_monotonic() - start;
+
+        pthread_mutex_lock(&control__.lock);
+
+        if(e->removed) {
+            entry_free__(e);
+            continue;
+        }
+
+        e->stats.calls++;
+        e->stats.last = duration;
+        e->stats.total += duration;
+        if(duration > e->stats.max) {
+            e->stats.max = duration;
+        }
+        if(duration > e->stats.rate) {
+            e->stats.overruns++;
+        }
+        if(rv < 0) {
+            e->stats.errors++;
         }
-        e->calls++;
-        timer_wheel_insert(control__.tw, &e->twe, os_time_monotonic() + e->rate);
+
+        entry_adapt__(e, rv, start + duration);
+        e->running = 0;
+        timer_wheel_insert(control__.tw, &e->twe, os_time_monotonic() + e->stats.rate);
     }
+
+    pthread_mutex_unlock(&control__.lock);
 }
 
 static void*
@@ -186,6 +581,7 @@ onlp_sys_platform_manage_thread__(void* vctrl)
          * Ask the timer wheel if there is an expiration in the next 2 seconds.
          */
         now = os_time_monotonic();
+        pthread_mutex_lock(&control__.lock);
         twe = timer_wheel_peek(ctrl->tw, now + 20000000);
 
         if(twe == NULL) {
@@ -205,6 +601,7 @@ onlp_sys_platform_manage_thread__(void* vctrl)
                 tv.tv_usec = 0;
             }
         }
+        pthread_mutex_unlock(&control__.lock);
 
         int rv = select(ctrl->eventfd+1, &fds, NULL, NULL, &tv);
         if(rv == 1 && FD_ISSET(ctrl->eventfd, &fds)) {
@@ -286,9 +683,102 @@ onlp_sys_platform_manage_join(void)
 }
 
 
+/*
+ * Check the thermal headroom.
+ *
+ * Returns URGENT if any thermal is within the configured margin of its
+ * warning threshold, ACTIVE if any temperature has moved by more than
+ * the hysteresis since the last check, and IDLE otherwise.
+ *
+ * Only the thermals just sampled by the fan control pass are checked.
+ * Nothing is read here.
+ */
 static int
-platform_psus_notify__(void)
+platform_thermals_check__(void)
 {
+    static onlp_oid_t thermal_oid_table[ONLP_OID_TABLE_SIZE] = {0};
+    static int mcelsius_table[ONLP_OID_TABLE_SIZE];
+    int rv = ONLP_SYS_PLATFORM_MANAGE_IDLE;
+    int i = 0;
+
+    if(thermal_oid_table[0] == 0) {
+        onlp_sys_info_t si;
+        onlp_oid_t* oidp;
+
+        if(onlp_sys_info_get(&si) < 0) {
+            AIM_LOG_ERROR("onlp_sys_info_get() failed.");
+            return -1;
+        }
+        ONLP_OID_TABLE_ITER_TYPE(si.hdr.coids, oidp, THERMAL) {
+            thermal_oid_table[i++] = *oidp;
+        }
+        onlp_sys_info_free(&si);
+    }
+
+    for(i = 0; i < AIM_ARRAYSIZE(thermal_oid_table); i++) {
+        onlp_thermal_info_t ti;
+
+        if(thermal_oid_table[i] == 0) {
+            break;
+        }
+
+        if(sample_thermal_peek__(thermal_oid_table[i], &ti) < 0 ||
+           !(ti.status & ONLP_THERMAL_STATUS_PRESENT) ||
+           !(ti.caps & ONLP_THERMAL_CAPS_GET_TEMPERATURE)) {
+            continue;
+        }
+
+        if((ti.caps & ONLP_THERMAL_CAPS_GET_WARNING_THRESHOLD) &&
+           ti.thresholds.warning - ti.mcelsius < ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_MARGIN) {
+            rv = ONLP_SYS_PLATFORM_MANAGE_URGENT;
+        }
+        else if(rv == ONLP_SYS_PLATFORM_MANAGE_IDLE &&
+                abs(ti.mcelsius - mcelsius_table[i]) > ONLP_CONFIG_PLATFORM_MANAGE_THERMAL_HYSTERESIS) {
+            rv = ONLP_SYS_PLATFORM_MANAGE_ACTIVE;
+        }
+        mcelsius_table[i] = ti.mcelsius;
+    }
+    return rv;
+}
+
+static int
+platform_manage_fans__(void* cookie)
+{
+    int rv = onlp_fan_control_manage();
+    if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+        /* No common policy registered. */
+        rv = onlp_sysi_platform_manage_fans();
+        if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+            /* No fan management on this platform. */
+            return ONLP_SYS_PLATFORM_MANAGE_IDLE;
+        }
+        /*
+         * The platform reads its thermals privately. Reading them
+         * again for the headroom check would double the I/O, so
+         * stay at the base rate.
+         */
+        return (rv < 0) ? rv : ONLP_SYS_PLATFORM_MANAGE_ACTIVE;
+    }
+    if(rv < 0) {
+        return rv;
+    }
+    return platform_thermals_check__();
+}
+
+static int
+platform_manage_leds__(void* cookie)
+{
+    int rv = onlp_sysi_platform_manage_leds();
+    if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+        return ONLP_SYS_PLATFORM_MANAGE_IDLE;
+    }
+    return rv;
+}
+
+static int
+platform_psus_notify__(void* cookie)
+{
+    int rv = ONLP_SYS_PLATFORM_MANAGE_IDLE;
     static onlp_oid_t psu_oid_table[ONLP_OID_TABLE_SIZE] = {0};
     static onlp_psu_info_t psu_info_table[ONLP_OID_TABLE_SIZE];
     int i = 0;
@@ -318,7 +808,7 @@ platform_psus_notify__(void)
             break;
         }
 
-        if(onlp_psu_info_get(psu_oid_table[i], &pi) < 0) {
+        if(onlp_sys_platform_manage_psu_get(psu_oid_table[i], &pi, 1) < 0) {
             AIM_LOG_ERROR("Failure retreiving status of PSU ID %d",
                           pid);
             continue;
@@ -351,6 +841,14 @@ platform_psus_notify__(void)
             uint32_t new = pi.status;
             uint32_t old = psu_info_table[i].status;
 
+            if(rv == ONLP_SYS_PLATFORM_MANAGE_IDLE) {
+                rv = ONLP_SYS_PLATFORM_MANAGE_ACTIVE;
+            }
+
+            if( (old ^ new) & 0x1 ) {
+                /* Presence changed. The OID tree may have changed. */
+                onlp_oid_snapshot_invalidate();
+            }
             if( !(old & 0x1) && (new & 0x1) ) {
                 /* PSU Inserted */
                 AIM_SYSLOG_INFO("PSU <id> has been inserted.",
@@ -375,6 +873,8 @@ platform_psus_notify__(void)
                 AIM_SYSLOG_CRIT("PSU <id> has failed.",
                                 "The given PSU has failed.",
                                 "PSU %d has failed.", pid);
+                /* Less power headroom. Tighten management. */
+                rv = ONLP_SYS_PLATFORM_MANAGE_URGENT;
             }
 
             if(!(new & ONLP_PSU_STATUS_FAILED) && (new & ONLP_PSU_STATUS_PRESENT)) {
@@ -396,12 +896,13 @@ platform_psus_notify__(void)
             memcpy(psu_info_table+i, &pi, sizeof(pi));
         }
     }
-    return 0;
+    return rv;
 }
 
 static int
-platform_fans_notify__(void)
+platform_fans_notify__(void* cookie)
 {
+    int rv = ONLP_SYS_PLATFORM_MANAGE_IDLE;
     static onlp_oid_t fan_oid_table[ONLP_OID_TABLE_SIZE] = {0};
     static onlp_fan_info_t fan_info_table[ONLP_OID_TABLE_SIZE];
     int i = 0;
@@ -431,7 +932,7 @@ platform_fans_notify__(void)
             break;
         }
 
-        if(onlp_fan_info_get(fan_oid_table[i], &fi) < 0) {
+        if(onlp_sys_platform_manage_fan_get(fan_oid_table[i], &fi, 1) < 0) {
             AIM_LOG_ERROR("Failure retreiving status of FAN ID %d",
                           fid);
             continue;
@@ -459,6 +960,14 @@ platform_fans_notify__(void)
             uint32_t new = fi.status;
             uint32_t old = fan_info_table[i].status;
 
+            if(rv == ONLP_SYS_PLATFORM_MANAGE_IDLE) {
+                rv = ONLP_SYS_PLATFORM_MANAGE_ACTIVE;
+            }
+
+            if( (old ^ new) & 0x1 ) {
+                /* Presence changed. The OID tree may have changed. */
+                onlp_oid_snapshot_invalidate();
+            }
             if( !(old & 0x1) && (new & 0x1) ) {
                 /* FAN Inserted */
                 AIM_SYSLOG_INFO("Fan <id> has been inserted.",
@@ -482,12 +991,14 @@ platform_fans_notify__(void)
                 AIM_SYSLOG_CRIT("Fan <id> has failed.",
                                 "The given fan has failed.",
                                 "Fan %d has failed.", fid);
+                /* Less cooling headroom. Tighten management. */
+                rv = ONLP_SYS_PLATFORM_MANAGE_URGENT;
             }
 
             memcpy(fan_info_table+i, &fi, sizeof(fi));
         }
     }
-    return 0;
+    return rv;
 }
 
 
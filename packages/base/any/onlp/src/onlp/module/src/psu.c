@@ -28,6 +28,7 @@
 #include <onlp/psu.h>
 #include <onlp/platformi/psui.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_PSU
 #include "onlp_locks.h"
 
 #define VALIDATE(_id)                           \
@@ -55,10 +56,16 @@ ONLP_LOCKED_API0(onlp_psu_init);
 static int
 onlp_psu_info_get_locked__(onlp_oid_t id,  onlp_psu_info_t* info)
 {
+    int rv;
+
     VALIDATE(id);
-    return onlp_psui_info_get(id, info);
+    rv = onlp_psui_info_get(id, info);
+    if(rv >= 0) {
+        onlp_oid_snapshot_presence_update(id, info->status & ONLP_PSU_STATUS_PRESENT);
+    }
+    return rv;
 }
-ONLP_LOCKED_API2(onlp_psu_info_get, onlp_oid_t, id, onlp_psu_info_t*, info);
+ONLP_LOCKED_SHARED_API2(onlp_psu_info_get, onlp_oid_t, id, onlp_psu_info_t*, info);
 
 static int
 onlp_psu_status_get_locked__(onlp_oid_t id, uint32_t* status)
@@ -74,7 +81,7 @@ onlp_psu_status_get_locked__(onlp_oid_t id, uint32_t* status)
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_psu_status_get, onlp_oid_t, id, uint32_t*, status);
+ONLP_LOCKED_SHARED_API2(onlp_psu_status_get, onlp_oid_t, id, uint32_t*, status);
 
 static int
 onlp_psu_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
@@ -90,7 +97,7 @@ onlp_psu_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_psu_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_SHARED_API2(onlp_psu_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
 int
 onlp_psu_vioctl_locked__(onlp_oid_t id, va_list vargs)
 {
@@ -24,7 +24,10 @@
  ***********************************************************/
 #include <onlp/sfp.h>
 #include <onlp/platformi/sfpi.h>
+#include <onlplib/i2c.h>
+#include "onlp_int.h"
 #include "onlp_log.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_SFP
 #include "onlp_locks.h"
 
 /**
@@ -32,6 +35,12 @@
  */
 static onlp_sfp_bitmap_t sfpi_bitmap__;
 
+/**
+ * Root I2C adapter + 1 of each port, or 0 if unknown.
+ */
+static int sfp_port_groups__[256];
+static void sfp_port_groups_resolve__(void);
+
 void
 onlp_sfp_bitmap_t_init(onlp_sfp_bitmap_t* bmap)
 {
@@ -64,11 +73,42 @@ onlp_sfp_init_locked__(void)
             AIM_LOG_ERROR("onlp_sfpi_bitmap_get(): %{onlp_status}", rv);
             return rv;
         }
+        sfp_port_groups_resolve__();
         return ONLP_STATUS_OK;
     }
 }
 ONLP_LOCKED_API0(onlp_sfp_init)
 
+/*
+ * Resolve the root I2C adapter of every port. Called once from
+ * onlp_sfp_init() with the SFP domain held exclusively, so the
+ * table never changes while a port lock is held.
+ */
+static void
+sfp_port_groups_resolve__(void)
+{
+    int p, port, bus, root;
+
+    memset(sfp_port_groups__, 0, sizeof(sfp_port_groups__));
+    AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
+        if(p >= AIM_ARRAYSIZE(sfp_port_groups__) ||
+           AIM_BITMAP_GET(&sfpi_bitmap__, p) == 0) {
+            continue;
+        }
+        port = p;
+        if(onlp_sfpi_port_map(p, &root) >= 0) {
+            port = root;
+        }
+        if(onlp_sfpi_port_bus_get(port, &bus) < 0 || bus < 0) {
+            continue;
+        }
+        if((root = onlp_i2c_root_bus_get(bus)) < 0) {
+            root = bus;
+        }
+        sfp_port_groups__[p] = root + 1;
+    }
+}
+
 
 
 static int
@@ -77,7 +117,7 @@ onlp_sfp_bitmap_get_locked__(onlp_sfp_bitmap_t* bmap)
     AIM_BITMAP_ASSIGN(bmap, &sfpi_bitmap__);
     return ONLP_STATUS_OK;
 }
-ONLP_LOCKED_API1(onlp_sfp_bitmap_get, onlp_sfp_bitmap_t*, bmap);
+ONLP_LOCKED_SHARED_API1(onlp_sfp_bitmap_get, onlp_sfp_bitmap_t*, bmap);
 
 
 static int
@@ -105,7 +145,7 @@ onlp_sfp_is_present_locked__(int port)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_is_present(port);
 }
-ONLP_LOCKED_API1(onlp_sfp_is_present, int, port);
+ONLP_LOCKED_PORT_API1(onlp_sfp_is_present, int, port);
 
 static int
 onlp_sfp_presence_bitmap_get_locked__(onlp_sfp_bitmap_t* dst)
@@ -154,7 +194,7 @@ onlp_sfp_eeprom_read_locked__(int port, uint8_t** datap)
     *datap = data;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_sfp_eeprom_read, int, port, uint8_t**, rv);
+ONLP_LOCKED_PORT_API2(onlp_sfp_eeprom_read, int, port, uint8_t**, rv);
 
 static int
 onlp_sfp_dom_read_locked__(int port, uint8_t** datap)
@@ -171,7 +211,7 @@ onlp_sfp_dom_read_locked__(int port, uint8_t** datap)
     *datap = data;
     return rv;
 }
-ONLP_LOCKED_API2(onlp_sfp_dom_read, int, port, uint8_t**, rv);
+ONLP_LOCKED_PORT_API2(onlp_sfp_dom_read, int, port, uint8_t**, rv);
 
 void
 onlp_sfp_dump(aim_pvs_t* pvs)
@@ -204,6 +244,10 @@ onlp_sfp_dump(aim_pvs_t* pvs)
     }
     aim_printf(pvs, "\n");
 
+    uint32_t flags[256];
+    int fstatus[256];
+    int frv = onlp_sfp_control_flags_all_get(flags, fstatus, AIM_ARRAYSIZE(flags));
+
     AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
         rv = onlp_sfp_is_present(p);
         aim_printf(pvs, "Port %.2d: ", p);
@@ -213,14 +257,14 @@ onlp_sfp_dump(aim_pvs_t* pvs)
         }
         else if(rv == 1) {
             /* Present, OK */
-            int srv;
-            uint32_t flags = 0;
-            srv = onlp_sfp_control_flags_get(p, &flags);
-            if(srv >= 0) {
-                aim_printf(pvs, "Present, Status = %{onlp_sfp_control_flags}\n", flags);
+            if(frv < 0) {
+                aim_printf(pvs, "Present, Status Unavailable [ %{onlp_status} ]\n", frv);
+            }
+            else if(fstatus[p] < 0) {
+                aim_printf(pvs, "Present, Status Unavailable [ %{onlp_status} ]\n", fstatus[p]);
             }
             else {
-                aim_printf(pvs, "Present, Status Unavailable [ %{onlp_status} ]\n", srv);
+                aim_printf(pvs, "Present, Status = %{onlp_sfp_control_flags}\n", flags[p]);
             }
         }
         else {
@@ -248,7 +292,7 @@ onlp_sfp_post_insert_locked__(int port, sff_info_t* info)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_post_insert(port, info);
 }
-ONLP_LOCKED_API2(onlp_sfp_post_insert, int, port, sff_info_t*, info);
+ONLP_LOCKED_PORT_API2(onlp_sfp_post_insert, int, port, sff_info_t*, info);
 
 static int
 onlp_sfp_control_set_locked__(int port, onlp_sfp_control_t control, int value)
@@ -280,7 +324,7 @@ onlp_sfp_control_set_locked__(int port, onlp_sfp_control_t control, int value)
         }
     return onlp_sfpi_control_set(port, control, value);
 }
-ONLP_LOCKED_API3(onlp_sfp_control_set, int, port, onlp_sfp_control_t, control,
+ONLP_LOCKED_PORT_API3(onlp_sfp_control_set, int, port, onlp_sfp_control_t, control,
                  int, value);
 
 static int
@@ -311,7 +355,7 @@ onlp_sfp_control_get_locked__(int port, onlp_sfp_control_t control, int* value)
 
     return (value) ? onlp_sfpi_control_get(port, control, value) : ONLP_STATUS_E_PARAM;
 }
-ONLP_LOCKED_API3(onlp_sfp_control_get, int, port, onlp_sfp_control_t, control,
+ONLP_LOCKED_PORT_API3(onlp_sfp_control_get, int, port, onlp_sfp_control_t, control,
                  int*, value);
 
 
@@ -342,20 +386,21 @@ onlp_sfp_rx_los_bitmap_get_locked__(onlp_sfp_bitmap_t* dst)
 ONLP_LOCKED_API1(onlp_sfp_rx_los_bitmap_get, onlp_sfp_bitmap_t*, dst);
 
 
+/**
+ * These are the control bits queried and returned.
+ */
+static const onlp_sfp_control_t control_flags__[] =
+    {
+        ONLP_SFP_CONTROL_RESET_STATE,
+        ONLP_SFP_CONTROL_RX_LOS,
+        ONLP_SFP_CONTROL_TX_FAULT,
+        ONLP_SFP_CONTROL_TX_DISABLE,
+        ONLP_SFP_CONTROL_LP_MODE
+    };
+
 int
 onlp_sfp_control_flags_get(int port, uint32_t* flags)
 {
-    /**
-     * These are the control bits queried and returned.
-     */
-    onlp_sfp_control_t controls[] =
-        {
-            ONLP_SFP_CONTROL_RESET_STATE,
-            ONLP_SFP_CONTROL_RX_LOS,
-            ONLP_SFP_CONTROL_TX_DISABLE,
-            ONLP_SFP_CONTROL_LP_MODE
-        };
-
     if(flags) {
         *flags = 0;
     }
@@ -365,11 +410,11 @@ onlp_sfp_control_flags_get(int port, uint32_t* flags)
 
     int rv, i, v;
 
-    for(i = 0; i < AIM_ARRAYSIZE(controls); i++) {
-        rv = onlp_sfp_control_get(port, controls[i], &v);
+    for(i = 0; i < AIM_ARRAYSIZE(control_flags__); i++) {
+        rv = onlp_sfp_control_get(port, control_flags__[i], &v);
         if(rv >= 0) {
             if(v) {
-                *flags |= (1 << controls[i]);
+                *flags |= (1 << control_flags__[i]);
             }
         }
         else {
@@ -381,6 +426,137 @@ onlp_sfp_control_flags_get(int port, uint32_t* flags)
     return 0;
 }
 
+/*
+ * The ports read one at a time when the SFPI driver has no bitmap
+ * for a control. Empty cages are skipped. If presence cannot be
+ * read, every port is.
+ */
+static void
+sfp_control_mask_get__(onlp_sfp_bitmap_t* mask, int* ready)
+{
+    int p;
+
+    if(*ready) {
+        return;
+    }
+    *ready = 1;
+
+    if(onlp_sfp_presence_bitmap_get_locked__(mask) < 0) {
+        onlp_sfp_bitmap_t_init(mask);
+        AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
+            if(AIM_BITMAP_GET(&sfpi_bitmap__, p)) {
+                AIM_BITMAP_SET(mask, p);
+            }
+        }
+    }
+}
+
+/*
+ * Get a control bitmap from the SFPI driver. If the driver does not
+ * support it, or fails, the ports in mask are read one at a time.
+ * A port which cannot be read is reported clear, and its error is
+ * stored in status[port] if status is not NULL.
+ */
+static int
+sfp_control_bitmap_get__(onlp_sfp_control_t control,
+                         onlp_sfp_bitmap_t* mask, int* mask_ready,
+                         onlp_sfp_bitmap_t* dst, int* status, int count)
+{
+    int rv, p;
+    int supported = 0;
+    int error = ONLP_STATUS_E_UNSUPPORTED;
+
+    onlp_sfp_bitmap_t_init(dst);
+    rv = onlp_sfpi_control_bitmap_get(control, dst);
+    if(rv == ONLP_STATUS_E_UNSUPPORTED && control == ONLP_SFP_CONTROL_RX_LOS) {
+        rv = onlp_sfpi_rx_los_bitmap_get(dst);
+    }
+    if(rv >= 0) {
+        return rv;
+    }
+
+    sfp_control_mask_get__(mask, mask_ready);
+    AIM_BITMAP_CLR_ALL(dst);
+    AIM_BITMAP_ITER(mask, p) {
+        int v;
+        if(AIM_BITMAP_GET(mask, p) == 0) {
+            continue;
+        }
+        rv = onlp_sfp_control_get_locked__(p, control, &v);
+        if(rv < 0) {
+            if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+                error = rv;
+                if(status && p < count && status[p] == 0) {
+                    status[p] = rv;
+                }
+            }
+            continue;
+        }
+        supported = 1;
+        if(v) {
+            AIM_BITMAP_SET(dst, p);
+        }
+    }
+
+    return supported ? ONLP_STATUS_OK : error;
+}
+
+static int
+onlp_sfp_control_bitmap_get_locked__(onlp_sfp_control_t control,
+                                     onlp_sfp_bitmap_t* dst)
+{
+    onlp_sfp_bitmap_t mask;
+    int mask_ready = 0;
+
+    if(!ONLP_SFP_CONTROL_VALID(control) || dst == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if(control == ONLP_SFP_CONTROL_RESET) {
+        /* This is a write-only control. */
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    return sfp_control_bitmap_get__(control, &mask, &mask_ready,
+                                    dst, NULL, 0);
+}
+ONLP_LOCKED_API2(onlp_sfp_control_bitmap_get, onlp_sfp_control_t, control,
+                 onlp_sfp_bitmap_t*, dst);
+
+static int
+onlp_sfp_control_flags_all_get_locked__(uint32_t* flags, int* status, int count)
+{
+    int i, p;
+    onlp_sfp_bitmap_t bmap;
+    onlp_sfp_bitmap_t mask;
+    int mask_ready = 0;
+
+    if(flags == NULL || count < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    memset(flags, 0, sizeof(*flags) * count);
+    if(status) {
+        memset(status, 0, sizeof(*status) * count);
+    }
+
+    /* Errors stay with the ports they came from. */
+    for(i = 0; i < AIM_ARRAYSIZE(control_flags__); i++) {
+        if(sfp_control_bitmap_get__(control_flags__[i], &mask, &mask_ready,
+                                    &bmap, status, count) < 0) {
+            continue;
+        }
+        AIM_BITMAP_ITER(&bmap, p) {
+            if(p < count && AIM_BITMAP_GET(&bmap, p)) {
+                flags[p] |= (1 << control_flags__[i]);
+            }
+        }
+    }
+    return 0;
+}
+ONLP_LOCKED_API3(onlp_sfp_control_flags_all_get, uint32_t*, flags,
+                 int*, status, int, count);
+
 int
 onlp_sfp_ioctl(int port, ...)
 {
@@ -397,7 +573,7 @@ onlp_sfp_vioctl_locked__(int port, va_list vargs)
 {
     return onlp_sfpi_ioctl(port, vargs);
 };
-ONLP_LOCKED_API2(onlp_sfp_vioctl, int, port, va_list, vargs);
+ONLP_LOCKED_PORT_API2(onlp_sfp_vioctl, int, port, va_list, vargs);
 
 
 int
@@ -406,7 +582,7 @@ onlp_sfp_dev_readb_locked__(int port, uint8_t devaddr, uint8_t addr)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_readb(port, devaddr, addr);
 }
-ONLP_LOCKED_API3(onlp_sfp_dev_readb, int, port, uint8_t, devaddr, uint8_t, addr);
+ONLP_LOCKED_PORT_API3(onlp_sfp_dev_readb, int, port, uint8_t, devaddr, uint8_t, addr);
 
 int
 onlp_sfp_dev_writeb_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t value)
@@ -414,7 +590,7 @@ onlp_sfp_dev_writeb_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t va
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_writeb(port, devaddr, addr, value);
 }
-ONLP_LOCKED_API4(onlp_sfp_dev_writeb, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t, value);
+ONLP_LOCKED_PORT_API4(onlp_sfp_dev_writeb, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t, value);
 
 int
 onlp_sfp_dev_readw_locked__(int port, uint8_t devaddr, uint8_t addr)
@@ -422,7 +598,7 @@ onlp_sfp_dev_readw_locked__(int port, uint8_t devaddr, uint8_t addr)
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_readw(port, devaddr, addr);
 }
-ONLP_LOCKED_API3(onlp_sfp_dev_readw, int, port, uint8_t, devaddr, uint8_t, addr);
+ONLP_LOCKED_PORT_API3(onlp_sfp_dev_readw, int, port, uint8_t, devaddr, uint8_t, addr);
 
 int
 onlp_sfp_dev_writew_locked__(int port, uint8_t devaddr, uint8_t addr, uint16_t value)
@@ -430,7 +606,7 @@ onlp_sfp_dev_writew_locked__(int port, uint8_t devaddr, uint8_t addr, uint16_t v
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_writew(port, devaddr, addr, value);
 }
-ONLP_LOCKED_API4(onlp_sfp_dev_writew, int, port, uint8_t, devaddr, uint8_t, addr, uint16_t, value);
+ONLP_LOCKED_PORT_API4(onlp_sfp_dev_writew, int, port, uint8_t, devaddr, uint8_t, addr, uint16_t, value);
 
 int
 onlp_sfp_dev_read_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t* rdata, int size)
@@ -438,7 +614,7 @@ onlp_sfp_dev_read_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t* rda
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_read(port, devaddr, addr, rdata, size);
 }
-ONLP_LOCKED_API5(onlp_sfp_dev_read, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t*, rdata, int, size);
+ONLP_LOCKED_PORT_API5(onlp_sfp_dev_read, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t*, rdata, int, size);
 
 int
 onlp_sfp_dev_write_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t* data, int size)
@@ -446,4 +622,736 @@ onlp_sfp_dev_write_locked__(int port, uint8_t devaddr, uint8_t addr, uint8_t* da
     ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
     return onlp_sfpi_dev_write(port, devaddr, addr, data, size);
 }
-ONLP_LOCKED_API5(onlp_sfp_dev_write, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t*, data, int, size);
+ONLP_LOCKED_PORT_API5(onlp_sfp_dev_write, int, port, uint8_t, devaddr, uint8_t, addr, uint8_t*, data, int, size);
+
+/*
+ * Paged memory access.
+ *
+ * The upper half of the address space is selected through the bank
+ * and page select bytes. Accesses which stay below offset 128 never
+ * need a selection. Selects are only written to modules which are
+ * known to be paged. Anything selected is returned to page 0, bank 0
+ * before the port lock is dropped, so other users see the default.
+ */
+#define SFP_MEMORY_BANK_SELECT 126
+#define SFP_MEMORY_PAGE_SELECT 127
+
+static int
+sfp_memory_validate__(int bank, int page, int offset, int len, uint8_t* data)
+{
+    if(data == NULL || len <= 0 || offset < 0 || offset + len > 256 ||
+       bank < 0 || bank > 255 || page < 0 || page > 255) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    return 0;
+}
+
+/*
+ * Return 1 if the module answers bank and page selects on devaddr.
+ * The 0x50 space is paged only for SFF-8636 and CMIS modules which
+ * do not report flat memory. Only CMIS modules have banks. SFF-8472
+ * selects 0x51 pages with byte 127 and has no banks.
+ */
+static int
+sfp_memory_paged__(int port, uint8_t devaddr, int bank)
+{
+    uint8_t id[3];
+    int rv;
+
+    if(devaddr != 0x50) {
+        return (bank == 0);
+    }
+
+    if((rv = onlp_sfpi_dev_read(port, devaddr, 0, id, sizeof(id))) < 0) {
+        return rv;
+    }
+
+    switch(id[0])
+        {
+        case 0x0C: /* QSFP */
+        case 0x0D: /* QSFP+ */
+        case 0x11: /* QSFP28 */
+            /* SFF-8636 byte 2 bit 2: flat memory */
+            return (bank == 0 && !(id[2] & 0x04));
+
+        case 0x18: /* QSFP-DD */
+        case 0x19: /* OSFP */
+        case 0x1E: /* QSFP+ with CMIS */
+        case 0x1F: /* SFP-DD */
+        case 0x20: /* SFP+ with CMIS */
+            /* CMIS byte 2 bit 7: flat memory */
+            return !(id[2] & 0x80);
+
+        default:
+            return 0;
+        }
+}
+
+#define SFP_MEMORY_SELECTED_BANK 0x1
+#define SFP_MEMORY_SELECTED_PAGE 0x2
+
+/*
+ * Select the bank and page. The selects which were written are
+ * recorded in *selected, even if a later one fails, so that
+ * sfp_memory_restore__() undoes exactly those.
+ */
+static int
+sfp_memory_select__(int port, uint8_t devaddr, int bank, int page, int* selected)
+{
+    int rv;
+
+    *selected = 0;
+
+    if((rv = sfp_memory_paged__(port, devaddr, bank)) <= 0) {
+        return (rv < 0) ? rv : ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    if(bank) {
+        if((rv = onlp_sfpi_dev_writeb(port, devaddr, SFP_MEMORY_BANK_SELECT, bank)) < 0) {
+            return rv;
+        }
+        *selected |= SFP_MEMORY_SELECTED_BANK;
+    }
+    if(page) {
+        if((rv = onlp_sfpi_dev_writeb(port, devaddr, SFP_MEMORY_PAGE_SELECT, page)) < 0) {
+            return rv;
+        }
+        *selected |= SFP_MEMORY_SELECTED_PAGE;
+    }
+    return 0;
+}
+
+static void
+sfp_memory_restore__(int port, uint8_t devaddr, int selected)
+{
+    if((selected & SFP_MEMORY_SELECTED_BANK) &&
+       onlp_sfpi_dev_writeb(port, devaddr, SFP_MEMORY_BANK_SELECT, 0) < 0) {
+        AIM_LOG_ERROR("port %d: failed to restore bank 0 on device 0x%x", port, devaddr);
+    }
+    if((selected & SFP_MEMORY_SELECTED_PAGE) &&
+       onlp_sfpi_dev_writeb(port, devaddr, SFP_MEMORY_PAGE_SELECT, 0) < 0) {
+        AIM_LOG_ERROR("port %d: failed to restore page 0 on device 0x%x", port, devaddr);
+    }
+}
+
+static int
+onlp_sfp_memory_read_locked__(int port, uint8_t devaddr, int bank, int page,
+                              int offset, int len, uint8_t* data)
+{
+    int rv;
+    uint8_t buf[256];
+
+    ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
+
+    if((rv = sfp_memory_validate__(bank, page, offset, len, data)) < 0) {
+        return rv;
+    }
+
+    rv = onlp_sfpi_memory_read(port, devaddr, bank, page, offset, len, data);
+    if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+        return (rv < 0) ? rv : ONLP_STATUS_OK;
+    }
+
+    if(offset + len <= 128) {
+        /* Lower page only */
+        bank = page = 0;
+    }
+
+    if(bank || page) {
+        int selected;
+        if((rv = sfp_memory_select__(port, devaddr, bank, page, &selected)) >= 0) {
+            rv = onlp_sfpi_dev_read(port, devaddr, offset, data, len);
+        }
+        sfp_memory_restore__(port, devaddr, selected);
+        return (rv < 0) ? rv : ONLP_STATUS_OK;
+    }
+
+    rv = onlp_sfpi_dev_read(port, devaddr, offset, data, len);
+    if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+        return (rv < 0) ? rv : ONLP_STATUS_OK;
+    }
+
+    /* Page 0 is also available through the whole EEPROM reads. */
+    switch(devaddr)
+        {
+        case 0x50: rv = onlp_sfpi_eeprom_read(port, buf); break;
+        case 0x51: rv = onlp_sfpi_dom_read(port, buf); break;
+        default: return ONLP_STATUS_E_UNSUPPORTED;
+        }
+    if(rv < 0) {
+        return rv;
+    }
+    memcpy(data, buf + offset, len);
+    return ONLP_STATUS_OK;
+}
+ONLP_LOCKED_PORT_API7(onlp_sfp_memory_read, int, port, uint8_t, devaddr,
+                      int, bank, int, page, int, offset, int, len,
+                      uint8_t*, data);
+
+static int
+onlp_sfp_memory_write_locked__(int port, uint8_t devaddr, int bank, int page,
+                               int offset, int len, uint8_t* data)
+{
+    int rv;
+
+    ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
+
+    if((rv = sfp_memory_validate__(bank, page, offset, len, data)) < 0) {
+        return rv;
+    }
+
+    rv = onlp_sfpi_memory_write(port, devaddr, bank, page, offset, len, data);
+    if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+        return (rv < 0) ? rv : ONLP_STATUS_OK;
+    }
+
+    if(offset + len <= 128) {
+        /* Lower page only */
+        bank = page = 0;
+    }
+
+    if(bank || page) {
+        int selected;
+        if((rv = sfp_memory_select__(port, devaddr, bank, page, &selected)) >= 0) {
+            rv = onlp_sfpi_dev_write(port, devaddr, offset, data, len);
+        }
+        sfp_memory_restore__(port, devaddr, selected);
+    }
+    else {
+        rv = onlp_sfpi_dev_write(port, devaddr, offset, data, len);
+    }
+    return (rv < 0) ? rv : ONLP_STATUS_OK;
+}
+ONLP_LOCKED_PORT_API7(onlp_sfp_memory_write, int, port, uint8_t, devaddr,
+                      int, bank, int, page, int, offset, int, len,
+                      uint8_t*, data);
+
+
+static int
+onlp_sfp_port_bus_get_locked__(int port, int* bus)
+{
+    ONLP_SFP_PORT_VALIDATE_AND_MAP(port);
+    return (bus) ? onlp_sfpi_port_bus_get(port, bus) : ONLP_STATUS_E_PARAM;
+}
+ONLP_LOCKED_PORT_API2(onlp_sfp_port_bus_get, int, port, int*, bus);
+
+int
+onlp_sfp_port_group_get(int port)
+{
+    if(port < 0 || port >= AIM_ARRAYSIZE(sfp_port_groups__) ||
+       AIM_BITMAP_GET(&sfpi_bitmap__, port) == 0) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    return (sfp_port_groups__[port] > 0) ?
+        sfp_port_groups__[port] - 1 : ONLP_STATUS_E_UNSUPPORTED;
+}
+
+
+#include <pthread.h>
+
+/**
+ * SFP inventory.
+ *
+ * Ports behind the same I2C adapter are read one after the other.
+ * Each adapter gets its own worker, so the total time approaches
+ * that of the slowest adapter. All per-port calls go through the
+ * public API. With lock domains (ONLP_CONFIG_API_LOCK_DOMAINS and
+ * onlp_sysi_api_lock_domains()) they only take the lock of their
+ * adapter group. Otherwise the global API lock serializes them.
+ */
+#if ONLP_CONFIG_SFP_INVENTORY_WORKERS < 1
+#error ONLP_CONFIG_SFP_INVENTORY_WORKERS must be at least 1.
+#endif
+
+typedef struct sfp_inventory_worker_s {
+    pthread_t thread;
+    int started;
+    int id;
+    int* assignment;
+    onlp_sfp_inventory_entry_t* entries;
+    int count;
+    uint32_t flags;
+} sfp_inventory_worker_t;
+
+static void
+sfp_inventory_port__(onlp_sfp_inventory_entry_t* e, uint32_t flags)
+{
+    uint8_t* data;
+
+    e->present = onlp_sfp_is_present(e->port);
+    e->eeprom_status = ONLP_STATUS_E_MISSING;
+    e->dom_status = ONLP_STATUS_E_MISSING;
+    if(e->present != 1) {
+        return;
+    }
+
+    if((e->eeprom_status = onlp_sfp_eeprom_read(e->port, &data)) >= 0) {
+        memcpy(e->eeprom, data, sizeof(e->eeprom));
+        aim_free(data);
+    }
+
+    if(flags & ONLP_SFP_INVENTORY_F_DOM) {
+        if((e->dom_status = onlp_sfp_dom_read(e->port, &data)) >= 0) {
+            memcpy(e->dom, data, sizeof(e->dom));
+            aim_free(data);
+        }
+    }
+}
+
+static void*
+sfp_inventory_worker__(void* arg)
+{
+    int i;
+    sfp_inventory_worker_t* w = arg;
+
+    for(i = 0; i < w->count; i++) {
+        if(w->assignment[i] == w->id) {
+            sfp_inventory_port__(w->entries + i, w->flags);
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Assign each entry to a worker by the root adapter of its bus.
+ * Every port on an adapter goes to the same worker. When there are
+ * more adapters than workers, the adapters are dealt out in the order
+ * they are first seen. Ports with an unknown adapter go to worker 0.
+ * Returns the number of workers.
+ */
+static int
+sfp_inventory_assign__(onlp_sfp_inventory_entry_t* entries, int count,
+                       int* assignment)
+{
+    int i, j;
+    int* roots = aim_zmalloc(sizeof(*roots) * count);
+    int nroots = 0;
+
+    for(i = 0; i < count; i++) {
+        int root;
+
+        assignment[i] = 0;
+        if((root = onlp_sfp_port_group_get(entries[i].port)) < 0) {
+            continue;
+        }
+
+        for(j = 0; j < nroots; j++) {
+            if(roots[j] == root) {
+                break;
+            }
+        }
+        if(j == nroots) {
+            roots[nroots++] = root;
+        }
+        assignment[i] = j % ONLP_CONFIG_SFP_INVENTORY_WORKERS;
+    }
+    aim_free(roots);
+
+    if(nroots > ONLP_CONFIG_SFP_INVENTORY_WORKERS) {
+        return ONLP_CONFIG_SFP_INVENTORY_WORKERS;
+    }
+    return nroots ? nroots : 1;
+}
+
+int
+onlp_sfp_inventory_get(onlp_sfp_inventory_entry_t* entries, int count,
+                       uint32_t flags)
+{
+    int i, p, rv;
+    int n = 0;
+    int nworkers;
+    int* assignment;
+    uint32_t* control_flags;
+    int* control_status;
+    sfp_inventory_worker_t* workers;
+
+    if(entries == NULL || count < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
+        if(AIM_BITMAP_GET(&sfpi_bitmap__, p) && n < count) {
+            memset(entries + n, 0, sizeof(*entries));
+            entries[n++].port = p;
+        }
+    }
+    if(n == 0) {
+        return 0;
+    }
+
+    assignment = aim_zmalloc(sizeof(*assignment) * n);
+    nworkers = sfp_inventory_assign__(entries, n, assignment);
+    workers = aim_zmalloc(sizeof(*workers) * nworkers);
+
+    for(i = 0; i < nworkers; i++) {
+        workers[i].id = i;
+        workers[i].assignment = assignment;
+        workers[i].entries = entries;
+        workers[i].count = n;
+        workers[i].flags = flags;
+    }
+
+    /* The first group runs on the calling thread. */
+    for(i = 1; i < nworkers; i++) {
+        if(pthread_create(&workers[i].thread, NULL,
+                          sfp_inventory_worker__, workers + i) == 0) {
+            workers[i].started = 1;
+        }
+        else {
+            AIM_LOG_ERROR("sfp inventory: pthread create failed.");
+            sfp_inventory_worker__(workers + i);
+        }
+    }
+    sfp_inventory_worker__(workers);
+    for(i = 1; i < nworkers; i++) {
+        if(workers[i].started) {
+            pthread_join(workers[i].thread, NULL);
+        }
+    }
+
+    /* Controls are read once for all ports. */
+    control_flags = aim_zmalloc(sizeof(*control_flags) * 256);
+    control_status = aim_zmalloc(sizeof(*control_status) * 256);
+    rv = onlp_sfp_control_flags_all_get(control_flags, control_status, 256);
+    for(i = 0; i < n; i++) {
+        entries[i].control_flags = control_flags[entries[i].port];
+        entries[i].control_status = (rv < 0) ? rv : control_status[entries[i].port];
+    }
+
+    aim_free(control_status);
+    aim_free(control_flags);
+    aim_free(workers);
+    aim_free(assignment);
+    return n;
+}
+
+#if ONLP_CONFIG_INCLUDE_SFP_NOTIFY == 1
+
+#include <OS/os_thread.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <errno.h>
+
+/**
+ * SFP change notifications.
+ *
+ * One scanner thread serves all subscribers. Each scan reads the
+ * presence and RX_LOS bitmaps once, diffs them against the previous
+ * scan, and merges the differences into every subscriber's pending
+ * event. Subscribers are woken through their own eventfd.
+ */
+struct onlp_sfp_notify_s {
+    /** Readable while changes are pending. */
+    int fd;
+
+    /** Changes are pending. */
+    int pending;
+
+    onlp_sfp_notify_event_t event;
+
+    struct onlp_sfp_notify_s* next;
+};
+
+static struct {
+    /**
+     * Serializes starting and stopping the scanner. Taken before lock.
+     * The scanner only takes lock, so it can be joined with this held.
+     */
+    pthread_mutex_t state_lock;
+
+    pthread_mutex_t lock;
+
+    /** Subscribers. The scanner runs while this is not empty. */
+    onlp_sfp_notify_t* subscribers;
+
+    /** Stops the scanner. */
+    int eventfd;
+    pthread_t thread;
+
+    /** Results of the last scan. */
+    int scanned;
+    onlp_sfp_bitmap_t present;
+    onlp_sfp_bitmap_t rx_los;
+
+} notify__ = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER, NULL, -1 };
+
+
+static void
+notify_event_init__(onlp_sfp_notify_event_t* event)
+{
+    onlp_sfp_bitmap_t_init(&event->present);
+    onlp_sfp_bitmap_t_init(&event->inserted);
+    onlp_sfp_bitmap_t_init(&event->removed);
+    onlp_sfp_bitmap_t_init(&event->rx_los);
+    onlp_sfp_bitmap_t_init(&event->rx_los_changed);
+}
+
+/*
+ * Wake a subscriber.
+ * Called with notify__.lock held.
+ */
+static void
+notify_signal__(onlp_sfp_notify_t* n)
+{
+    uint64_t one = 1;
+    if(!n->pending) {
+        n->pending = 1;
+        if(write(n->fd, &one, sizeof(one)) < 0) {
+            AIM_LOG_ERROR("sfp notify: eventfd write failed: %{errno}", errno);
+        }
+    }
+}
+
+/*
+ * Scan presence and RX_LOS once and distribute the changes.
+ */
+static void
+notify_scan__(void)
+{
+    int p;
+    onlp_sfp_notify_t* n;
+    onlp_sfp_bitmap_t present, rx_los;
+
+    onlp_sfp_bitmap_t_init(&present);
+    onlp_sfp_bitmap_t_init(&rx_los);
+
+    if(onlp_sfp_presence_bitmap_get(&present) < 0) {
+        /* Try again on the next scan. */
+        return;
+    }
+    if(onlp_sfp_rx_los_bitmap_get(&rx_los) < 0) {
+        /* Not supported on all platforms. */
+        AIM_BITMAP_CLR_ALL(&rx_los);
+    }
+
+    pthread_mutex_lock(&notify__.lock);
+
+    AIM_BITMAP_ITER(&sfpi_bitmap__, p) {
+        int was = notify__.scanned ? AIM_BITMAP_GET(&notify__.present, p) : 0;
+        int is = AIM_BITMAP_GET(&present, p);
+        int los_was = notify__.scanned ? AIM_BITMAP_GET(&notify__.rx_los, p) : 0;
+        int los_is = AIM_BITMAP_GET(&rx_los, p);
+
+        if(was == is && los_was == los_is) {
+            continue;
+        }
+
+        for(n = notify__.subscribers; n; n = n->next) {
+            if(!was && is) {
+                AIM_BITMAP_SET(&n->event.inserted, p);
+            }
+            if(was && !is) {
+                AIM_BITMAP_SET(&n->event.removed, p);
+            }
+            if(los_was != los_is) {
+                AIM_BITMAP_SET(&n->event.rx_los_changed, p);
+            }
+            notify_signal__(n);
+        }
+    }
+
+    AIM_BITMAP_ASSIGN(&notify__.present, &present);
+    AIM_BITMAP_ASSIGN(&notify__.rx_los, &rx_los);
+    notify__.scanned = 1;
+
+    pthread_mutex_unlock(&notify__.lock);
+}
+
+static void*
+notify_thread__(void* arg)
+{
+    int efd = -1;
+    int timeout;
+    int stop = notify__.eventfd;
+
+    os_thread_name_set("onlp.sfp.notify");
+
+    if(onlp_sfpi_presence_notify_fd_get(&efd) < 0) {
+        efd = -1;
+    }
+    timeout = (efd >= 0) ? ONLP_CONFIG_SFP_NOTIFY_EVENT_SCAN_INTERVAL :
+        ONLP_CONFIG_SFP_NOTIFY_SCAN_INTERVAL;
+
+    for(;;) {
+        struct pollfd fds[2];
+        int count = 0;
+
+        notify_scan__();
+
+        fds[count].fd = stop;
+        fds[count++].events = POLLIN;
+        if(efd >= 0) {
+            fds[count].fd = efd;
+            fds[count++].events = POLLIN | POLLPRI;
+        }
+
+        int rv = poll(fds, count, timeout);
+        if(rv < 0 && errno != EINTR) {
+            AIM_LOG_ERROR("sfp notify: poll() failed: %{errno}", errno);
+            sleep(1);
+            continue;
+        }
+
+        if(fds[0].revents & POLLIN) {
+            /* Unsubscribed. */
+            return NULL;
+        }
+
+        if(count > 1 && fds[1].revents) {
+            /* Re-arm the platform event. sysfs requires a fresh read. */
+            char buf[4096];
+            lseek(efd, 0, SEEK_SET);
+            if(read(efd, buf, sizeof(buf)) < 0) {
+                /* Nothing to drain. */
+            }
+        }
+    }
+}
+
+static int
+notify_start__(void)
+{
+    if( (notify__.eventfd = eventfd(0, EFD_CLOEXEC)) < 0) {
+        AIM_LOG_ERROR("sfp notify: eventfd create failed: %{errno}", errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    notify__.scanned = 0;
+    if(pthread_create(&notify__.thread, NULL, notify_thread__, NULL) != 0) {
+        AIM_LOG_ERROR("sfp notify: pthread create failed.");
+        close(notify__.eventfd);
+        notify__.eventfd = -1;
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return 0;
+}
+
+static void
+notify_stop__(void)
+{
+    uint64_t one = 1;
+    if(write(notify__.eventfd, &one, sizeof(one)) < 0) {
+        AIM_LOG_ERROR("sfp notify: eventfd write failed: %{errno}", errno);
+    }
+    pthread_join(notify__.thread, NULL);
+    close(notify__.eventfd);
+    notify__.eventfd = -1;
+}
+
+int
+onlp_sfp_notify_subscribe(onlp_sfp_notify_t** rv)
+{
+    int p;
+    onlp_sfp_notify_t* n;
+
+    if(rv == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    n = aim_zmalloc(sizeof(*n));
+    notify_event_init__(&n->event);
+    if( (n->fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) < 0) {
+        AIM_LOG_ERROR("sfp notify: eventfd create failed: %{errno}", errno);
+        aim_free(n);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    pthread_mutex_lock(&notify__.state_lock);
+    pthread_mutex_lock(&notify__.lock);
+
+    if(notify__.subscribers == NULL && notify_start__() < 0) {
+        pthread_mutex_unlock(&notify__.lock);
+        pthread_mutex_unlock(&notify__.state_lock);
+        close(n->fd);
+        aim_free(n);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    if(notify__.scanned) {
+        /* Start from the current state. */
+        AIM_BITMAP_ITER(&notify__.present, p) {
+            if(AIM_BITMAP_GET(&notify__.present, p)) {
+                AIM_BITMAP_SET(&n->event.inserted, p);
+            }
+            if(AIM_BITMAP_GET(&notify__.rx_los, p)) {
+                AIM_BITMAP_SET(&n->event.rx_los_changed, p);
+            }
+        }
+        notify_signal__(n);
+    }
+
+    n->next = notify__.subscribers;
+    notify__.subscribers = n;
+
+    pthread_mutex_unlock(&notify__.lock);
+    pthread_mutex_unlock(&notify__.state_lock);
+
+    *rv = n;
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfp_notify_unsubscribe(onlp_sfp_notify_t* notify)
+{
+    onlp_sfp_notify_t** pn;
+    int stop = 0;
+
+    pthread_mutex_lock(&notify__.state_lock);
+    pthread_mutex_lock(&notify__.lock);
+    for(pn = &notify__.subscribers; *pn; pn = &(*pn)->next) {
+        if(*pn == notify) {
+            *pn = notify->next;
+            break;
+        }
+    }
+    stop = (notify__.subscribers == NULL && notify__.eventfd >= 0);
+    pthread_mutex_unlock(&notify__.lock);
+
+    if(stop) {
+        /*
+         * The scanner takes notify__.lock, so stop it with only the
+         * state lock held. A concurrent subscribe waits for the stop
+         * to finish before starting a new scanner.
+         */
+        notify_stop__();
+    }
+    pthread_mutex_unlock(&notify__.state_lock);
+
+    close(notify->fd);
+    aim_free(notify);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfp_notify_fd(onlp_sfp_notify_t* notify)
+{
+    return notify->fd;
+}
+
+int
+onlp_sfp_notify_get(onlp_sfp_notify_t* notify, onlp_sfp_notify_event_t* event)
+{
+    int rv;
+    uint64_t count;
+
+    pthread_mutex_lock(&notify__.lock);
+
+    rv = notify->pending;
+    if(rv) {
+        if(read(notify->fd, &count, sizeof(count)) < 0) {
+            /* Already drained. */
+        }
+        notify->pending = 0;
+    }
+
+    AIM_BITMAP_ASSIGN(&notify->event.present, &notify__.present);
+    AIM_BITMAP_ASSIGN(&notify->event.rx_los, &notify__.rx_los);
+    memcpy(event, &notify->event, sizeof(*event));
+    notify_event_init__(&notify->event);
+
+    pthread_mutex_unlock(&notify__.lock);
+    return rv;
+}
+
+#endif /* ONLP_CONFIG_INCLUDE_SFP_NOTIFY */
@@ -26,8 +26,11 @@
 #include <onlp/platformi/sysi.h>
 #include <onlplib/mmap.h>
 #include <AIM/aim.h>
+#include <pthread.h>
+#include <unistd.h>
 #include "onlp_log.h"
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_SYS
 #include "onlp_locks.h"
 
 static char*
@@ -120,34 +123,209 @@ onie_data_get__(int* free)
     return ma;
 }
 
+/*
+ * Read the ONIE information from the platform.
+ * The raw TlvInfo data (if any) is saved to the cache file.
+ * Returns 0 if the information was retrieved.
+ */
 static int
-onlp_sys_info_get_locked__(onlp_sys_info_t* rv)
+onie_info_read__(onlp_onie_info_t* info)
 {
-    if(rv == NULL) {
-        return -1;
-    }
-
-    memset(rv, 0, sizeof(*rv));
-
-    /**
-     * Get the system ONIE information.
-     */
+    int rv = 0;
     int free;
     uint8_t* onie_data = onie_data_get__(&free);
 
     if(onie_data) {
-        onlp_onie_decode(&rv->onie_info, onie_data, -1);
+        rv = onlp_onie_decode(info, onie_data, -1);
+        if(rv == 0 && ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE &&
+           ONLP_CONFIG_SYS_INFO_CACHE_FILENAME) {
+            int size = onlp_onie_data_size(onie_data);
+            FILE* fp;
+
+            /* Write and rename so readers never see partial data. */
+            char* tmp = aim_fstrdup("%s.%d", ONLP_CONFIG_SYS_INFO_CACHE_FILENAME, getpid());
+            if(size > 0 && (fp = fopen(tmp, "wb"))) {
+                int count = fwrite(onie_data, 1, size, fp);
+                if(fclose(fp) == 0 && count == size) {
+                    rename(tmp, ONLP_CONFIG_SYS_INFO_CACHE_FILENAME);
+                }
+                unlink(tmp);
+            }
+            aim_free(tmp);
+        }
         if(free) {
             onlp_sysi_onie_data_free(onie_data);
         }
     }
     else {
-        if(onlp_sysi_onie_info_get(&rv->onie_info) != 0) {
-            memset(&rv->onie_info, 0, sizeof(rv->onie_info));
-            list_init(&rv->onie_info.vx_list);
+        if( (rv = onlp_sysi_onie_info_get(info)) != 0) {
+            memset(info, 0, sizeof(*info));
+            list_init(&info->vx_list);
+        }
+    }
+    return rv;
+}
+
+#if ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE == 1
+
+/**
+ * Memoized system information.
+ *
+ * The ONIE data, system OIDs and platform information do not change
+ * at runtime, so they are retrieved once and copied out on request.
+ * The raw ONIE data is also shared with other processes through
+ * ONLP_CONFIG_SYS_INFO_CACHE_FILENAME.
+ */
+static struct {
+    /** The OIDs and platform information are cached. */
+    int loaded;
+
+    /** The ONIE information is cached. */
+    int onie_valid;
+
+    onlp_sys_info_t info;
+} sys_info_cache__;
+
+static pthread_mutex_t sys_info_cache_lock__ = PTHREAD_MUTEX_INITIALIZER;
+
+static char*
+strdup__(const char* s)
+{
+    return (s) ? aim_strdup(s) : NULL;
+}
+
+static void
+onie_info_reset__(onlp_onie_info_t* info)
+{
+    onlp_onie_info_free(info);
+    memset(info, 0, sizeof(*info));
+    list_init(&info->vx_list);
+}
+
+static void
+sys_info_cache_clear__(void)
+{
+    if(sys_info_cache__.loaded) {
+        onlp_onie_info_free(&sys_info_cache__.info.onie_info);
+        aim_free(sys_info_cache__.info.platform_info.cpld_versions);
+        aim_free(sys_info_cache__.info.platform_info.other_versions);
+    }
+    memset(&sys_info_cache__, 0, sizeof(sys_info_cache__));
+    list_init(&sys_info_cache__.info.onie_info.vx_list);
+}
+
+static void
+sys_info_cache_load__(int onie)
+{
+    onlp_sys_info_t* si = &sys_info_cache__.info;
+
+    if(!sys_info_cache__.loaded) {
+        onlp_platform_info_t pi;
+
+        sys_info_cache_clear__();
+        onlp_sysi_oids_get(si->hdr.coids, AIM_ARRAYSIZE(si->hdr.coids));
+
+        /* Keep our own copies of the platform strings. */
+        memset(&pi, 0, sizeof(pi));
+        onlp_sysi_platform_info_get(&pi);
+        si->platform_info.cpld_versions = strdup__(pi.cpld_versions);
+        si->platform_info.other_versions = strdup__(pi.other_versions);
+        onlp_sysi_platform_info_free(&pi);
+
+        sys_info_cache__.loaded = 1;
+    }
+
+    if(onie && !sys_info_cache__.onie_valid) {
+        onie_info_reset__(&si->onie_info);
+        if(ONLP_CONFIG_SYS_INFO_CACHE_FILENAME &&
+           onlp_onie_decode_file(&si->onie_info,
+                                 ONLP_CONFIG_SYS_INFO_CACHE_FILENAME) == 0) {
+            sys_info_cache__.onie_valid = 1;
         }
+        else {
+            /* Missing or invalid. Go to the platform. */
+            onie_info_reset__(&si->onie_info);
+            /* Retried on the next request if this fails. */
+            sys_info_cache__.onie_valid = (onie_info_read__(&si->onie_info) == 0);
+        }
+    }
+}
+
+void
+onlp_sys_info_cache_invalidate(void)
+{
+    pthread_mutex_lock(&sys_info_cache_lock__);
+    sys_info_cache_clear__();
+    if(ONLP_CONFIG_SYS_INFO_CACHE_FILENAME) {
+        unlink(ONLP_CONFIG_SYS_INFO_CACHE_FILENAME);
+    }
+    pthread_mutex_unlock(&sys_info_cache_lock__);
+}
+
+static int
+onlp_sys_info_get_locked__(onlp_sys_info_t* rv)
+{
+    onlp_sys_info_t* si = &sys_info_cache__.info;
+
+    if(rv == NULL) {
+        return -1;
+    }
+
+    memset(rv, 0, sizeof(*rv));
+
+    pthread_mutex_lock(&sys_info_cache_lock__);
+    sys_info_cache_load__(1);
+    onlp_onie_info_copy(&rv->onie_info, &si->onie_info);
+    memcpy(rv->hdr.coids, si->hdr.coids, sizeof(rv->hdr.coids));
+    rv->platform_info.cpld_versions = strdup__(si->platform_info.cpld_versions);
+    rv->platform_info.other_versions = strdup__(si->platform_info.other_versions);
+    pthread_mutex_unlock(&sys_info_cache_lock__);
+
+    return 0;
+}
+ONLP_LOCKED_SHARED_API1(onlp_sys_info_get,onlp_sys_info_t*,rv);
+
+void
+onlp_sys_info_free(onlp_sys_info_t* info)
+{
+    onlp_onie_info_free(&info->onie_info);
+    aim_free(info->platform_info.cpld_versions);
+    aim_free(info->platform_info.other_versions);
+}
+
+static int
+onlp_sys_hdr_get_locked__(onlp_oid_hdr_t* hdr)
+{
+    memset(hdr, 0, sizeof(*hdr));
+    pthread_mutex_lock(&sys_info_cache_lock__);
+    sys_info_cache_load__(0);
+    memcpy(hdr->coids, sys_info_cache__.info.hdr.coids, sizeof(hdr->coids));
+    pthread_mutex_unlock(&sys_info_cache_lock__);
+    return 0;
+}
+ONLP_LOCKED_SHARED_API1(onlp_sys_hdr_get, onlp_oid_hdr_t*, hdr);
+
+#else
+
+void
+onlp_sys_info_cache_invalidate(void)
+{
+}
+
+static int
+onlp_sys_info_get_locked__(onlp_sys_info_t* rv)
+{
+    if(rv == NULL) {
+        return -1;
     }
 
+    memset(rv, 0, sizeof(*rv));
+
+    /**
+     * Get the system ONIE information.
+     */
+    onie_info_read__(&rv->onie_info);
+
     /*
      * Query the sys oids
      */
@@ -160,7 +338,7 @@ onlp_sys_info_get_locked__(onlp_sys_info_t* rv)
 
     return 0;
 }
-ONLP_LOCKED_API1(onlp_sys_info_get,onlp_sys_info_t*,rv);
+ONLP_LOCKED_SHARED_API1(onlp_sys_info_get,onlp_sys_info_t*,rv);
 
 void
 onlp_sys_info_free(onlp_sys_info_t* info)
@@ -175,7 +353,9 @@ onlp_sys_hdr_get_locked__(onlp_oid_hdr_t* hdr)
     memset(hdr, 0, sizeof(*hdr));
     return onlp_sysi_oids_get(hdr->coids, AIM_ARRAYSIZE(hdr->coids));
 }
-ONLP_LOCKED_API1(onlp_sys_hdr_get, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_SHARED_API1(onlp_sys_hdr_get, onlp_oid_hdr_t*, hdr);
+
+#endif /* ONLP_CONFIG_INCLUDE_SYS_INFO_CACHE */
 
 
 void
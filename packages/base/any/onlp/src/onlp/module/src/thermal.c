@@ -25,8 +25,11 @@
 #include <onlp/thermal.h>
 #include <onlp/platformi/thermali.h>
 #include <onlp/oids.h>
+#include <stddef.h>
 #include "onlp_int.h"
+#define ONLP_API_LOCK_DOMAIN ONLP_API_LOCK_DOMAIN_THERMAL
 #include "onlp_locks.h"
+#include "onlp_json.h"
 
 #define VALIDATE(_id)                           \
     do {                                        \
@@ -43,37 +46,25 @@
     } while(0)
 
 
+#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
+static const onlp_json_override_field_t thermal_override_fields__[] = {
+    { "status", offsetof(onlp_thermal_info_t, status) },
+    { "mcelsius", offsetof(onlp_thermal_info_t, mcelsius) },
+};
+#endif
+
 static int
 onlp_thermal_init_locked__(void)
 {
+#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
+    onlp_json_override_register(ONLP_OID_TYPE_THERMAL, "thermal",
+                                thermal_override_fields__,
+                                AIM_ARRAYSIZE(thermal_override_fields__));
+#endif
     return onlp_thermali_init();
 }
 ONLP_LOCKED_API0(onlp_thermal_init);
 
-#if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
-
-static int
-onlp_thermali_info_from_json__(cJSON* data, onlp_thermal_info_t* info, int errorcheck)
-{
-    int rv;
-    int t;
-
-    if(data == NULL) {
-        return (errorcheck) ? ONLP_STATUS_E_PARAM : 0;
-    }
-
-    rv = cjson_util_lookup_int(data, (int*) &info->status, "status");
-    if(rv < 0 && errorcheck) return rv;
-
-    rv = cjson_util_lookup_int(data, &t, "mcelsius");
-    if(rv < 0 && errorcheck) return rv;
-    info->mcelsius = t;
-
-    return 0;
-}
-
-#endif
-
 static int
 onlp_thermal_info_get_locked__(onlp_oid_t oid, onlp_thermal_info_t* info)
 {
@@ -84,17 +75,13 @@ onlp_thermal_info_get_locked__(onlp_oid_t oid, onlp_thermal_info_t* info)
     if(rv >= 0) {
 
 #if ONLP_CONFIG_INCLUDE_PLATFORM_OVERRIDES == 1
-        int id = ONLP_OID_ID_GET(oid);
-        cJSON* entry = NULL;
-
-        cjson_util_lookup(onlp_json_get(0), &entry, "overrides.thermal.%d", id);
-        onlp_thermali_info_from_json__(entry, info, 0);
+        onlp_json_override_apply(oid, info);
 #endif
 
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_thermal_info_get, onlp_oid_t, oid, onlp_thermal_info_t*, info);
+ONLP_LOCKED_SHARED_API2(onlp_thermal_info_get, onlp_oid_t, oid, onlp_thermal_info_t*, info);
 
 static int
 onlp_thermal_status_get_locked__(onlp_oid_t id, uint32_t* status)
@@ -110,7 +97,7 @@ onlp_thermal_status_get_locked__(onlp_oid_t id, uint32_t* status)
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_thermal_status_get, onlp_oid_t, id, uint32_t*, status);
+ONLP_LOCKED_SHARED_API2(onlp_thermal_status_get, onlp_oid_t, id, uint32_t*, status);
 
 static int
 onlp_thermal_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
@@ -126,7 +113,7 @@ onlp_thermal_hdr_get_locked__(onlp_oid_t id, onlp_oid_hdr_t* hdr)
     }
     return rv;
 }
-ONLP_LOCKED_API2(onlp_thermal_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
+ONLP_LOCKED_SHARED_API2(onlp_thermal_hdr_get, onlp_oid_t, id, onlp_oid_hdr_t*, hdr);
 int
 onlp_thermal_ioctl(int code, ...)
 {
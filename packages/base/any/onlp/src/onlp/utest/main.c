@@ -83,6 +83,19 @@ shlock_test(void)
     if(strcmp("utest-lock:1", onlp_shlock_name(lock))) {
         AIM_DIE("lock name does not match (%s)", onlp_shlock_name(lock));
     }
+
+    onlp_shrwlock_t* rwlock = NULL;
+
+    TRY(onlp_shrwlock_create("/tmp/onlp-utest-rwlock", 4, &rwlock));
+    TRY(onlp_shrwlock_take(rwlock, 0, 0));
+    TRY(onlp_shrwlock_take(rwlock, 0, 0));
+    TRY(onlp_shrwlock_take(rwlock, 1, 1));
+    TRY(onlp_shrwlock_give(rwlock, 1));
+    TRY(onlp_shrwlock_give(rwlock, 0));
+    TRY(onlp_shrwlock_give(rwlock, 0));
+    TRY(onlp_shrwlock_take(rwlock, 0, 1));
+    TRY(onlp_shrwlock_give(rwlock, 0));
+    TRY(onlp_shrwlock_destroy(rwlock));
 }
 
 /**
@@ -30,10 +30,13 @@ __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_bitmap_get(onlp_sfp_bitmap_t* bmap));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_is_present(int port));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst));
+__ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_control_bitmap_get(onlp_sfp_control_t control, onlp_sfp_bitmap_t* dst));
+__ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_presence_notify_fd_get(int* fd));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_eeprom_read(int port, uint8_t data[256]));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_dom_read(int port, uint8_t data[256]));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_post_insert(int port, sff_info_t* sff_info));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_port_map(int port, int* rport));
+__ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_port_bus_get(int port, int* bus));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_denit(void));
 __ONLP_DEFAULTI_VIMPLEMENTATION(onlp_sfpi_debug(int port, aim_pvs_t* pvs));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_ioctl(int port, va_list vargs));
@@ -46,3 +49,5 @@ __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_dev_readw(int port, uint8_t devaddr, ui
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_dev_read(int port, uint8_t devaddr, uint8_t addr, uint8_t *rdata, int size));
 __ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_dev_write(int port, uint8_t devaddr, uint8_t addr, uint8_t* data, int size));
+__ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_memory_read(int port, uint8_t devaddr, int bank, int page, int offset, int len, uint8_t* data));
+__ONLP_DEFAULTI_IMPLEMENTATION(onlp_sfpi_memory_write(int port, uint8_t devaddr, int bank, int page, int offset, int len, uint8_t* data));
@@ -114,6 +114,26 @@
 #define ONLPIE_CONFIG_INCLUDE_UCLI 0
 #endif
 
+/**
+ * ONLPIE_CONFIG_MODEL_FILENAME
+ *
+ * The default simulation model file. The built-in example model is used if it does not exist. */
+
+
+#ifndef ONLPIE_CONFIG_MODEL_FILENAME
+#define ONLPIE_CONFIG_MODEL_FILENAME "/etc/onlp/onlpie.json"
+#endif
+
+/**
+ * ONLPIE_CONFIG_MODEL_ENV
+ *
+ * Environment variable which overrides the simulation model filename. */
+
+
+#ifndef ONLPIE_CONFIG_MODEL_ENV
+#define ONLPIE_CONFIG_MODEL_ENV "ONLPIE_MODEL"
+#endif
+
 
 
 /**
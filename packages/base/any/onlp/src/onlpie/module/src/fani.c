@@ -37,46 +37,44 @@ onlp_fani_init(void)
 /*
  * Get the fan information.
  */
-
-/* Static fan information */
-onlp_fan_info_t finfo[] = {
-    { }, /* Not used */
-    {
-        { ONLP_FAN_ID_CREATE(1), "Chassis Fan 1", 0 },
-        0x1,
-        ONLP_FAN_CAPS_B2F,
-        9000,
-        100,
-        ONLP_FAN_MODE_MAX,
-        "FAN1Model",
-        "FAN1SerialNumber",
-    },
-    {
-        { ONLP_FAN_ID_CREATE(2), "Chassis Fan 2", 0 },
-        0x0,
-    },
-    {
-        { ONLP_FAN_ID_CREATE(3), "PSU-1 Fan 1", 0 },
-        0x1,
-        ONLP_FAN_CAPS_B2F,
-        5004,
-        50,
-        ONLP_FAN_MODE_NORMAL,
-    },
-    {
-        { ONLP_FAN_ID_CREATE(3), "PSU-1 Fan 2", 0 },
-        0x1,
-        ONLP_FAN_CAPS_B2F,
-        5020,
-        50,
-        ONLP_FAN_MODE_NORMAL,
-    },
-};
-
 int
 onlp_fani_info_get(onlp_oid_t id, onlp_fan_info_t* info)
 {
-    *info = finfo[ONLP_OID_ID_GET(id)];
+    onlpie_model_t* m = onlpie_model_get();
+    onlpie_fan_t* f;
+    int fid = ONLP_OID_ID_GET(id);
+
+    if(!ONLPIE_VALID_ID(fid, m->fan_count)) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    ONLPIE_SIM_OP(ONLPIE_OP_FAN);
+
+    f = m->fans + fid;
+    memset(info, 0, sizeof(*info));
+    info->hdr.id = id;
+    aim_strlcpy(info->hdr.description, f->desc, sizeof(info->hdr.description));
+    if(f->psu) {
+        info->hdr.poid = ONLP_PSU_ID_CREATE(f->psu);
+    }
+    if(onlpie_sim_present(ONLPIE_OBJECT_FAN, fid) &&
+       (f->psu == 0 || onlpie_sim_present(ONLPIE_OBJECT_PSU, f->psu))) {
+        info->status = ONLP_FAN_STATUS_PRESENT;
+        if(f->failed) {
+            info->status |= ONLP_FAN_STATUS_FAILED;
+        }
+        if(f->caps & ONLP_FAN_CAPS_B2F) {
+            info->status |= ONLP_FAN_STATUS_B2F;
+        }
+        if(f->caps & ONLP_FAN_CAPS_F2B) {
+            info->status |= ONLP_FAN_STATUS_F2B;
+        }
+        info->caps = f->caps;
+        info->rpm = (f->failed) ? 0 : f->rpm;
+        info->percentage = f->percentage;
+        info->mode = f->mode;
+        aim_strlcpy(info->model, f->model, sizeof(info->model));
+        aim_strlcpy(info->serial, f->serial, sizeof(info->serial));
+    }
     return ONLP_STATUS_OK;
 }
 
@@ -91,7 +89,18 @@ onlp_fani_info_get(onlp_oid_t id, onlp_fan_info_t* info)
 int
 onlp_fani_rpm_set(onlp_oid_t id, int rpm)
 {
-    return ONLP_STATUS_E_UNSUPPORTED;
+    onlpie_model_t* m = onlpie_model_get();
+    int fid = ONLP_OID_ID_GET(id);
+
+    if(!ONLPIE_VALID_ID(fid, m->fan_count)) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if(!(m->fans[fid].caps & ONLP_FAN_CAPS_SET_RPM)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    ONLPIE_SIM_OP(ONLPIE_OP_FAN);
+    m->fans[fid].rpm = rpm;
+    return ONLP_STATUS_OK;
 }
 
 
@@ -106,7 +115,20 @@ onlp_fani_rpm_set(onlp_oid_t id, int rpm)
 int
 onlp_fani_percentage_set(onlp_oid_t id, int p)
 {
-    return ONLP_STATUS_E_UNSUPPORTED;
+    onlpie_model_t* m = onlpie_model_get();
+    int fid = ONLP_OID_ID_GET(id);
+
+    if(!ONLPIE_VALID_ID(fid, m->fan_count)) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    if(!(m->fans[fid].caps & ONLP_FAN_CAPS_SET_PERCENTAGE)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    ONLPIE_SIM_OP(ONLPIE_OP_FAN);
+    /* Simulated fans reach 10000 RPM at full speed. */
+    m->fans[fid].percentage = p;
+    m->fans[fid].rpm = p * 100;
+    return ONLP_STATUS_OK;
 }
 
 /*
@@ -36,25 +36,30 @@ onlp_ledi_init(void)
 /*
  * Get the information for the given LED OID.
  */
-static onlp_led_info_t linfo[] =
-    {
-        { }, /* Not used */
-        {
-            { ONLP_LED_ID_CREATE(1), "Chassis LED 1", 0 },
-            0x1,
-            ONLP_LED_CAPS_ON_OFF | ONLP_LED_CAPS_RED | ONLP_LED_CAPS_RED_BLINKING,
-            ONLP_LED_MODE_RED
-        },
-        {
-            { ONLP_LED_ID_CREATE(2), "Chassis LED 2", 0 },
-            0x0,
-        },
-    };
-
 int
 onlp_ledi_info_get(onlp_oid_t id, onlp_led_info_t* info)
 {
-    *info = linfo[ONLP_OID_ID_GET(id)];
+    onlpie_model_t* m = onlpie_model_get();
+    onlpie_led_t* l;
+    int lid = ONLP_OID_ID_GET(id);
+
+    if(!ONLPIE_VALID_ID(lid, m->led_count)) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    ONLPIE_SIM_OP(ONLPIE_OP_LED);
+
+    l = m->leds + lid;
+    memset(info, 0, sizeof(*info));
+    info->hdr.id = id;
+    aim_strlcpy(info->hdr.description, l->desc, sizeof(info->hdr.description));
+    if(l->present) {
+        info->status = ONLP_LED_STATUS_PRESENT;
+        if(l->mode != ONLP_LED_MODE_OFF) {
+            info->status |= ONLP_LED_STATUS_ON;
+        }
+        info->caps = l->caps;
+        info->mode = l->mode;
+    }
     return ONLP_STATUS_OK;
 }
 
@@ -70,7 +75,7 @@ onlp_ledi_info_get(onlp_oid_t id, onlp_led_info_t* info)
 int
 onlp_ledi_set(onlp_oid_t id, int on_or_off)
 {
-    return ONLP_STATUS_E_UNSUPPORTED;
+    return onlp_ledi_mode_set(id, (on_or_off) ? ONLP_LED_MODE_ON : ONLP_LED_MODE_OFF);
 }
 
 /*
@@ -82,7 +87,15 @@ onlp_ledi_set(onlp_oid_t id, int on_or_off)
 int
 onlp_ledi_mode_set(onlp_oid_t id, onlp_led_mode_t mode)
 {
-    return ONLP_STATUS_E_UNSUPPORTED;
+    onlpie_model_t* m = onlpie_model_get();
+    int lid = ONLP_OID_ID_GET(id);
+
+    if(!ONLPIE_VALID_ID(lid, m->led_count)) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    ONLPIE_SIM_OP(ONLPIE_OP_LED);
+    m->leds[lid].mode = mode;
+    return ONLP_STATUS_OK;
 }
 
 /*
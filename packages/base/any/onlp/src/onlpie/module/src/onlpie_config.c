@@ -64,6 +64,16 @@ onlpie_config_settings_t onlpie_config_settings[] =
     { __onlpie_config_STRINGIFY_NAME(ONLPIE_CONFIG_INCLUDE_UCLI), __onlpie_config_STRINGIFY_VALUE(ONLPIE_CONFIG_INCLUDE_UCLI) },
 #else
 { ONLPIE_CONFIG_INCLUDE_UCLI(__onlpie_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPIE_CONFIG_MODEL_FILENAME
+    { __onlpie_config_STRINGIFY_NAME(ONLPIE_CONFIG_MODEL_FILENAME), __onlpie_config_STRINGIFY_VALUE(ONLPIE_CONFIG_MODEL_FILENAME) },
+#else
+{ ONLPIE_CONFIG_MODEL_FILENAME(__onlpie_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPIE_CONFIG_MODEL_ENV
+    { __onlpie_config_STRINGIFY_NAME(ONLPIE_CONFIG_MODEL_ENV), __onlpie_config_STRINGIFY_VALUE(ONLPIE_CONFIG_MODEL_ENV) },
+#else
+{ ONLPIE_CONFIG_MODEL_ENV(__onlpie_config_STRINGIFY_NAME), "__undefined__" },
 #endif
     { NULL, NULL }
 };
@@ -27,6 +27,153 @@
 #define __ONLPIE_INT_H__
 
 #include <onlpie/onlpie_config.h>
+#include <onlp/onlp.h>
+#include <onlp/oids.h>
+#include <onlp/sfp.h>
+
+/**
+ * Simulation model.
+ *
+ * The platform is described by a JSON model file. See
+ * onlpie_sim.c for the format. Every platform call is charged the
+ * latency and error injection configured for its operation class.
+ */
+
+typedef enum onlpie_op_e {
+    ONLPIE_OP_SYS,
+    ONLPIE_OP_THERMAL,
+    ONLPIE_OP_FAN,
+    ONLPIE_OP_PSU,
+    ONLPIE_OP_LED,
+    ONLPIE_OP_SFP_PRESENCE,
+    ONLPIE_OP_SFP_EEPROM,
+    ONLPIE_OP_SFP_DOM,
+    ONLPIE_OP_SFP_CONTROL,
+    ONLPIE_OP_COUNT,
+} onlpie_op_t;
+
+/** Object classes with a presence schedule. */
+typedef enum onlpie_object_e {
+    ONLPIE_OBJECT_PORT,
+    ONLPIE_OBJECT_THERMAL,
+    ONLPIE_OBJECT_FAN,
+    ONLPIE_OBJECT_PSU,
+    ONLPIE_OBJECT_COUNT,
+} onlpie_object_t;
+
+typedef struct onlpie_thermal_s {
+    char desc[ONLP_OID_DESC_SIZE];
+    int present;
+    int failed;
+    int mcelsius;
+    int warning;
+    int error;
+    int shutdown;
+} onlpie_thermal_t;
+
+typedef struct onlpie_fan_s {
+    char desc[ONLP_OID_DESC_SIZE];
+    int present;
+    int failed;
+    uint32_t caps;
+    int rpm;
+    int percentage;
+    int mode;
+    /** The PSU which contains this fan, 0 for the chassis. */
+    int psu;
+    char model[ONLP_CONFIG_INFO_STR_MAX];
+    char serial[ONLP_CONFIG_INFO_STR_MAX];
+} onlpie_fan_t;
+
+typedef struct onlpie_psu_s {
+    char desc[ONLP_OID_DESC_SIZE];
+    int present;
+    int failed;
+    uint32_t caps;
+    int mvin, mvout, miin, miout, mpin, mpout;
+    char model[ONLP_CONFIG_INFO_STR_MAX];
+    char serial[ONLP_CONFIG_INFO_STR_MAX];
+} onlpie_psu_t;
+
+typedef struct onlpie_led_s {
+    char desc[ONLP_OID_DESC_SIZE];
+    int present;
+    uint32_t caps;
+    int mode;
+} onlpie_led_t;
+
+typedef struct onlpie_port_s {
+    int present;
+    int rx_los;
+    /** Bit N holds the value of control N. */
+    uint32_t controls;
+    uint8_t eeprom[256];
+    uint8_t dom[256];
+} onlpie_port_t;
+
+typedef struct onlpie_model_s {
+    /** Ports are numbered port_first .. port_first+port_count-1 */
+    int port_first;
+    int port_count;
+    /** Number of ports which share a simulated I2C adapter. */
+    int ports_per_bus;
+    onlpie_port_t* ports;
+
+    /* Indexed by OID id. Entry 0 is unused. */
+    onlpie_thermal_t* thermals;
+    int thermal_count;
+    onlpie_fan_t* fans;
+    int fan_count;
+    onlpie_psu_t* psus;
+    int psu_count;
+    onlpie_led_t* leds;
+    int led_count;
+} onlpie_model_t;
+
+/**
+ * @brief Get the simulation model. The model is loaded on first use.
+ */
+onlpie_model_t* onlpie_model_get(void);
+
+/**
+ * @brief Charge the latency and error injection for an operation.
+ * @param op The operation class.
+ * @returns 0 or the injected error status.
+ */
+int onlpie_sim_op(onlpie_op_t op);
+
+/**
+ * @brief Get the current presence of a simulated object.
+ * @param type The object class.
+ * @param id The port number or OID id.
+ * @note This applies the presence change schedule.
+ */
+int onlpie_sim_present(onlpie_object_t type, int id);
+
+/**
+ * @brief Get a descriptor which becomes readable at the next
+ * scheduled presence change.
+ * @param type The object class. Only one class is supported.
+ */
+int onlpie_sim_notify_fd(onlpie_object_t type);
+
+/**
+ * @brief Re-arm the notification descriptor after a presence scan.
+ * @param type The object class.
+ */
+void onlpie_sim_notify_arm(onlpie_object_t type);
+
+/** Check an OID id against a model table. */
+#define ONLPIE_VALID_ID(_id, _count) ( (_id) > 0 && (_id) < (_count) )
+
+/** Charge the simulated cost of an operation, returning on injected errors. */
+#define ONLPIE_SIM_OP(_op)                      \
+    do {                                        \
+        int _rv = onlpie_sim_op(_op);           \
+        if(_rv < 0) {                           \
+            return _rv;                         \
+        }                                       \
+    } while(0)
 
 
 #endif /* __ONLPIE_INT_H__ */
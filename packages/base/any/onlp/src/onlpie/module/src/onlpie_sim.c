@@ -0,0 +1,766 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ * 
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.       
+ * 
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ * 
+ *        http://www.eclipse.org/legal/epl-v10.html
+ * 
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ * 
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlp/fan.h>
+#include <onlp/led.h>
+#include <onlp/psu.h>
+#include <onlplib/file.h>
+#include <cjson_util/cjson_util.h>
+#include <AIM/aim.h>
+#include "onlpie_int.h"
+#include "onlpie_log.h"
+
+#include <math.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+
+/**
+ * Simulation model format:
+ *
+ * {
+ *   "seed": 1,
+ *   "ports": { "first": 1, "count": 32, "ports_per_bus": 8,
+ *              "present": "all" | [ 1, 2, ... ], "rx_los": [ ... ],
+ *              "eeprom": { "default": "<file>", "<port>": "<file>" } },
+ *   "thermals": [ { "desc": "...", "present": 1, "failed": 0, "mcelsius": 25000,
+ *                   "warning": 45000, "error": 55000, "shutdown": 60000 }, ... ],
+ *   "fans": [ { "desc": "...", "present": 1, "caps": <int>, "rpm": 9000,
+ *               "percentage": 50, "mode": "NORMAL", "psu": <psu id> }, ... ],
+ *   "psus": [ { "desc": "...", "present": 1, "caps": <int>, "model": "...",
+ *               "serial": "...", "mvin": 220000, ... }, ... ],
+ *   "leds": [ { "desc": "...", "present": 1, "caps": <int>, "mode": "GREEN" }, ... ],
+ *   "ops": { "default": { "latency_us": 100, "jitter_us": 20,
+ *                         "distribution": "fixed|uniform|normal|exponential",
+ *                         "error_rate": 0.001, "error_status": -1 },
+ *            "sfp_eeprom": { ... }, ... },
+ *   "schedule": [ { "object": "port|thermal|fan|psu", "id": 3, "at_ms": 5000,
+ *                   "period_ms": 10000, "present": 0 | 1 | "toggle" }, ... ]
+ * }
+ *
+ * Array position N describes OID id N+1. EEPROM files hold the A0 page
+ * optionally followed by the A2 page. Ports without a file get a
+ * generated 10G-SR SFP+ image.
+ *
+ * Schedule times are relative to the model file's modification time,
+ * so every process using the same model sees the same presence
+ * changes. Touch the file to restart the schedule.
+ */
+
+static const char* op_names__[ONLPIE_OP_COUNT] = {
+    "sys", "thermal", "fan", "psu", "led",
+    "sfp_presence", "sfp_eeprom", "sfp_dom", "sfp_control",
+};
+
+static const char* object_names__[ONLPIE_OBJECT_COUNT] = {
+    "port", "thermal", "fan", "psu",
+};
+
+typedef enum distribution_e {
+    DISTRIBUTION_FIXED,
+    DISTRIBUTION_UNIFORM,
+    DISTRIBUTION_NORMAL,
+    DISTRIBUTION_EXPONENTIAL,
+} distribution_t;
+
+static aim_map_si_t distribution_map__[] = {
+    { "fixed", DISTRIBUTION_FIXED },
+    { "uniform", DISTRIBUTION_UNIFORM },
+    { "normal", DISTRIBUTION_NORMAL },
+    { "exponential", DISTRIBUTION_EXPONENTIAL },
+    { NULL, 0 }
+};
+
+typedef struct op_model_s {
+    distribution_t distribution;
+    int latency_us;
+    int jitter_us;
+    double error_rate;
+    int error_status;
+} op_model_t;
+
+/** onlp_sfp_bitmap_t holds 256 ports. */
+#define PORT_MAX 256
+
+/** Presence value for toggle events. */
+#define SCHEDULE_TOGGLE -1
+
+typedef struct schedule_event_s {
+    onlpie_object_t object;
+    int id;
+    uint64_t at_ms;
+    uint64_t period_ms;
+    int present;
+} schedule_event_t;
+
+static struct {
+    onlpie_model_t model;
+    op_model_t ops[ONLPIE_OP_COUNT];
+    schedule_event_t* events;
+    int event_count;
+    uint64_t epoch_ms;
+    unsigned int seed;
+} sim__;
+
+static pthread_once_t sim_once__ = PTHREAD_ONCE_INIT;
+
+/**
+ * The built-in model matches the original example platform.
+ */
+static const char* default_model__ =
+    "{"
+    " \"ports\": { \"first\": 17, \"count\": 4, \"present\": [ 17, 19 ], \"rx_los\": [ 19 ] },"
+    " \"thermals\": ["
+    "  { \"desc\": \"Chassis Thermal Sensor 1\", \"mcelsius\": 23100,"
+    "    \"warning\": 35000, \"error\": 50000, \"shutdown\": 60000 },"
+    "  { \"desc\": \"Chassis Thermal Sensor 2\", \"present\": 0 } ],"
+    " \"fans\": ["
+    "  { \"desc\": \"Chassis Fan 1\", \"rpm\": 9000, \"percentage\": 100, \"mode\": \"MAX\","
+    "    \"model\": \"FAN1Model\", \"serial\": \"FAN1SerialNumber\" },"
+    "  { \"desc\": \"Chassis Fan 2\", \"present\": 0 },"
+    "  { \"desc\": \"PSU-1 Fan 1\", \"rpm\": 5004, \"percentage\": 50, \"psu\": 1 },"
+    "  { \"desc\": \"PSU-1 Fan 2\", \"rpm\": 5020, \"percentage\": 50, \"psu\": 1 } ],"
+    " \"psus\": ["
+    "  { \"desc\": \"PSU-1\", \"model\": \"ONLPIE PSU MODEL (AC)\", \"serial\": \"ONLPIE PSU SN\","
+    "    \"caps\": 57, \"mvin\": 241100, \"mvout\": 122200, \"miin\": 23300, \"miout\": 3440 },"
+    "  { \"desc\": \"PSU-2\", \"present\": 0 },"
+    "  { \"desc\": \"PSU-3\", \"model\": \"ONLPIE PSU MODEL (DC)\", \"serial\": \"ONLPIE PSU SN\","
+    "    \"caps\": 4, \"mvin\": 48100, \"mvout\": 12200, \"miin\": 2300 } ],"
+    " \"leds\": ["
+    "  { \"desc\": \"Chassis LED 1\", \"caps\": 3073, \"mode\": \"RED\" },"
+    "  { \"desc\": \"Chassis LED 2\", \"present\": 0 } ]"
+    "}";
+
+static uint64_t
+realtime_ms__(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static int
+jint__(cJSON* obj, const char* key, int def)
+{
+    int v;
+    if(obj && cjson_util_lookup_int(obj, &v, "%s", key) == 0) {
+        return v;
+    }
+    return def;
+}
+
+static void
+jstr__(cJSON* obj, const char* key, char* dst, int size)
+{
+    char* s = NULL;
+    if(obj && cjson_util_lookup_string(obj, &s, "%s", key) == 0 && s) {
+        aim_strlcpy(dst, s, size);
+    }
+}
+
+static int
+jcount__(cJSON* array)
+{
+    int count = 0;
+    cJSON* e;
+    for(e = (array) ? array->child : NULL; e; e = e->next) {
+        count++;
+    }
+    return count;
+}
+
+static cJSON*
+jget__(cJSON* obj, const char* key)
+{
+    cJSON* rv = NULL;
+    if(obj == NULL || cjson_util_lookup(obj, &rv, "%s", key) < 0) {
+        return NULL;
+    }
+    return rv;
+}
+
+/**
+ * Enum fields may be given as the ONLP enum name or as an integer.
+ */
+static int
+jmode__(cJSON* obj, const char* key, int def,
+        int (*value_f)(const char*, int*, int))
+{
+    int v;
+    char* s = NULL;
+
+    if(obj && cjson_util_lookup_string(obj, &s, "%s", key) == 0 && s) {
+        if(value_f(s, &v, 0) < 0) {
+            AIM_LOG_ERROR("Invalid %s '%s'", key, s);
+            return def;
+        }
+        return v;
+    }
+    return jint__(obj, key, def);
+}
+
+static int
+fan_mode_value__(const char* s, int* v, int substr)
+{
+    onlp_fan_mode_t mode;
+    int rv = onlp_fan_mode_value(s, &mode, substr);
+    *v = mode;
+    return rv;
+}
+
+static int
+led_mode_value__(const char* s, int* v, int substr)
+{
+    onlp_led_mode_t mode;
+    int rv = onlp_led_mode_value(s, &mode, substr);
+    *v = mode;
+    return rv;
+}
+
+/**
+ * Generate a 10G-SR SFP+ A0 page (SFF-8472) for ports without an image.
+ */
+static void
+eeprom_generate__(int port, uint8_t* data)
+{
+    int i;
+    uint8_t cc;
+    char sn[17];
+
+    memset(data, 0, 256);
+    data[0] = 0x03;                     /* SFP/SFP+ */
+    data[1] = 0x04;
+    data[2] = 0x07;                     /* LC */
+    data[3] = 0x10;                     /* 10GBASE-SR */
+    data[11] = 0x06;                    /* 64B/66B */
+    data[12] = 0x67;                    /* 10.3 Gbps */
+    data[17] = 0x08;                    /* 80m OM2 */
+    data[18] = 0x1E;                    /* 300m OM3 */
+    memcpy(data + 20, "ONLPIE          ", 16);
+    memcpy(data + 40, "SIM-SFP-10G-SR  ", 16);
+    memcpy(data + 56, "A   ", 4);
+    data[60] = 0x03;                    /* 850nm */
+    data[61] = 0x52;
+    for(cc = 0, i = 0; i < 63; i++) {
+        cc += data[i];
+    }
+    data[63] = cc;
+
+    snprintf(sn, sizeof(sn), "SIM%013d", port);
+    memcpy(data + 68, sn, 16);
+    memcpy(data + 84, "20140101", 8);
+    data[92] = 0x68;                    /* DDM implemented, internally calibrated */
+    data[94] = 0x08;
+    for(cc = 0, i = 64; i < 95; i++) {
+        cc += data[i];
+    }
+    data[95] = cc;
+}
+
+static void
+port_list_apply__(cJSON* list, int* field, size_t stride)
+{
+    cJSON* e;
+    onlpie_model_t* m = &sim__.model;
+
+    if(list == NULL) {
+        return;
+    }
+    if(list->valuestring && !strcmp(list->valuestring, "all")) {
+        int i;
+        for(i = 0; i < m->port_count; i++) {
+            *(int*)((uint8_t*)field + i*stride) = 1;
+        }
+        return;
+    }
+    for(e = list->child; e; e = e->next) {
+        int port = e->valueint - m->port_first;
+        if(port >= 0 && port < m->port_count) {
+            *(int*)((uint8_t*)field + port*stride) = 1;
+        }
+    }
+}
+
+static void
+ports_load__(cJSON* root)
+{
+    int i;
+    cJSON* ports = jget__(root, "ports");
+    cJSON* eeprom = jget__(ports, "eeprom");
+    onlpie_model_t* m = &sim__.model;
+
+    m->port_first = jint__(ports, "first", 1);
+    m->port_count = jint__(ports, "count", 0);
+    m->ports_per_bus = jint__(ports, "ports_per_bus", 1);
+    if(m->port_count < 0 ||
+       m->port_first < 0 || m->port_first + m->port_count > PORT_MAX) {
+        AIM_LOG_ERROR("Invalid port range %d+%d", m->port_first, m->port_count);
+        m->port_count = 0;
+    }
+    if(m->ports_per_bus < 1) {
+        m->ports_per_bus = 1;
+    }
+
+    m->ports = aim_zmalloc((m->port_count + 1) * sizeof(*m->ports));
+    port_list_apply__(jget__(ports, "present"), &m->ports[0].present, sizeof(*m->ports));
+    port_list_apply__(jget__(ports, "rx_los"), &m->ports[0].rx_los, sizeof(*m->ports));
+
+    for(i = 0; i < m->port_count; i++) {
+        int len = 0;
+        int port = m->port_first + i;
+        uint8_t image[512];
+        char key[16];
+        char file[256] = "";
+
+        snprintf(key, sizeof(key), "%d", port);
+        jstr__(eeprom, "default", file, sizeof(file));
+        jstr__(eeprom, key, file, sizeof(file));
+
+        if(file[0] && onlp_file_read(image, sizeof(image), &len, "%s", file) >= 0 &&
+           len >= 256) {
+            memcpy(m->ports[i].eeprom, image, 256);
+            if(len >= 512) {
+                memcpy(m->ports[i].dom, image + 256, 256);
+            }
+        }
+        else {
+            if(file[0]) {
+                AIM_LOG_ERROR("Cannot read EEPROM image %s for port %d", file, port);
+            }
+            eeprom_generate__(port, m->ports[i].eeprom);
+        }
+    }
+}
+
+static void
+oids_load__(cJSON* root)
+{
+    int i;
+    cJSON* e;
+    cJSON* a;
+    onlpie_model_t* m = &sim__.model;
+
+    a = jget__(root, "thermals");
+    m->thermal_count = jcount__(a) + 1;
+    m->thermals = aim_zmalloc(m->thermal_count * sizeof(*m->thermals));
+    for(i = 1, e = (a) ? a->child : NULL; e; e = e->next, i++) {
+        onlpie_thermal_t* t = m->thermals + i;
+        snprintf(t->desc, sizeof(t->desc), "Thermal %d", i);
+        jstr__(e, "desc", t->desc, sizeof(t->desc));
+        t->present = jint__(e, "present", 1);
+        t->failed = jint__(e, "failed", 0);
+        t->mcelsius = jint__(e, "mcelsius", 25000);
+        t->warning = jint__(e, "warning", 0);
+        t->error = jint__(e, "error", 0);
+        t->shutdown = jint__(e, "shutdown", 0);
+    }
+
+    a = jget__(root, "fans");
+    m->fan_count = jcount__(a) + 1;
+    m->fans = aim_zmalloc(m->fan_count * sizeof(*m->fans));
+    for(i = 1, e = (a) ? a->child : NULL; e; e = e->next, i++) {
+        onlpie_fan_t* f = m->fans + i;
+        snprintf(f->desc, sizeof(f->desc), "Fan %d", i);
+        jstr__(e, "desc", f->desc, sizeof(f->desc));
+        f->present = jint__(e, "present", 1);
+        f->failed = jint__(e, "failed", 0);
+        f->caps = jint__(e, "caps",
+                         ONLP_FAN_CAPS_B2F | ONLP_FAN_CAPS_GET_RPM |
+                         ONLP_FAN_CAPS_GET_PERCENTAGE | ONLP_FAN_CAPS_SET_PERCENTAGE);
+        f->rpm = jint__(e, "rpm", 0);
+        f->percentage = jint__(e, "percentage", 0);
+        f->mode = jmode__(e, "mode", ONLP_FAN_MODE_NORMAL, fan_mode_value__);
+        f->psu = jint__(e, "psu", 0);
+        jstr__(e, "model", f->model, sizeof(f->model));
+        jstr__(e, "serial", f->serial, sizeof(f->serial));
+    }
+
+    a = jget__(root, "psus");
+    m->psu_count = jcount__(a) + 1;
+    m->psus = aim_zmalloc(m->psu_count * sizeof(*m->psus));
+    for(i = 1, e = (a) ? a->child : NULL; e; e = e->next, i++) {
+        onlpie_psu_t* p = m->psus + i;
+        snprintf(p->desc, sizeof(p->desc), "PSU-%d", i);
+        jstr__(e, "desc", p->desc, sizeof(p->desc));
+        p->present = jint__(e, "present", 1);
+        p->failed = jint__(e, "failed", 0);
+        p->caps = jint__(e, "caps",
+                         ONLP_PSU_CAPS_AC | ONLP_PSU_CAPS_VIN | ONLP_PSU_CAPS_VOUT |
+                         ONLP_PSU_CAPS_IIN | ONLP_PSU_CAPS_IOUT |
+                         ONLP_PSU_CAPS_PIN | ONLP_PSU_CAPS_POUT);
+        p->mvin = jint__(e, "mvin", 0);
+        p->mvout = jint__(e, "mvout", 0);
+        p->miin = jint__(e, "miin", 0);
+        p->miout = jint__(e, "miout", 0);
+        p->mpin = jint__(e, "mpin", 0);
+        p->mpout = jint__(e, "mpout", 0);
+        jstr__(e, "model", p->model, sizeof(p->model));
+        jstr__(e, "serial", p->serial, sizeof(p->serial));
+    }
+
+    a = jget__(root, "leds");
+    m->led_count = jcount__(a) + 1;
+    m->leds = aim_zmalloc(m->led_count * sizeof(*m->leds));
+    for(i = 1, e = (a) ? a->child : NULL; e; e = e->next, i++) {
+        onlpie_led_t* l = m->leds + i;
+        snprintf(l->desc, sizeof(l->desc), "LED %d", i);
+        jstr__(e, "desc", l->desc, sizeof(l->desc));
+        l->present = jint__(e, "present", 1);
+        l->caps = jint__(e, "caps", ONLP_LED_CAPS_ON_OFF | ONLP_LED_CAPS_GREEN);
+        l->mode = jmode__(e, "mode", ONLP_LED_MODE_GREEN, led_mode_value__);
+    }
+}
+
+static void
+op_load__(cJSON* obj, op_model_t* op)
+{
+    char dist[32] = "";
+    cJSON* rate;
+
+    if(obj == NULL) {
+        return;
+    }
+
+    op->latency_us = jint__(obj, "latency_us", op->latency_us);
+    op->jitter_us = jint__(obj, "jitter_us", op->jitter_us);
+    op->error_status = jint__(obj, "error_status", op->error_status);
+    if((rate = jget__(obj, "error_rate"))) {
+        op->error_rate = rate->valuedouble;
+    }
+    jstr__(obj, "distribution", dist, sizeof(dist));
+    if(dist[0] && aim_map_si_s((int*)&op->distribution, dist, distribution_map__, 0) == 0) {
+        AIM_LOG_ERROR("Invalid distribution '%s'", dist);
+    }
+}
+
+static void
+ops_load__(cJSON* root)
+{
+    int i;
+    op_model_t def = { DISTRIBUTION_FIXED, 0, 0, 0.0, ONLP_STATUS_E_INTERNAL };
+    cJSON* ops = jget__(root, "ops");
+
+    op_load__(jget__(ops, "default"), &def);
+    for(i = 0; i < ONLPIE_OP_COUNT; i++) {
+        sim__.ops[i] = def;
+        op_load__(jget__(ops, op_names__[i]), &sim__.ops[i]);
+    }
+}
+
+static void
+schedule_load__(cJSON* root)
+{
+    int i, o;
+    cJSON* e;
+    cJSON* a = jget__(root, "schedule");
+
+    sim__.event_count = jcount__(a);
+    sim__.events = aim_zmalloc((sim__.event_count + 1) * sizeof(*sim__.events));
+
+    for(i = 0, e = (a) ? a->child : NULL; e; e = e->next) {
+        schedule_event_t* ev = sim__.events + i;
+        char object[32] = "";
+        char present[32] = "";
+
+        jstr__(e, "object", object, sizeof(object));
+        for(o = 0; o < ONLPIE_OBJECT_COUNT; o++) {
+            if(!strcmp(object, object_names__[o])) {
+                break;
+            }
+        }
+        if(o == ONLPIE_OBJECT_COUNT) {
+            AIM_LOG_ERROR("Invalid schedule object '%s'", object);
+            continue;
+        }
+
+        ev->object = o;
+        ev->id = jint__(e, "id", 0);
+        ev->at_ms = jint__(e, "at_ms", 0);
+        ev->period_ms = jint__(e, "period_ms", 0);
+        jstr__(e, "present", present, sizeof(present));
+        ev->present = (!strcmp(present, "toggle")) ?
+            SCHEDULE_TOGGLE : (jint__(e, "present", 0) != 0);
+        i++;
+    }
+    sim__.event_count = i;
+}
+
+static void
+sim_load__(void)
+{
+    int rv;
+    char* fname;
+    cJSON* root = NULL;
+    struct stat st;
+
+    if( (fname = getenv(ONLPIE_CONFIG_MODEL_ENV)) == NULL) {
+        fname = ONLPIE_CONFIG_MODEL_FILENAME;
+    }
+
+    rv = cjson_util_parse_file(fname, &root);
+    if(rv >= 0 && root && stat(fname, &st) == 0) {
+        AIM_LOG_INFO("Loaded simulation model %s", fname);
+        sim__.epoch_ms = (uint64_t)st.st_mtim.tv_sec * 1000 + st.st_mtim.tv_nsec / 1000000;
+    }
+    else {
+        if(getenv(ONLPIE_CONFIG_MODEL_ENV)) {
+            AIM_LOG_ERROR("Cannot load simulation model %s. Using the built-in model.", fname);
+        }
+        if(root) {
+            cJSON_Delete(root);
+        }
+        root = cJSON_Parse(default_model__);
+        sim__.epoch_ms = realtime_ms__();
+    }
+
+    sim__.seed = jint__(root, "seed", 1);
+    ports_load__(root);
+    oids_load__(root);
+    ops_load__(root);
+    schedule_load__(root);
+
+    cJSON_Delete(root);
+}
+
+onlpie_model_t*
+onlpie_model_get(void)
+{
+    pthread_once(&sim_once__, sim_load__);
+    return &sim__.model;
+}
+
+/**
+ * Uniform random value in (0, 1), per thread.
+ */
+static double
+uniform__(void)
+{
+    static __thread unsigned int seed;
+    static __thread int seeded;
+
+    if(!seeded) {
+        seed = sim__.seed ^ (unsigned int)(uintptr_t)&seed ^ (unsigned int)getpid();
+        seeded = 1;
+    }
+    return (rand_r(&seed) + 1.0) / (RAND_MAX + 2.0);
+}
+
+static int
+latency_sample_us__(op_model_t* op)
+{
+    double v = op->latency_us;
+
+    switch(op->distribution)
+        {
+        case DISTRIBUTION_FIXED:
+            break;
+        case DISTRIBUTION_UNIFORM:
+            v += op->jitter_us * (2 * uniform__() - 1);
+            break;
+        case DISTRIBUTION_NORMAL:
+            v += op->jitter_us * sqrt(-2 * log(uniform__())) * cos(2 * M_PI * uniform__());
+            break;
+        case DISTRIBUTION_EXPONENTIAL:
+            v = -op->latency_us * log(uniform__());
+            break;
+        }
+    return (v > 0) ? (int)v : 0;
+}
+
+static void
+delay_us__(int us)
+{
+    struct timespec ts;
+
+    if(us <= 0) {
+        return;
+    }
+
+    if(us < 100) {
+        /* Too short for the scheduler. Spin instead. */
+        uint64_t end;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        end = (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec + (uint64_t)us * 1000;
+        do {
+            clock_gettime(CLOCK_MONOTONIC, &ts);
+        } while((uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec < end);
+        return;
+    }
+
+    ts.tv_sec = us / 1000000;
+    ts.tv_nsec = (us % 1000000) * 1000;
+    while(nanosleep(&ts, &ts) < 0);
+}
+
+int
+onlpie_sim_op(onlpie_op_t op)
+{
+    op_model_t* m;
+
+    onlpie_model_get();
+    m = sim__.ops + op;
+
+    delay_us__(latency_sample_us__(m));
+
+    if(m->error_rate > 0 && uniform__() < m->error_rate) {
+        AIM_LOG_VERBOSE("Injected error %d for %s", m->error_status, op_names__[op]);
+        return m->error_status;
+    }
+    return 0;
+}
+
+int
+onlpie_sim_present(onlpie_object_t type, int id)
+{
+    int i;
+    int present = 0;
+    uint64_t now;
+    onlpie_model_t* m = onlpie_model_get();
+
+    switch(type)
+        {
+        case ONLPIE_OBJECT_PORT:
+            id -= m->port_first;
+            present = (id >= 0 && id < m->port_count) ? m->ports[id].present : 0;
+            id += m->port_first;
+            break;
+        case ONLPIE_OBJECT_THERMAL:
+            present = ONLPIE_VALID_ID(id, m->thermal_count) ? m->thermals[id].present : 0;
+            break;
+        case ONLPIE_OBJECT_FAN:
+            present = ONLPIE_VALID_ID(id, m->fan_count) ? m->fans[id].present : 0;
+            break;
+        case ONLPIE_OBJECT_PSU:
+            present = ONLPIE_VALID_ID(id, m->psu_count) ? m->psus[id].present : 0;
+            break;
+        default:
+            return 0;
+        }
+
+    if(sim__.event_count == 0) {
+        return present;
+    }
+
+    now = realtime_ms__();
+    now = (now > sim__.epoch_ms) ? now - sim__.epoch_ms : 0;
+
+    for(i = 0; i < sim__.event_count; i++) {
+        schedule_event_t* ev = sim__.events + i;
+        uint64_t n;
+
+        if(ev->object != type || ev->id != id || now < ev->at_ms) {
+            continue;
+        }
+        n = (ev->period_ms) ? (now - ev->at_ms) / ev->period_ms + 1 : 1;
+        if(ev->present == SCHEDULE_TOGGLE) {
+            if(n & 1) {
+                present = !present;
+            }
+        }
+        else {
+            present = ev->present;
+        }
+    }
+    return present;
+}
+
+/**
+ * Port presence notifications.
+ *
+ * A timerfd which expires at the next scheduled port event.
+ * It is re-armed by onlpie_sim_notify_arm() after every scan.
+ */
+static int notify_fd__ = -1;
+static pthread_once_t notify_once__ = PTHREAD_ONCE_INIT;
+
+static void
+notify_init__(void)
+{
+    if( (notify_fd__ = timerfd_create(CLOCK_REALTIME,
+                                      TFD_CLOEXEC | TFD_NONBLOCK)) < 0) {
+        AIM_LOG_ERROR("timerfd_create failed: %{errno}", errno);
+    }
+}
+
+void
+onlpie_sim_notify_arm(onlpie_object_t type)
+{
+    int i;
+    uint64_t now, next = 0;
+    struct itimerspec its;
+
+    if(notify_fd__ < 0) {
+        return;
+    }
+
+    now = realtime_ms__();
+    now = (now > sim__.epoch_ms) ? now - sim__.epoch_ms : 0;
+
+    for(i = 0; i < sim__.event_count; i++) {
+        schedule_event_t* ev = sim__.events + i;
+        uint64_t t;
+
+        if(ev->object != type) {
+            continue;
+        }
+        if(now < ev->at_ms) {
+            t = ev->at_ms;
+        }
+        else if(ev->period_ms) {
+            t = ev->at_ms + ((now - ev->at_ms) / ev->period_ms + 1) * ev->period_ms;
+        }
+        else {
+            continue;
+        }
+        if(next == 0 || t < next) {
+            next = t;
+        }
+    }
+
+    /* A zero expiration disarms the timer. */
+    memset(&its, 0, sizeof(its));
+    if(next) {
+        next += sim__.epoch_ms;
+        its.it_value.tv_sec = next / 1000;
+        its.it_value.tv_nsec = (next % 1000) * 1000000;
+    }
+    timerfd_settime(notify_fd__, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+int
+onlpie_sim_notify_fd(onlpie_object_t type)
+{
+    onlpie_model_get();
+    pthread_once(&notify_once__, notify_init__);
+    if(notify_fd__ < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    onlpie_sim_notify_arm(type);
+    return notify_fd__;
+}
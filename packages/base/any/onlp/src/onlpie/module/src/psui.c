@@ -37,46 +37,47 @@ onlp_psui_init(void)
 /*
  * Get all information about the given PSU oid.
  */
-static onlp_psu_info_t pinfo[] =
-    {
-        { }, /* Not used */
-        {
-            {
-                ONLP_PSU_ID_CREATE(1), "PSU-1", 0,
-                /* This PSU has 2 fans */
-                { ONLP_FAN_ID_CREATE(3), ONLP_FAN_ID_CREATE(4) }
-            },
-            "ONLPIE PSU MODEL (AC)", "ONLPIE PSU SN",
-            0x1,
-            ONLP_PSU_CAPS_AC | ONLP_PSU_CAPS_VIN | ONLP_PSU_CAPS_VOUT | ONLP_PSU_CAPS_IIN,
-            241100,
-            122200,
-            23300,
-            3440,
-            0,
-            0,
-        },
-        {
-            { ONLP_PSU_ID_CREATE(2), "PSU-2", 0 },
-            "", "",
-            0,
-        },
-        {
-            { ONLP_PSU_ID_CREATE(3), "PSU-3", 0 },
-            "ONLPIE PSU MODEL (DC)", "ONLPIE PSU SN",
-            0x1,
-            ONLP_PSU_CAPS_DC48,
-            48100,
-            12200,
-            2300
-        },
-    };
-
-
 int
 onlp_psui_info_get(onlp_oid_t id, onlp_psu_info_t* info)
 {
-    *info = pinfo[ONLP_OID_ID_GET(id)];
+    int i;
+    onlp_oid_t* coid;
+    onlpie_model_t* m = onlpie_model_get();
+    onlpie_psu_t* p;
+    int pid = ONLP_OID_ID_GET(id);
+
+    if(!ONLPIE_VALID_ID(pid, m->psu_count)) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    ONLPIE_SIM_OP(ONLPIE_OP_PSU);
+
+    p = m->psus + pid;
+    memset(info, 0, sizeof(*info));
+    info->hdr.id = id;
+    aim_strlcpy(info->hdr.description, p->desc, sizeof(info->hdr.description));
+
+    coid = info->hdr.coids;
+    for(i = 1; i < m->fan_count; i++) {
+        if(m->fans[i].psu == pid) {
+            *coid++ = ONLP_FAN_ID_CREATE(i);
+        }
+    }
+
+    if(onlpie_sim_present(ONLPIE_OBJECT_PSU, pid)) {
+        info->status = ONLP_PSU_STATUS_PRESENT;
+        if(p->failed) {
+            info->status |= ONLP_PSU_STATUS_FAILED;
+        }
+        info->caps = p->caps;
+        info->mvin = p->mvin;
+        info->mvout = p->mvout;
+        info->miin = p->miin;
+        info->miout = p->miout;
+        info->mpin = p->mpin;
+        info->mpout = p->mpout;
+        aim_strlcpy(info->model, p->model, sizeof(info->model));
+        aim_strlcpy(info->serial, p->serial, sizeof(info->serial));
+    }
     return ONLP_STATUS_OK;
 }
 
@@ -22,6 +22,7 @@
  *
  ***********************************************************/
 #include <onlp/platformi/sfpi.h>
+#include "onlpie_int.h"
 #include "onlpie_log.h"
 
 /*
@@ -53,11 +54,12 @@ onlp_sfpi_init(void)
 int
 onlp_sfpi_bitmap_get(onlp_sfp_bitmap_t* bmap)
 {
-    /* We simulate 4 SFP ports -- 17, 18, 19, and 20 */
-    AIM_BITMAP_SET(bmap, 17);
-    AIM_BITMAP_SET(bmap, 18);
-    AIM_BITMAP_SET(bmap, 19);
-    AIM_BITMAP_SET(bmap, 20);
+    int p;
+    onlpie_model_t* m = onlpie_model_get();
+
+    for(p = 0; p < m->port_count; p++) {
+        AIM_BITMAP_SET(bmap, m->port_first + p);
+    }
     return ONLP_STATUS_OK;
 }
 
@@ -72,30 +74,87 @@ onlp_sfpi_bitmap_get(onlp_sfp_bitmap_t* bmap)
 int
 onlp_sfpi_is_present(int port)
 {
-    /* In this example only ports 17 and 19 have SFPs inserted */
-    if(port == 17 || port == 19) {
-        return 1;
-    }
-    return 0;
+    ONLPIE_SIM_OP(ONLPIE_OP_SFP_PRESENCE);
+    return onlpie_sim_present(ONLPIE_OBJECT_PORT, port);
 }
 
 int
 onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst)
 {
+    int p;
+    onlpie_model_t* m = onlpie_model_get();
+
+    ONLPIE_SIM_OP(ONLPIE_OP_SFP_PRESENCE);
     AIM_BITMAP_CLR_ALL(dst);
-    AIM_BITMAP_SET(dst, 17);
-    AIM_BITMAP_SET(dst, 19);
+    for(p = 0; p < m->port_count; p++) {
+        int port = m->port_first + p;
+        AIM_BITMAP_MOD(dst, port, onlpie_sim_present(ONLPIE_OBJECT_PORT, port));
+    }
+    onlpie_sim_notify_arm(ONLPIE_OBJECT_PORT);
+    return ONLP_STATUS_OK;
+}
+
+/*
+ * The descriptor expires at the next scheduled port
+ * presence change in the simulation model.
+ */
+int
+onlp_sfpi_presence_notify_fd_get(int* fd)
+{
+    int rv = onlpie_sim_notify_fd(ONLPIE_OBJECT_PORT);
+    if(rv < 0) {
+        return rv;
+    }
+    *fd = rv;
     return ONLP_STATUS_OK;
 }
 
 int
 onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst)
 {
+    int p;
+    onlpie_model_t* m = onlpie_model_get();
+
+    ONLPIE_SIM_OP(ONLPIE_OP_SFP_CONTROL);
     AIM_BITMAP_CLR_ALL(dst);
-    AIM_BITMAP_SET(dst, 19);
+    for(p = 0; p < m->port_count; p++) {
+        int port = m->port_first + p;
+        AIM_BITMAP_MOD(dst, port, m->ports[p].rx_los &&
+                       onlpie_sim_present(ONLPIE_OBJECT_PORT, port));
+    }
     return ONLP_STATUS_OK;
 }
 
+/*
+ * Simulated I2C topology. Each group of ports_per_bus ports
+ * shares one adapter. The bus numbers start at
+ * ONLPIE_SIM_BUS_BASE, far above any real adapter, so that
+ * onlp_i2c_root_bus_get() never resolves them through the host's
+ * /sys/bus/i2c and the groups are the simulated buses themselves.
+ */
+#define ONLPIE_SIM_BUS_BASE 0x10000
+
+int
+onlp_sfpi_port_bus_get(int port, int* bus)
+{
+    onlpie_model_t* m = onlpie_model_get();
+
+    port -= m->port_first;
+    if(port < 0 || port >= m->port_count) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    *bus = ONLPIE_SIM_BUS_BASE + port / m->ports_per_bus;
+    return ONLP_STATUS_OK;
+}
+
+static onlpie_port_t*
+port_get__(int port)
+{
+    onlpie_model_t* m = onlpie_model_get();
+    port -= m->port_first;
+    return (port >= 0 && port < m->port_count) ? m->ports + port : NULL;
+}
+
 /*
  * This function reads the SFPs idrom and returns in
  * in the data buffer provided.
@@ -103,14 +162,103 @@ onlp_sfpi_rx_los_bitmap_get(onlp_sfp_bitmap_t* dst)
 int
 onlp_sfpi_eeprom_read(int port, uint8_t data[256])
 {
-    if(port == 17 || port == 19) {
-        /* These ports have SFPs inserted in this example */
-        return ONLP_STATUS_OK;
+    onlpie_port_t* p = port_get__(port);
+
+    ONLPIE_SIM_OP(ONLPIE_OP_SFP_EEPROM);
+    if(p == NULL || !onlpie_sim_present(ONLPIE_OBJECT_PORT, port)) {
+        return ONLP_STATUS_E_MISSING;
     }
-    else {
-        /* These ports have no SFPs inserted. */
+    memcpy(data, p->eeprom, 256);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_dom_read(int port, uint8_t data[256])
+{
+    onlpie_port_t* p = port_get__(port);
+
+    ONLPIE_SIM_OP(ONLPIE_OP_SFP_DOM);
+    if(p == NULL || !onlpie_sim_present(ONLPIE_OBJECT_PORT, port)) {
         return ONLP_STATUS_E_MISSING;
     }
+    memcpy(data, p->dom, 256);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_control_supported(int port, onlp_sfp_control_t control, int* rv)
+{
+    switch(control)
+        {
+        case ONLP_SFP_CONTROL_RESET_STATE:
+        case ONLP_SFP_CONTROL_RX_LOS:
+        case ONLP_SFP_CONTROL_TX_FAULT:
+        case ONLP_SFP_CONTROL_TX_DISABLE:
+        case ONLP_SFP_CONTROL_LP_MODE:
+            *rv = 1;
+            break;
+        default:
+            *rv = 0;
+            break;
+        }
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_control_set(int port, onlp_sfp_control_t control, int value)
+{
+    onlpie_port_t* p = port_get__(port);
+
+    if(p == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+
+    switch(control)
+        {
+        case ONLP_SFP_CONTROL_RESET_STATE:
+        case ONLP_SFP_CONTROL_TX_DISABLE:
+        case ONLP_SFP_CONTROL_LP_MODE:
+            ONLPIE_SIM_OP(ONLPIE_OP_SFP_CONTROL);
+            if(value) {
+                p->controls |= (1 << control);
+            }
+            else {
+                p->controls &= ~(1 << control);
+            }
+            return ONLP_STATUS_OK;
+        default:
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+}
+
+int
+onlp_sfpi_control_get(int port, onlp_sfp_control_t control, int* value)
+{
+    onlpie_port_t* p = port_get__(port);
+
+    if(p == NULL) {
+        return ONLP_STATUS_E_INVALID;
+    }
+
+    switch(control)
+        {
+        case ONLP_SFP_CONTROL_RX_LOS:
+            ONLPIE_SIM_OP(ONLPIE_OP_SFP_CONTROL);
+            *value = p->rx_los;
+            return ONLP_STATUS_OK;
+        case ONLP_SFP_CONTROL_TX_FAULT:
+            ONLPIE_SIM_OP(ONLPIE_OP_SFP_CONTROL);
+            *value = 0;
+            return ONLP_STATUS_OK;
+        case ONLP_SFP_CONTROL_RESET_STATE:
+        case ONLP_SFP_CONTROL_TX_DISABLE:
+        case ONLP_SFP_CONTROL_LP_MODE:
+            ONLPIE_SIM_OP(ONLPIE_OP_SFP_CONTROL);
+            *value = !!(p->controls & (1 << control));
+            return ONLP_STATUS_OK;
+        default:
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
 }
 
 /*
@@ -186,7 +334,13 @@ onlp_sfpi_denit(void)
 void
 onlp_sfpi_debug(int port, aim_pvs_t* pvs)
 {
-    aim_printf(pvs, "Debug data for port %d goes here.", port);
+    onlpie_port_t* p = port_get__(port);
+
+    if(p) {
+        aim_printf(pvs, "Simulated port %d: present=%d rx_los=%d controls=0x%x\n",
+                   port, onlpie_sim_present(ONLPIE_OBJECT_PORT, port),
+                   p->rx_los, p->controls);
+    }
 }
 
 /*
@@ -24,6 +24,7 @@
  ***********************************************************/
 #include <onlp/platformi/sysi.h>
 #include <onlplib/crc32.h>
+#include "onlpie_int.h"
 #include "onlpie_log.h"
 
 
@@ -76,6 +77,7 @@ int
 onlp_sysi_init(void)
 {
     AIM_LOG_MSG("%s", __func__);
+    onlpie_model_get();
     return ONLP_STATUS_OK;
 }
 
@@ -158,29 +160,41 @@ onlp_sysi_platform_manage(void)
      */
 }
 
+/*
+ * Writes to the model are per object and the simulation keeps no
+ * other shared state, so all lock domains may run concurrently.
+ */
+int
+onlp_sysi_api_lock_domains(void)
+{
+    return 1;
+}
+
 int
 onlp_sysi_oids_get(onlp_oid_t* table, int max)
 {
+    int i;
     onlp_oid_t* e = table;
-    memset(table, 0, max*sizeof(onlp_oid_t));
-
-    /* This example supports 2 Thermal sensors on the chassis */
-    *e++ = ONLP_THERMAL_ID_CREATE(1);
-    *e++ = ONLP_THERMAL_ID_CREATE(2);
+    onlp_oid_t* end = table + max;
+    onlpie_model_t* m = onlpie_model_get();
 
-    /* 3 PSUs */
-    *e++ = ONLP_PSU_ID_CREATE(1);
-    *e++ = ONLP_PSU_ID_CREATE(2);
-    *e++ = ONLP_PSU_ID_CREATE(3);
-
-    /* 2 Fans */
-    *e++ = ONLP_FAN_ID_CREATE(1);
-    *e++ = ONLP_FAN_ID_CREATE(2);
+    memset(table, 0, max*sizeof(onlp_oid_t));
 
-    /* 2 LEDs */
-    *e++ = ONLP_LED_ID_CREATE(1);
-    *e++ = ONLP_LED_ID_CREATE(2);
+    for(i = 1; i < m->thermal_count && e < end; i++) {
+        *e++ = ONLP_THERMAL_ID_CREATE(i);
+    }
+    for(i = 1; i < m->psu_count && e < end; i++) {
+        *e++ = ONLP_PSU_ID_CREATE(i);
+    }
+    /* PSU fans are children of their PSU. */
+    for(i = 1; i < m->fan_count && e < end; i++) {
+        if(m->fans[i].psu == 0) {
+            *e++ = ONLP_FAN_ID_CREATE(i);
+        }
+    }
+    for(i = 1; i < m->led_count && e < end; i++) {
+        *e++ = ONLP_LED_ID_CREATE(i);
+    }
 
     return 0;
 }
-
@@ -23,6 +23,7 @@
  *
  ***********************************************************/
 #include <onlp/platformi/thermali.h>
+#include "onlpie_int.h"
 #include "onlpie_log.h"
 
 /*
@@ -49,15 +50,38 @@ onlp_thermali_init(void)
 int
 onlp_thermali_info_get(onlp_oid_t id, onlp_thermal_info_t* rv)
 {
-    /* Static values */
-    onlp_thermal_info_t info[] = {
-        { }, /* Not used */
-        { { ONLP_THERMAL_ID_CREATE(1), "Chassis Thermal Sensor 1", 0}, 0x1,
-          ONLP_THERMAL_CAPS_ALL,
-          23100, { 35000, 50000, 60000 }, },
-        { { ONLP_THERMAL_ID_CREATE(2), "Chassis Thermal Sensor 2", 0}, 0x0, 0 }
-    };
-    *rv = info[ONLP_OID_ID_GET(id)];
+    onlpie_model_t* m = onlpie_model_get();
+    onlpie_thermal_t* t;
+    int tid = ONLP_OID_ID_GET(id);
 
+    if(!ONLPIE_VALID_ID(tid, m->thermal_count)) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    ONLPIE_SIM_OP(ONLPIE_OP_THERMAL);
+
+    t = m->thermals + tid;
+    memset(rv, 0, sizeof(*rv));
+    rv->hdr.id = id;
+    aim_strlcpy(rv->hdr.description, t->desc, sizeof(rv->hdr.description));
+    if(onlpie_sim_present(ONLPIE_OBJECT_THERMAL, tid)) {
+        rv->status = ONLP_THERMAL_STATUS_PRESENT;
+        if(t->failed) {
+            rv->status |= ONLP_THERMAL_STATUS_FAILED;
+        }
+        rv->caps = ONLP_THERMAL_CAPS_GET_TEMPERATURE;
+        rv->mcelsius = t->mcelsius;
+        if(t->warning) {
+            rv->caps |= ONLP_THERMAL_CAPS_GET_WARNING_THRESHOLD;
+            rv->thresholds.warning = t->warning;
+        }
+        if(t->error) {
+            rv->caps |= ONLP_THERMAL_CAPS_GET_ERROR_THRESHOLD;
+            rv->thresholds.error = t->error;
+        }
+        if(t->shutdown) {
+            rv->caps |= ONLP_THERMAL_CAPS_GET_SHUTDOWN_THRESHOLD;
+            rv->thresholds.shutdown = t->shutdown;
+        }
+    }
     return ONLP_STATUS_OK;
 }
@@ -0,0 +1,184 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * BMC Console Sessions
+ *
+ * Some platforms can only reach their fans, PSUs and thermal
+ * sensors through a shell on the BMC serial console. This module
+ * keeps that console open and logged in and runs commands on it.
+ *
+ * Several commands can be sent in a single round trip. Each
+ * command is followed by a sentinel which carries its exit status,
+ * so the output is split without waiting for fixed delays.
+ *
+ * Read results may be cached for a short time.
+ *
+ * The console is shared between processes. It is locked with
+ * flock() for the duration of each round trip.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_BMC_H__
+#define __ONLPLIB_BMC_H__
+
+#include <onlplib/onlplib_config.h>
+#include <stdint.h>
+
+/**
+ * BMC session configuration.
+ */
+typedef struct onlp_bmc_config_s {
+    /** Console device, e.g. "/dev/ttyACM0". */
+    const char* device;
+
+    /** Line speed, e.g. B57600. */
+    int speed;
+
+    /** Shell prompt substring, e.g. "@bmc:". */
+    const char* prompt;
+
+    /** Login credentials. */
+    const char* user;
+    const char* password;
+
+    /** Login step timeout. */
+    uint32_t login_timeout_ms;
+
+    /** Timeout for a round trip. */
+    uint32_t command_timeout_ms;
+
+    /** Lifetime of cached read results. 0 disables caching. */
+    uint32_t cache_ms;
+
+} onlp_bmc_config_t;
+
+/**
+ * @brief BMC session handle.
+ */
+typedef struct onlp_bmc_session_s onlp_bmc_session_t;
+
+/**
+ * @brief Open a BMC session.
+ * @param config The session configuration. It is copied.
+ * @param rv Receives the session.
+ * @note Login happens on first use.
+ */
+int onlp_bmc_session_open(const onlp_bmc_config_t* config,
+                          onlp_bmc_session_t** rv);
+
+/**
+ * @brief Open a BMC session on an existing descriptor.
+ * @param config The session configuration. The device and speed are ignored.
+ * @param fd The console descriptor. The session owns it.
+ * @param rv Receives the session.
+ * @note The line settings of fd are not changed. This is used to
+ * attach to a pty.
+ */
+int onlp_bmc_session_open_fd(const onlp_bmc_config_t* config, int fd,
+                             onlp_bmc_session_t** rv);
+
+/**
+ * @brief Close a BMC session.
+ * @param session The session.
+ */
+void onlp_bmc_session_close(onlp_bmc_session_t* session);
+
+/**
+ * A single command in a round trip.
+ */
+typedef struct onlp_bmc_request_s {
+    /** The shell command, without line terminator. */
+    const char* cmd;
+
+    /** Receives the command output, without echo or prompt. */
+    char* resp;
+    int size;
+
+    /** The result may be served from, and stored in, the cache. */
+    int cache;
+
+    /** Receives the command exit status, or a negative ONLP status. */
+    int status;
+
+} onlp_bmc_request_t;
+
+/**
+ * @brief Run commands on the BMC.
+ * @param session The session.
+ * @param requests The commands.
+ * @param count The number of commands.
+ * @returns 0 if all commands ran. Per-command results are in the requests.
+ * @note Commands which are not served from the cache are sent
+ * together, split over as few round trips as the console line
+ * length allows.
+ */
+int onlp_bmc_request(onlp_bmc_session_t* session,
+                     onlp_bmc_request_t* requests, int count);
+
+/**
+ * @brief Run a single command on the BMC.
+ * @param session The session.
+ * @param cmd The shell command.
+ * @param resp Receives the output. May be NULL.
+ * @param size The size of resp.
+ * @returns The command exit status, or a negative ONLP status.
+ */
+int onlp_bmc_command(onlp_bmc_session_t* session, const char* cmd,
+                     char* resp, int size);
+
+/**
+ * @brief Run a single read command on the BMC, using the cache.
+ * @see onlp_bmc_command
+ */
+int onlp_bmc_read(onlp_bmc_session_t* session, const char* cmd,
+                  char* resp, int size);
+
+/**
+ * @brief Drop all cached results.
+ * @param session The session.
+ */
+void onlp_bmc_cache_invalidate(onlp_bmc_session_t* session);
+
+/**
+ * BMC session statistics.
+ */
+typedef struct onlp_bmc_stats_s {
+    /** Round trips on the console. */
+    uint64_t round_trips;
+    /** Commands sent. */
+    uint64_t commands;
+    /** Commands served from the cache. */
+    uint64_t cache_hits;
+    /** Logins performed. */
+    uint64_t logins;
+    /** Round trips which timed out. */
+    uint64_t timeouts;
+} onlp_bmc_stats_t;
+
+/**
+ * @brief Get the session statistics.
+ * @param session The session.
+ * @param stats Receives the statistics.
+ * @param clear Clear the statistics after reading.
+ */
+void onlp_bmc_stats_get(onlp_bmc_session_t* session,
+                        onlp_bmc_stats_t* stats, int clear);
+
+#endif /* __ONLPLIB_BMC_H__ */
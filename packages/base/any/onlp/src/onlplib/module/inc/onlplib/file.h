@@ -197,4 +197,140 @@ int onlp_file_vopen(int flags, int log, const char* fmt, va_list vargs);
  */
 int onlp_file_find(char* root, char* fname, char** rpath);
 
+/**
+ * @brief Enable or disable the file cache.
+ * @param enable Enable the cache.
+ * @returns The previous setting.
+ * @note When enabled, the paths of filenames containing '*' are
+ * remembered, and sysfs attributes read through onlp_file_read()
+ * and friends are kept open and reread in place.
+ */
+int onlp_file_cache_enable(int enable);
+
+/**
+ * @brief Close all cached descriptors and forget all cached paths.
+ * @note This should be called if the devices behind cached
+ * filenames are replaced, e.g. after reloading a driver.
+ * Attributes which disappear are dropped from the cache
+ * automatically.
+ */
+void onlp_file_cache_flush(void);
+
+/**
+ * File access counters.
+ */
+typedef struct onlp_file_stats_s {
+    /** Number of directory searches for filenames containing '*'. */
+    uint64_t searches;
+
+    /** Number of files opened. */
+    uint64_t opens;
+
+    /** Number of reads from an already open descriptor. */
+    uint64_t rereads;
+
+    /** Number of cached paths and descriptors dropped. */
+    uint64_t flushes;
+
+    /** Number of accesses done uncached because the cache entry was in use. */
+    uint64_t busy;
+
+} onlp_file_stats_t;
+
+/**
+ * @brief Get the file access counters.
+ * @param stats [out] Receives the counters.
+ * @param clear Reset the counters after reading.
+ */
+void onlp_file_stats_get(onlp_file_stats_t* stats, int clear);
+
+/**
+ * @brief Show the file access counters.
+ * @param pvs The output pvs.
+ */
+void onlp_file_stats_show(aim_pvs_t* pvs);
+
+/**
+ * Attribute vectors.
+ *
+ * A vector is a set of attributes (usually sysfs) which are read
+ * together. The attributes are registered once. Each is opened on
+ * first use and then kept open and reread in place, so reading
+ * the whole vector costs one read per attribute.
+ */
+typedef struct onlp_file_vec_s onlp_file_vec_t;
+
+/**
+ * Attribute value types.
+ */
+typedef enum onlp_file_vec_type_e {
+    /** A decimal integer. */
+    ONLP_FILE_VEC_TYPE_INT,
+    /** A string. Trailing newlines are removed. */
+    ONLP_FILE_VEC_TYPE_STR,
+} onlp_file_vec_type_t;
+
+/**
+ * The value of one attribute.
+ */
+typedef struct onlp_file_vec_result_s {
+    /** ONLP_STATUS_OK, or the error for this attribute. */
+    int status;
+
+    /** ONLP_FILE_VEC_TYPE_INT value. */
+    int value;
+
+    /** ONLP_FILE_VEC_TYPE_STR value. */
+    char str[ONLPLIB_CONFIG_FILE_VEC_STR_MAX];
+
+} onlp_file_vec_result_t;
+
+/**
+ * @brief Create an empty attribute vector.
+ * @param rv Receives the vector.
+ */
+int onlp_file_vec_create(onlp_file_vec_t** rv);
+
+/**
+ * @brief Destroy an attribute vector.
+ * @param vec The vector.
+ */
+void onlp_file_vec_destroy(onlp_file_vec_t* vec);
+
+/**
+ * @brief Add an attribute to a vector.
+ * @param vec The vector.
+ * @param type The value type.
+ * @param fmt The filename format string.
+ * @param vargs The filename format string arguments.
+ * @returns The index of the attribute in the results.
+ * @note The attribute does not need to exist yet.
+ */
+int onlp_file_vec_vadd(onlp_file_vec_t* vec, onlp_file_vec_type_t type,
+                       const char* fmt, va_list vargs);
+
+/**
+ * @brief Add an attribute to a vector.
+ * @see onlp_file_vec_vadd
+ */
+int onlp_file_vec_add(onlp_file_vec_t* vec, onlp_file_vec_type_t type,
+                      const char* fmt, ...);
+
+/**
+ * @brief The number of attributes in a vector.
+ * @param vec The vector.
+ */
+int onlp_file_vec_count(onlp_file_vec_t* vec);
+
+/**
+ * @brief Read all attributes in a vector.
+ * @param vec The vector.
+ * @param results Receives one result per attribute, in the order
+ * they were added.
+ * @returns The number of attributes read successfully.
+ * @note Attributes which cannot be read are reopened on the
+ * next call.
+ */
+int onlp_file_vec_read(onlp_file_vec_t* vec, onlp_file_vec_result_t* results);
+
 #endif /* __ONLPLIB_FILE_H__ */
@@ -86,6 +86,54 @@
  */
 int onlp_i2c_open(int bus, uint8_t addr, uint32_t flags);
 
+/**
+ * @brief Close the cached descriptors for a bus.
+ * @param bus The i2c bus number, or -1 for all buses.
+ * @note Descriptors are reopened on the next transaction.
+ * This should be called if the bus adapters are reloaded.
+ */
+int onlp_i2c_flush(int bus);
+
+/**
+ * I2C transaction counters.
+ */
+typedef struct onlp_i2c_stats_s {
+    /** Number of /dev/i2c-N opens. */
+    uint64_t opens;
+
+    /** Number of I2C_TENBIT, I2C_PEC and I2C_SLAVE ioctls. */
+    uint64_t ioctls;
+
+    /** Number of transactions using an already open descriptor. */
+    uint64_t reuses;
+
+    /** Number of cached descriptors closed by flushes or descriptor errors. */
+    uint64_t flushes;
+
+    /** Number of I2C_RDWR transfers. */
+    uint64_t transfers;
+
+    /** Number of mux control register writes. */
+    uint64_t mux_writes;
+
+    /** Number of mux writes skipped because the channel was already selected. */
+    uint64_t mux_skips;
+
+} onlp_i2c_stats_t;
+
+/**
+ * @brief Get the I2C transaction counters.
+ * @param stats [out] Receives the counters.
+ * @param clear Reset the counters after reading.
+ */
+void onlp_i2c_stats_get(onlp_i2c_stats_t* stats, int clear);
+
+/**
+ * @brief Show the I2C transaction counters.
+ * @param pvs The output pvs.
+ */
+void onlp_i2c_stats_show(aim_pvs_t* pvs);
+
 
 /**
  * @brief Read i2c data.
@@ -109,7 +157,10 @@ int onlp_i2c_read(int bus, uint8_t addr, uint8_t offset, int size,
  * @param offset The starting offset.
  * @param size The byte count.
  * @param flags Seel ONLP_I2C_F_*
- * @note This function reads in increments of ONLPLIB_CONFIG_I2C_BLOCK_SIZE
+ * @note This function reads in increments of ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE
+ * using combined transfers if supported by the adapter, and in increments of
+ * ONLPLIB_CONFIG_I2C_BLOCK_SIZE otherwise. Either way the read fails if a
+ * kernel driver owns the address, unless ONLP_I2C_F_FORCE is specified.
  */
 int onlp_i2c_block_read(int bus, uint8_t addr, uint8_t offset, int size,
                         uint8_t* rdata, uint32_t flags);
@@ -182,6 +233,77 @@ int onlp_i2c_writew(int bus, uint8_t addr, uint8_t offset, uint16_t word,
                     uint32_t flags);
 
 
+/****************************************************************************
+ *
+ * Combined I2C transactions.
+ *
+ * A transfer is a sequence of messages executed by the adapter in a
+ * single I2C_RDWR request, separated by repeated starts unless a
+ * message requests a STOP.
+ *
+ ***************************************************************************/
+
+/** This message is a read. The default is a write. */
+#define ONLP_I2C_MSG_F_READ 0x1
+
+/**
+ * Issue a STOP after this message.
+ * Requires adapter protocol mangling support.
+ */
+#define ONLP_I2C_MSG_F_STOP 0x2
+
+/**
+ * A single transfer message.
+ */
+typedef struct onlp_i2c_msg_s {
+    /** Slave address. */
+    uint8_t addr;
+
+    /** See ONLP_I2C_MSG_F_* */
+    uint16_t flags;
+
+    /** Data length. */
+    uint16_t len;
+
+    /** Data buffer. */
+    uint8_t* buf;
+
+} onlp_i2c_msg_t;
+
+/** The maximum number of messages in a single transfer. */
+#define ONLP_I2C_TRANSFER_MSGS_MAX 32
+
+/**
+ * @brief Determine whether a bus supports combined transfers.
+ * @param bus The i2c bus number.
+ * @param stop Also require support for ONLP_I2C_MSG_F_STOP.
+ * @returns 1 if supported, 0 if not, < 0 on error.
+ */
+int onlp_i2c_transfer_supported(int bus, int stop);
+
+/**
+ * @brief Execute a combined transfer.
+ * @param bus The i2c bus number.
+ * @param msgs The messages.
+ * @param count The number of messages.
+ * @param flags See ONLP_I2C_F_*
+ * @returns ONLP_STATUS_E_UNSUPPORTED if the adapter cannot execute the transfer.
+ * @note Transfers containing reads are retried unless ONLP_I2C_F_DISABLE_READ_RETRIES is specified.
+ * @note I2C_RDWR does not check whether a kernel driver owns the addresses.
+ */
+int onlp_i2c_transfer(int bus, onlp_i2c_msg_t* msgs, int count, uint32_t flags);
+
+/**
+ * @brief Get the root adapter of a bus.
+ * @param bus The i2c bus number.
+ * @returns The number of the physical adapter which carries the bus.
+ * This is the bus itself unless it is a mux channel.
+ * @note Buses with different root adapters can be accessed in parallel.
+ */
+int onlp_i2c_root_bus_get(int bus);
+
+
+
 
 /****************************************************************************
  *
@@ -270,6 +392,26 @@ typedef struct onlp_i2c_dev_s {
 } onlp_i2c_dev_t;
 
 
+/**
+ * @brief Enable or disable the mux cache.
+ * @param enable Nonzero to skip writes which would not change a mux's channel.
+ * @returns The previous setting.
+ * @note Writes are only skipped by the onlp_i2c_dev_*() functions, which
+ * hold a per-bus lock from the mux selects until the device access
+ * has completed. Direct mux selects always write the mux.
+ * @note Mux devices are identified by their descriptor. Each physical
+ * mux must be described by a single onlp_i2c_mux_device_t.
+ */
+int onlp_i2c_mux_cache_enable(int enable);
+
+/**
+ * @brief Forget the cached channel selections for a bus.
+ * @param bus The i2c bus number, or -1 for all buses.
+ * @note This should be called if the muxes may have been reset or
+ * reprogrammed outside of this library.
+ */
+void onlp_i2c_mux_cache_invalidate(int bus);
+
 /**
  * @brief Select a mux channel.
  * @param muxdev The mux device instance.
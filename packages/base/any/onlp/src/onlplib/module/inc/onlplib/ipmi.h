@@ -0,0 +1,317 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * In-process IPMI
+ *
+ * Requests go to the BMC system interface through the kernel
+ * IPMI device (/dev/ipmi0). The device stays open. Requests are
+ * sent without waiting, so several can be outstanding, and
+ * responses are matched to their requests by message id.
+ *
+ * Helpers are provided for sensor readings from the SDR
+ * repository and for FRU product and board information.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_IPMI_H__
+#define __ONLPLIB_IPMI_H__
+
+#include <onlplib/onlplib_config.h>
+#include <stdint.h>
+
+#define ONLP_IPMI_NETFN_SENSOR  0x04
+#define ONLP_IPMI_NETFN_APP     0x06
+#define ONLP_IPMI_NETFN_STORAGE 0x0A
+
+/**
+ * IPMI transport.
+ *
+ * The default transport uses the kernel IPMI device. Another
+ * transport can be supplied, e.g. to run against a simulated BMC.
+ */
+typedef struct onlp_ipmi_transport_s {
+    /**
+     * Send a request. Must not wait for the response.
+     */
+    int (*send)(void* cookie, long msgid, uint8_t netfn, uint8_t cmd,
+                const uint8_t* data, int len);
+
+    /**
+     * Receive a pending response.
+     * @param msgid Receives the message id of the request.
+     * @param data Receives the completion code followed by the response data.
+     * @param len The size of data on input, the response length on output.
+     * @returns 0 on success, ONLP_STATUS_E_MISSING if no response is pending.
+     */
+    int (*recv)(void* cookie, long* msgid, uint8_t* data, int* len);
+
+    /**
+     * Descriptor which becomes readable when a response is pending.
+     */
+    int (*fd)(void* cookie);
+
+    /**
+     * Release the transport. May be NULL.
+     */
+    void (*close)(void* cookie);
+
+} onlp_ipmi_transport_t;
+
+/**
+ * @brief IPMI handle.
+ */
+typedef struct onlp_ipmi_s onlp_ipmi_t;
+
+/**
+ * @brief Open the kernel IPMI device.
+ * @param device The device, or NULL for ONLPLIB_CONFIG_IPMI_DEVICE.
+ * @param rv Receives the handle.
+ */
+int onlp_ipmi_open(const char* device, onlp_ipmi_t** rv);
+
+/**
+ * @brief Open a handle on a custom transport.
+ * @param transport The transport.
+ * @param cookie Passed to the transport functions.
+ * @param rv Receives the handle.
+ */
+int onlp_ipmi_open_transport(const onlp_ipmi_transport_t* transport,
+                             void* cookie, onlp_ipmi_t** rv);
+
+/**
+ * @brief Close a handle.
+ */
+void onlp_ipmi_close(onlp_ipmi_t* ipmi);
+
+/**
+ * A single IPMI request.
+ */
+typedef struct onlp_ipmi_request_s {
+    uint8_t netfn;
+    uint8_t cmd;
+    const uint8_t* data;
+    int len;
+
+    /** Receives the response data, without the completion code. */
+    uint8_t* resp;
+    int size;
+
+    /** Receives the response data length. */
+    int rlen;
+
+    /** Receives the completion code. */
+    uint8_t ccode;
+
+    /** Receives 0, or a negative ONLP status if there was no response. */
+    int status;
+
+} onlp_ipmi_request_t;
+
+/**
+ * @brief Run requests.
+ * @param ipmi The handle.
+ * @param requests The requests.
+ * @param count The number of requests.
+ * @returns 0 if all requests received a response.
+ * @note Up to ONLPLIB_CONFIG_IPMI_OUTSTANDING requests are in
+ * flight at the same time. Responses may arrive in any order.
+ */
+int onlp_ipmi_request(onlp_ipmi_t* ipmi,
+                      onlp_ipmi_request_t* requests, int count);
+
+/**
+ * @brief Run a single request.
+ * @returns The response length, or a negative ONLP status. A non-zero
+ * completion code is reported as ONLP_STATUS_E_INTERNAL.
+ */
+int onlp_ipmi_raw(onlp_ipmi_t* ipmi, uint8_t netfn, uint8_t cmd,
+                  const uint8_t* data, int len,
+                  uint8_t* resp, int size);
+
+/**
+ * @brief Read a sensor by name.
+ * @param ipmi The handle.
+ * @param name The sensor ID string from the SDR repository.
+ * @param value Receives the converted reading.
+ * @note The SDR repository is read on first use and kept.
+ * @returns ONLP_STATUS_E_MISSING if there is no such sensor, or
+ * ONLP_STATUS_E_UNSUPPORTED if its reading cannot be converted.
+ */
+int onlp_ipmi_sensor_get(onlp_ipmi_t* ipmi, const char* name, double* value);
+
+/**
+ * Sensor thresholds, in the order used by Get Sensor Thresholds.
+ */
+typedef enum onlp_ipmi_threshold_e {
+    ONLP_IPMI_THRESHOLD_LNC,
+    ONLP_IPMI_THRESHOLD_LCR,
+    ONLP_IPMI_THRESHOLD_LNR,
+    ONLP_IPMI_THRESHOLD_UNC,
+    ONLP_IPMI_THRESHOLD_UCR,
+    ONLP_IPMI_THRESHOLD_UNR,
+    ONLP_IPMI_THRESHOLD_COUNT,
+} onlp_ipmi_threshold_t;
+
+/** The reading is available and was converted. */
+#define ONLP_IPMI_SENSOR_F_VALID    0x01
+/** The sensor is discrete. The reading is in state, not value. */
+#define ONLP_IPMI_SENSOR_F_DISCRETE 0x02
+
+/**
+ * A sensor and its current reading.
+ */
+typedef struct onlp_ipmi_sensor_s {
+    /** The sensor ID string from the SDR repository. */
+    char name[33];
+    uint8_t number;
+
+    /** Sensor type and base unit codes. */
+    uint8_t type;
+    uint8_t units;
+
+    /** ONLP_IPMI_SENSOR_F_* */
+    uint8_t flags;
+
+    /** Converted reading of a threshold sensor. */
+    double value;
+
+    /** State bits of a discrete sensor. */
+    uint16_t state;
+
+    /** Bitmap of the thresholds which are set, by onlp_ipmi_threshold_t. */
+    uint8_t thresholds;
+    double threshold[ONLP_IPMI_THRESHOLD_COUNT];
+
+} onlp_ipmi_sensor_t;
+
+/**
+ * @brief Read all sensors.
+ * @param ipmi The handle.
+ * @param sensors Receives the sensors, in SDR repository order.
+ * @param max The size of sensors.
+ * @returns The number of sensors, or a negative ONLP status.
+ * @note The readings and thresholds of all sensors are requested
+ * together. Bridged sensors are listed without a reading.
+ */
+int onlp_ipmi_sensor_list(onlp_ipmi_t* ipmi,
+                          onlp_ipmi_sensor_t* sensors, int max);
+
+/**
+ * A FRU device from the SDR repository.
+ */
+typedef struct onlp_ipmi_fru_locator_s {
+    /** The device ID string, e.g. "FRU_PSUL". */
+    char name[33];
+    uint8_t id;
+} onlp_ipmi_fru_locator_t;
+
+/**
+ * @brief List the FRU devices.
+ * @param ipmi The handle.
+ * @param frus Receives the logical FRU devices behind the BMC.
+ * @param max The size of frus.
+ * @returns The number of FRU devices, or a negative ONLP status.
+ */
+int onlp_ipmi_fru_list(onlp_ipmi_t* ipmi,
+                       onlp_ipmi_fru_locator_t* frus, int max);
+
+/**
+ * @brief Read a FRU device.
+ * @param ipmi The handle.
+ * @param id The FRU device id.
+ * @param data Receives the FRU contents.
+ * @param size The size of data.
+ * @returns The number of bytes read, or a negative ONLP status.
+ */
+int onlp_ipmi_fru_read(onlp_ipmi_t* ipmi, uint8_t id, uint8_t* data, int size);
+
+/**
+ * FRU product info area fields, in area order.
+ */
+typedef enum onlp_ipmi_fru_product_e {
+    ONLP_IPMI_FRU_PRODUCT_MANUFACTURER,
+    ONLP_IPMI_FRU_PRODUCT_NAME,
+    ONLP_IPMI_FRU_PRODUCT_PART_NUMBER,
+    ONLP_IPMI_FRU_PRODUCT_VERSION,
+    ONLP_IPMI_FRU_PRODUCT_SERIAL,
+    ONLP_IPMI_FRU_PRODUCT_ASSET_TAG,
+    ONLP_IPMI_FRU_PRODUCT_COUNT,
+} onlp_ipmi_fru_product_t;
+
+/**
+ * @brief Get a field from the FRU product info area.
+ * @param fru The FRU contents.
+ * @param size The size of the FRU contents.
+ * @param field The field.
+ * @param dst Receives the field as a string.
+ * @param dsize The size of dst.
+ */
+int onlp_ipmi_fru_product_get(const uint8_t* fru, int size,
+                              onlp_ipmi_fru_product_t field,
+                              char* dst, int dsize);
+
+/**
+ * FRU board info area fields, in area order. The custom fields
+ * follow, ONLP_IPMI_FRU_BOARD_CUSTOM + n is the nth custom field.
+ */
+typedef enum onlp_ipmi_fru_board_e {
+    ONLP_IPMI_FRU_BOARD_MANUFACTURER,
+    ONLP_IPMI_FRU_BOARD_NAME,
+    ONLP_IPMI_FRU_BOARD_SERIAL,
+    ONLP_IPMI_FRU_BOARD_PART_NUMBER,
+    ONLP_IPMI_FRU_BOARD_FILE_ID,
+    ONLP_IPMI_FRU_BOARD_CUSTOM,
+} onlp_ipmi_fru_board_t;
+
+/**
+ * @brief Get a field from the FRU board info area.
+ * @see onlp_ipmi_fru_product_get
+ */
+int onlp_ipmi_fru_board_get(const uint8_t* fru, int size,
+                            onlp_ipmi_fru_board_t field,
+                            char* dst, int dsize);
+
+/**
+ * @brief Run an ipmitool command line in process.
+ * @param ipmi The handle, or NULL.
+ * @param cmd The ipmitool arguments, e.g. "sensor get Fan_1".
+ * @param out Receives the output ipmitool would print.
+ * @param outlen The size of out.
+ * @returns ONLP_STATUS_E_UNSUPPORTED if ipmi is NULL or the command
+ * is not handled, in which case the caller should run ipmitool.
+ * @note Only "raw", "sensor get" and "fru print" are handled. Shell
+ * redirections in cmd are ignored.
+ */
+int onlp_ipmi_tool_exec(onlp_ipmi_t* ipmi, const char* cmd,
+                        char* out, int outlen);
+
+/**
+ * @brief Apply a shell pipeline to ipmitool output.
+ * @param text The output from onlp_ipmi_tool_exec().
+ * @param filter The pipeline, e.g. |grep "Product Name" |cut -d : -f 2
+ * @param out Receives the filtered text.
+ * @param outlen The size of out.
+ * @returns ONLP_STATUS_E_UNSUPPORTED if the pipeline uses anything
+ * but grep with a fixed string and cut -d -f.
+ */
+int onlp_ipmi_tool_filter(const char* text, const char* filter,
+                          char* out, int outlen);
+
+#endif /* __ONLPLIB_IPMI_H__ */
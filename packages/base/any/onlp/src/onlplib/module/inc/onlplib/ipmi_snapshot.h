@@ -0,0 +1,144 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ * IPMI Sensor and FRU Snapshot
+ *
+ * All sensors and FRU devices behind the BMC are read once per
+ * refresh period and kept in a shared memory table. Any ONLP
+ * process can look up a sensor by name or number, or a FRU device
+ * by name, without talking to the BMC.
+ *
+ * The first process which finds the table out of date refreshes
+ * it. The others keep using the current contents meanwhile.
+ * Readers do not lock. The table carries a sequence count which
+ * is odd while it is being written, and a read is retried if the
+ * count changed.
+ *
+ ***********************************************************/
+#ifndef __ONLPLIB_IPMI_SNAPSHOT_H__
+#define __ONLPLIB_IPMI_SNAPSHOT_H__
+
+#include <onlplib/onlplib_config.h>
+#include <onlplib/ipmi.h>
+#include <sys/types.h>
+#include <stdint.h>
+
+/**
+ * Snapshot configuration.
+ */
+typedef struct onlp_ipmi_snapshot_config_s {
+    /** Shared memory key, or 0 for ONLPLIB_CONFIG_IPMI_SNAPSHOT_KEY. */
+    key_t key;
+
+    /** Refresh period, or 0 for ONLPLIB_CONFIG_IPMI_SNAPSHOT_REFRESH_MS. */
+    uint32_t refresh_ms;
+
+    /**
+     * The IPMI handle used for refreshes. It is not closed with the
+     * snapshot. If NULL, the default device is opened when needed.
+     */
+    onlp_ipmi_t* ipmi;
+
+} onlp_ipmi_snapshot_config_t;
+
+/**
+ * A FRU device.
+ */
+typedef struct onlp_ipmi_snapshot_fru_s {
+    /** The device ID string, e.g. "FRU_PSUL". */
+    char name[33];
+    uint8_t id;
+
+    /** The device could be read. */
+    uint8_t present;
+
+    /** The FRU contents. Longer devices are truncated. */
+    uint16_t size;
+    uint8_t data[ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRU_SIZE];
+
+} onlp_ipmi_snapshot_fru_t;
+
+/**
+ * @brief Snapshot handle.
+ */
+typedef struct onlp_ipmi_snapshot_s onlp_ipmi_snapshot_t;
+
+/**
+ * @brief Attach to the snapshot.
+ * @param config The configuration, or NULL for the defaults.
+ * @param rv Receives the handle.
+ */
+int onlp_ipmi_snapshot_open(const onlp_ipmi_snapshot_config_t* config,
+                            onlp_ipmi_snapshot_t** rv);
+
+/**
+ * @brief Detach from the snapshot.
+ * @param snapshot The handle.
+ */
+void onlp_ipmi_snapshot_close(onlp_ipmi_snapshot_t* snapshot);
+
+/**
+ * @brief Refresh the snapshot.
+ * @param snapshot The handle.
+ * @param force Refresh even if the snapshot is up to date.
+ * @note Lookups refresh the snapshot as needed. This is only
+ * required to pick up a change immediately.
+ */
+int onlp_ipmi_snapshot_refresh(onlp_ipmi_snapshot_t* snapshot, int force);
+
+/**
+ * @brief Get the snapshot generation.
+ * @param snapshot The handle.
+ * @returns The number of refreshes, 0 if the snapshot is still empty.
+ */
+uint32_t onlp_ipmi_snapshot_generation(onlp_ipmi_snapshot_t* snapshot);
+
+/**
+ * @brief Look up a sensor by name.
+ * @param snapshot The handle.
+ * @param name The sensor ID string.
+ * @param rv Receives the sensor.
+ * @returns ONLP_STATUS_E_MISSING if there is no such sensor.
+ */
+int onlp_ipmi_snapshot_sensor_get(onlp_ipmi_snapshot_t* snapshot,
+                                  const char* name, onlp_ipmi_sensor_t* rv);
+
+/**
+ * @brief Look up a sensor by number.
+ * @see onlp_ipmi_snapshot_sensor_get
+ */
+int onlp_ipmi_snapshot_sensor_get_number(onlp_ipmi_snapshot_t* snapshot,
+                                         uint8_t number,
+                                         onlp_ipmi_sensor_t* rv);
+
+/**
+ * @brief Look up a FRU device by name.
+ * @param snapshot The handle.
+ * @param name The device ID string.
+ * @param rv Receives the FRU device.
+ * @returns ONLP_STATUS_E_MISSING if there is no such device or it
+ * is not present.
+ */
+int onlp_ipmi_snapshot_fru_get(onlp_ipmi_snapshot_t* snapshot,
+                               const char* name,
+                               onlp_ipmi_snapshot_fru_t* rv);
+
+#endif /* __ONLPLIB_IPMI_SNAPSHOT_H__ */
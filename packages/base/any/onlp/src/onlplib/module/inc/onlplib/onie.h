@@ -90,6 +90,18 @@ int onlp_onie_decode_file(onlp_onie_info_t* rv, const char* file);
  */
 void onlp_onie_info_free(onlp_onie_info_t* info);
 
+/**
+ * Copy an ONIE info structure.
+ * The copy must be released with onlp_onie_info_free().
+ */
+int onlp_onie_info_copy(onlp_onie_info_t* dst, const onlp_onie_info_t* src);
+
+/**
+ * Get the total size of an ONIE TlvInfo blob (header and TLVs).
+ * Returns -1 if the data does not start with a valid TlvInfo header.
+ */
+int onlp_onie_data_size(const uint8_t* data);
+
 /**
  * Show the contents of an ONIE info structure.
  */
@@ -125,6 +125,26 @@
 #define ONLPLIB_CONFIG_INCLUDE_I2C 1
 #endif
 
+/**
+ * ONLPLIB_CONFIG_INCLUDE_BMC
+ *
+ * Include BMC console session support. */
+
+
+#ifndef ONLPLIB_CONFIG_INCLUDE_BMC
+#define ONLPLIB_CONFIG_INCLUDE_BMC 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_INCLUDE_IPMI
+ *
+ * Include in-process IPMI support. */
+
+
+#ifndef ONLPLIB_CONFIG_INCLUDE_IPMI
+#define ONLPLIB_CONFIG_INCLUDE_IPMI 1
+#endif
+
 /**
  * ONLPLIB_CONFIG_I2C_BLOCK_SIZE
  *
@@ -145,6 +165,236 @@
 #define ONLPLIB_CONFIG_I2C_READ_RETRY_COUNT 16
 #endif
 
+/**
+ * ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE
+ *
+ * Keep /dev/i2c-N descriptors open between transactions and only reprogram the slave address when it changes. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE
+#define ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE
+ *
+ * The number of i2c buses (0..N-1) eligible for descriptor caching. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE
+#define ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE 64
+#endif
+
+/**
+ * ONLPLIB_CONFIG_I2C_INCLUDE_RDWR
+ *
+ * Use combined I2C_RDWR transactions for block and device reads when the adapter supports them. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_INCLUDE_RDWR
+#define ONLPLIB_CONFIG_I2C_INCLUDE_RDWR 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE
+ *
+ * Maximum size of a single I2C_RDWR read message. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE
+#define ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE 256
+#endif
+
+/**
+ * ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE
+ *
+ * Remember the last channel selected on each mux device and skip redundant mux writes. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE
+#define ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_I2C_MUX_CACHE_SIZE
+ *
+ * Maximum number of mux devices tracked by the mux cache. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_MUX_CACHE_SIZE
+#define ONLPLIB_CONFIG_I2C_MUX_CACHE_SIZE 64
+#endif
+
+/**
+ * ONLPLIB_CONFIG_I2C_MUX_LOCK_FILENAME
+ *
+ * The lock file used to serialize mux selects and device accesses on each bus between processes when the mux cache is enabled. */
+
+
+#ifndef ONLPLIB_CONFIG_I2C_MUX_LOCK_FILENAME
+#define ONLPLIB_CONFIG_I2C_MUX_LOCK_FILENAME "/var/run/onlp-i2c-mux.lock"
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_INCLUDE_CACHE
+ *
+ * Remember resolved file paths and keep sysfs attributes open between onlp_file reads. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_INCLUDE_CACHE
+#define ONLPLIB_CONFIG_FILE_INCLUDE_CACHE 1
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_CACHE_SIZE
+ *
+ * Maximum number of files tracked by the onlp_file cache. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_CACHE_SIZE
+#define ONLPLIB_CONFIG_FILE_CACHE_SIZE 128
+#endif
+
+/**
+ * ONLPLIB_CONFIG_FILE_VEC_STR_MAX
+ *
+ * Maximum length of a string attribute read through an onlp_file_vec. */
+
+
+#ifndef ONLPLIB_CONFIG_FILE_VEC_STR_MAX
+#define ONLPLIB_CONFIG_FILE_VEC_STR_MAX 64
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_CACHE_SIZE
+ *
+ * Number of cached BMC command results per session. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_CACHE_SIZE
+#define ONLPLIB_CONFIG_BMC_CACHE_SIZE 64
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_COMMAND_MAX
+ *
+ * Maximum length of a single BMC command. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_COMMAND_MAX
+#define ONLPLIB_CONFIG_BMC_COMMAND_MAX 256
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_LINE_MAX
+ *
+ * Maximum length of a batched BMC command line. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_LINE_MAX
+#define ONLPLIB_CONFIG_BMC_LINE_MAX 1024
+#endif
+
+/**
+ * ONLPLIB_CONFIG_BMC_BUFFER_SIZE
+ *
+ * Size of the BMC console output buffer. */
+
+
+#ifndef ONLPLIB_CONFIG_BMC_BUFFER_SIZE
+#define ONLPLIB_CONFIG_BMC_BUFFER_SIZE 16384
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_DEVICE
+ *
+ * The kernel IPMI device. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_DEVICE
+#define ONLPLIB_CONFIG_IPMI_DEVICE "/dev/ipmi0"
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_OUTSTANDING
+ *
+ * Maximum number of IPMI requests in flight at the same time. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_OUTSTANDING
+#define ONLPLIB_CONFIG_IPMI_OUTSTANDING 8
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_TIMEOUT_MS
+ *
+ * IPMI response timeout. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_TIMEOUT_MS
+#define ONLPLIB_CONFIG_IPMI_TIMEOUT_MS 5000
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_READ_CHUNK
+ *
+ * Maximum number of bytes in a single SDR or FRU read request. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_READ_CHUNK
+#define ONLPLIB_CONFIG_IPMI_READ_CHUNK 16
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_SNAPSHOT_KEY
+ *
+ * Shared memory key of the IPMI sensor and FRU snapshot. The next key is used for its lock. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_SNAPSHOT_KEY
+#define ONLPLIB_CONFIG_IPMI_SNAPSHOT_KEY 0xF00DF010
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_SNAPSHOT_REFRESH_MS
+ *
+ * Default IPMI snapshot refresh period. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_SNAPSHOT_REFRESH_MS
+#define ONLPLIB_CONFIG_IPMI_SNAPSHOT_REFRESH_MS 5000
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS
+ *
+ * Maximum number of sensors in the IPMI snapshot. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS
+#define ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS 256
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS
+ *
+ * Maximum number of FRU devices in the IPMI snapshot. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS
+#define ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS 32
+#endif
+
+/**
+ * ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRU_SIZE
+ *
+ * Maximum size of a FRU device in the IPMI snapshot. */
+
+
+#ifndef ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRU_SIZE
+#define ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRU_SIZE 512
+#endif
+
 /**
  * ONLPLIB_CONFIG_I2C_USE_CUSTOM_HEADER
  *
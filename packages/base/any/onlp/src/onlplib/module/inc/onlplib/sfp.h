@@ -62,4 +62,32 @@ int onlplib_sfp_reset_file(const char* file, const char* first, int delay_ms,
  * to implement your onlp_sfpi_eeprom_read() interface. */
 int onlplib_sfp_eeprom_read_file(const char* fname, uint8_t data[256]);
 
+/**
+ * @brief Read SFP paged memory from an optoe eeprom file.
+ * @param fname The filename.
+ * @param devaddr 0x50, or 0x51 for the SFF-8472 diagnostics.
+ * 0x51 is only supported on optoe2 devices, and the 0x50 space
+ * of optoe2 devices has no upper pages. The device class is read
+ * from the dev_class attribute next to the eeprom file.
+ * @param bank The bank. optoe does not select banks, so this must be 0.
+ * @param page The upper page.
+ * @param offset The offset within the device's 256 byte address space.
+ * @param len The number of bytes.
+ * @param data Receives the data.
+ * @notes optoe exports the lower page followed by every upper page as
+ * one flat file. You can use this function to implement your
+ * onlp_sfpi_memory_read() interface on optoe devices.
+ */
+int onlplib_sfp_memory_read_file(const char* fname, uint8_t devaddr,
+                                 int bank, int page, int offset, int len,
+                                 uint8_t* data);
+
+/**
+ * @brief Write SFP paged memory through an optoe eeprom file.
+ * @notes See onlplib_sfp_memory_read_file().
+ */
+int onlplib_sfp_memory_write_file(const char* fname, uint8_t devaddr,
+                                  int bank, int page, int offset, int len,
+                                  uint8_t* data);
+
 #endif /* __ONLPLIB_SFP_H__ */
@@ -100,4 +100,45 @@ int onlp_shlock_global_take(void);
 int onlp_shlock_global_give(void);
 
 
+/**
+ * Reader/writer lock sets.
+ *
+ * A lock set is a fixed number of independent reader/writer
+ * locks addressed by index. Each lock is shared between the threads
+ * of the current process and, if a filename is specified, between
+ * processes using fcntl() record locks on that file. Record locks
+ * are released by the kernel when the owning process exits.
+ */
+typedef struct onlp_shrwlock_s onlp_shrwlock_t;
+
+/**
+ * @brief Create a reader/writer lock set.
+ * @param fname The lock file shared by all processes (or NULL for process-local locks).
+ * @param count The number of locks in the set.
+ * @param rv Receives the lock set.
+ */
+int onlp_shrwlock_create(const char* fname, int count, onlp_shrwlock_t** rv);
+
+/**
+ * @brief Destroy a reader/writer lock set.
+ * @param l The lock set.
+ */
+int onlp_shrwlock_destroy(onlp_shrwlock_t* l);
+
+/**
+ * @brief Take a lock in the set.
+ * @param l The lock set.
+ * @param index The lock index.
+ * @param exclusive Take the lock for writing if nonzero, for reading otherwise.
+ */
+int onlp_shrwlock_take(onlp_shrwlock_t* l, int index, int exclusive);
+
+/**
+ * @brief Give a lock in the set.
+ * @param l The lock set.
+ * @param index The lock index.
+ */
+int onlp_shrwlock_give(onlp_shrwlock_t* l, int index);
+
+
 #endif /* __ONLP_SHLOCKS_H__ */
@@ -0,0 +1,638 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlplib/onlplib_config.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_BMC == 1
+
+#include <onlplib/bmc.h>
+#include <onlp/onlp.h>
+#include <AIM/aim.h>
+#include "onlplib_log.h"
+
+#include <termios.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <pthread.h>
+
+/*
+ * Sentinels are echoed with a split string so the console echo of
+ * the command line never matches the output.
+ */
+#define SENTINEL_ECHO   "echo @@ON''LP"
+#define SENTINEL        "@@ONLP"
+
+#define CACHE_RESP_SIZE 256
+
+typedef struct bmc_cache_entry_s {
+    char cmd[ONLPLIB_CONFIG_BMC_COMMAND_MAX];
+    char resp[CACHE_RESP_SIZE];
+    int status;
+    uint64_t time;
+} bmc_cache_entry_t;
+
+struct onlp_bmc_session_s {
+    onlp_bmc_config_t config;
+    int fd;
+    int logged_in;
+    uint32_t seq;
+    pthread_mutex_t lock;
+    onlp_bmc_stats_t stats;
+
+    /* Console output of the current round trip. */
+    char buf[ONLPLIB_CONFIG_BMC_BUFFER_SIZE];
+    int len;
+
+    bmc_cache_entry_t cache[ONLPLIB_CONFIG_BMC_CACHE_SIZE];
+};
+
+
+static int
+session_init__(onlp_bmc_session_t* s, const onlp_bmc_config_t* config, int fd)
+{
+    s->config = *config;
+    s->config.device = config->device ? aim_strdup(config->device) : NULL;
+    s->config.prompt = aim_strdup(config->prompt);
+    s->config.user = aim_strdup(config->user);
+    s->config.password = aim_strdup(config->password);
+    s->fd = fd;
+    pthread_mutex_init(&s->lock, NULL);
+    return fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+int
+onlp_bmc_session_open_fd(const onlp_bmc_config_t* config, int fd,
+                         onlp_bmc_session_t** rv)
+{
+    onlp_bmc_session_t* s;
+
+    if(config == NULL || config->prompt == NULL || fd < 0 || rv == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    s = aim_zmalloc(sizeof(*s));
+    if(session_init__(s, config, fd) < 0) {
+        AIM_LOG_ERROR("bmc: cannot configure descriptor: %{errno}", errno);
+        onlp_bmc_session_close(s);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    *rv = s;
+    return 0;
+}
+
+int
+onlp_bmc_session_open(const onlp_bmc_config_t* config,
+                      onlp_bmc_session_t** rv)
+{
+    int fd;
+    struct termios attr;
+
+    if(config == NULL || config->device == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    if((fd = open(config->device, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC)) < 0) {
+        AIM_LOG_ERROR("bmc: cannot open %s: %{errno}", config->device, errno);
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    tcgetattr(fd, &attr);
+    cfmakeraw(&attr);
+    attr.c_cflag |= CLOCAL | CREAD;
+    attr.c_cc[VMIN] = 0;
+    attr.c_cc[VTIME] = 0;
+    cfsetospeed(&attr, config->speed);
+    cfsetispeed(&attr, config->speed);
+    tcsetattr(fd, TCSANOW, &attr);
+
+    return onlp_bmc_session_open_fd(config, fd, rv);
+}
+
+void
+onlp_bmc_session_close(onlp_bmc_session_t* s)
+{
+    if(s) {
+        if(s->fd >= 0) {
+            close(s->fd);
+        }
+        aim_free((char*)s->config.device);
+        aim_free((char*)s->config.prompt);
+        aim_free((char*)s->config.user);
+        aim_free((char*)s->config.password);
+        pthread_mutex_destroy(&s->lock);
+        aim_free(s);
+    }
+}
+
+
+/**
+ * Console I/O
+ */
+static void
+drain__(onlp_bmc_session_t* s)
+{
+    char junk[256];
+    while(read(s->fd, junk, sizeof(junk)) > 0);
+    s->len = 0;
+    s->buf[0] = 0;
+}
+
+static int
+write__(onlp_bmc_session_t* s, const char* data)
+{
+    int len = strlen(data);
+    int tries = 0;
+
+    while(len > 0) {
+        int rv = write(s->fd, data, len);
+        if(rv < 0) {
+            if(errno != EAGAIN && errno != EINTR) {
+                AIM_LOG_ERROR("bmc: write failed: %{errno}", errno);
+                return ONLP_STATUS_E_INTERNAL;
+            }
+            if(++tries > 100) {
+                return ONLP_STATUS_E_INTERNAL;
+            }
+            usleep(1000);
+            continue;
+        }
+        data += rv;
+        len -= rv;
+    }
+    return 0;
+}
+
+typedef int (*match_f)(onlp_bmc_session_t* s, void* cookie);
+
+/*
+ * Read until the match function succeeds or the timeout expires.
+ * Returns the match result.
+ */
+static int
+read_until__(onlp_bmc_session_t* s, uint32_t timeout_ms,
+             match_f match, void* cookie)
+{
+    int rv;
+    uint64_t deadline = aim_time_monotonic() + (uint64_t)timeout_ms * 1000;
+
+    for(;;) {
+        if((rv = match(s, cookie)) != 0) {
+            return rv;
+        }
+
+        uint64_t now = aim_time_monotonic();
+        if(now >= deadline) {
+            return 0;
+        }
+
+        struct pollfd pfd = { s->fd, POLLIN, 0 };
+        if(poll(&pfd, 1, (deadline - now + 999) / 1000) <= 0) {
+            continue;
+        }
+
+        int space = sizeof(s->buf) - 1 - s->len;
+        if(space <= 0) {
+            AIM_LOG_ERROR("bmc: console buffer overflow.");
+            return 0;
+        }
+        rv = read(s->fd, s->buf + s->len, space);
+        if(rv > 0) {
+            s->len += rv;
+            s->buf[s->len] = 0;
+        }
+    }
+}
+
+/**
+ * Login
+ */
+#define LOGIN_SHELL    1
+#define LOGIN_USER     2
+#define LOGIN_PASSWORD 3
+
+static int
+tail_is__(onlp_bmc_session_t* s, const char* str)
+{
+    int len = s->len;
+    int slen = strlen(str);
+    while(len > 0 && s->buf[len-1] == ' ') {
+        len--;
+    }
+    return len >= slen && !memcmp(s->buf + len - slen, str, slen);
+}
+
+/*
+ * Classify the console state. Login prompts only count at the end
+ * of the output, as "Last login:" may appear in the banner.
+ */
+static int
+match_login__(onlp_bmc_session_t* s, void* cookie)
+{
+    if(strstr(s->buf, s->config.prompt)) {
+        return LOGIN_SHELL;
+    }
+    if(tail_is__(s, "login:")) {
+        return LOGIN_USER;
+    }
+    if(tail_is__(s, "Password:")) {
+        return LOGIN_PASSWORD;
+    }
+    return 0;
+}
+
+static int
+send_and_match__(onlp_bmc_session_t* s, const char* send)
+{
+    drain__(s);
+    if(write__(s, send) < 0) {
+        return 0;
+    }
+    return read_until__(s, s->config.login_timeout_ms, match_login__, NULL);
+}
+
+static int
+login__(onlp_bmc_session_t* s)
+{
+    int i;
+    char line[128];
+
+    for(i = 0; i < 3; i++) {
+        switch(send_and_match__(s, "\r"))
+            {
+            case LOGIN_SHELL:
+                s->logged_in = 1;
+                return 0;
+
+            case LOGIN_USER:
+                snprintf(line, sizeof(line), "%s\r", s->config.user);
+                if(send_and_match__(s, line) == LOGIN_PASSWORD) {
+                    snprintf(line, sizeof(line), "%s\r", s->config.password);
+                    if(send_and_match__(s, line) == LOGIN_SHELL) {
+                        s->stats.logins++;
+                        s->logged_in = 1;
+                        return 0;
+                    }
+                }
+                break;
+
+            default:
+                /* Stale password prompt or no answer. */
+                break;
+            }
+    }
+
+    AIM_LOG_ERROR("bmc: login failed.");
+    return ONLP_STATUS_E_INTERNAL;
+}
+
+
+/**
+ * Command round trips
+ */
+typedef struct round_trip_s {
+    uint32_t seq;
+    int count;
+} round_trip_t;
+
+static int
+match_round_trip__(onlp_bmc_session_t* s, void* cookie)
+{
+    round_trip_t* rt = cookie;
+    char last[32];
+    char* p;
+
+    snprintf(last, sizeof(last), SENTINEL "%u:%d:", rt->seq, rt->count - 1);
+    p = strstr(s->buf, last);
+    return (p && strstr(p + strlen(last), "@@")) ? 1 : 0;
+}
+
+static void
+strip_eol__(char* s)
+{
+    int len = strlen(s);
+    while(len > 0 && (s[len-1] == '\r' || s[len-1] == '\n')) {
+        s[--len] = 0;
+    }
+}
+
+/*
+ * Split the output into the requests.
+ */
+static int
+parse_round_trip__(onlp_bmc_session_t* s, round_trip_t* rt,
+                   onlp_bmc_request_t** requests)
+{
+    char marker[32];
+    char* p;
+    int i;
+
+    snprintf(marker, sizeof(marker), SENTINEL "%u:B@@", rt->seq);
+    if((p = strstr(s->buf, marker)) == NULL) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    p += strlen(marker);
+
+    for(i = 0; i < rt->count; i++) {
+        onlp_bmc_request_t* r = requests[i];
+        char* end;
+
+        while(*p == '\r' || *p == '\n') {
+            p++;
+        }
+
+        snprintf(marker, sizeof(marker), SENTINEL "%u:%d:", rt->seq, i);
+        if((end = strstr(p, marker)) == NULL) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+
+        if(r->resp && r->size > 0) {
+            int len = end - p;
+            if(len >= r->size) {
+                len = r->size - 1;
+            }
+            memcpy(r->resp, p, len);
+            r->resp[len] = 0;
+            strip_eol__(r->resp);
+        }
+
+        r->status = atoi(end + strlen(marker));
+        p = strstr(end + strlen(marker), "@@");
+        if(p == NULL) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        p += 2;
+    }
+
+    return 0;
+}
+
+static int
+round_trip__(onlp_bmc_session_t* s, onlp_bmc_request_t** requests, int count)
+{
+    int i, rv;
+    char line[ONLPLIB_CONFIG_BMC_LINE_MAX + ONLPLIB_CONFIG_BMC_COMMAND_MAX + 64];
+    int len;
+    round_trip_t rt;
+
+    rt.seq = ++s->seq;
+    rt.count = count;
+
+    len = snprintf(line, sizeof(line), SENTINEL_ECHO "%u:B@@", rt.seq);
+    for(i = 0; i < count; i++) {
+        len += snprintf(line + len, sizeof(line) - len,
+                        "; %s; " SENTINEL_ECHO "%u:%d:$?@@",
+                        requests[i]->cmd, rt.seq, i);
+    }
+    snprintf(line + len, sizeof(line) - len, "\r");
+
+    drain__(s);
+    if((rv = write__(s, line)) < 0) {
+        return rv;
+    }
+
+    s->stats.round_trips++;
+    s->stats.commands += count;
+
+    if(!read_until__(s, s->config.command_timeout_ms, match_round_trip__, &rt)) {
+        AIM_LOG_VERBOSE("bmc: round trip %u timed out.", rt.seq);
+        s->stats.timeouts++;
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    return parse_round_trip__(s, &rt, requests);
+}
+
+/*
+ * Run one round trip with the console locked, logging in as needed.
+ */
+static int
+round_trip_locked__(onlp_bmc_session_t* s, onlp_bmc_request_t** requests,
+                    int count)
+{
+    int rv = ONLP_STATUS_E_INTERNAL;
+    int attempt;
+
+    if(flock(s->fd, LOCK_EX) < 0 && errno != ENOTTY && errno != EINVAL) {
+        AIM_LOG_ERROR("bmc: cannot lock console: %{errno}", errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    for(attempt = 0; attempt < 2; attempt++) {
+        if(!s->logged_in && (rv = login__(s)) < 0) {
+            break;
+        }
+        if((rv = round_trip__(s, requests, count)) == 0) {
+            break;
+        }
+        /* Another user may have logged out or left the shell busy. */
+        s->logged_in = 0;
+    }
+
+    flock(s->fd, LOCK_UN);
+    return rv;
+}
+
+
+/**
+ * Cache
+ */
+static bmc_cache_entry_t*
+cache_find__(onlp_bmc_session_t* s, const char* cmd, uint64_t now)
+{
+    int i;
+    for(i = 0; i < ONLPLIB_CONFIG_BMC_CACHE_SIZE; i++) {
+        bmc_cache_entry_t* e = s->cache + i;
+        if(e->time && !strcmp(e->cmd, cmd)) {
+            if(now - e->time > (uint64_t)s->config.cache_ms * 1000) {
+                e->time = 0;
+                return NULL;
+            }
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void
+cache_store__(onlp_bmc_session_t* s, onlp_bmc_request_t* r, uint64_t now)
+{
+    int i;
+    bmc_cache_entry_t* victim = s->cache;
+
+    if(strlen(r->cmd) >= sizeof(victim->cmd) ||
+       strlen(r->resp) >= sizeof(victim->resp)) {
+        return;
+    }
+
+    for(i = 0; i < ONLPLIB_CONFIG_BMC_CACHE_SIZE; i++) {
+        bmc_cache_entry_t* e = s->cache + i;
+        if(e->time == 0 || !strcmp(e->cmd, r->cmd)) {
+            victim = e;
+            break;
+        }
+        if(e->time < victim->time) {
+            victim = e;
+        }
+    }
+
+    strcpy(victim->cmd, r->cmd);
+    strcpy(victim->resp, r->resp);
+    victim->status = r->status;
+    victim->time = now;
+}
+
+void
+onlp_bmc_cache_invalidate(onlp_bmc_session_t* s)
+{
+    int i;
+    pthread_mutex_lock(&s->lock);
+    for(i = 0; i < ONLPLIB_CONFIG_BMC_CACHE_SIZE; i++) {
+        s->cache[i].time = 0;
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+
+int
+onlp_bmc_request(onlp_bmc_session_t* s,
+                 onlp_bmc_request_t* requests, int count)
+{
+    int i, rv = 0;
+    int pending = 0;
+    onlp_bmc_request_t** batch;
+    uint64_t now = aim_time_monotonic();
+
+    if(s == NULL || requests == NULL || count <= 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    batch = aim_zmalloc(sizeof(*batch) * count);
+
+    pthread_mutex_lock(&s->lock);
+
+    for(i = 0; i < count; i++) {
+        onlp_bmc_request_t* r = requests + i;
+        bmc_cache_entry_t* e;
+
+        if(strlen(r->cmd) >= ONLPLIB_CONFIG_BMC_COMMAND_MAX) {
+            r->status = ONLP_STATUS_E_PARAM;
+            rv = ONLP_STATUS_E_PARAM;
+            continue;
+        }
+
+        if(r->cache && s->config.cache_ms &&
+           (e = cache_find__(s, r->cmd, now)) != NULL) {
+            if(r->resp && r->size > 0) {
+                aim_strlcpy(r->resp, e->resp, r->size);
+            }
+            r->status = e->status;
+            s->stats.cache_hits++;
+            continue;
+        }
+
+        if(!r->cache) {
+            /* Writes may change what the cached reads would return. */
+            int j;
+            for(j = 0; j < ONLPLIB_CONFIG_BMC_CACHE_SIZE; j++) {
+                s->cache[j].time = 0;
+            }
+        }
+
+        batch[pending++] = r;
+    }
+
+    /* Send the rest in as few round trips as the line length allows. */
+    i = 0;
+    while(i < pending) {
+        int n = 0, len = 0;
+        while(i + n < pending &&
+              (n == 0 || len + strlen(batch[i+n]->cmd) + 32 <= ONLPLIB_CONFIG_BMC_LINE_MAX)) {
+            len += strlen(batch[i+n]->cmd) + 32;
+            n++;
+        }
+
+        int rrv = round_trip_locked__(s, batch + i, n);
+        int j;
+        for(j = i; j < i + n; j++) {
+            if(rrv < 0) {
+                batch[j]->status = rrv;
+                if(batch[j]->resp && batch[j]->size > 0) {
+                    batch[j]->resp[0] = 0;
+                }
+                rv = rrv;
+            }
+            else if(batch[j]->cache && s->config.cache_ms && batch[j]->resp) {
+                cache_store__(s, batch[j], now);
+            }
+        }
+        i += n;
+    }
+
+    pthread_mutex_unlock(&s->lock);
+    aim_free(batch);
+    return rv;
+}
+
+static int
+command__(onlp_bmc_session_t* s, const char* cmd, char* resp, int size,
+          int cache)
+{
+    int rv;
+    onlp_bmc_request_t r = { cmd, resp, size, cache, 0 };
+
+    if((rv = onlp_bmc_request(s, &r, 1)) < 0) {
+        return rv;
+    }
+    return r.status;
+}
+
+int
+onlp_bmc_command(onlp_bmc_session_t* s, const char* cmd, char* resp, int size)
+{
+    return command__(s, cmd, resp, size, 0);
+}
+
+int
+onlp_bmc_read(onlp_bmc_session_t* s, const char* cmd, char* resp, int size)
+{
+    return command__(s, cmd, resp, size, 1);
+}
+
+void
+onlp_bmc_stats_get(onlp_bmc_session_t* s, onlp_bmc_stats_t* stats, int clear)
+{
+    pthread_mutex_lock(&s->lock);
+    if(stats) {
+        *stats = s->stats;
+    }
+    if(clear) {
+        memset(&s->stats, 0, sizeof(s->stats));
+    }
+    pthread_mutex_unlock(&s->lock);
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_BMC */
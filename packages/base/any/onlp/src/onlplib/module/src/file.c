@@ -31,10 +31,14 @@
 #include "onlplib_log.h"
 #include <onlp/onlp.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <sys/stat.h>
 
+static onlp_file_stats_t stats__;
+#define FILE_STAT_INC(_field) __sync_fetch_and_add(&stats__._field, 1)
+
 /**
  * @brief Connects to a unix domain socket.
  * @param path The socket path.
@@ -77,22 +81,313 @@ ds_connect__(const char* path)
     }
 }
 
+#if ONLPLIB_CONFIG_FILE_INCLUDE_CACHE == 1
+
+#include <pthread.h>
+#include <sys/vfs.h>
+
+#ifndef SYSFS_MAGIC
+#define SYSFS_MAGIC 0x62656572
+#endif
+
+/**
+ * File cache.
+ *
+ * Entries are keyed by the formatted filename. Each holds the path
+ * a filename containing '*' resolved to, and for sysfs attributes a
+ * descriptor which is kept open for reading. sysfs produces a fresh
+ * value for every read at offset 0, so the descriptor is simply read
+ * again with pread(). A read which fails (the attribute went away,
+ * usually with ENODEV) closes the descriptor and forgets the path so
+ * the filename is resolved from scratch.
+ *
+ * The table lock protects the keys. The entry lock is held while its
+ * descriptor is used so that a slow read does not block other files.
+ */
+typedef struct file_cache_entry_s {
+    pthread_mutex_t lock;
+    uint32_t hash;
+    char* name;
+    char* path;
+    int fd;
+    uint64_t used;
+} file_cache_entry_t;
+
+static file_cache_entry_t file_cache__[ONLPLIB_CONFIG_FILE_CACHE_SIZE];
+static pthread_mutex_t file_cache_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t file_cache_once__ = PTHREAD_ONCE_INIT;
+static int file_cache_enabled__ = 1;
+static uint64_t file_cache_clock__;
+
+static uint32_t
+file_cache_hash__(const char* s)
+{
+    uint32_t h = 2166136261u;
+    while(*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* Close the descriptor and forget the resolved path. */
+static void
+file_cache_close__(file_cache_entry_t* e)
+{
+    if(e->fd >= 0) {
+        close(e->fd);
+        e->fd = -1;
+        FILE_STAT_INC(flushes);
+    }
+    if(e->path) {
+        aim_free(e->path);
+        e->path = NULL;
+        FILE_STAT_INC(flushes);
+    }
+}
+
+static void
+file_cache_drop__(file_cache_entry_t* e)
+{
+    file_cache_close__(e);
+    aim_free(e->name);
+    e->name = NULL;
+    e->hash = 0;
+    e->used = 0;
+}
+
+static void
+file_cache_reset__(void)
+{
+    int i;
+    pthread_mutex_init(&file_cache_lock__, NULL);
+    for(i = 0; i < AIM_ARRAYSIZE(file_cache__); i++) {
+        pthread_mutex_init(&file_cache__[i].lock, NULL);
+        file_cache__[i].fd = -1;
+    }
+}
+
+static void
+file_cache_atfork_child__(void)
+{
+    int i;
+    /*
+     * Another thread may have held a lock at the time of the fork.
+     * Start over rather than inherit it.
+     */
+    for(i = 0; i < AIM_ARRAYSIZE(file_cache__); i++) {
+        file_cache_drop__(file_cache__ + i);
+    }
+    file_cache_reset__();
+}
+
+static void
+file_cache_init__(void)
+{
+    file_cache_reset__();
+    pthread_atfork(NULL, NULL, file_cache_atfork_child__);
+}
+
+/*
+ * Find the entry for a filename, optionally creating it.
+ * Returns the entry locked, or NULL.
+ * An entry is only taken if its lock is free. A read may hold it
+ * across a slow sysfs attribute, and waiting for it with the table
+ * locked would stall every other file access. The caller falls back
+ * to an uncached access instead.
+ */
+static file_cache_entry_t*
+file_cache_get__(const char* name, int create)
+{
+    int i;
+    uint32_t hash;
+    file_cache_entry_t* e = NULL;
+    file_cache_entry_t* victim = NULL;
+
+    pthread_once(&file_cache_once__, file_cache_init__);
+
+    hash = file_cache_hash__(name);
+    pthread_mutex_lock(&file_cache_lock__);
+
+    if(!file_cache_enabled__) {
+        pthread_mutex_unlock(&file_cache_lock__);
+        return NULL;
+    }
+
+    for(i = 0; i < AIM_ARRAYSIZE(file_cache__); i++) {
+        file_cache_entry_t* c = file_cache__ + i;
+        if(c->name && c->hash == hash && !strcmp(c->name, name)) {
+            if(pthread_mutex_trylock(&c->lock) == 0) {
+                e = c;
+            }
+            else {
+                FILE_STAT_INC(busy);
+                create = 0;
+            }
+            break;
+        }
+    }
+
+    if(e == NULL && create) {
+        /* Use a free entry, or the least recently used one not in use. */
+        for(i = 0; i < AIM_ARRAYSIZE(file_cache__); i++) {
+            file_cache_entry_t* c = file_cache__ + i;
+            if(c->name && victim && c->used >= victim->used) {
+                continue;
+            }
+            if(pthread_mutex_trylock(&c->lock) != 0) {
+                continue;
+            }
+            if(victim) {
+                pthread_mutex_unlock(&victim->lock);
+            }
+            victim = c;
+            if(c->name == NULL) {
+                break;
+            }
+        }
+        if(victim) {
+            e = victim;
+            file_cache_drop__(e);
+            e->name = aim_strdup(name);
+            e->hash = hash;
+        }
+    }
+
+    if(e) {
+        e->used = ++file_cache_clock__;
+    }
+    pthread_mutex_unlock(&file_cache_lock__);
+    return e;
+}
+
+static void
+file_cache_put__(file_cache_entry_t* e)
+{
+    pthread_mutex_unlock(&e->lock);
+}
+
+/*
+ * Read from the cached descriptor for fname.
+ * Returns 1 if the read was served from the cache, with its status
+ * in *status.
+ */
+static int
+file_cache_read__(const char* fname, uint8_t* data, int max, int* len,
+                  int* status)
+{
+    file_cache_entry_t* e = file_cache_get__(fname, 0);
+    int rv = 0;
+
+    if(e) {
+        if(e->fd >= 0) {
+            memset(data, 0, max);
+            if((*len = pread(e->fd, data, max, 0)) >= 0) {
+                FILE_STAT_INC(rereads);
+                rv = 1;
+                /*
+                 * An empty attribute is a failed read, as it is on a
+                 * fresh descriptor, but the descriptor is still good.
+                 */
+                if(*len == 0) {
+                    AIM_LOG_ERROR("Failed to read input file '%s'", fname);
+                    *status = ONLP_STATUS_E_INTERNAL;
+                }
+                else {
+                    *status = ONLP_STATUS_OK;
+                }
+            }
+            else {
+                file_cache_close__(e);
+            }
+        }
+        file_cache_put__(e);
+    }
+    return rv;
+}
+
+/*
+ * Keep a descriptor just used to read fname open, if it is a sysfs
+ * attribute. Returns 1 if the descriptor was taken.
+ */
+static int
+file_cache_keep__(const char* fname, int fd)
+{
+    struct statfs sfs;
+    file_cache_entry_t* e;
+    int rv = 0;
+
+    if(!file_cache_enabled__ ||
+       fstatfs(fd, &sfs) < 0 || sfs.f_type != SYSFS_MAGIC) {
+        return 0;
+    }
+
+    if( (e = file_cache_get__(fname, 1)) ) {
+        if(e->fd < 0) {
+            e->fd = fd;
+            rv = 1;
+        }
+        file_cache_put__(e);
+    }
+    return rv;
+}
+
+/*
+ * Look up the path a filename containing '*' resolved to.
+ */
+static int
+file_cache_path_get__(const char* fname, char* path, int size)
+{
+    file_cache_entry_t* e = file_cache_get__(fname, 0);
+    int rv = 0;
+
+    if(e) {
+        if(e->path) {
+            aim_strlcpy(path, e->path, size);
+            rv = 1;
+        }
+        file_cache_put__(e);
+    }
+    return rv;
+}
+
+static void
+file_cache_path_set__(const char* fname, const char* path)
+{
+    file_cache_entry_t* e = file_cache_get__(fname, 1);
+    if(e) {
+        if(e->path == NULL) {
+            e->path = aim_strdup(path);
+        }
+        file_cache_put__(e);
+    }
+}
+
+static void
+file_cache_path_drop__(const char* fname)
+{
+    file_cache_entry_t* e = file_cache_get__(fname, 0);
+    if(e) {
+        file_cache_close__(e);
+        file_cache_put__(e);
+    }
+}
+
+#endif /* ONLPLIB_CONFIG_FILE_INCLUDE_CACHE */
+
 /**
  * @brief Open a file or domain socket.
  * @param dst Receives the full filename (for logging purposes).
  * @param flags The open flags.
- * @param fmt Format specifier.
- * @param vargs Format specifier arguments.
+ * @param fname The filename. Resolved in place if it contains an asterisk.
  */
 static int
-vopen__(char** dst, int flags, const char* fmt, va_list vargs)
+open__(char** dst, int flags, char* fname)
 {
     int fd;
     struct stat sb;
-    char fname[PATH_MAX];
     char* asterisk;
-
-    ONLPLIB_VSNPRINTF(fname, sizeof(fname)-1, fmt, vargs);
+    int cached = 0;
 
     /**
      * An asterisk in the filename separates a search root
@@ -101,22 +396,47 @@ vopen__(char** dst, int flags, const char* fmt, va_list vargs)
     if( (asterisk = strchr(fname, '*')) ) {
         char* root = fname;
         char* rpath = NULL;
-        *asterisk = 0;
-        if(onlp_file_find(root, asterisk+1, &rpath) < 0) {
-            return ONLP_STATUS_E_MISSING;
+
+#if ONLPLIB_CONFIG_FILE_INCLUDE_CACHE == 1
+        char key[PATH_MAX];
+        char cpath[PATH_MAX];
+
+        strcpy(key, fname);
+        if(file_cache_path_get__(key, cpath, sizeof(cpath))) {
+            if(stat(cpath, &sb) == 0) {
+                strcpy(fname, cpath);
+                cached = 1;
+            }
+            else {
+                /* Gone (or renumbered), search again. */
+                file_cache_path_drop__(key);
+            }
+        }
+#endif
+
+        if(!cached) {
+            *asterisk = 0;
+            FILE_STAT_INC(searches);
+            if(onlp_file_find(root, asterisk+1, &rpath) < 0) {
+                return ONLP_STATUS_E_MISSING;
+            }
+#if ONLPLIB_CONFIG_FILE_INCLUDE_CACHE == 1
+            file_cache_path_set__(key, rpath);
+#endif
+            strcpy(fname, rpath);
+            aim_free(rpath);
         }
-        strcpy(fname, rpath);
-        aim_free(rpath);
     }
 
     if(dst) {
         *dst = aim_strdup(fname);
     }
 
-    if(stat(fname, &sb) == -1) {
+    if(!cached && stat(fname, &sb) == -1) {
         return ONLP_STATUS_E_MISSING;
     }
 
+    FILE_STAT_INC(opens);
     if(S_ISSOCK(sb.st_mode)) {
         fd = ds_connect__(fname);
     }
@@ -127,6 +447,21 @@ vopen__(char** dst, int flags, const char* fmt, va_list vargs)
     return (fd > 0) ? fd : ONLP_STATUS_E_MISSING;
 }
 
+/**
+ * @brief Open a file or domain socket.
+ * @param dst Receives the full filename (for logging purposes).
+ * @param flags The open flags.
+ * @param fmt Format specifier.
+ * @param vargs Format specifier arguments.
+ */
+static int
+vopen__(char** dst, int flags, const char* fmt, va_list vargs)
+{
+    char fname[PATH_MAX];
+    ONLPLIB_VSNPRINTF(fname, sizeof(fname)-1, fmt, vargs);
+    return open__(dst, flags, fname);
+}
+
 int
 onlp_file_vsize(const char* fmt, va_list vargs)
 {
@@ -161,9 +496,23 @@ onlp_file_vread(uint8_t* data, int max, int* len, const char* fmt, va_list vargs
 {
     int fd;
     char* fname = NULL;
+    char name[PATH_MAX];
     int rv;
+#if ONLPLIB_CONFIG_FILE_INCLUDE_CACHE == 1
+    char key[PATH_MAX];
+#endif
 
-    if ((fd = vopen__(&fname, O_RDONLY, fmt, vargs)) < 0) {
+    ONLPLIB_VSNPRINTF(name, sizeof(name)-1, fmt, vargs);
+
+#if ONLPLIB_CONFIG_FILE_INCLUDE_CACHE == 1
+    if(file_cache_read__(name, data, max, len, &rv)) {
+        return rv;
+    }
+    /* open__() resolves name in place */
+    strcpy(key, name);
+#endif
+
+    if ((fd = open__(&fname, O_RDONLY | O_CLOEXEC, name)) < 0) {
         rv = fd;
     }
     else {
@@ -174,8 +523,15 @@ onlp_file_vread(uint8_t* data, int max, int* len, const char* fmt, va_list vargs
         }
         else {
             rv = ONLP_STATUS_OK;
+#if ONLPLIB_CONFIG_FILE_INCLUDE_CACHE == 1
+            if(file_cache_keep__(key, fd)) {
+                fd = -1;
+            }
+#endif
+        }
+        if(fd >= 0) {
+            close(fd);
         }
-        close(fd);
     }
     aim_free(fname);
     return rv;
@@ -411,6 +767,234 @@ onlp_file_vopen(int flags, int log, const char* fmt, va_list vargs)
     return rv;
 }
 
+int
+onlp_file_cache_enable(int enable)
+{
+#if ONLPLIB_CONFIG_FILE_INCLUDE_CACHE == 1
+    int rv;
+    onlp_file_cache_flush();
+    pthread_mutex_lock(&file_cache_lock__);
+    rv = file_cache_enabled__;
+    file_cache_enabled__ = enable;
+    pthread_mutex_unlock(&file_cache_lock__);
+    return rv;
+#else
+    return 0;
+#endif
+}
+
+void
+onlp_file_cache_flush(void)
+{
+#if ONLPLIB_CONFIG_FILE_INCLUDE_CACHE == 1
+    int i;
+    pthread_once(&file_cache_once__, file_cache_init__);
+    pthread_mutex_lock(&file_cache_lock__);
+    for(i = 0; i < AIM_ARRAYSIZE(file_cache__); i++) {
+        file_cache_entry_t* e = file_cache__ + i;
+        pthread_mutex_lock(&e->lock);
+        file_cache_drop__(e);
+        pthread_mutex_unlock(&e->lock);
+    }
+    pthread_mutex_unlock(&file_cache_lock__);
+#endif
+}
+
+void
+onlp_file_stats_get(onlp_file_stats_t* stats, int clear)
+{
+    stats->searches = clear ? __sync_fetch_and_and(&stats__.searches, 0) : stats__.searches;
+    stats->opens = clear ? __sync_fetch_and_and(&stats__.opens, 0) : stats__.opens;
+    stats->rereads = clear ? __sync_fetch_and_and(&stats__.rereads, 0) : stats__.rereads;
+    stats->flushes = clear ? __sync_fetch_and_and(&stats__.flushes, 0) : stats__.flushes;
+    stats->busy = clear ? __sync_fetch_and_and(&stats__.busy, 0) : stats__.busy;
+}
+
+void
+onlp_file_stats_show(aim_pvs_t* pvs)
+{
+    onlp_file_stats_t stats;
+    onlp_file_stats_get(&stats, 0);
+    aim_printf(pvs, "searches=%"PRIu64" opens=%"PRIu64" rereads=%"PRIu64" flushes=%"PRIu64" busy=%"PRIu64"\n",
+               stats.searches, stats.opens, stats.rereads, stats.flushes, stats.busy);
+}
+
+#include <pthread.h>
+
+typedef struct file_vec_attr_s {
+    char* name;
+    onlp_file_vec_type_t type;
+    int fd;
+} file_vec_attr_t;
+
+struct onlp_file_vec_s {
+    pthread_mutex_t lock;
+    file_vec_attr_t* attrs;
+    int count;
+    int size;
+};
+
+int
+onlp_file_vec_create(onlp_file_vec_t** rv)
+{
+    onlp_file_vec_t* vec;
+
+    if(rv == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    vec = aim_zmalloc(sizeof(*vec));
+    pthread_mutex_init(&vec->lock, NULL);
+    *rv = vec;
+    return 0;
+}
+
+void
+onlp_file_vec_destroy(onlp_file_vec_t* vec)
+{
+    int i;
+
+    if(vec == NULL) {
+        return;
+    }
+
+    for(i = 0; i < vec->count; i++) {
+        if(vec->attrs[i].fd >= 0) {
+            close(vec->attrs[i].fd);
+        }
+        aim_free(vec->attrs[i].name);
+    }
+    aim_free(vec->attrs);
+    pthread_mutex_destroy(&vec->lock);
+    aim_free(vec);
+}
+
+int
+onlp_file_vec_vadd(onlp_file_vec_t* vec, onlp_file_vec_type_t type,
+                   const char* fmt, va_list vargs)
+{
+    int rv;
+    file_vec_attr_t* a;
+
+    if(vec == NULL || fmt == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&vec->lock);
+    if(vec->count == vec->size) {
+        vec->size = vec->size ? vec->size * 2 : 8;
+        vec->attrs = aim_realloc(vec->attrs, vec->size * sizeof(*vec->attrs));
+    }
+    rv = vec->count++;
+    a = vec->attrs + rv;
+    a->name = aim_vdfstrdup(fmt, vargs);
+    a->type = type;
+    a->fd = -1;
+    pthread_mutex_unlock(&vec->lock);
+    return rv;
+}
+
+int
+onlp_file_vec_add(onlp_file_vec_t* vec, onlp_file_vec_type_t type,
+                  const char* fmt, ...)
+{
+    int rv;
+    va_list vargs;
+    va_start(vargs, fmt);
+    rv = onlp_file_vec_vadd(vec, type, fmt, vargs);
+    va_end(vargs);
+    return rv;
+}
+
+int
+onlp_file_vec_count(onlp_file_vec_t* vec)
+{
+    return vec ? vec->count : 0;
+}
+
+/*
+ * Read one attribute, opening it if necessary.
+ * A descriptor which fails is closed and the attribute reopened
+ * once, in case it was removed and created again.
+ */
+static int
+file_vec_read__(file_vec_attr_t* a, char* buf, int size)
+{
+    int tries;
+    int len;
+
+    for(tries = 0; tries < 2; tries++) {
+        if(a->fd < 0) {
+            char fname[PATH_MAX];
+            aim_strlcpy(fname, a->name, sizeof(fname));
+            if((a->fd = open__(NULL, O_RDONLY | O_CLOEXEC, fname)) < 0) {
+                int rv = a->fd;
+                a->fd = -1;
+                return rv;
+            }
+            tries++;
+        }
+        else {
+            FILE_STAT_INC(rereads);
+        }
+
+        if((len = pread(a->fd, buf, size - 1, 0)) > 0) {
+            buf[len] = 0;
+            return len;
+        }
+        if(len == 0) {
+            /* Empty, but the descriptor is still good. */
+            return ONLP_STATUS_E_INTERNAL;
+        }
+
+        close(a->fd);
+        a->fd = -1;
+        FILE_STAT_INC(flushes);
+    }
+    return ONLP_STATUS_E_INTERNAL;
+}
+
+int
+onlp_file_vec_read(onlp_file_vec_t* vec, onlp_file_vec_result_t* results)
+{
+    int i;
+    int rv = 0;
+
+    if(vec == NULL || results == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&vec->lock);
+    for(i = 0; i < vec->count; i++) {
+        file_vec_attr_t* a = vec->attrs + i;
+        onlp_file_vec_result_t* r = results + i;
+        char buf[ONLPLIB_CONFIG_FILE_VEC_STR_MAX];
+        int len;
+
+        memset(r, 0, sizeof(*r));
+        if((len = file_vec_read__(a, buf, sizeof(buf))) < 0) {
+            r->status = len;
+            continue;
+        }
+
+        switch(a->type)
+            {
+            case ONLP_FILE_VEC_TYPE_INT:
+                r->value = ONLPLIB_ATOI(buf);
+                break;
+            case ONLP_FILE_VEC_TYPE_STR:
+                while(len && (buf[len-1] == '\n' || buf[len-1] == '\r')) {
+                    buf[--len] = 0;
+                }
+                aim_strlcpy(r->str, buf, sizeof(r->str));
+                break;
+            }
+        rv++;
+    }
+    pthread_mutex_unlock(&vec->lock);
+    return rv;
+}
+
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <err.h>
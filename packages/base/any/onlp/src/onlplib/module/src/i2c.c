@@ -33,55 +33,540 @@
 #include <sys/types.h>
 #include <sys/ioctl.h>
 #include <errno.h>
+#include <inttypes.h>
 #include <onlp/onlp.h>
 #include "onlplib_log.h"
 
+static onlp_i2c_stats_t stats__;
+#define I2C_STAT_INC(_field) __sync_fetch_and_add(&stats__._field, 1)
+
+/*
+ * Adapter functionality (I2C_FUNCS) per bus.
+ * Zero means not yet queried.
+ */
+static unsigned long funcs__[ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE];
+
+/*
+ * Program the descriptor for the given address and flags.
+ * Only the settings which differ from the current address
+ * and flags are reprogrammed. A current address of -1
+ * indicates a newly opened descriptor.
+ */
+static int
+i2c_configure__(int fd, int bus, uint8_t addr, uint32_t flags,
+                int caddr, uint32_t cflags)
+{
+    int rv;
+    uint32_t changed = flags ^ cflags;
+
+    if(caddr < 0 || (changed & ONLP_I2C_F_TENBIT)) {
+        /* Set 10 or 7 bit mode */
+        I2C_STAT_INC(ioctls);
+        rv = ioctl(fd, I2C_TENBIT, (flags & ONLP_I2C_F_TENBIT) ? 1 : 0);
+        if(rv == -1) {
+            rv = errno;
+            AIM_LOG_ERROR("i2c-%d: failed to set %d bit mode", bus,
+                          (flags & ONLP_I2C_F_TENBIT) ? 10 : 7);
+            errno = rv;
+            return ONLP_STATUS_E_I2C;
+        }
+    }
+
+    if(caddr < 0 || (changed & ONLP_I2C_F_PEC)) {
+        /* Enable/Disable PEC */
+        I2C_STAT_INC(ioctls);
+        rv = ioctl(fd, I2C_PEC, (flags & ONLP_I2C_F_PEC) ? 1 : 0);
+        if(rv == -1) {
+            rv = errno;
+            AIM_LOG_ERROR("i2c-%d: failed to set PEC mode %d", bus,
+                          (flags & ONLP_I2C_F_PEC) ? 1 : 0);
+            errno = rv;
+            return ONLP_STATUS_E_I2C;
+        }
+    }
+
+    if(caddr != addr || (changed & ONLP_I2C_F_FORCE)) {
+        /* Set SLAVE or SLAVE_FORCE address */
+        I2C_STAT_INC(ioctls);
+        rv = ioctl(fd,
+                   (flags & ONLP_I2C_F_FORCE) ? I2C_SLAVE_FORCE : I2C_SLAVE,
+                   addr);
+
+        if(rv == -1) {
+            rv = errno;
+            AIM_LOG_ERROR("i2c-%d: %s slave address 0x%x failed: %{errno}",
+                          bus,
+                          (flags & ONLP_I2C_F_FORCE) ? "forcing" : "setting",
+                          addr,
+                          rv);
+            errno = rv;
+            return ONLP_STATUS_E_I2C;
+        }
+    }
+
+    return 0;
+}
+
 int
 onlp_i2c_open(int bus, uint8_t addr, uint32_t flags)
 {
     int fd;
-    int rv;
 
-    fd = onlp_file_open(O_RDWR, 1, "/dev/i2c-%d", bus);
+    fd = onlp_file_open(O_RDWR | O_CLOEXEC, 1, "/dev/i2c-%d", bus);
     if(fd < 0) {
         return fd;
     }
+    I2C_STAT_INC(opens);
 
-    /* Set 10 or 7 bit mode */
-    rv = ioctl(fd, I2C_TENBIT, (flags & ONLP_I2C_F_TENBIT) ? 1 : 0);
-    if(rv == -1) {
-        AIM_LOG_ERROR("i2c-%d: failed to set %d bit mode", bus,
-                      (flags & ONLP_I2C_F_TENBIT) ? 10 : 7);
-        goto error;
+    if(i2c_configure__(fd, bus, addr, flags, -1, 0) < 0) {
+        close(fd);
+        return ONLP_STATUS_E_I2C;
     }
 
-    /* Enable/Disable PEC */
-    rv = ioctl(fd, I2C_PEC, (flags & ONLP_I2C_F_PEC) ? 1 : 0);
-    if(rv == -1) {
-        AIM_LOG_ERROR("i2c-%d: failed to set PEC mode %d", bus,
-                      (flags & ONLP_I2C_F_PEC) ? 1 : 0);
-        goto error;
+    return fd;
+}
+
+
+#if ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE == 1
+
+#include <pthread.h>
+
+/**
+ * Per-bus descriptor cache.
+ *
+ * Each entry holds an open descriptor and the address and flags
+ * it is currently programmed for. The entry lock is held for the
+ * duration of each transaction since the slave address is a
+ * property of the descriptor. Descriptors are private to each
+ * process so this does not interact with the ONLP API locks.
+ */
+typedef struct i2c_fd_cache_entry_s {
+    pthread_mutex_t lock;
+    int fd;
+    int addr;
+    uint32_t flags;
+} i2c_fd_cache_entry_t;
+
+static i2c_fd_cache_entry_t fd_cache__[ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE];
+static pthread_once_t fd_cache_once__ = PTHREAD_ONCE_INIT;
+
+static void
+fd_cache_reset__(void)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(fd_cache__); i++) {
+        pthread_mutex_init(&fd_cache__[i].lock, NULL);
+        fd_cache__[i].fd = -1;
+        fd_cache__[i].addr = -1;
+        fd_cache__[i].flags = 0;
     }
+}
 
-    /* Set SLAVE or SLAVE_FORCE address */
-    rv = ioctl(fd,
-               (flags & ONLP_I2C_F_FORCE) ? I2C_SLAVE_FORCE : I2C_SLAVE,
-               addr);
+static void
+fd_cache_atfork_child__(void)
+{
+    int i;
+    /*
+     * The child shares the parent's open file descriptions
+     * (and therefore their slave addresses). Drop them.
+     */
+    for(i = 0; i < AIM_ARRAYSIZE(fd_cache__); i++) {
+        if(fd_cache__[i].fd >= 0) {
+            close(fd_cache__[i].fd);
+        }
+    }
+    fd_cache_reset__();
+}
 
-    if(rv == -1) {
-        AIM_LOG_ERROR("i2c-%d: %s slave address 0x%x failed: %{errno}",
-                      bus,
-                      (flags & ONLP_I2C_F_FORCE) ? "forcing" : "setting",
-                      addr,
-                      errno);
-        goto error;
+static void
+fd_cache_init__(void)
+{
+    fd_cache_reset__();
+    pthread_atfork(NULL, NULL, fd_cache_atfork_child__);
+}
+
+static i2c_fd_cache_entry_t*
+fd_cache_entry__(int bus)
+{
+    if(bus < 0 || bus >= AIM_ARRAYSIZE(fd_cache__)) {
+        return NULL;
     }
+    pthread_once(&fd_cache_once__, fd_cache_init__);
+    return fd_cache__ + bus;
+}
 
-    return fd;
+/*
+ * Errors which mean the descriptor itself is no longer usable
+ * (e.g. the adapter was removed). Errors from the device, such as
+ * a NAK (ENXIO, EREMOTEIO) or a timeout, leave the descriptor open.
+ */
+static int
+fd_cache_error__(int error)
+{
+    return error == EBADF || error == ENODEV;
+}
 
- error:
+static void
+fd_cache_close__(i2c_fd_cache_entry_t* e)
+{
+    if(e->fd >= 0) {
+        close(e->fd);
+        I2C_STAT_INC(flushes);
+    }
+    e->fd = -1;
+    e->addr = -1;
+    e->flags = 0;
+}
+
+#endif /* ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE */
+
+/*
+ * Get a descriptor for a transaction.
+ * Must be paired with i2c_fd_give__().
+ * An address of -1 returns the descriptor without programming
+ * the slave address (for combined transfers).
+ */
+static int
+i2c_fd_take__(int bus, int addr, uint32_t flags)
+{
+#if ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE == 1
+    i2c_fd_cache_entry_t* e = fd_cache_entry__(bus);
+    if(e) {
+        pthread_mutex_lock(&e->lock);
+        if(e->fd < 0) {
+            e->fd = onlp_file_open(O_RDWR | O_CLOEXEC, 1, "/dev/i2c-%d", bus);
+            if(e->fd < 0) {
+                int rv = e->fd;
+                fd_cache_close__(e);
+                pthread_mutex_unlock(&e->lock);
+                return rv;
+            }
+            I2C_STAT_INC(opens);
+        }
+        else {
+            I2C_STAT_INC(reuses);
+        }
+
+        if(addr < 0) {
+            return e->fd;
+        }
+
+        if(i2c_configure__(e->fd, bus, addr, flags, e->addr, e->flags) < 0) {
+            if(fd_cache_error__(errno)) {
+                fd_cache_close__(e);
+            }
+            else {
+                /* Reprogram everything on the next transaction. */
+                e->addr = -1;
+            }
+            pthread_mutex_unlock(&e->lock);
+            return ONLP_STATUS_E_I2C;
+        }
+        e->addr = addr;
+        e->flags = flags;
+        return e->fd;
+    }
+#endif
+    if(addr < 0) {
+        int fd = onlp_file_open(O_RDWR | O_CLOEXEC, 1, "/dev/i2c-%d", bus);
+        if(fd >= 0) {
+            I2C_STAT_INC(opens);
+        }
+        return fd;
+    }
+    return onlp_i2c_open(bus, addr, flags);
+}
+
+/*
+ * Release a descriptor after a transaction.
+ * error is the errno of a failed transaction, or 0.
+ * The cached descriptor is discarded if it went bad.
+ */
+static void
+i2c_fd_give__(int bus, int fd, int error)
+{
+#if ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE == 1
+    i2c_fd_cache_entry_t* e = fd_cache_entry__(bus);
+    if(e) {
+        if(fd_cache_error__(error)) {
+            fd_cache_close__(e);
+        }
+        pthread_mutex_unlock(&e->lock);
+        return;
+    }
+#endif
     close(fd);
-    return ONLP_STATUS_E_I2C;
+}
+
+int
+onlp_i2c_flush(int bus)
+{
+    int i;
+
+    for(i = 0; i < AIM_ARRAYSIZE(funcs__); i++) {
+        if(bus < 0 || bus == i) {
+            funcs__[i] = 0;
+        }
+    }
+
+#if ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE == 1
+    for(i = 0; i < AIM_ARRAYSIZE(fd_cache__); i++) {
+        if(bus < 0 || bus == i) {
+            i2c_fd_cache_entry_t* e = fd_cache_entry__(i);
+            pthread_mutex_lock(&e->lock);
+            fd_cache_close__(e);
+            pthread_mutex_unlock(&e->lock);
+        }
+    }
+#endif
+
+    onlp_i2c_mux_cache_invalidate(bus);
+    return 0;
+}
+
+void
+onlp_i2c_stats_get(onlp_i2c_stats_t* stats, int clear)
+{
+    stats->opens = clear ? __sync_fetch_and_and(&stats__.opens, 0) : stats__.opens;
+    stats->ioctls = clear ? __sync_fetch_and_and(&stats__.ioctls, 0) : stats__.ioctls;
+    stats->reuses = clear ? __sync_fetch_and_and(&stats__.reuses, 0) : stats__.reuses;
+    stats->flushes = clear ? __sync_fetch_and_and(&stats__.flushes, 0) : stats__.flushes;
+    stats->transfers = clear ? __sync_fetch_and_and(&stats__.transfers, 0) : stats__.transfers;
+    stats->mux_writes = clear ? __sync_fetch_and_and(&stats__.mux_writes, 0) : stats__.mux_writes;
+    stats->mux_skips = clear ? __sync_fetch_and_and(&stats__.mux_skips, 0) : stats__.mux_skips;
+}
+
+void
+onlp_i2c_stats_show(aim_pvs_t* pvs)
+{
+    onlp_i2c_stats_t stats;
+    onlp_i2c_stats_get(&stats, 0);
+    aim_printf(pvs, "opens=%"PRIu64" ioctls=%"PRIu64" reuses=%"PRIu64" flushes=%"PRIu64" transfers=%"PRIu64" mux_writes=%"PRIu64" mux_skips=%"PRIu64"\n",
+               stats.opens, stats.ioctls, stats.reuses, stats.flushes, stats.transfers,
+               stats.mux_writes, stats.mux_skips);
+}
+
+#ifndef I2C_M_STOP
+#define I2C_M_STOP 0x8000
+#endif
+
+#ifndef I2C_FUNC_PROTOCOL_MANGLING
+#define I2C_FUNC_PROTOCOL_MANGLING 0x00000004
+#endif
+
+static int
+i2c_funcs_get__(int bus, int fd, unsigned long* funcs)
+{
+    if(bus >= 0 && bus < AIM_ARRAYSIZE(funcs__) && funcs__[bus]) {
+        *funcs = funcs__[bus];
+        return 0;
+    }
+
+    I2C_STAT_INC(ioctls);
+    if(ioctl(fd, I2C_FUNCS, funcs) < 0) {
+        AIM_LOG_ERROR("i2c-%d: I2C_FUNCS failed: %{errno}", bus, errno);
+        return ONLP_STATUS_E_I2C;
+    }
+
+    if(bus >= 0 && bus < AIM_ARRAYSIZE(funcs__)) {
+        funcs__[bus] = *funcs;
+    }
+    return 0;
+}
+
+static int
+i2c_transfer_supported__(int bus, int fd, int stop)
+{
+#if ONLPLIB_CONFIG_I2C_INCLUDE_RDWR == 1
+    unsigned long funcs;
+    if(i2c_funcs_get__(bus, fd, &funcs) < 0) {
+        return 0;
+    }
+    if(!(funcs & I2C_FUNC_I2C)) {
+        return 0;
+    }
+    if(stop && !(funcs & I2C_FUNC_PROTOCOL_MANGLING)) {
+        return 0;
+    }
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+int
+onlp_i2c_transfer_supported(int bus, int stop)
+{
+    int fd, rv;
+
+    fd = i2c_fd_take__(bus, -1, 0);
+    if(fd < 0) {
+        return fd;
+    }
+    rv = i2c_transfer_supported__(bus, fd, stop);
+    i2c_fd_give__(bus, fd, 0);
+    return rv;
+}
+
+/*
+ * Execute a combined transfer. If addr is not -1 the descriptor is
+ * programmed for addr first, so the transfer is refused (EBUSY) like
+ * the SMBus path when a kernel driver owns the address and
+ * ONLP_I2C_F_FORCE is not set.
+ */
+static int
+i2c_transfer__(int bus, int addr, onlp_i2c_msg_t* msgs, int count,
+               uint32_t flags)
+{
+#if ONLPLIB_CONFIG_I2C_INCLUDE_RDWR == 1
+    int i, fd, rv;
+    int stop = 0;
+    int reads = 0;
+    int retries;
+    struct i2c_msg kmsgs[ONLP_I2C_TRANSFER_MSGS_MAX];
+    struct i2c_rdwr_ioctl_data data;
+
+    for(i = 0; i < count; i++) {
+        kmsgs[i].addr = msgs[i].addr;
+        kmsgs[i].flags = 0;
+        kmsgs[i].len = msgs[i].len;
+        kmsgs[i].buf = msgs[i].buf;
+
+        if(flags & ONLP_I2C_F_TENBIT) {
+            kmsgs[i].flags |= I2C_M_TEN;
+        }
+        if(msgs[i].flags & ONLP_I2C_MSG_F_READ) {
+            kmsgs[i].flags |= I2C_M_RD;
+            reads++;
+        }
+        /* The final message is always followed by a STOP. */
+        if((msgs[i].flags & ONLP_I2C_MSG_F_STOP) && i < count - 1) {
+            kmsgs[i].flags |= I2C_M_STOP;
+            stop = 1;
+        }
+    }
+
+    data.msgs = kmsgs;
+    data.nmsgs = count;
+
+    fd = i2c_fd_take__(bus, addr, flags);
+    if(fd < 0) {
+        return fd;
+    }
+
+    if(!i2c_transfer_supported__(bus, fd, stop)) {
+        i2c_fd_give__(bus, fd, 0);
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    /* Writes are not retried. */
+    retries = (reads == 0 || (flags & ONLP_I2C_F_DISABLE_READ_RETRIES)) ?
+        1 : ONLPLIB_CONFIG_I2C_READ_RETRY_COUNT;
+
+    rv = -1;
+    while(retries-- && rv < 0) {
+        I2C_STAT_INC(transfers);
+        rv = ioctl(fd, I2C_RDWR, &data);
+        if(rv < 0 && errno == EOPNOTSUPP) {
+            break;
+        }
+    }
+
+    if(rv < 0 && errno == EOPNOTSUPP) {
+        /*
+         * Some adapters advertise I2C_FUNC_I2C but refuse the transfer
+         * (or the STOPs in it). Stop trying and let the caller fall
+         * back to SMBus.
+         */
+        AIM_LOG_VERBOSE("i2c-%d: combined transfers are not supported.", bus);
+        if(bus >= 0 && bus < AIM_ARRAYSIZE(funcs__)) {
+            funcs__[bus] &= ~(stop ? I2C_FUNC_PROTOCOL_MANGLING : I2C_FUNC_I2C);
+        }
+        i2c_fd_give__(bus, fd, 0);
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    if(rv != count) {
+        int error = (rv < 0) ? errno : 0;
+        AIM_LOG_ERROR("i2c-%d: transfer of %d messages to address 0x%x failed: %{errno}",
+                      bus, count, msgs[count-1].addr, error);
+        i2c_fd_give__(bus, fd, error);
+        return ONLP_STATUS_E_I2C;
+    }
+
+    i2c_fd_give__(bus, fd, 0);
+    return 0;
+#else
+    return ONLP_STATUS_E_UNSUPPORTED;
+#endif
+}
+
+int
+onlp_i2c_transfer(int bus, onlp_i2c_msg_t* msgs, int count, uint32_t flags)
+{
+    if(msgs == NULL || count <= 0 || count > ONLP_I2C_TRANSFER_MSGS_MAX) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    return i2c_transfer__(bus, -1, msgs, count, flags);
+}
+
+int
+onlp_i2c_root_bus_get(int bus)
+{
+    char path[64];
+    char* real;
+    char* s;
+    char* saveptr = NULL;
+    int root = bus;
+
+    /*
+     * Mux channels are registered below their parent adapter, e.g.
+     * /sys/devices/pci0000:00/0000:00:1f.3/i2c-0/0-0070/i2c-20.
+     * The first adapter in the path is the physical one. Only whole
+     * "i2c-<n>" components are adapters; parent devices such as
+     * i2c-gpio.1 are not.
+     */
+    snprintf(path, sizeof(path), "/sys/bus/i2c/devices/i2c-%d", bus);
+    if((real = realpath(path, NULL)) == NULL) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    for(s = strtok_r(real, "/", &saveptr); s; s = strtok_r(NULL, "/", &saveptr)) {
+        if(!strncmp(s, "i2c-", 4) && s[4] && strspn(s + 4, "0123456789") == strlen(s + 4)) {
+            root = atoi(s + 4);
+            break;
+        }
+    }
+    free(real);
+    return root;
+}
+
+/*
+ * Read a block using combined (offset write, data read) transfers.
+ * The address is claimed with I2C_SLAVE first, as for SMBus reads.
+ */
+static int
+i2c_transfer_block_read__(int bus, uint8_t addr, uint8_t offset, int size,
+                          uint8_t* rdata, uint32_t flags)
+{
+    int rv;
+    uint8_t* p = rdata;
+
+    while(size > 0) {
+        int rsize = (size >= ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE) ?
+            ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE : size;
+        onlp_i2c_msg_t msgs[] = {
+            { addr, 0, 1, &offset },
+            { addr, ONLP_I2C_MSG_F_READ, rsize, p },
+        };
+
+        if((rv = i2c_transfer__(bus, addr, msgs, 2, flags)) < 0) {
+            return rv;
+        }
+        offset += rsize;
+        p += rsize;
+        size -= rsize;
+    }
+    return 0;
 }
 
 int
@@ -89,8 +574,17 @@ onlp_i2c_block_read(int bus, uint8_t addr, uint8_t offset, int size,
                     uint8_t* rdata, uint32_t flags)
 {
     int fd;
+    int error;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    if(!(flags & ONLP_I2C_F_USE_SMBUS_BLOCK_READ)) {
+        int rv = i2c_transfer_block_read__(bus, addr, offset, size, rdata, flags);
+        if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+            return rv;
+        }
+        /* Fall back to SMBus block reads. */
+    }
+
+    fd = i2c_fd_take__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -118,8 +612,9 @@ onlp_i2c_block_read(int bus, uint8_t addr, uint8_t offset, int size,
         }
 
         if(rv != rsize) {
+            error = (rv < 0) ? errno : 0;
             AIM_LOG_ERROR("i2c-%d: reading address 0x%x, offset %d, size=%d failed: %{errno}",
-                          bus, addr, p - rdata, rsize, errno);
+                          bus, addr, p - rdata, rsize, error);
             goto error;
         }
 
@@ -127,11 +622,11 @@ onlp_i2c_block_read(int bus, uint8_t addr, uint8_t offset, int size,
         count -= rsize;
     }
 
-    close(fd);
+    i2c_fd_give__(bus, fd, 0);
     return 0;
 
  error:
-    close(fd);
+    i2c_fd_give__(bus, fd, error);
     return ONLP_STATUS_E_I2C;
 }
 
@@ -141,8 +636,9 @@ onlp_i2c_read(int bus, uint8_t addr, uint8_t offset, int size,
 {
     int i;
     int fd;
+    int error;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_take__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -157,19 +653,20 @@ onlp_i2c_read(int bus, uint8_t addr, uint8_t offset, int size,
         }
 
         if(rv < 0) {
+            error = errno;
             AIM_LOG_ERROR("i2c-%d: reading address 0x%x, offset %d failed: %{errno}",
-                          bus, addr, offset+i, errno);
+                          bus, addr, offset+i, error);
             goto error;
         }
         else {
             rdata[i] = rv;
         }
     }
-    close(fd);
+    i2c_fd_give__(bus, fd, 0);
     return 0;
 
  error:
-    close(fd);
+    i2c_fd_give__(bus, fd, error);
     return ONLP_STATUS_E_I2C;
 }
 
@@ -180,8 +677,9 @@ onlp_i2c_write(int bus, uint8_t addr, uint8_t offset, int size,
 {
     int i;
     int fd;
+    int error;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_take__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -190,16 +688,17 @@ onlp_i2c_write(int bus, uint8_t addr, uint8_t offset, int size,
     for(i = 0; i < size; i++) {
         int rv = i2c_smbus_write_byte_data(fd, offset+i, data[i]);
         if(rv < 0) {
+            error = errno;
             AIM_LOG_ERROR("i2c-%d: writing address 0x%x, offset %d failed: %{errno}",
-                          bus, addr, offset+i, errno);
+                          bus, addr, offset+i, error);
             goto error;
         }
     }
-    close(fd);
+    i2c_fd_give__(bus, fd, 0);
     return 0;
 
  error:
-    close(fd);
+    i2c_fd_give__(bus, fd, error);
     return ONLP_STATUS_E_I2C;
 }
 
@@ -236,7 +735,7 @@ onlp_i2c_readw(int bus, uint8_t addr, uint8_t offset, uint32_t flags)
     int fd;
     int rv;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_take__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -244,7 +743,7 @@ onlp_i2c_readw(int bus, uint8_t addr, uint8_t offset, uint32_t flags)
 
     rv = i2c_smbus_read_word_data(fd, offset);
 
-    close(fd);
+    i2c_fd_give__(bus, fd, (rv < 0) ? errno : 0);
     return rv;
 }
 
@@ -255,7 +754,7 @@ onlp_i2c_writew(int bus, uint8_t addr, uint8_t offset, uint16_t word,
     int fd;
     int rv;
 
-    fd = onlp_i2c_open(bus, addr, flags);
+    fd = i2c_fd_take__(bus, addr, flags);
 
     if(fd < 0) {
         return fd;
@@ -263,38 +762,304 @@ onlp_i2c_writew(int bus, uint8_t addr, uint8_t offset, uint16_t word,
 
     rv = i2c_smbus_write_word_data(fd, offset, word);
 
-    close(fd);
+    i2c_fd_give__(bus, fd, (rv < 0) ? errno : 0);
     return rv;
 
 }
 
-int
-onlp_i2c_mux_select(onlp_i2c_mux_device_t* dev, int channel)
+/*
+ * Mux cache.
+ *
+ * The last value written to each mux's control register is remembered
+ * so that selecting an already selected channel costs nothing.
+ *
+ * Other processes may reprogram the same muxes between our API calls.
+ * Every mux write bumps a per-bus generation counter in shared memory.
+ * A process only trusts its cached state for a bus while the shared
+ * generation matches the value it recorded after its own last write.
+ */
+#if ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE == 1
+
+#include <onlplib/shlocks.h>
+
+#define I2C_MUX_SHM_KEY 0xF00DF00E
+#define I2C_MUX_BUS_COUNT ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE
+
+typedef struct i2c_mux_cache_entry_s {
+    onlp_i2c_mux_device_t* dev;
+    int valid;
+    uint8_t value;
+} i2c_mux_cache_entry_t;
+
+static i2c_mux_cache_entry_t mux_cache__[ONLPLIB_CONFIG_I2C_MUX_CACHE_SIZE];
+static pthread_mutex_t mux_cache_lock__ = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t mux_cache_once__ = PTHREAD_ONCE_INIT;
+static int mux_cache_enabled__ = 1;
+
+/* Per-bus locks held from a mux select until the device access is done. */
+static onlp_shrwlock_t* mux_locks__ = NULL;
+
+/* Shared generations and the values we last observed. */
+static uint32_t* mux_generations__ = NULL;
+static uint32_t mux_local_generations__[I2C_MUX_BUS_COUNT];
+
+static void
+mux_cache_init__(void)
+{
+    void* mem = NULL;
+    if(onlp_shmem_create(I2C_MUX_SHM_KEY,
+                         sizeof(uint32_t)*I2C_MUX_BUS_COUNT, &mem) < 0) {
+        /* Without the shared generations we cannot detect other writers. */
+        AIM_LOG_WARN("i2c mux cache disabled.");
+        mux_cache_enabled__ = 0;
+        return;
+    }
+    if(onlp_shrwlock_create(ONLPLIB_CONFIG_I2C_MUX_LOCK_FILENAME,
+                            I2C_MUX_BUS_COUNT, &mux_locks__) < 0) {
+        AIM_LOG_WARN("i2c mux cache disabled.");
+        mux_cache_enabled__ = 0;
+        return;
+    }
+    mux_generations__ = mem;
+    memcpy(mux_local_generations__, mux_generations__,
+           sizeof(mux_local_generations__));
+}
+
+/*
+ * A cached mux state is only good until someone else programs the mux.
+ * Device accesses lock their bus from the mux selects until the access
+ * has completed, and writes are only skipped under that lock.
+ * Returns the locked bus, or -1 if nothing was locked.
+ */
+static int
+mux_bus_lock__(int bus)
+{
+    pthread_once(&mux_cache_once__, mux_cache_init__);
+
+    if(!mux_cache_enabled__ || bus < 0 || bus >= I2C_MUX_BUS_COUNT) {
+        return -1;
+    }
+    onlp_shrwlock_take(mux_locks__, bus, 1);
+    return bus;
+}
+
+static void
+mux_bus_unlock__(int locked)
+{
+    if(locked >= 0) {
+        onlp_shrwlock_give(mux_locks__, locked);
+    }
+}
+
+static void
+mux_cache_invalidate_locked__(int bus)
 {
     int i;
-    for(i = 0; i < AIM_ARRAYSIZE(dev->driver->channels); i++) {
-        if(dev->driver->channels[i].channel == channel) {
-            AIM_LOG_VERBOSE("i2c_mux_select: Selecting channel %2d on device '%s'  [ bus=%d addr=0x%x offset=0x%x value=0x%x ]...",
-                        channel, dev->name, dev->bus, dev->devaddr,
-                        dev->driver->control, dev->driver->channels[i].value);
+    for(i = 0; i < AIM_ARRAYSIZE(mux_cache__); i++) {
+        if(mux_cache__[i].dev && (bus < 0 || mux_cache__[i].dev->bus == bus)) {
+            mux_cache__[i].valid = 0;
+        }
+    }
+}
 
-            int rv = onlp_i2c_writeb(dev->bus,
-                                     dev->devaddr,
-                                     dev->driver->control,
-                                     dev->driver->channels[i].value,
-                                     0);
+/*
+ * Find (or allocate) the cache entry for a mux.
+ * Returns NULL if the mux cannot be cached.
+ * Called with mux_cache_lock__ held.
+ */
+static i2c_mux_cache_entry_t*
+mux_cache_entry__(onlp_i2c_mux_device_t* dev)
+{
+    int i;
+    i2c_mux_cache_entry_t* slot = NULL;
 
-            if(rv < 0) {
-                AIM_LOG_ERROR("i2c_mux_select: Selecting channel %2d on device '%s'  [ bus=%d addr=0x%x offset=0x%x value=0x%x ] failed: %d",
-                              channel, dev->name, dev->bus, dev->devaddr,
-                              dev->driver->control, dev->driver->channels[i].value, rv);
+    pthread_once(&mux_cache_once__, mux_cache_init__);
+
+    if(!mux_cache_enabled__ || dev->bus < 0 || dev->bus >= I2C_MUX_BUS_COUNT) {
+        return NULL;
+    }
+
+    if(mux_generations__[dev->bus] != mux_local_generations__[dev->bus]) {
+        /* Another process has programmed muxes on this bus. */
+        mux_cache_invalidate_locked__(dev->bus);
+        mux_local_generations__[dev->bus] = mux_generations__[dev->bus];
+    }
+
+    for(i = 0; i < AIM_ARRAYSIZE(mux_cache__); i++) {
+        if(mux_cache__[i].dev == dev) {
+            return mux_cache__ + i;
+        }
+        if(mux_cache__[i].dev == NULL && slot == NULL) {
+            slot = mux_cache__ + i;
+        }
+    }
+    if(slot) {
+        slot->dev = dev;
+        slot->valid = 0;
+    }
+    return slot;
+}
+
+/*
+ * Record the result of a mux write.
+ * Called with mux_cache_lock__ held.
+ */
+static void
+mux_cache_update__(onlp_i2c_mux_device_t* dev, i2c_mux_cache_entry_t* e,
+                   uint8_t value, int rv)
+{
+    uint32_t expected, generation;
+
+    if(mux_generations__ == NULL || dev->bus < 0 || dev->bus >= I2C_MUX_BUS_COUNT) {
+        return;
+    }
+
+    expected = mux_local_generations__[dev->bus] + 1;
+    generation = __sync_add_and_fetch(mux_generations__ + dev->bus, 1);
+    mux_local_generations__[dev->bus] = generation;
+
+    if(generation != expected) {
+        /* Raced with another process. Trust nothing. */
+        mux_cache_invalidate_locked__(dev->bus);
+        return;
+    }
+
+    if(e) {
+        e->valid = (rv >= 0);
+        e->value = value;
+    }
+}
+
+static void
+mux_channels_invalidate_locked__(onlp_i2c_mux_channels_t* mcs)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(mcs->channels); i++) {
+        if(mcs->channels[i].mux) {
+            i2c_mux_cache_entry_t* e = mux_cache_entry__(mcs->channels[i].mux);
+            if(e) {
+                e->valid = 0;
             }
-            return rv;
+        }
+    }
+}
+
+#define MUX_CACHE_LOCK() pthread_mutex_lock(&mux_cache_lock__)
+#define MUX_CACHE_UNLOCK() pthread_mutex_unlock(&mux_cache_lock__)
+
+#else
+
+typedef struct i2c_mux_cache_entry_s {
+    int valid;
+    uint8_t value;
+} i2c_mux_cache_entry_t;
+
+#define mux_cache_entry__(_dev) ((i2c_mux_cache_entry_t*)NULL)
+#define mux_bus_lock__(_bus) (-1)
+#define mux_bus_unlock__(_locked)
+#define mux_cache_update__(_dev, _e, _value, _rv)
+#define mux_channels_invalidate_locked__(_mcs)
+#define MUX_CACHE_LOCK()
+#define MUX_CACHE_UNLOCK()
+
+#endif /* ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE */
+
+int
+onlp_i2c_mux_cache_enable(int enable)
+{
+#if ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE == 1
+    int rv;
+    MUX_CACHE_LOCK();
+    rv = mux_cache_enabled__;
+    mux_cache_enabled__ = enable;
+    mux_cache_invalidate_locked__(-1);
+    MUX_CACHE_UNLOCK();
+    return rv;
+#else
+    return 0;
+#endif
+}
+
+void
+onlp_i2c_mux_cache_invalidate(int bus)
+{
+#if ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE == 1
+    MUX_CACHE_LOCK();
+    mux_cache_invalidate_locked__(bus);
+    MUX_CACHE_UNLOCK();
+#endif
+}
+
+static void
+mux_channels_invalidate__(onlp_i2c_mux_channels_t* mcs)
+{
+    MUX_CACHE_LOCK();
+    mux_channels_invalidate_locked__(mcs);
+    MUX_CACHE_UNLOCK();
+}
+
+static int
+mux_channel_value__(onlp_i2c_mux_device_t* dev, int channel, uint8_t* value)
+{
+    int i;
+    for(i = 0; i < AIM_ARRAYSIZE(dev->driver->channels); i++) {
+        if(dev->driver->channels[i].channel == channel) {
+            *value = dev->driver->channels[i].value;
+            return 0;
         }
     }
     return ONLP_STATUS_E_PARAM;
 }
 
+/*
+ * Select a mux channel. The write is only skipped if the cache says
+ * it is redundant and the mux's bus is locked by the caller.
+ */
+static int
+mux_select__(onlp_i2c_mux_device_t* dev, int channel, int locked)
+{
+    uint8_t value;
+    i2c_mux_cache_entry_t* e;
+
+    if(mux_channel_value__(dev, channel, &value) < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    MUX_CACHE_LOCK();
+    e = mux_cache_entry__(dev);
+    if(e && e->valid && e->value == value && dev->bus == locked) {
+        MUX_CACHE_UNLOCK();
+        I2C_STAT_INC(mux_skips);
+        return 0;
+    }
+
+    AIM_LOG_VERBOSE("i2c_mux_select: Selecting channel %2d on device '%s'  [ bus=%d addr=0x%x offset=0x%x value=0x%x ]...",
+                    channel, dev->name, dev->bus, dev->devaddr,
+                    dev->driver->control, value);
+
+    int rv = onlp_i2c_writeb(dev->bus,
+                             dev->devaddr,
+                             dev->driver->control,
+                             value,
+                             0);
+    I2C_STAT_INC(mux_writes);
+    mux_cache_update__(dev, e, value, rv);
+    MUX_CACHE_UNLOCK();
+
+    if(rv < 0) {
+        AIM_LOG_ERROR("i2c_mux_select: Selecting channel %2d on device '%s'  [ bus=%d addr=0x%x offset=0x%x value=0x%x ] failed: %d",
+                      channel, dev->name, dev->bus, dev->devaddr,
+                      dev->driver->control, value, rv);
+    }
+    return rv;
+}
+
+int
+onlp_i2c_mux_select(onlp_i2c_mux_device_t* dev, int channel)
+{
+    return mux_select__(dev, channel, -1);
+}
+
 
 int
 onlp_i2c_mux_deselect(onlp_i2c_mux_device_t* dev)
@@ -317,13 +1082,14 @@ onlp_i2c_mux_channel_deselect(onlp_i2c_mux_channel_t* mc)
 }
 
 
-int
-onlp_i2c_mux_channels_select(onlp_i2c_mux_channels_t* mcs)
+static int
+mux_channels_select__(onlp_i2c_mux_channels_t* mcs, int locked)
 {
     int i;
     for(i = 0; i < AIM_ARRAYSIZE(mcs->channels); i++) {
         if(mcs->channels[i].mux) {
-            int rv = onlp_i2c_mux_channel_select(mcs->channels + i);
+            int rv = mux_select__(mcs->channels[i].mux,
+                                  mcs->channels[i].channel, locked);
             if(rv < 0) {
                 /** Error already reported */
                 return rv;
@@ -335,12 +1101,19 @@ onlp_i2c_mux_channels_select(onlp_i2c_mux_channels_t* mcs)
 
 
 int
-onlp_i2c_mux_channels_deselect(onlp_i2c_mux_channels_t* mcs)
+onlp_i2c_mux_channels_select(onlp_i2c_mux_channels_t* mcs)
+{
+    return mux_channels_select__(mcs, -1);
+}
+
+
+static int
+mux_channels_deselect__(onlp_i2c_mux_channels_t* mcs, int locked)
 {
     int i;
     for(i = AIM_ARRAYSIZE(mcs->channels) - 1; i >= 0; i--) {
         if(mcs->channels[i].mux) {
-            int rv = onlp_i2c_mux_channel_deselect(mcs->channels + i);
+            int rv = mux_select__(mcs->channels[i].mux, -1, locked);
             if(rv < 0) {
                 /** Error already reported. */
                 return rv;
@@ -351,6 +1124,13 @@ onlp_i2c_mux_channels_deselect(onlp_i2c_mux_channels_t* mcs)
 }
 
 
+int
+onlp_i2c_mux_channels_deselect(onlp_i2c_mux_channels_t* mcs)
+{
+    return mux_channels_deselect__(mcs, -1);
+}
+
+
 int
 onlp_i2c_dev_mux_channels_select(onlp_i2c_dev_t* dev)
 {
@@ -376,32 +1156,187 @@ onlp_i2c_dev_mux_channels_deselect(onlp_i2c_dev_t* dev)
 
 
 static int
-dev_mux_channels_select__(onlp_i2c_dev_t* dev, uint32_t flags)
+dev_mux_channels_select__(onlp_i2c_dev_t* dev, uint32_t flags, int locked)
 {
     if(flags & ONLP_I2C_F_NO_MUX_SELECT) {
         return 0;
     }
-    return onlp_i2c_dev_mux_channels_select(dev);
+    return mux_channels_select__((dev->pchannels) ? dev->pchannels : &dev->ichannels,
+                                 locked);
 }
 
 static int
-dev_mux_channels_deselect__(onlp_i2c_dev_t* dev, uint32_t flags)
+dev_mux_channels_deselect__(onlp_i2c_dev_t* dev, uint32_t flags, int locked)
 {
     if(flags & ONLP_I2C_F_NO_MUX_DESELECT) {
         return 0;
     }
-    return onlp_i2c_dev_mux_channels_deselect(dev);
+    return mux_channels_deselect__((dev->pchannels) ? dev->pchannels : &dev->ichannels,
+                                   locked);
+}
+
+/*
+ * A failed device access may be caused by a mux which is not in the
+ * state we believe it to be. Force the next access to reprogram them.
+ */
+static void
+dev_mux_channels_invalidate__(onlp_i2c_dev_t* dev)
+{
+    mux_channels_invalidate__((dev->pchannels) ? dev->pchannels : &dev->ichannels);
 }
 
 
+/*
+ * Perform a device block read as a single combined transfer:
+ *
+ *   mux selects (STOP after each), offset write, data read,
+ *   mux deselects (STOP after each).
+ *
+ * PCA954x muxes only switch channels on a STOP, so mux programming
+ * can only be merged if the adapter supports protocol mangling.
+ * Selects which the mux cache knows to be redundant are omitted,
+ * provided the caller holds the bus lock.
+ *
+ * Returns ONLP_STATUS_E_UNSUPPORTED if the request cannot be merged.
+ */
+typedef struct dev_mux_write_s {
+    onlp_i2c_mux_device_t* mux;
+    i2c_mux_cache_entry_t* entry;
+    uint8_t data[2];
+} dev_mux_write_t;
+
+static int
+dev_transfer_read__(onlp_i2c_dev_t* dev, uint8_t offset, int size,
+                    uint8_t* rdata, uint32_t flags, int locked)
+{
+    int i, rv;
+    int count = 0;
+    int writes = 0;
+    onlp_i2c_msg_t msgs[ONLP_I2C_TRANSFER_MSGS_MAX];
+    dev_mux_write_t mw[2*AIM_ARRAYSIZE(dev->ichannels.channels)];
+    onlp_i2c_mux_channels_t* mcs = (dev->pchannels) ? dev->pchannels : &dev->ichannels;
+    int select = !(flags & ONLP_I2C_F_NO_MUX_SELECT);
+    int deselect = !(flags & ONLP_I2C_F_NO_MUX_DESELECT);
+    int selects;
+    int skips = 0;
+
+    if(ONLPLIB_CONFIG_I2C_INCLUDE_RDWR == 0 ||
+       !(flags & ONLP_I2C_F_USE_BLOCK_READ) ||
+       (flags & ONLP_I2C_F_USE_SMBUS_BLOCK_READ) ||
+       size > ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    for(i = 0; i < AIM_ARRAYSIZE(mcs->channels); i++) {
+        onlp_i2c_mux_channel_t* mc = mcs->channels + i;
+        if(mc->mux && mc->mux->bus != dev->bus) {
+            /* Not on the same adapter. */
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+    }
+
+    MUX_CACHE_LOCK();
+
+    for(i = 0; select && i < AIM_ARRAYSIZE(mcs->channels); i++) {
+        onlp_i2c_mux_channel_t* mc = mcs->channels + i;
+        dev_mux_write_t* w = mw + writes;
+        if(mc->mux == NULL) {
+            continue;
+        }
+        w->mux = mc->mux;
+        w->entry = mux_cache_entry__(mc->mux);
+        w->data[0] = mc->mux->driver->control;
+        if(mux_channel_value__(mc->mux, mc->channel, &w->data[1]) < 0) {
+            MUX_CACHE_UNLOCK();
+            return ONLP_STATUS_E_PARAM;
+        }
+        if(w->entry && w->entry->valid && w->entry->value == w->data[1] &&
+           locked == dev->bus) {
+            skips++;
+            continue;
+        }
+        writes++;
+    }
+    selects = writes;
+
+    for(i = AIM_ARRAYSIZE(mcs->channels) - 1; deselect && i >= 0; i--) {
+        onlp_i2c_mux_channel_t* mc = mcs->channels + i;
+        dev_mux_write_t* w = mw + writes;
+        if(mc->mux == NULL) {
+            continue;
+        }
+        w->mux = mc->mux;
+        w->entry = mux_cache_entry__(mc->mux);
+        w->data[0] = mc->mux->driver->control;
+        if(mux_channel_value__(mc->mux, -1, &w->data[1]) < 0) {
+            MUX_CACHE_UNLOCK();
+            return ONLP_STATUS_E_PARAM;
+        }
+        writes++;
+    }
+
+    /*
+     * With no mux programming to merge the plain block read path
+     * performs the same transfer.
+     */
+    if(writes == 0 || onlp_i2c_transfer_supported(dev->bus, 1) != 1) {
+        MUX_CACHE_UNLOCK();
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    for(i = 0; i < selects; i++) {
+        msgs[count++] = (onlp_i2c_msg_t) { mw[i].mux->devaddr, ONLP_I2C_MSG_F_STOP, 2, mw[i].data };
+    }
+    msgs[count++] = (onlp_i2c_msg_t) { dev->addr, 0, 1, &offset };
+    msgs[count++] = (onlp_i2c_msg_t) { dev->addr,
+                                       ONLP_I2C_MSG_F_READ | ONLP_I2C_MSG_F_STOP,
+                                       size, rdata };
+    for(i = selects; i < writes; i++) {
+        msgs[count++] = (onlp_i2c_msg_t) { mw[i].mux->devaddr, ONLP_I2C_MSG_F_STOP, 2, mw[i].data };
+    }
+
+    /* Claim dev->addr as the SMBus path would. */
+    rv = i2c_transfer__(dev->bus, dev->addr, msgs, count, flags);
+    if(rv == ONLP_STATUS_E_UNSUPPORTED) {
+        /* The adapter refused the transfer. Don't trust the muxes. */
+        mux_channels_invalidate_locked__(mcs);
+        MUX_CACHE_UNLOCK();
+        return rv;
+    }
+
+    __sync_fetch_and_add(&stats__.mux_skips, skips);
+
+    /* Entries are updated in write order so the last value wins. */
+    for(i = 0; i < writes; i++) {
+        I2C_STAT_INC(mux_writes);
+        mux_cache_update__(mw[i].mux, mw[i].entry, mw[i].data[1], rv);
+    }
+    if(rv < 0) {
+        mux_channels_invalidate_locked__(mcs);
+    }
+
+    MUX_CACHE_UNLOCK();
+    return rv;
+}
+
 int
 onlp_i2c_dev_read(onlp_i2c_dev_t* dev, uint8_t offset, int size,
                   uint8_t* rdata, uint32_t flags)
 {
     int error, rv;
+    int locked = mux_bus_lock__(dev->bus);
+
+    rv = dev_transfer_read__(dev, offset, size, rdata, flags, locked);
+    if(rv != ONLP_STATUS_E_UNSUPPORTED) {
+        if(rv < 0) {
+            AIM_LOG_ERROR("Device %s: read() failed: %d",
+                          dev->name, rv);
+        }
+        goto done;
+    }
 
-    if( (error = dev_mux_channels_select__(dev, flags)) < 0) {
-        return error;
+    if( (rv = dev_mux_channels_select__(dev, flags, locked)) < 0) {
+        goto done;
     }
 
     if(flags & ONLP_I2C_F_USE_BLOCK_READ) {
@@ -414,13 +1349,16 @@ onlp_i2c_dev_read(onlp_i2c_dev_t* dev, uint8_t offset, int size,
     if( rv < 0 ) {
         AIM_LOG_ERROR("Device %s: read() failed: %d",
                       dev->name, rv);
-        return rv;
+        dev_mux_channels_invalidate__(dev);
+        goto done;
     }
 
-    if( (error = dev_mux_channels_deselect__(dev, flags)) < 0) {
-        return error;
+    if( (error = dev_mux_channels_deselect__(dev, flags, locked)) < 0) {
+        rv = error;
     }
 
+ done:
+    mux_bus_unlock__(locked);
     return rv;
 }
 
@@ -430,21 +1368,25 @@ onlp_i2c_dev_write(onlp_i2c_dev_t* dev,
                    uint8_t offset, int size, uint8_t* data, uint32_t flags)
 {
     int error, rv;
+    int locked = mux_bus_lock__(dev->bus);
 
-    if( (error = dev_mux_channels_select__(dev, flags)) < 0) {
-        return error;
+    if( (rv = dev_mux_channels_select__(dev, flags, locked)) < 0) {
+        goto done;
     }
 
     if( (rv = onlp_i2c_write(dev->bus, dev->addr, offset, size, data, flags)) < 0) {
         AIM_LOG_ERROR("Device %s: write() failed: %d",
                       dev->name, rv);
-        return rv;
+        dev_mux_channels_invalidate__(dev);
+        goto done;
     }
 
-    if( (error = dev_mux_channels_deselect__(dev, flags)) < 0) {
-        return error;
+    if( (error = dev_mux_channels_deselect__(dev, flags, locked)) < 0) {
+        rv = error;
     }
 
+ done:
+    mux_bus_unlock__(locked);
     return rv;
 }
 
@@ -453,21 +1395,25 @@ int
 onlp_i2c_dev_readb(onlp_i2c_dev_t* dev, uint8_t offset, uint32_t flags)
 {
     int error, rv;
+    int locked = mux_bus_lock__(dev->bus);
 
-    if( (error = dev_mux_channels_select__(dev, flags)) < 0) {
-        return error;
+    if( (rv = dev_mux_channels_select__(dev, flags, locked)) < 0) {
+        goto done;
     }
 
     if( (rv = onlp_i2c_readb(dev->bus, dev->addr, offset, flags)) < 0) {
         AIM_LOG_ERROR("Device %s: readb() failed: %d",
                       dev->name, rv);
-        return rv;
+        dev_mux_channels_invalidate__(dev);
+        goto done;
     }
 
-    if( (error = dev_mux_channels_deselect__(dev, flags)) < 0) {
-        return error;
+    if( (error = dev_mux_channels_deselect__(dev, flags, locked)) < 0) {
+        rv = error;
     }
 
+ done:
+    mux_bus_unlock__(locked);
     return rv;
 }
 
@@ -477,21 +1423,25 @@ onlp_i2c_dev_writeb(onlp_i2c_dev_t* dev,
                     uint8_t offset, uint8_t byte, uint32_t flags)
 {
     int error, rv;
+    int locked = mux_bus_lock__(dev->bus);
 
-    if( (error = dev_mux_channels_select__(dev, flags)) < 0) {
-        return error;
+    if( (rv = dev_mux_channels_select__(dev, flags, locked)) < 0) {
+        goto done;
     }
 
     if( (rv = onlp_i2c_writeb(dev->bus, dev->addr, offset, byte, flags)) < 0) {
         AIM_LOG_ERROR("Device %s: writeb() failed: %d",
                       dev->name, rv);
-        return rv;
+        dev_mux_channels_invalidate__(dev);
+        goto done;
     }
 
-    if( (error = dev_mux_channels_deselect__(dev, flags)) < 0) {
-        return error;
+    if( (error = dev_mux_channels_deselect__(dev, flags, locked)) < 0) {
+        rv = error;
     }
 
+ done:
+    mux_bus_unlock__(locked);
     return rv;
 }
 
@@ -501,21 +1451,25 @@ onlp_i2c_dev_readw(onlp_i2c_dev_t* dev,
                    uint8_t offset, uint32_t flags)
 {
     int error, rv;
+    int locked = mux_bus_lock__(dev->bus);
 
-    if( (error = dev_mux_channels_select__(dev, flags)) < 0) {
-        return error;
+    if( (rv = dev_mux_channels_select__(dev, flags, locked)) < 0) {
+        goto done;
     }
 
     if( (rv = onlp_i2c_readw(dev->bus, dev->addr, offset, flags)) < 0) {
         AIM_LOG_ERROR("Device %s: readw() failed: %d",
                       dev->name, rv);
-        return rv;
+        dev_mux_channels_invalidate__(dev);
+        goto done;
     }
 
-    if( (error = dev_mux_channels_deselect__(dev, flags)) < 0) {
-        return error;
+    if( (error = dev_mux_channels_deselect__(dev, flags, locked)) < 0) {
+        rv = error;
     }
 
+ done:
+    mux_bus_unlock__(locked);
     return rv;
 }
 
@@ -525,21 +1479,25 @@ onlp_i2c_dev_writew(onlp_i2c_dev_t* dev,
                         uint8_t offset, uint16_t word, uint32_t flags)
 {
     int error, rv;
+    int locked = mux_bus_lock__(dev->bus);
 
-    if( (error = dev_mux_channels_select__(dev, flags)) < 0) {
-        return error;
+    if( (rv = dev_mux_channels_select__(dev, flags, locked)) < 0) {
+        goto done;
     }
 
     if( (rv = onlp_i2c_writew(dev->bus, dev->addr, offset, word, flags)) < 0) {
         AIM_LOG_ERROR("Device %s: writew() failed: %d",
                       dev->name, rv);
-        return rv;
+        dev_mux_channels_invalidate__(dev);
+        goto done;
     }
 
-    if( (error = dev_mux_channels_deselect__(dev, flags)) < 0) {
-        return error;
+    if( (error = dev_mux_channels_deselect__(dev, flags, locked)) < 0) {
+        rv = error;
     }
 
+ done:
+    mux_bus_unlock__(locked);
     return rv;
 }
 
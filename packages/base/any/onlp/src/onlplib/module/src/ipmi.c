@@ -0,0 +1,1225 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlplib/onlplib_config.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_IPMI == 1
+
+#include <onlplib/ipmi.h>
+#include <onlp/onlp.h>
+#include <AIM/aim.h>
+#include <AIM/aim_time.h>
+#include "onlplib_log.h"
+
+#include <linux/ipmi.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <pthread.h>
+
+#define IPMI_CMD_GET_FRU_AREA_INFO      0x10
+#define IPMI_CMD_READ_FRU_DATA          0x11
+#define IPMI_CMD_RESERVE_SDR_REPO       0x22
+#define IPMI_CMD_GET_SDR                0x23
+#define IPMI_CMD_GET_SENSOR_THRESHOLDS  0x27
+#define IPMI_CMD_GET_SENSOR_READING     0x2D
+
+#define IPMI_CC_RESERVATION_CANCELLED   0xC5
+#define IPMI_BMC_SLAVE_ADDR             0x20
+
+#define SDR_TYPE_FULL                   0x01
+#define SDR_TYPE_COMPACT                0x02
+#define SDR_TYPE_FRU_LOCATOR            0x11
+#define SDR_READING_TYPE_THRESHOLD      0x01
+
+#define IPMI_MAX_MSG                    256
+
+/* Internal marker for requests which are waiting for a response. */
+#define REQUEST_PENDING                 1
+
+typedef struct sdr_sensor_s {
+    char name[33];
+    uint8_t owner;
+    uint8_t lun;
+    uint8_t number;
+    uint8_t type;
+    uint8_t reading_type;
+    uint8_t units;
+
+    /* Conversion factors, from full sensor records only. */
+    int full;
+    uint8_t format;
+    uint8_t linearization;
+    int m;
+    int b;
+    int bexp;
+    int rexp;
+} sdr_sensor_t;
+
+struct onlp_ipmi_s {
+    onlp_ipmi_transport_t transport;
+    void* cookie;
+    long msgid;
+    pthread_mutex_t lock;
+
+    int sdr_loaded;
+    sdr_sensor_t* sensors;
+    int nsensors;
+    onlp_ipmi_fru_locator_t* frus;
+    int nfrus;
+};
+
+
+/**
+ * Kernel IPMI device transport.
+ */
+static int
+kernel_send__(void* cookie, long msgid, uint8_t netfn, uint8_t cmd,
+              const uint8_t* data, int len)
+{
+    int fd = (int)(intptr_t)cookie;
+    struct ipmi_system_interface_addr addr;
+    struct ipmi_req req;
+
+    memset(&addr, 0, sizeof(addr));
+    addr.addr_type = IPMI_SYSTEM_INTERFACE_ADDR_TYPE;
+    addr.channel = IPMI_BMC_CHANNEL;
+
+    memset(&req, 0, sizeof(req));
+    req.addr = (unsigned char*)&addr;
+    req.addr_len = sizeof(addr);
+    req.msgid = msgid;
+    req.msg.netfn = netfn;
+    req.msg.cmd = cmd;
+    req.msg.data = (unsigned char*)data;
+    req.msg.data_len = len;
+
+    if(ioctl(fd, IPMICTL_SEND_COMMAND, &req) < 0) {
+        AIM_LOG_ERROR("ipmi: send failed: %{errno}", errno);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return 0;
+}
+
+static int
+kernel_recv__(void* cookie, long* msgid, uint8_t* data, int* len)
+{
+    int fd = (int)(intptr_t)cookie;
+    struct ipmi_addr addr;
+    struct ipmi_recv recv;
+
+    memset(&recv, 0, sizeof(recv));
+    recv.addr = (unsigned char*)&addr;
+    recv.addr_len = sizeof(addr);
+    recv.msg.data = data;
+    recv.msg.data_len = *len;
+
+    /* A truncated response still carries its completion code. */
+    if(ioctl(fd, IPMICTL_RECEIVE_MSG_TRUNC, &recv) < 0 && errno != EMSGSIZE) {
+        return (errno == EAGAIN) ? ONLP_STATUS_E_MISSING : ONLP_STATUS_E_INTERNAL;
+    }
+    if(recv.recv_type != IPMI_RESPONSE_RECV_TYPE) {
+        /* Events and incoming commands are not used. */
+        *msgid = -1;
+        *len = 0;
+        return 0;
+    }
+    *msgid = recv.msgid;
+    *len = recv.msg.data_len;
+    return 0;
+}
+
+static int
+kernel_fd__(void* cookie)
+{
+    return (int)(intptr_t)cookie;
+}
+
+static void
+kernel_close__(void* cookie)
+{
+    close((int)(intptr_t)cookie);
+}
+
+static const onlp_ipmi_transport_t kernel_transport__ = {
+    kernel_send__,
+    kernel_recv__,
+    kernel_fd__,
+    kernel_close__,
+};
+
+int
+onlp_ipmi_open_transport(const onlp_ipmi_transport_t* transport,
+                         void* cookie, onlp_ipmi_t** rv)
+{
+    onlp_ipmi_t* ipmi;
+
+    if(transport == NULL || rv == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    ipmi = aim_zmalloc(sizeof(*ipmi));
+    ipmi->transport = *transport;
+    ipmi->cookie = cookie;
+    ipmi->msgid = 1;
+    pthread_mutex_init(&ipmi->lock, NULL);
+    *rv = ipmi;
+    return 0;
+}
+
+int
+onlp_ipmi_open(const char* device, onlp_ipmi_t** rv)
+{
+    int fd;
+
+    if(device == NULL) {
+        device = ONLPLIB_CONFIG_IPMI_DEVICE;
+    }
+
+    if((fd = open(device, O_RDWR | O_CLOEXEC)) < 0) {
+        AIM_LOG_VERBOSE("ipmi: cannot open %s: %{errno}", device, errno);
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    return onlp_ipmi_open_transport(&kernel_transport__,
+                                    (void*)(intptr_t)fd, rv);
+}
+
+void
+onlp_ipmi_close(onlp_ipmi_t* ipmi)
+{
+    if(ipmi) {
+        if(ipmi->transport.close) {
+            ipmi->transport.close(ipmi->cookie);
+        }
+        pthread_mutex_destroy(&ipmi->lock);
+        aim_free(ipmi->sensors);
+        aim_free(ipmi->frus);
+        aim_free(ipmi);
+    }
+}
+
+
+/**
+ * Requests
+ */
+
+/*
+ * Collect the pending responses. Responses to requests which are
+ * not part of this batch, e.g. from an earlier batch which timed
+ * out, are dropped.
+ */
+static int
+collect__(onlp_ipmi_t* ipmi, long base, onlp_ipmi_request_t* requests,
+          int count)
+{
+    int collected = 0;
+    uint8_t msg[IPMI_MAX_MSG];
+
+    for(;;) {
+        long msgid;
+        int len = sizeof(msg);
+
+        if(ipmi->transport.recv(ipmi->cookie, &msgid, msg, &len) < 0) {
+            return collected;
+        }
+
+        long idx = msgid - base;
+        if(idx < 0 || idx >= count ||
+           requests[idx].status != REQUEST_PENDING) {
+            AIM_LOG_VERBOSE("ipmi: dropping response to message %ld", msgid);
+            continue;
+        }
+
+        onlp_ipmi_request_t* r = requests + idx;
+        r->status = 0;
+        r->ccode = (len > 0) ? msg[0] : 0xFF;
+        r->rlen = (len > 1) ? len - 1 : 0;
+        if(r->rlen > r->size) {
+            r->rlen = r->size;
+        }
+        if(r->rlen && r->resp) {
+            memcpy(r->resp, msg + 1, r->rlen);
+        }
+        collected++;
+    }
+}
+
+static int
+request_locked__(onlp_ipmi_t* ipmi, onlp_ipmi_request_t* requests, int count)
+{
+    int i, next = 0, outstanding = 0, rv = 0;
+    long base = ipmi->msgid;
+    uint64_t deadline = aim_time_monotonic() +
+        (uint64_t)ONLPLIB_CONFIG_IPMI_TIMEOUT_MS * 1000;
+
+    ipmi->msgid += count;
+
+    for(i = 0; i < count; i++) {
+        requests[i].status = REQUEST_PENDING;
+        requests[i].rlen = 0;
+        requests[i].ccode = 0;
+    }
+
+    while(next < count || outstanding > 0) {
+        while(next < count && outstanding < ONLPLIB_CONFIG_IPMI_OUTSTANDING) {
+            onlp_ipmi_request_t* r = requests + next;
+            if(ipmi->transport.send(ipmi->cookie, base + next, r->netfn,
+                                    r->cmd, r->data, r->len) < 0) {
+                r->status = ONLP_STATUS_E_INTERNAL;
+            }
+            else {
+                outstanding++;
+            }
+            next++;
+        }
+
+        if(outstanding == 0) {
+            continue;
+        }
+
+        uint64_t now = aim_time_monotonic();
+        if(now >= deadline) {
+            break;
+        }
+
+        struct pollfd pfd = { ipmi->transport.fd(ipmi->cookie), POLLIN, 0 };
+        if(poll(&pfd, 1, (deadline - now + 999) / 1000) > 0) {
+            outstanding -= collect__(ipmi, base, requests, count);
+        }
+    }
+
+    for(i = 0; i < count; i++) {
+        if(requests[i].status == REQUEST_PENDING) {
+            AIM_LOG_VERBOSE("ipmi: netfn 0x%x cmd 0x%x timed out.",
+                            requests[i].netfn, requests[i].cmd);
+            requests[i].status = ONLP_STATUS_E_INTERNAL;
+        }
+        if(requests[i].status < 0) {
+            rv = ONLP_STATUS_E_INTERNAL;
+        }
+    }
+    return rv;
+}
+
+int
+onlp_ipmi_request(onlp_ipmi_t* ipmi, onlp_ipmi_request_t* requests, int count)
+{
+    int rv;
+
+    if(ipmi == NULL || (requests == NULL && count)) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&ipmi->lock);
+    rv = request_locked__(ipmi, requests, count);
+    pthread_mutex_unlock(&ipmi->lock);
+    return rv;
+}
+
+static int
+raw_result__(onlp_ipmi_request_t* r)
+{
+    if(r->status < 0) {
+        return r->status;
+    }
+    if(r->ccode) {
+        AIM_LOG_VERBOSE("ipmi: netfn 0x%x cmd 0x%x completion code 0x%x",
+                        r->netfn, r->cmd, r->ccode);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    return r->rlen;
+}
+
+int
+onlp_ipmi_raw(onlp_ipmi_t* ipmi, uint8_t netfn, uint8_t cmd,
+              const uint8_t* data, int len, uint8_t* resp, int size)
+{
+    onlp_ipmi_request_t r = { netfn, cmd, data, len, resp, size };
+
+    onlp_ipmi_request(ipmi, &r, 1);
+    return raw_result__(&r);
+}
+
+
+/**
+ * Type/length encoded strings, as used in SDR and FRU records.
+ */
+static void
+tl_decode__(uint8_t type, const uint8_t* p, int len, char* dst, int dsize)
+{
+    static const char bcd[] = "0123456789 -.???";
+    int i, n = 0;
+
+    dst[0] = 0;
+    switch(type)
+        {
+        case 0: /* Binary */
+            for(i = 0; i < len && n + 3 <= dsize; i++) {
+                n += snprintf(dst + n, dsize - n, "%02x", p[i]);
+            }
+            break;
+        case 1: /* BCD plus */
+            for(i = 0; i < len * 2 && n + 1 < dsize; i++) {
+                dst[n++] = bcd[(i & 1) ? (p[i/2] & 0xF) : (p[i/2] >> 4)];
+            }
+            dst[n] = 0;
+            break;
+        case 2: /* 6-bit packed ASCII */
+            for(i = 0; i * 6 + 6 <= len * 8 && n + 1 < dsize; i++) {
+                int bit = i * 6;
+                int v = p[bit / 8] >> (bit % 8);
+                if(bit % 8 > 2) {
+                    v |= p[bit / 8 + 1] << (8 - bit % 8);
+                }
+                dst[n++] = 0x20 + (v & 0x3F);
+            }
+            dst[n] = 0;
+            break;
+        default: /* 8-bit ASCII */
+            n = (len < dsize - 1) ? len : dsize - 1;
+            memcpy(dst, p, n);
+            dst[n] = 0;
+            break;
+        }
+}
+
+
+/**
+ * SDR repository
+ */
+static int
+sdr_reserve__(onlp_ipmi_t* ipmi, uint8_t* reservation)
+{
+    onlp_ipmi_request_t r = { ONLP_IPMI_NETFN_STORAGE,
+                              IPMI_CMD_RESERVE_SDR_REPO,
+                              NULL, 0, reservation, 2 };
+    request_locked__(ipmi, &r, 1);
+    return (raw_result__(&r) == 2) ? 0 : ONLP_STATUS_E_INTERNAL;
+}
+
+/*
+ * Read one SDR record. The header is read first, then the body
+ * is read in chunks which are all sent at once.
+ */
+static int
+sdr_record_read__(onlp_ipmi_t* ipmi, uint8_t* reservation, uint16_t id,
+                  uint16_t* next, uint8_t* record, int* len)
+{
+    uint8_t hdr_req[6], hdr_resp[2 + 5];
+    onlp_ipmi_request_t hdr = { ONLP_IPMI_NETFN_STORAGE, IPMI_CMD_GET_SDR,
+                                hdr_req, 6, hdr_resp, sizeof(hdr_resp) };
+    int i, chunks, total;
+
+    hdr_req[0] = reservation[0];
+    hdr_req[1] = reservation[1];
+    hdr_req[2] = id & 0xFF;
+    hdr_req[3] = id >> 8;
+    hdr_req[4] = 0;
+    hdr_req[5] = 5;
+
+    request_locked__(ipmi, &hdr, 1);
+    if(hdr.status < 0) {
+        return hdr.status;
+    }
+    if(hdr.ccode == IPMI_CC_RESERVATION_CANCELLED) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    if(hdr.ccode || hdr.rlen < 7) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    *next = hdr_resp[0] | (hdr_resp[1] << 8);
+    memcpy(record, hdr_resp + 2, 5);
+    total = 5 + hdr_resp[2 + 4];
+    *len = total;
+
+    /* Only sensor and FRU locator records are needed. */
+    if(total == 5 || (record[3] != SDR_TYPE_FULL &&
+                      record[3] != SDR_TYPE_COMPACT &&
+                      record[3] != SDR_TYPE_FRU_LOCATOR)) {
+        *len = 5;
+        return 0;
+    }
+
+    chunks = (total - 5 + ONLPLIB_CONFIG_IPMI_READ_CHUNK - 1) /
+        ONLPLIB_CONFIG_IPMI_READ_CHUNK;
+    onlp_ipmi_request_t r[chunks];
+    uint8_t req[chunks][6];
+    uint8_t resp[chunks][2 + ONLPLIB_CONFIG_IPMI_READ_CHUNK];
+
+    for(i = 0; i < chunks; i++) {
+        int offset = 5 + i * ONLPLIB_CONFIG_IPMI_READ_CHUNK;
+        int n = total - offset;
+        if(n > ONLPLIB_CONFIG_IPMI_READ_CHUNK) {
+            n = ONLPLIB_CONFIG_IPMI_READ_CHUNK;
+        }
+        memcpy(req[i], hdr_req, 4);
+        req[i][4] = offset;
+        req[i][5] = n;
+        r[i] = (onlp_ipmi_request_t) { ONLP_IPMI_NETFN_STORAGE,
+                                       IPMI_CMD_GET_SDR, req[i], 6,
+                                       resp[i], sizeof(resp[i]) };
+    }
+
+    request_locked__(ipmi, r, chunks);
+    for(i = 0; i < chunks; i++) {
+        if(r[i].status < 0) {
+            return r[i].status;
+        }
+        if(r[i].ccode == IPMI_CC_RESERVATION_CANCELLED) {
+            return ONLP_STATUS_E_MISSING;
+        }
+        if(r[i].ccode || r[i].rlen != req[i][5] + 2) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+        memcpy(record + req[i][4], resp[i] + 2, req[i][5]);
+    }
+    return 0;
+}
+
+static int
+sign_extend__(int value, int bits)
+{
+    return (value & (1 << (bits - 1))) ? value - (1 << bits) : value;
+}
+
+static void
+sdr_fru_add__(onlp_ipmi_t* ipmi, const uint8_t* rec, int len)
+{
+    onlp_ipmi_fru_locator_t f;
+
+    /* Only logical FRU devices behind the BMC can be read by id. */
+    if(len < 16 || rec[5] != IPMI_BMC_SLAVE_ADDR || !(rec[7] & 0x80)) {
+        return;
+    }
+
+    memset(&f, 0, sizeof(f));
+    f.id = rec[6];
+
+    int nlen = rec[15] & 0x1F;
+    if(16 + nlen > len) {
+        nlen = len - 16;
+    }
+    tl_decode__(rec[15] >> 6, rec + 16, nlen, f.name, sizeof(f.name));
+
+    ipmi->frus = aim_realloc(ipmi->frus, (ipmi->nfrus + 1) * sizeof(f));
+    ipmi->frus[ipmi->nfrus++] = f;
+}
+
+static void
+sdr_record_add__(onlp_ipmi_t* ipmi, const uint8_t* rec, int len)
+{
+    sdr_sensor_t s;
+    int name;
+
+    if(rec[3] == SDR_TYPE_FRU_LOCATOR) {
+        sdr_fru_add__(ipmi, rec, len);
+        return;
+    }
+    if(rec[3] != SDR_TYPE_FULL && rec[3] != SDR_TYPE_COMPACT) {
+        return;
+    }
+
+    memset(&s, 0, sizeof(s));
+    if(rec[3] == SDR_TYPE_FULL) {
+        /* Full sensor record */
+        if(len < 48) {
+            return;
+        }
+        s.full = 1;
+        s.format = rec[20] >> 6;
+        s.linearization = rec[23] & 0x7F;
+        s.m = sign_extend__(rec[24] | ((rec[25] & 0xC0) << 2), 10);
+        s.b = sign_extend__(rec[26] | ((rec[27] & 0xC0) << 2), 10);
+        s.rexp = sign_extend__(rec[29] >> 4, 4);
+        s.bexp = sign_extend__(rec[29] & 0xF, 4);
+        name = 47;
+    }
+    else {
+        /* Compact sensor record */
+        if(len < 32) {
+            return;
+        }
+        name = 31;
+    }
+
+    s.owner = rec[5];
+    s.lun = rec[6] & 0x3;
+    s.number = rec[7];
+    s.type = rec[12];
+    s.reading_type = rec[13];
+    s.units = rec[21];
+
+    int nlen = rec[name] & 0x1F;
+    if(name + 1 + nlen > len) {
+        nlen = len - name - 1;
+    }
+    tl_decode__(rec[name] >> 6, rec + name + 1, nlen, s.name, sizeof(s.name));
+
+    ipmi->sensors = aim_realloc(ipmi->sensors,
+                                (ipmi->nsensors + 1) * sizeof(s));
+    ipmi->sensors[ipmi->nsensors++] = s;
+}
+
+static int
+sdr_load__(onlp_ipmi_t* ipmi)
+{
+    uint8_t reservation[2];
+    uint8_t record[5 + 256];
+    uint16_t id = 0, next;
+    int len, rv, retries = 0;
+
+    if(ipmi->sdr_loaded) {
+        return 0;
+    }
+
+    if((rv = sdr_reserve__(ipmi, reservation)) < 0) {
+        return rv;
+    }
+
+    while(id != 0xFFFF) {
+        rv = sdr_record_read__(ipmi, reservation, id, &next, record, &len);
+        if(rv == ONLP_STATUS_E_MISSING && retries++ < 3) {
+            /* The reservation was cancelled. Reserve again and retry. */
+            if((rv = sdr_reserve__(ipmi, reservation)) < 0) {
+                return rv;
+            }
+            continue;
+        }
+        if(rv < 0) {
+            AIM_LOG_ERROR("ipmi: cannot read SDR record 0x%x", id);
+            return rv;
+        }
+        if(len > 5) {
+            sdr_record_add__(ipmi, record, len);
+        }
+        if(next == id) {
+            break;
+        }
+        id = next;
+    }
+
+    ipmi->sdr_loaded = 1;
+    return 0;
+}
+
+static double
+pow10__(int exp)
+{
+    double v = 1;
+    for(; exp > 0; exp--) v *= 10;
+    for(; exp < 0; exp++) v /= 10;
+    return v;
+}
+
+static int
+sensor_convert__(const sdr_sensor_t* s, uint8_t raw, double* value)
+{
+    int x;
+
+    if(!s->full || s->format == 3) {
+        *value = raw;
+        return 0;
+    }
+    if(s->linearization != 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    switch(s->format)
+        {
+        case 1: x = (raw & 0x80) ? -(int)(~raw & 0x7F) : raw; break;
+        case 2: x = (int8_t)raw; break;
+        default: x = raw; break;
+        }
+
+    *value = (s->m * x + s->b * pow10__(s->bexp)) * pow10__(s->rexp);
+    return 0;
+}
+
+int
+onlp_ipmi_sensor_get(onlp_ipmi_t* ipmi, const char* name, double* value)
+{
+    int i, rv;
+    sdr_sensor_t* s = NULL;
+    uint8_t resp[4];
+
+    if(ipmi == NULL || name == NULL || value == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&ipmi->lock);
+    if((rv = sdr_load__(ipmi)) < 0) {
+        goto done;
+    }
+
+    for(i = 0; i < ipmi->nsensors; i++) {
+        if(!strcmp(ipmi->sensors[i].name, name)) {
+            s = ipmi->sensors + i;
+            break;
+        }
+    }
+    if(s == NULL) {
+        rv = ONLP_STATUS_E_MISSING;
+        goto done;
+    }
+    if(s->owner != IPMI_BMC_SLAVE_ADDR || s->lun != 0) {
+        /* Bridged sensors are not supported. */
+        rv = ONLP_STATUS_E_UNSUPPORTED;
+        goto done;
+    }
+
+    onlp_ipmi_request_t r = { ONLP_IPMI_NETFN_SENSOR,
+                              IPMI_CMD_GET_SENSOR_READING,
+                              &s->number, 1, resp, sizeof(resp) };
+    request_locked__(ipmi, &r, 1);
+    if((rv = raw_result__(&r)) < 2) {
+        rv = (rv < 0) ? rv : ONLP_STATUS_E_INTERNAL;
+        goto done;
+    }
+    if(resp[1] & 0x20) {
+        /* Reading unavailable */
+        rv = ONLP_STATUS_E_MISSING;
+        goto done;
+    }
+    rv = sensor_convert__(s, resp[0], value);
+
+ done:
+    pthread_mutex_unlock(&ipmi->lock);
+    return rv;
+}
+
+int
+onlp_ipmi_sensor_list(onlp_ipmi_t* ipmi, onlp_ipmi_sensor_t* sensors, int max)
+{
+    int i, j, n, count, rv;
+
+    if(ipmi == NULL || (sensors == NULL && max)) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&ipmi->lock);
+    if((rv = sdr_load__(ipmi)) < 0) {
+        pthread_mutex_unlock(&ipmi->lock);
+        return rv;
+    }
+
+    count = (ipmi->nsensors < max) ? ipmi->nsensors : max;
+    if(count == 0) {
+        pthread_mutex_unlock(&ipmi->lock);
+        return 0;
+    }
+
+    /* A reading for each local sensor, and thresholds where they apply. */
+    onlp_ipmi_request_t r[count * 2];
+    uint8_t resp[count * 2][ONLP_IPMI_THRESHOLD_COUNT + 1];
+    int reading[count], thresholds[count];
+
+    for(i = 0, n = 0; i < count; i++) {
+        sdr_sensor_t* s = ipmi->sensors + i;
+        reading[i] = thresholds[i] = -1;
+        if(s->owner != IPMI_BMC_SLAVE_ADDR || s->lun != 0) {
+            continue;
+        }
+        reading[i] = n;
+        r[n] = (onlp_ipmi_request_t) { ONLP_IPMI_NETFN_SENSOR,
+                                       IPMI_CMD_GET_SENSOR_READING,
+                                       &s->number, 1, resp[n], sizeof(resp[n]) };
+        n++;
+        if(s->full && s->reading_type == SDR_READING_TYPE_THRESHOLD) {
+            thresholds[i] = n;
+            r[n] = (onlp_ipmi_request_t) { ONLP_IPMI_NETFN_SENSOR,
+                                           IPMI_CMD_GET_SENSOR_THRESHOLDS,
+                                           &s->number, 1, resp[n], sizeof(resp[n]) };
+            n++;
+        }
+    }
+    request_locked__(ipmi, r, n);
+
+    for(i = 0; i < count; i++) {
+        sdr_sensor_t* s = ipmi->sensors + i;
+        onlp_ipmi_sensor_t* d = sensors + i;
+
+        memset(d, 0, sizeof(*d));
+        aim_strlcpy(d->name, s->name, sizeof(d->name));
+        d->number = s->number;
+        d->type = s->type;
+        d->units = s->units;
+        if(s->reading_type != SDR_READING_TYPE_THRESHOLD) {
+            d->flags |= ONLP_IPMI_SENSOR_F_DISCRETE;
+        }
+
+        if(reading[i] >= 0 && raw_result__(r + reading[i]) >= 2) {
+            uint8_t* p = resp[reading[i]];
+            int rlen = r[reading[i]].rlen;
+            if(p[1] & 0x20) {
+                /* Reading unavailable */
+            }
+            else if(d->flags & ONLP_IPMI_SENSOR_F_DISCRETE) {
+                d->state = (rlen > 2) ? p[2] : 0;
+                d->state |= (rlen > 3) ? (p[3] << 8) : 0;
+                d->flags |= ONLP_IPMI_SENSOR_F_VALID;
+            }
+            else if(sensor_convert__(s, p[0], &d->value) == 0) {
+                d->flags |= ONLP_IPMI_SENSOR_F_VALID;
+            }
+        }
+
+        if(thresholds[i] >= 0 &&
+           raw_result__(r + thresholds[i]) >= ONLP_IPMI_THRESHOLD_COUNT + 1) {
+            uint8_t* p = resp[thresholds[i]];
+            for(j = 0; j < ONLP_IPMI_THRESHOLD_COUNT; j++) {
+                if((p[0] & (1 << j)) &&
+                   sensor_convert__(s, p[j + 1], d->threshold + j) == 0) {
+                    d->thresholds |= (1 << j);
+                }
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&ipmi->lock);
+    return count;
+}
+
+
+/**
+ * FRU
+ */
+int
+onlp_ipmi_fru_list(onlp_ipmi_t* ipmi, onlp_ipmi_fru_locator_t* frus, int max)
+{
+    int rv;
+
+    if(ipmi == NULL || (frus == NULL && max)) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    pthread_mutex_lock(&ipmi->lock);
+    if((rv = sdr_load__(ipmi)) == 0) {
+        rv = (ipmi->nfrus < max) ? ipmi->nfrus : max;
+        memcpy(frus, ipmi->frus, rv * sizeof(*frus));
+    }
+    pthread_mutex_unlock(&ipmi->lock);
+    return rv;
+}
+
+int
+onlp_ipmi_fru_read(onlp_ipmi_t* ipmi, uint8_t id, uint8_t* data, int size)
+{
+    uint8_t info[3];
+    int i, rv, words, total, chunk, chunks;
+
+    if(ipmi == NULL || data == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+
+    rv = onlp_ipmi_raw(ipmi, ONLP_IPMI_NETFN_STORAGE,
+                       IPMI_CMD_GET_FRU_AREA_INFO, &id, 1, info, sizeof(info));
+    if(rv < 3) {
+        return (rv < 0) ? rv : ONLP_STATUS_E_INTERNAL;
+    }
+
+    total = info[0] | (info[1] << 8);
+    words = info[2] & 1;
+    if(total > size) {
+        total = size;
+    }
+
+    chunk = ONLPLIB_CONFIG_IPMI_READ_CHUNK & ~words;
+    chunks = (total + chunk - 1) / chunk;
+    if(chunks == 0) {
+        return 0;
+    }
+
+    onlp_ipmi_request_t r[chunks];
+    uint8_t req[chunks][4];
+    uint8_t resp[chunks][1 + ONLPLIB_CONFIG_IPMI_READ_CHUNK];
+
+    for(i = 0; i < chunks; i++) {
+        int offset = i * chunk;
+        int n = (total - offset < chunk) ? total - offset : chunk;
+        req[i][0] = id;
+        req[i][1] = (offset >> words) & 0xFF;
+        req[i][2] = (offset >> words) >> 8;
+        req[i][3] = n >> words;
+        r[i] = (onlp_ipmi_request_t) { ONLP_IPMI_NETFN_STORAGE,
+                                       IPMI_CMD_READ_FRU_DATA, req[i], 4,
+                                       resp[i], sizeof(resp[i]) };
+    }
+
+    onlp_ipmi_request(ipmi, r, chunks);
+
+    for(i = 0; i < chunks; i++) {
+        int offset = i * chunk;
+        int n;
+        if((rv = raw_result__(r + i)) < 1) {
+            return (rv < 0) ? rv : ONLP_STATUS_E_INTERNAL;
+        }
+        n = resp[i][0] << words;
+        if(n > rv - 1) {
+            n = rv - 1;
+        }
+        if(n > total - offset) {
+            n = total - offset;
+        }
+        memcpy(data + offset, resp[i] + 1, n);
+        if(n < ((req[i][3]) << words)) {
+            /* Short read, the rest is unavailable. */
+            return offset + n;
+        }
+    }
+    return total;
+}
+
+/*
+ * Find a field in a FRU info area.
+ * The area offset is at byte 'area' of the common header, and its
+ * fields start 'skip' bytes into the area.
+ */
+static int
+fru_area_get__(const uint8_t* fru, int size, int area, int skip,
+               int field, char* dst, int dsize)
+{
+    int i, p, end;
+
+    if(fru == NULL || dst == NULL || dsize <= 0 || field < 0) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    dst[0] = 0;
+
+    /* Common header */
+    if(size < 8 || fru[0] != 0x01 || fru[area] == 0) {
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    p = fru[area] * 8;
+    if(p + skip > size) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    end = p + fru[p + 1] * 8;
+    if(end > size) {
+        end = size;
+    }
+
+    p += skip;
+    for(i = 0; p < end && fru[p] != 0xC1; i++) {
+        int len = fru[p] & 0x3F;
+        if(p + 1 + len > end) {
+            return ONLP_STATUS_E_INVALID;
+        }
+        if(i == field) {
+            tl_decode__(fru[p] >> 6, fru + p + 1, len, dst, dsize);
+            return 0;
+        }
+        p += 1 + len;
+    }
+    return ONLP_STATUS_E_MISSING;
+}
+
+int
+onlp_ipmi_fru_product_get(const uint8_t* fru, int size,
+                          onlp_ipmi_fru_product_t field,
+                          char* dst, int dsize)
+{
+    if(field >= ONLP_IPMI_FRU_PRODUCT_COUNT) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    /* Skip the version, length and language code. */
+    return fru_area_get__(fru, size, 4, 3, field, dst, dsize);
+}
+
+int
+onlp_ipmi_fru_board_get(const uint8_t* fru, int size,
+                        onlp_ipmi_fru_board_t field,
+                        char* dst, int dsize)
+{
+    /* Skip the version, length, language code and manufacturing date. */
+    return fru_area_get__(fru, size, 3, 6, field, dst, dsize);
+}
+
+/*
+ * Split a command line into words. Single and double quotes group
+ * words and are removed.
+ */
+static int
+tool_tokenize__(char* str, char** tokens, int max)
+{
+    int count = 0;
+    char* dst;
+
+    while(*str && count < max) {
+        while(*str == ' ' || *str == '\t') {
+            str++;
+        }
+        if(*str == '\0') {
+            break;
+        }
+
+        tokens[count++] = dst = str;
+        while(*str && *str != ' ' && *str != '\t') {
+            if(*str == '\'' || *str == '"') {
+                char quote = *str++;
+                while(*str && *str != quote) {
+                    *dst++ = *str++;
+                }
+                if(*str) {
+                    str++;
+                }
+            }
+            else {
+                *dst++ = *str++;
+            }
+        }
+        if(*str) {
+            str++;
+        }
+        *dst = '\0';
+    }
+
+    return count;
+}
+
+static int
+tool_raw__(onlp_ipmi_t* ipmi, int argc, char** argv, char* out, int outlen)
+{
+    uint8_t data[32], resp[256];
+    int i, rv, len = 0;
+
+    if(argc - 3 > sizeof(data)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    for(i = 3; i < argc; i++) {
+        data[i - 3] = strtoul(argv[i], NULL, 0);
+    }
+
+    rv = onlp_ipmi_raw(ipmi, strtoul(argv[1], NULL, 0),
+                       strtoul(argv[2], NULL, 0),
+                       data, argc - 3, resp, sizeof(resp));
+    if(rv < 0) {
+        return rv;
+    }
+
+    for(i = 0; i < rv && len < outlen - 5; i++) {
+        len += snprintf(out + len, outlen - len, " %02x", resp[i]);
+        if((i % 16) == 15) {
+            len += snprintf(out + len, outlen - len, "\n");
+        }
+    }
+    if(len && out[len - 1] != '\n') {
+        snprintf(out + len, outlen - len, "\n");
+    }
+    return 0;
+}
+
+static int
+tool_sensor_get__(onlp_ipmi_t* ipmi, const char* name, char* out, int outlen)
+{
+    double value;
+    int rv;
+
+    if((rv = onlp_ipmi_sensor_get(ipmi, name, &value)) < 0) {
+        return rv;
+    }
+
+    snprintf(out, outlen,
+             " Sensor ID              : %s\n"
+             " Sensor Reading        : %.*f (+/- 0)\n",
+             name, (value == (int)value) ? 0 : 3, value);
+    return 0;
+}
+
+static int
+tool_fru_print__(onlp_ipmi_t* ipmi, uint8_t id, char* out, int outlen)
+{
+    static const char* names[ONLP_IPMI_FRU_PRODUCT_COUNT] = {
+        "Product Manufacturer",
+        "Product Name",
+        "Product Part Number",
+        "Product Version",
+        "Product Serial",
+        "Product Asset Tag",
+    };
+    uint8_t fru[512];
+    char field[64];
+    int i, n, len = 0;
+
+    if((n = onlp_ipmi_fru_read(ipmi, id, fru, sizeof(fru))) < 0) {
+        return n;
+    }
+
+    for(i = 0; i < ONLP_IPMI_FRU_PRODUCT_COUNT && len < outlen; i++) {
+        if(onlp_ipmi_fru_product_get(fru, n, i, field, sizeof(field)) == 0 &&
+           field[0]) {
+            len += snprintf(out + len, outlen - len, " %-22s: %s\n",
+                            names[i], field);
+        }
+    }
+    return 0;
+}
+
+int
+onlp_ipmi_tool_exec(onlp_ipmi_t* ipmi, const char* cmd, char* out, int outlen)
+{
+    char buf[128], *argv[40];
+    int argc, i, n;
+
+    if(ipmi == NULL || cmd == NULL || strlen(cmd) >= sizeof(buf)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    strcpy(buf, cmd);
+    argc = tool_tokenize__(buf, argv, AIM_ARRAYSIZE(argv));
+
+    /* Redirections are for the shell. */
+    for(n = 0, i = 0; i < argc; i++) {
+        if(argv[i][0] != '>' && strncmp(argv[i], "2>", 2)) {
+            argv[n++] = argv[i];
+        }
+    }
+    argc = n;
+    out[0] = '\0';
+
+    if(argc >= 3 && !strcmp(argv[0], "raw")) {
+        return tool_raw__(ipmi, argc, argv, out, outlen);
+    }
+    if(argc == 3 && !strcmp(argv[0], "sensor") && !strcmp(argv[1], "get")) {
+        return tool_sensor_get__(ipmi, argv[2], out, outlen);
+    }
+    if(argc == 3 && !strcmp(argv[0], "fru") && !strcmp(argv[1], "print")) {
+        return tool_fru_print__(ipmi, strtoul(argv[2], NULL, 0), out, outlen);
+    }
+    return ONLP_STATUS_E_UNSUPPORTED;
+}
+
+/*
+ * Append the cut(1) fields of line, or the whole line if it
+ * does not contain the delimiter.
+ */
+static int
+tool_cut__(char* line, char delim, int first, int to_end, char* dst, int dsize)
+{
+    char* f = line;
+    char* e;
+    int field;
+
+    if(strchr(line, delim) == NULL) {
+        return snprintf(dst, dsize, "%s\n", line);
+    }
+    for(field = 1; field < first && f; field++) {
+        f = strchr(f, delim);
+        if(f) {
+            f++;
+        }
+    }
+    if(f == NULL) {
+        f = "";
+    }
+    else if(!to_end && (e = strchr(f, delim)) != NULL) {
+        *e = '\0';
+    }
+    return snprintf(dst, dsize, "%s\n", f);
+}
+
+int
+onlp_ipmi_tool_filter(const char* text, const char* filter,
+                      char* out, int outlen)
+{
+    char stages[128], *stage, *save = NULL;
+    char work[2][1024];
+    int cur = 0;
+
+    if(strlen(filter) >= sizeof(stages)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    strcpy(stages, filter);
+    snprintf(work[cur], sizeof(work[cur]), "%s", text);
+
+    for(stage = strtok_r(stages, "|", &save); stage;
+        stage = strtok_r(NULL, "|", &save)) {
+        char *argv[8], *line, *next, *src = work[cur], *dst = work[!cur];
+        char l[256];
+        char delim = '\t';
+        int argc, llen, first = 0, to_end = 0, len = 0;
+
+        argc = tool_tokenize__(stage, argv, AIM_ARRAYSIZE(argv));
+        if(argc == 0) {
+            continue;
+        }
+
+        if(argc == 2 && !strcmp(argv[0], "grep")) {
+            first = 0;
+        }
+        else if(argc == 5 && !strcmp(argv[0], "cut") &&
+                !strcmp(argv[1], "-d") && strlen(argv[2]) == 1 &&
+                !strcmp(argv[3], "-f")) {
+            delim = argv[2][0];
+            first = atoi(argv[4]);
+            to_end = (argv[4][strlen(argv[4]) - 1] == '-');
+            if(first < 1) {
+                return ONLP_STATUS_E_UNSUPPORTED;
+            }
+        }
+        else {
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+
+        dst[0] = '\0';
+        for(line = src; *line; line = next) {
+            next = strchr(line, '\n');
+            next = next ? next + 1 : line + strlen(line);
+
+            llen = next - line;
+            if(llen && line[llen - 1] == '\n') {
+                llen--;
+            }
+            if(llen >= sizeof(l)) {
+                llen = sizeof(l) - 1;
+            }
+            memcpy(l, line, llen);
+            l[llen] = '\0';
+
+            if(first == 0) {
+                if(strstr(l, argv[1]) == NULL) {
+                    continue;
+                }
+                len += snprintf(dst + len, sizeof(work[0]) - len, "%s\n", l);
+            }
+            else {
+                len += tool_cut__(l, delim, first, to_end,
+                                  dst + len, sizeof(work[0]) - len);
+            }
+            if(len >= sizeof(work[0])) {
+                len = sizeof(work[0]) - 1;
+            }
+        }
+        cur = !cur;
+    }
+
+    snprintf(out, outlen, "%s", work[cur]);
+    return 0;
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_IPMI */
@@ -0,0 +1,438 @@
+/************************************************************
+ * <bsn.cl fy=2014 v=onl>
+ *
+ *        Copyright 2014, 2015 Big Switch Networks, Inc.
+ *
+ * Licensed under the Eclipse Public License, Version 1.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License. You may obtain a copy of the License at
+ *
+ *        http://www.eclipse.org/legal/epl-v10.html
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied. See the License for the specific
+ * language governing permissions and limitations under the
+ * License.
+ *
+ * </bsn.cl>
+ ************************************************************
+ *
+ *
+ *
+ ***********************************************************/
+#include <onlplib/onlplib_config.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_IPMI == 1
+
+#include <onlplib/ipmi_snapshot.h>
+#include <onlplib/shlocks.h>
+#include <onlp/onlp.h>
+#include <AIM/aim.h>
+#include <AIM/aim_time.h>
+#include "onlplib_log.h"
+
+#include <sys/shm.h>
+#include <sched.h>
+
+#define SNAPSHOT_MAGIC          0x49534E50
+#define SNAPSHOT_VERSION        1
+
+/* Name index sizes. Twice the records keeps the probe chains short. */
+#define SENSOR_SLOTS            (ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS * 2)
+#define FRU_SLOTS               (ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS * 2)
+
+/* Reads retried before a reader assumes the writer died. */
+#define SNAPSHOT_READ_RETRIES   1000
+
+/*
+ * The table contents. The indexes hold the record index plus one,
+ * so zero is an empty slot.
+ */
+typedef struct snapshot_table_s {
+    uint32_t nsensors;
+    uint32_t nfrus;
+    uint16_t sensor_names[SENSOR_SLOTS];
+    uint16_t sensor_numbers[256];
+    uint16_t fru_names[FRU_SLOTS];
+    onlp_ipmi_sensor_t sensors[ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS];
+    onlp_ipmi_snapshot_fru_t frus[ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS];
+} snapshot_table_t;
+
+/*
+ * The shared memory layout.
+ */
+typedef struct snapshot_shm_s {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+
+    /* Odd while the table is being written. */
+    volatile uint32_t seq;
+    volatile uint32_t generation;
+
+    /* Last refresh attempt, and when a refresh was last claimed. */
+    volatile uint64_t updated_ms;
+    volatile uint64_t claimed_ms;
+
+    snapshot_table_t table;
+} snapshot_shm_t;
+
+struct onlp_ipmi_snapshot_s {
+    snapshot_shm_t* shm;
+    onlp_shlock_t* lock;
+    uint32_t refresh_ms;
+
+    onlp_ipmi_t* ipmi;
+    int own_ipmi;
+
+    /* The next table is built here before it is published. */
+    snapshot_table_t* scratch;
+};
+
+static uint64_t
+now_ms__(void)
+{
+    return aim_time_monotonic() / 1000;
+}
+
+static uint32_t
+name_hash__(const char* name)
+{
+    uint32_t h = 2166136261u;
+    while(*name) {
+        h = (h ^ (uint8_t)*name++) * 16777619u;
+    }
+    return h;
+}
+
+static void
+name_index_add__(uint16_t* slots, int nslots, const char* name, int index)
+{
+    uint32_t i = name_hash__(name) % nslots;
+    while(slots[i]) {
+        i = (i + 1) % nslots;
+    }
+    slots[i] = index + 1;
+}
+
+int
+onlp_ipmi_snapshot_open(const onlp_ipmi_snapshot_config_t* config,
+                        onlp_ipmi_snapshot_t** rv)
+{
+    onlp_ipmi_snapshot_t* s;
+    snapshot_shm_t* shm = NULL;
+    key_t key = ONLPLIB_CONFIG_IPMI_SNAPSHOT_KEY;
+
+    if(rv == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    if(config && config->key) {
+        key = config->key;
+    }
+
+    if(onlp_shmem_create(key, sizeof(*shm), (void**)&shm) < 0) {
+        AIM_LOG_ERROR("ipmi snapshot: cannot attach to shared memory 0x%x.",
+                      key);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    s = aim_zmalloc(sizeof(*s));
+    s->shm = shm;
+    s->refresh_ms = (config && config->refresh_ms) ?
+        config->refresh_ms : ONLPLIB_CONFIG_IPMI_SNAPSHOT_REFRESH_MS;
+    s->ipmi = config ? config->ipmi : NULL;
+    onlp_shlock_create(key + 1, &s->lock, "ipmi-snapshot-0x%x", key);
+
+    onlp_shlock_take(s->lock);
+    if(shm->magic != SNAPSHOT_MAGIC || shm->version != SNAPSHOT_VERSION ||
+       shm->size != sizeof(*shm)) {
+        /* New, or left behind by a different layout. */
+        memset(shm, 0, sizeof(*shm));
+        shm->version = SNAPSHOT_VERSION;
+        shm->size = sizeof(*shm);
+        shm->magic = SNAPSHOT_MAGIC;
+    }
+    onlp_shlock_give(s->lock);
+
+    *rv = s;
+    return 0;
+}
+
+void
+onlp_ipmi_snapshot_close(onlp_ipmi_snapshot_t* s)
+{
+    if(s) {
+        if(s->own_ipmi) {
+            onlp_ipmi_close(s->ipmi);
+        }
+        shmdt(s->shm);
+        onlp_shlock_destroy(s->lock);
+        aim_free(s->scratch);
+        aim_free(s);
+    }
+}
+
+
+/**
+ * Refresh
+ */
+static int
+fetch__(onlp_ipmi_snapshot_t* s, snapshot_table_t* t)
+{
+    onlp_ipmi_fru_locator_t frus[ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS];
+    int i, n, rv;
+
+    if(s->ipmi == NULL) {
+        if((rv = onlp_ipmi_open(NULL, &s->ipmi)) < 0) {
+            return rv;
+        }
+        s->own_ipmi = 1;
+    }
+
+    memset(t, 0, sizeof(*t));
+
+    n = onlp_ipmi_sensor_list(s->ipmi, t->sensors,
+                              ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS);
+    if(n < 0) {
+        return n;
+    }
+    t->nsensors = n;
+    for(i = n - 1; i >= 0; i--) {
+        /* Backwards, so the first of several sensors with a number wins. */
+        t->sensor_numbers[t->sensors[i].number] = i + 1;
+    }
+    for(i = 0; i < n; i++) {
+        name_index_add__(t->sensor_names, SENSOR_SLOTS, t->sensors[i].name, i);
+    }
+
+    n = onlp_ipmi_fru_list(s->ipmi, frus, AIM_ARRAYSIZE(frus));
+    if(n < 0) {
+        return n;
+    }
+    t->nfrus = n;
+    for(i = 0; i < n; i++) {
+        onlp_ipmi_snapshot_fru_t* f = t->frus + i;
+        aim_strlcpy(f->name, frus[i].name, sizeof(f->name));
+        f->id = frus[i].id;
+        rv = onlp_ipmi_fru_read(s->ipmi, f->id, f->data, sizeof(f->data));
+        if(rv > 0) {
+            f->present = 1;
+            f->size = rv;
+        }
+        name_index_add__(t->fru_names, FRU_SLOTS, f->name, i);
+    }
+
+    return 0;
+}
+
+static void
+publish__(snapshot_shm_t* shm, const snapshot_table_t* t)
+{
+    uint32_t seq = shm->seq | 1;
+
+    shm->seq = seq;
+    __sync_synchronize();
+    memcpy(&shm->table, t, sizeof(*t));
+    shm->generation++;
+    __sync_synchronize();
+    shm->seq = seq + 1;
+}
+
+static int
+refresh_locked__(onlp_ipmi_snapshot_t* s, int force)
+{
+    snapshot_shm_t* shm = s->shm;
+    int rv;
+
+    if(!force && shm->updated_ms &&
+       now_ms__() - shm->updated_ms < s->refresh_ms) {
+        /* Refreshed by someone else while we waited. */
+        return 0;
+    }
+
+    if(s->scratch == NULL) {
+        s->scratch = aim_zmalloc(sizeof(*s->scratch));
+    }
+
+    if((rv = fetch__(s, s->scratch)) < 0) {
+        /* Keep the current contents and try again next period. */
+        AIM_LOG_ERROR("ipmi snapshot: refresh failed: %{onlp_status}", rv);
+    }
+    else {
+        publish__(shm, s->scratch);
+    }
+    shm->updated_ms = now_ms__();
+    return rv;
+}
+
+int
+onlp_ipmi_snapshot_refresh(onlp_ipmi_snapshot_t* s, int force)
+{
+    snapshot_shm_t* shm;
+    uint64_t now, claimed;
+    int rv;
+
+    if(s == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    shm = s->shm;
+    now = now_ms__();
+
+    if(!force) {
+        if(shm->updated_ms && now - shm->updated_ms < s->refresh_ms) {
+            return 0;
+        }
+
+        /*
+         * Claim the refresh. A claim expires after a refresh period,
+         * in case its owner died.
+         */
+        claimed = shm->claimed_ms;
+        if((claimed && now - claimed < s->refresh_ms) ||
+           !__sync_bool_compare_and_swap(&shm->claimed_ms, claimed, now)) {
+            if(shm->updated_ms) {
+                /* Someone else is refreshing. Use the current contents. */
+                return 0;
+            }
+            /*
+             * There is nothing to use yet. Wait for the first refresh,
+             * which is checked for again under the lock.
+             */
+        }
+    }
+
+    onlp_shlock_take(s->lock);
+    rv = refresh_locked__(s, force);
+    onlp_shlock_give(s->lock);
+    return rv;
+}
+
+uint32_t
+onlp_ipmi_snapshot_generation(onlp_ipmi_snapshot_t* s)
+{
+    return s ? s->shm->generation : 0;
+}
+
+
+/**
+ * Lookups
+ */
+typedef int (*snapshot_reader_f)(const snapshot_table_t* t,
+                                 const void* key, void* rv);
+
+/*
+ * Run a lookup against a consistent view of the table.
+ * The table may change underneath the lookup, so lookups must stay
+ * within bounds no matter what they read.
+ */
+static int
+snapshot_read__(onlp_ipmi_snapshot_t* s, snapshot_reader_f reader,
+                const void* key, void* out)
+{
+    snapshot_shm_t* shm;
+    int rv, tries;
+
+    if(s == NULL || key == NULL || out == NULL) {
+        return ONLP_STATUS_E_PARAM;
+    }
+    shm = s->shm;
+
+    onlp_ipmi_snapshot_refresh(s, 0);
+
+    for(tries = 0; tries < SNAPSHOT_READ_RETRIES * 2; tries++) {
+        uint32_t seq = shm->seq;
+        if(!(seq & 1)) {
+            __sync_synchronize();
+            rv = reader(&shm->table, key, out);
+            __sync_synchronize();
+            if(shm->seq == seq) {
+                return rv;
+            }
+        }
+        if(tries == SNAPSHOT_READ_RETRIES) {
+            /*
+             * The table has been in flux for too long. If the writer
+             * died, a new refresh rewrites the table.
+             */
+            AIM_LOG_WARN("ipmi snapshot: table busy, refreshing.");
+            onlp_ipmi_snapshot_refresh(s, 1);
+        }
+        sched_yield();
+    }
+    return ONLP_STATUS_E_INTERNAL;
+}
+
+static int
+sensor_name_reader__(const snapshot_table_t* t, const void* key, void* rv)
+{
+    const char* name = key;
+    uint32_t i = name_hash__(name) % SENSOR_SLOTS;
+    int n;
+
+    for(n = 0; n < SENSOR_SLOTS && t->sensor_names[i]; n++) {
+        int idx = t->sensor_names[i] - 1;
+        if(idx < ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS &&
+           !strncmp(t->sensors[idx].name, name, sizeof(t->sensors[idx].name))) {
+            memcpy(rv, t->sensors + idx, sizeof(t->sensors[idx]));
+            return 0;
+        }
+        i = (i + 1) % SENSOR_SLOTS;
+    }
+    return ONLP_STATUS_E_MISSING;
+}
+
+static int
+sensor_number_reader__(const snapshot_table_t* t, const void* key, void* rv)
+{
+    int idx = t->sensor_numbers[*(const uint8_t*)key] - 1;
+
+    if(idx < 0 || idx >= ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    memcpy(rv, t->sensors + idx, sizeof(t->sensors[idx]));
+    return 0;
+}
+
+static int
+fru_name_reader__(const snapshot_table_t* t, const void* key, void* rv)
+{
+    const char* name = key;
+    uint32_t i = name_hash__(name) % FRU_SLOTS;
+    int n;
+
+    for(n = 0; n < FRU_SLOTS && t->fru_names[i]; n++) {
+        int idx = t->fru_names[i] - 1;
+        if(idx < ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS &&
+           !strncmp(t->frus[idx].name, name, sizeof(t->frus[idx].name))) {
+            memcpy(rv, t->frus + idx, sizeof(t->frus[idx]));
+            return t->frus[idx].present ? 0 : ONLP_STATUS_E_MISSING;
+        }
+        i = (i + 1) % FRU_SLOTS;
+    }
+    return ONLP_STATUS_E_MISSING;
+}
+
+int
+onlp_ipmi_snapshot_sensor_get(onlp_ipmi_snapshot_t* s, const char* name,
+                              onlp_ipmi_sensor_t* rv)
+{
+    return snapshot_read__(s, sensor_name_reader__, name, rv);
+}
+
+int
+onlp_ipmi_snapshot_sensor_get_number(onlp_ipmi_snapshot_t* s, uint8_t number,
+                                     onlp_ipmi_sensor_t* rv)
+{
+    return snapshot_read__(s, sensor_number_reader__, &number, rv);
+}
+
+int
+onlp_ipmi_snapshot_fru_get(onlp_ipmi_snapshot_t* s, const char* name,
+                           onlp_ipmi_snapshot_fru_t* rv)
+{
+    return snapshot_read__(s, fru_name_reader__, name, rv);
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_IPMI */
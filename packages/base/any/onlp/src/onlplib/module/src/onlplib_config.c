@@ -70,6 +70,16 @@ onlplib_config_settings_t onlplib_config_settings[] =
 #else
 { ONLPLIB_CONFIG_INCLUDE_I2C(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef ONLPLIB_CONFIG_INCLUDE_BMC
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_INCLUDE_BMC), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_INCLUDE_BMC) },
+#else
+{ ONLPLIB_CONFIG_INCLUDE_BMC(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_INCLUDE_IPMI
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_INCLUDE_IPMI), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_INCLUDE_IPMI) },
+#else
+{ ONLPLIB_CONFIG_INCLUDE_IPMI(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef ONLPLIB_CONFIG_I2C_BLOCK_SIZE
     { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_BLOCK_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_BLOCK_SIZE) },
 #else
@@ -80,6 +90,121 @@ onlplib_config_settings_t onlplib_config_settings[] =
 #else
 { ONLPLIB_CONFIG_I2C_READ_RETRY_COUNT(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
 #endif
+#ifdef ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE) },
+#else
+{ ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE) },
+#else
+{ ONLPLIB_CONFIG_I2C_FD_CACHE_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_I2C_INCLUDE_RDWR
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_INCLUDE_RDWR), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_INCLUDE_RDWR) },
+#else
+{ ONLPLIB_CONFIG_I2C_INCLUDE_RDWR(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE) },
+#else
+{ ONLPLIB_CONFIG_I2C_RDWR_BLOCK_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE) },
+#else
+{ ONLPLIB_CONFIG_I2C_INCLUDE_MUX_CACHE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_I2C_MUX_CACHE_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_MUX_CACHE_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_MUX_CACHE_SIZE) },
+#else
+{ ONLPLIB_CONFIG_I2C_MUX_CACHE_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_I2C_MUX_LOCK_FILENAME
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_MUX_LOCK_FILENAME), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_MUX_LOCK_FILENAME) },
+#else
+{ ONLPLIB_CONFIG_I2C_MUX_LOCK_FILENAME(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_INCLUDE_CACHE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_INCLUDE_CACHE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_INCLUDE_CACHE) },
+#else
+{ ONLPLIB_CONFIG_FILE_INCLUDE_CACHE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_CACHE_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_CACHE_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_CACHE_SIZE) },
+#else
+{ ONLPLIB_CONFIG_FILE_CACHE_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_FILE_VEC_STR_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_FILE_VEC_STR_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_FILE_VEC_STR_MAX) },
+#else
+{ ONLPLIB_CONFIG_FILE_VEC_STR_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_CACHE_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_CACHE_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_CACHE_SIZE) },
+#else
+{ ONLPLIB_CONFIG_BMC_CACHE_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_COMMAND_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_COMMAND_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_COMMAND_MAX) },
+#else
+{ ONLPLIB_CONFIG_BMC_COMMAND_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_LINE_MAX
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_LINE_MAX), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_LINE_MAX) },
+#else
+{ ONLPLIB_CONFIG_BMC_LINE_MAX(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_BMC_BUFFER_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_BMC_BUFFER_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_BMC_BUFFER_SIZE) },
+#else
+{ ONLPLIB_CONFIG_BMC_BUFFER_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_DEVICE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_DEVICE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_DEVICE) },
+#else
+{ ONLPLIB_CONFIG_IPMI_DEVICE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_OUTSTANDING
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_OUTSTANDING), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_OUTSTANDING) },
+#else
+{ ONLPLIB_CONFIG_IPMI_OUTSTANDING(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_TIMEOUT_MS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_TIMEOUT_MS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_TIMEOUT_MS) },
+#else
+{ ONLPLIB_CONFIG_IPMI_TIMEOUT_MS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_READ_CHUNK
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_READ_CHUNK), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_READ_CHUNK) },
+#else
+{ ONLPLIB_CONFIG_IPMI_READ_CHUNK(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_SNAPSHOT_KEY
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_SNAPSHOT_KEY), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_SNAPSHOT_KEY) },
+#else
+{ ONLPLIB_CONFIG_IPMI_SNAPSHOT_KEY(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_SNAPSHOT_REFRESH_MS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_SNAPSHOT_REFRESH_MS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_SNAPSHOT_REFRESH_MS) },
+#else
+{ ONLPLIB_CONFIG_IPMI_SNAPSHOT_REFRESH_MS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS) },
+#else
+{ ONLPLIB_CONFIG_IPMI_SNAPSHOT_SENSORS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS) },
+#else
+{ ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRUS(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
+#ifdef ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRU_SIZE
+    { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRU_SIZE), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRU_SIZE) },
+#else
+{ ONLPLIB_CONFIG_IPMI_SNAPSHOT_FRU_SIZE(__onlplib_config_STRINGIFY_NAME), "__undefined__" },
+#endif
 #ifdef ONLPLIB_CONFIG_I2C_USE_CUSTOM_HEADER
     { __onlplib_config_STRINGIFY_NAME(ONLPLIB_CONFIG_I2C_USE_CUSTOM_HEADER), __onlplib_config_STRINGIFY_VALUE(ONLPLIB_CONFIG_I2C_USE_CUSTOM_HEADER) },
 #else
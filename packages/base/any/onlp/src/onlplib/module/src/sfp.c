@@ -29,6 +29,9 @@
 #include <onlp/onlp.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 
@@ -128,3 +131,115 @@ onlplib_sfp_reset_file(const char* fname,
 
     return ONLP_STATUS_OK;
 }
+
+/*
+ * Return the optoe device class of the given eeprom file.
+ * 1 (optoe1) devices have a single paged 0x50 space. 2 (optoe2)
+ * devices have an unpaged 0x50 space and a paged 0x51 space.
+ * The class is read from the dev_class attribute next to the eeprom.
+ * Files without one are treated as single address devices.
+ */
+static int
+sfp_memory_file_class__(const char* fname)
+{
+    char path[256];
+    char buf[8] = {0};
+    const char* slash = strrchr(fname, '/');
+    int fd;
+    int dev_class = 1;
+
+    if(slash == NULL) {
+        return dev_class;
+    }
+    snprintf(path, sizeof(path), "%.*s/dev_class", (int)(slash - fname), fname);
+
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if(fd >= 0) {
+        if(read(fd, buf, sizeof(buf) - 1) > 0 && atoi(buf) == 2) {
+            dev_class = 2;
+        }
+        close(fd);
+    }
+    return dev_class;
+}
+
+/*
+ * optoe places the 128 byte upper pages one after the other behind
+ * the lower page. The 0x51 (A2) space of optoe2 devices follows the
+ * 256 bytes of the 0x50 space.
+ */
+static int
+sfp_memory_file__(const char* fname, int wr, uint8_t devaddr,
+                  int bank, int page, int offset, int len, uint8_t* data)
+{
+    int fd;
+    int rv = ONLP_STATUS_OK;
+    off_t base;
+
+    if(bank != 0 || (devaddr != 0x50 && devaddr != 0x51)) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+
+    if(sfp_memory_file_class__(fname) == 2) {
+        /* The A0 space of optoe2 devices is not paged. */
+        if(devaddr == 0x50 && page != 0) {
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+        base = (devaddr == 0x51) ? 256 : 0;
+    }
+    else {
+        if(devaddr == 0x51) {
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+        base = 0;
+    }
+
+    fd = open(fname, (wr ? O_WRONLY : O_RDONLY) | O_CLOEXEC);
+    if(fd < 0) {
+        return ONLP_STATUS_E_MISSING;
+    }
+
+    while(len > 0) {
+        off_t foff;
+        ssize_t n;
+
+        if(offset < 128) {
+            /* The lower page is contiguous with page 0 only. */
+            n = (page && offset + len > 128) ? 128 - offset : len;
+            foff = base + offset;
+        }
+        else {
+            n = len;
+            foff = base + 128 * (page + 1) + (offset - 128);
+        }
+
+        if((wr ? pwrite(fd, data, n, foff) : pread(fd, data, n, foff)) != n) {
+            AIM_LOG_INTERNAL("Failed to %s %d bytes at %d of EEPROM file '%s'",
+                             wr ? "write" : "read", (int)n, (int)foff, fname);
+            rv = ONLP_STATUS_E_INTERNAL;
+            break;
+        }
+        data += n;
+        offset += n;
+        len -= n;
+    }
+
+    close(fd);
+    return rv;
+}
+
+int
+onlplib_sfp_memory_read_file(const char* fname, uint8_t devaddr,
+                             int bank, int page, int offset, int len,
+                             uint8_t* data)
+{
+    return sfp_memory_file__(fname, 0, devaddr, bank, page, offset, len, data);
+}
+
+int
+onlplib_sfp_memory_write_file(const char* fname, uint8_t devaddr,
+                              int bank, int page, int offset, int len,
+                              uint8_t* data)
+{
+    return sfp_memory_file__(fname, 1, devaddr, bank, page, offset, len, data);
+}
@@ -241,3 +241,174 @@ onlp_shlock_global_give(void)
 {
     return onlp_shlock_give(global_lock__);
 }
+
+
+/**
+ * Reader/writer lock sets.
+ *
+ * Threads within the process are serialized by a pthread rwlock.
+ * The process as a whole holds an fcntl() record lock on byte <index>
+ * of the lock file while any of its threads hold the lock. The reader
+ * count tracks when the record lock must be acquired and released.
+ */
+#include <fcntl.h>
+#include <unistd.h>
+
+typedef struct onlp_shrwlock_entry_s {
+    pthread_rwlock_t rwlock;
+    pthread_mutex_t mutex;
+    int readers;
+    int writer;
+} onlp_shrwlock_entry_t;
+
+struct onlp_shrwlock_s {
+    int fd;
+    int count;
+    onlp_shrwlock_entry_t* entries;
+};
+
+static int
+shrwlock_record__(onlp_shrwlock_t* l, int index, short type)
+{
+    struct flock fl;
+
+    if(l->fd < 0) {
+        return 0;
+    }
+
+    memset(&fl, 0, sizeof(fl));
+    fl.l_type = type;
+    fl.l_whence = SEEK_SET;
+    fl.l_start = index;
+    fl.l_len = 1;
+
+    while(fcntl(l->fd, F_SETLKW, &fl) < 0) {
+        if(errno != EINTR) {
+            AIM_LOG_ERROR("fcntl(lock %d, type %d) failed: %{errno}",
+                          index, type, errno);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int
+onlp_shrwlock_create(const char* fname, int count, onlp_shrwlock_t** rv)
+{
+    int i;
+    onlp_shrwlock_t* l;
+    pthread_rwlockattr_t ra;
+
+    if(rv == NULL || count <= 0) {
+        return -1;
+    }
+
+    l = aim_zmalloc(sizeof(*l));
+    l->fd = -1;
+    l->count = count;
+    l->entries = aim_zmalloc(sizeof(*l->entries)*count);
+
+    if(fname) {
+        l->fd = open(fname, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+        if(l->fd < 0) {
+            AIM_LOG_ERROR("open(%s) failed: %{errno}", fname, errno);
+            aim_free(l->entries);
+            aim_free(l);
+            return -1;
+        }
+    }
+
+    pthread_rwlockattr_init(&ra);
+    /* Writers must not be starved by a steady stream of readers. */
+    pthread_rwlockattr_setkind_np(&ra, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+    for(i = 0; i < count; i++) {
+        pthread_rwlock_init(&l->entries[i].rwlock, &ra);
+        pthread_mutex_init(&l->entries[i].mutex, NULL);
+    }
+    pthread_rwlockattr_destroy(&ra);
+
+    *rv = l;
+    return 0;
+}
+
+int
+onlp_shrwlock_destroy(onlp_shrwlock_t* l)
+{
+    int i;
+
+    if(l == NULL) {
+        return 0;
+    }
+    for(i = 0; i < l->count; i++) {
+        pthread_rwlock_destroy(&l->entries[i].rwlock);
+        pthread_mutex_destroy(&l->entries[i].mutex);
+    }
+    if(l->fd >= 0) {
+        /* Releases any record locks still held by this process. */
+        close(l->fd);
+    }
+    aim_free(l->entries);
+    aim_free(l);
+    return 0;
+}
+
+int
+onlp_shrwlock_take(onlp_shrwlock_t* l, int index, int exclusive)
+{
+    onlp_shrwlock_entry_t* e;
+
+    if(l == NULL || index < 0 || index >= l->count) {
+        AIM_DIE("shrwlock_take(): invalid lock or index %d", index);
+    }
+    e = l->entries + index;
+
+    if(exclusive) {
+        if(pthread_rwlock_wrlock(&e->rwlock) != 0) {
+            AIM_DIE("rwlock_wrlock() failed: %{errno}", errno);
+        }
+        if(shrwlock_record__(l, index, F_WRLCK) < 0) {
+            AIM_DIE("shrwlock_take(): record lock %d failed.", index);
+        }
+        e->writer = 1;
+    }
+    else {
+        if(pthread_rwlock_rdlock(&e->rwlock) != 0) {
+            AIM_DIE("rwlock_rdlock() failed: %{errno}", errno);
+        }
+        pthread_mutex_lock(&e->mutex);
+        if(e->readers++ == 0 && shrwlock_record__(l, index, F_RDLCK) < 0) {
+            AIM_DIE("shrwlock_take(): record lock %d failed.", index);
+        }
+        pthread_mutex_unlock(&e->mutex);
+    }
+    return 0;
+}
+
+int
+onlp_shrwlock_give(onlp_shrwlock_t* l, int index)
+{
+    onlp_shrwlock_entry_t* e;
+
+    if(l == NULL || index < 0 || index >= l->count) {
+        AIM_DIE("shrwlock_give(): invalid lock or index %d", index);
+    }
+    e = l->entries + index;
+
+    if(e->writer) {
+        /* Only the writing thread can observe this while holding the lock. */
+        e->writer = 0;
+        shrwlock_record__(l, index, F_UNLCK);
+    }
+    else {
+        pthread_mutex_lock(&e->mutex);
+        if(--e->readers == 0) {
+            shrwlock_record__(l, index, F_UNLCK);
+        }
+        pthread_mutex_unlock(&e->mutex);
+    }
+
+    if(pthread_rwlock_unlock(&e->rwlock) != 0) {
+        AIM_DIE("rwlock_unlock() failed: %{errno}", errno);
+    }
+    return 0;
+}
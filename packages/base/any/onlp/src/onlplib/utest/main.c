@@ -22,18 +22,956 @@
  *
  *
  ***********************************************************/
+/* posix_openpt() */
+#define _GNU_SOURCE
 
 #include <onlplib/onlplib_config.h>
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <inttypes.h>
+#include <sys/shm.h>
 #include <AIM/aim.h>
+#include <onlp/onlp.h>
+#include <onlplib/i2c.h>
+#include <onlplib/file.h>
+#include <onlplib/bmc.h>
+#include <onlplib/ipmi.h>
+#include <onlplib/ipmi_snapshot.h>
+
+#if ONLPLIB_CONFIG_INCLUDE_I2C == 1
+
+/*
+ * Mux sweep benchmark.
+ *
+ * Reads one byte from each of 32 ports behind a pca9548 parent with
+ * four pca9548 children and reports the number of bus transactions.
+ * The devices must answer on the given bus, e.g.
+ *
+ *   modprobe i2c-stub chip_addr=0x50,0x70,0x71,0x72,0x73,0x74
+ *   ONLPLIB_UTEST_I2C_BUS=<bus> utest
+ */
+#define SWEEP_PORTS 32
+
+static onlp_i2c_mux_device_t sweep_parent__ = {
+    "parent", 0, 0x70, &onlp_i2c_mux_driver_pca9548
+};
+static onlp_i2c_mux_device_t sweep_children__[4] = {
+    { "child0", 0, 0x71, &onlp_i2c_mux_driver_pca9548 },
+    { "child1", 0, 0x72, &onlp_i2c_mux_driver_pca9548 },
+    { "child2", 0, 0x73, &onlp_i2c_mux_driver_pca9548 },
+    { "child3", 0, 0x74, &onlp_i2c_mux_driver_pca9548 },
+};
+
+static int
+i2c_mux_sweep__(int bus, int cache, uint32_t flags)
+{
+    int p, i;
+    onlp_i2c_stats_t stats;
+    onlp_i2c_dev_t dev;
+
+    sweep_parent__.bus = bus;
+    for(i = 0; i < AIM_ARRAYSIZE(sweep_children__); i++) {
+        sweep_children__[i].bus = bus;
+    }
+
+    onlp_i2c_mux_cache_enable(cache);
+    onlp_i2c_stats_get(&stats, 1);
+
+    for(p = 0; p < SWEEP_PORTS; p++) {
+        memset(&dev, 0, sizeof(dev));
+        dev.name = "port";
+        dev.bus = bus;
+        dev.addr = 0x50;
+        dev.ichannels.channels[0].mux = &sweep_parent__;
+        dev.ichannels.channels[0].channel = p / 8;
+        dev.ichannels.channels[1].mux = sweep_children__ + (p / 8);
+        dev.ichannels.channels[1].channel = p % 8;
+        if(onlp_i2c_dev_readb(&dev, 0, flags) < 0) {
+            return -1;
+        }
+    }
+
+    onlp_i2c_stats_get(&stats, 1);
+    printf("  cache=%-3s deselect=%-3s  device=%d mux_writes=%"PRIu64" mux_skips=%"PRIu64" total=%"PRIu64"\n",
+           cache ? "on" : "off",
+           (flags & ONLP_I2C_F_NO_MUX_DESELECT) ? "no" : "yes",
+           SWEEP_PORTS, stats.mux_writes, stats.mux_skips,
+           SWEEP_PORTS + stats.mux_writes);
+    return 0;
+}
+
+static int
+i2c_mux_sweep_benchmark(void)
+{
+    int bus;
+    const char* s = getenv("ONLPLIB_UTEST_I2C_BUS");
+
+    if(s == NULL) {
+        printf("i2c mux sweep: ONLPLIB_UTEST_I2C_BUS not set (skipped)\n");
+        return 0;
+    }
+    bus = atoi(s);
+
+    printf("i2c mux sweep: %d ports on bus %d\n", SWEEP_PORTS, bus);
+    if(i2c_mux_sweep__(bus, 0, 0) < 0 ||
+       i2c_mux_sweep__(bus, 1, 0) < 0 ||
+       i2c_mux_sweep__(bus, 0, ONLP_I2C_F_NO_MUX_DESELECT) < 0 ||
+       i2c_mux_sweep__(bus, 1, ONLP_I2C_F_NO_MUX_DESELECT) < 0) {
+        printf("i2c mux sweep: device access failed on bus %d\n", bus);
+        return -1;
+    }
+    onlp_i2c_mux_cache_enable(1);
+    return 0;
+}
+
+#if ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE == 1
+
+/*
+ * Descriptor cache counters, on the same i2c-stub bus.
+ * A device error must not close the cached descriptor.
+ */
+static int
+i2c_fd_cache_test(void)
+{
+    int bus;
+    uint8_t data[4];
+    onlp_i2c_stats_t stats;
+    const char* s = getenv("ONLPLIB_UTEST_I2C_BUS");
+
+    if(s == NULL) {
+        printf("i2c fd cache: ONLPLIB_UTEST_I2C_BUS not set (skipped)\n");
+        return 0;
+    }
+    bus = atoi(s);
+
+    onlp_i2c_flush(bus);
+    onlp_i2c_stats_get(&stats, 1);
+
+    if(onlp_i2c_readb(bus, 0x50, 0, 0) < 0 ||
+       onlp_i2c_readb(bus, 0x50, 1, 0) < 0) {
+        printf("i2c fd cache: device access failed on bus %d\n", bus);
+        return -1;
+    }
+    /* i2c-stub does not implement SMBus block reads (EOPNOTSUPP). */
+    if(onlp_i2c_block_read(bus, 0x50, 0, sizeof(data), data,
+                           ONLP_I2C_F_USE_SMBUS_BLOCK_READ |
+                           ONLP_I2C_F_DISABLE_READ_RETRIES) >= 0 ||
+       onlp_i2c_readb(bus, 0x50, 2, 0) < 0) {
+        printf("i2c fd cache: unexpected block read result.\n");
+        return -1;
+    }
+    onlp_i2c_stats_get(&stats, 1);
+    printf("i2c fd cache: opens=%"PRIu64" ioctls=%"PRIu64" reuses=%"PRIu64" flushes=%"PRIu64"\n",
+           stats.opens, stats.ioctls, stats.reuses, stats.flushes);
+    if(stats.opens != 1 || stats.ioctls != 3 ||
+       stats.reuses != 3 || stats.flushes != 0) {
+        printf("i2c fd cache: the descriptor was not reused.\n");
+        return -1;
+    }
+
+    onlp_i2c_flush(bus);
+    if(onlp_i2c_readb(bus, 0x50, 0, 0) < 0) {
+        return -1;
+    }
+    onlp_i2c_stats_get(&stats, 1);
+    if(stats.opens != 1 || stats.flushes != 1) {
+        printf("i2c fd cache: flush did not reopen the descriptor.\n");
+        return -1;
+    }
+    return 0;
+}
+
+#endif /* ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE */
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_I2C */
+
+#if ONLPLIB_CONFIG_INCLUDE_BMC == 1
+
+#include <AIM/aim_time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+/*
+ * BMC console simulator.
+ *
+ * A login dialog followed by an interactive shell on a pty.
+ */
+static void
+bmc_simulator__(const char* slave)
+{
+    char line[128];
+    int fd;
+
+    setsid();
+    if((fd = open(slave, O_RDWR)) < 0) {
+        _exit(1);
+    }
+    dup2(fd, 0);
+    dup2(fd, 1);
+    dup2(fd, 2);
+
+    for(;;) {
+        printf("\r\nbmc login: ");
+        fflush(stdout);
+        if(fgets(line, sizeof(line), stdin) == NULL) {
+            _exit(1);
+        }
+        if(strncmp(line, "root", 4)) {
+            continue;
+        }
+        printf("Password: ");
+        fflush(stdout);
+        if(fgets(line, sizeof(line), stdin) == NULL) {
+            _exit(1);
+        }
+        if(!strncmp(line, "0penBmc", 7)) {
+            break;
+        }
+    }
+
+    printf("Last login: never\r\n");
+    fflush(stdout);
+    setenv("PS1", "root@bmc:~# ", 1);
+    execl("/bin/sh", "sh", "-i", (char*)NULL);
+    _exit(1);
+}
+
+static int
+bmc_session_test(void)
+{
+    int master, i, rv = -1;
+    pid_t pid;
+    uint64_t start;
+    char resp[3][64];
+    onlp_bmc_session_t* s;
+    onlp_bmc_stats_t stats;
+    onlp_bmc_config_t config = {
+        NULL, 0, "@bmc:", "root", "0penBmc", 2000, 2000, 1000
+    };
+    onlp_bmc_request_t requests[] = {
+        { "echo 0x1f", resp[0], sizeof(resp[0]), 1 },
+        { "cat /nonexistent 2>/dev/null", resp[1], sizeof(resp[1]), 1 },
+        { "printf 42", resp[2], sizeof(resp[2]), 1 },
+    };
+
+    if((master = posix_openpt(O_RDWR | O_NOCTTY)) < 0 ||
+       grantpt(master) < 0 || unlockpt(master) < 0) {
+        printf("bmc session: no pty (skipped)\n");
+        return 0;
+    }
+
+    if((pid = fork()) < 0) {
+        printf("bmc session: fork failed: %s\n", strerror(errno));
+        close(master);
+        return -1;
+    }
+    if(pid == 0) {
+        bmc_simulator__(ptsname(master));
+    }
+
+    if(onlp_bmc_session_open_fd(&config, master, &s) < 0) {
+        goto done;
+    }
+
+    if(onlp_bmc_request(s, requests, AIM_ARRAYSIZE(requests)) < 0 ||
+       strcmp(resp[0], "0x1f") || requests[0].status != 0 ||
+       requests[1].status == 0 ||
+       strcmp(resp[2], "42") || requests[2].status != 0) {
+        printf("bmc session: batch failed: [%s] [%s] [%s]\n",
+               resp[0], resp[1], resp[2]);
+        goto close;
+    }
+
+    if(onlp_bmc_read(s, "echo 0x1f", resp[0], sizeof(resp[0])) != 0 ||
+       strcmp(resp[0], "0x1f")) {
+        printf("bmc session: cached read failed.\n");
+        goto close;
+    }
+
+    onlp_bmc_stats_get(s, &stats, 1);
+    if(stats.logins != 1 || stats.round_trips != 1 || stats.cache_hits != 1) {
+        printf("bmc session: unexpected stats.\n");
+        goto close;
+    }
+
+    /* Single commands versus one batch. */
+    start = aim_time_monotonic();
+    for(i = 0; i < 16; i++) {
+        onlp_bmc_command(s, "echo 1", resp[0], sizeof(resp[0]));
+    }
+    printf("bmc session: 16 commands, 16 round trips: %"PRIu64" us\n",
+           aim_time_monotonic() - start);
+
+    onlp_bmc_request_t batch[16];
+    for(i = 0; i < 16; i++) {
+        batch[i].cmd = "echo 1";
+        batch[i].resp = resp[0];
+        batch[i].size = sizeof(resp[0]);
+        batch[i].cache = 0;
+    }
+    start = aim_time_monotonic();
+    onlp_bmc_request(s, batch, 16);
+    printf("bmc session: 16 commands, 1 round trip: %"PRIu64" us\n",
+           aim_time_monotonic() - start);
+
+    rv = 0;
+
+ close:
+    onlp_bmc_session_close(s);
+ done:
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    return rv;
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_BMC */
+
+#if ONLPLIB_CONFIG_INCLUDE_IPMI == 1
+
+#include <unistd.h>
+
+/*
+ * Simulated BMC behind an IPMI transport.
+ *
+ * Responses are queued when a request is sent and are delivered in
+ * reverse order, to check message id matching. A stale response is
+ * queued first, as left behind by an earlier request which timed out.
+ */
+#define FAKE_QUEUE 64
+
+typedef struct fake_ipmi_s {
+    int pipe[2];
+    struct {
+        long msgid;
+        uint8_t data[64];
+        int len;
+    } queue[FAKE_QUEUE];
+    int count;
+    int sent;
+    int max_outstanding;
+    uint8_t sdr[4][64];
+    int sdr_len[4];
+    uint8_t fru[64];
+} fake_ipmi_t;
+
+static void
+fake_queue__(fake_ipmi_t* f, long msgid, const uint8_t* data, int len)
+{
+    f->queue[f->count].msgid = msgid;
+    memcpy(f->queue[f->count].data, data, len);
+    f->queue[f->count].len = len;
+    f->count++;
+    if(f->count > f->max_outstanding) {
+        f->max_outstanding = f->count;
+    }
+    if(write(f->pipe[1], "", 1) != 1) {
+        AIM_DIE("fake ipmi: pipe write failed");
+    }
+}
+
+static int
+fake_send__(void* cookie, long msgid, uint8_t netfn, uint8_t cmd,
+            const uint8_t* data, int len)
+{
+    fake_ipmi_t* f = cookie;
+    uint8_t rsp[64] = { 0 };
+    int rlen = 1;
+
+    if(f->sent++ == 0) {
+        fake_queue__(f, msgid - 100, rsp, 1);
+    }
+
+    if(netfn == ONLP_IPMI_NETFN_STORAGE && cmd == 0x22) {
+        rsp[1] = 0x01;
+        rsp[2] = 0x00;
+        rlen = 3;
+    }
+    else if(netfn == ONLP_IPMI_NETFN_STORAGE && cmd == 0x23) {
+        int id = data[2] | (data[3] << 8);
+        int next = (id + 1 < 4) ? id + 1 : 0xFFFF;
+        rsp[1] = next & 0xFF;
+        rsp[2] = next >> 8;
+        memcpy(rsp + 3, f->sdr[id] + data[4], data[5]);
+        rlen = 3 + data[5];
+    }
+    else if(netfn == ONLP_IPMI_NETFN_SENSOR && cmd == 0x2D) {
+        rsp[1] = (data[0] == 1) ? 35 : 120;
+        rsp[2] = 0xC0;
+        rlen = 3;
+    }
+    else if(netfn == ONLP_IPMI_NETFN_SENSOR && cmd == 0x27) {
+        /* Upper critical only */
+        rsp[1] = 0x10;
+        rsp[6] = 90;
+        rlen = 8;
+    }
+    else if(netfn == ONLP_IPMI_NETFN_STORAGE && cmd == 0x10) {
+        rsp[1] = sizeof(f->fru);
+        rlen = 4;
+    }
+    else if(netfn == ONLP_IPMI_NETFN_STORAGE && cmd == 0x11) {
+        int offset = data[1] | (data[2] << 8);
+        rsp[1] = data[3];
+        memcpy(rsp + 2, f->fru + offset, data[3]);
+        rlen = 2 + data[3];
+    }
+    else if(netfn == 0x3C) {
+        /* OEM echo */
+        memcpy(rsp + 1, data, len);
+        rlen = 1 + len;
+    }
+    else {
+        rsp[0] = 0xC1;
+    }
+
+    fake_queue__(f, msgid, rsp, rlen);
+    return 0;
+}
+
+static int
+fake_recv__(void* cookie, long* msgid, uint8_t* data, int* len)
+{
+    fake_ipmi_t* f = cookie;
+    char c;
+
+    if(f->count == 0 || read(f->pipe[0], &c, 1) != 1) {
+        return ONLP_STATUS_E_MISSING;
+    }
+    f->count--;
+    *msgid = f->queue[f->count].msgid;
+    *len = f->queue[f->count].len;
+    memcpy(data, f->queue[f->count].data, *len);
+    return 0;
+}
+
+static int
+fake_fd__(void* cookie)
+{
+    return ((fake_ipmi_t*)cookie)->pipe[0];
+}
+
+static const onlp_ipmi_transport_t fake_transport__ = {
+    fake_send__, fake_recv__, fake_fd__, NULL
+};
+
+static void
+fake_sdr__(fake_ipmi_t* f, int id, int number, int m, const char* name)
+{
+    uint8_t* r = f->sdr[id];
+    int len = strlen(name);
+
+    r[0] = id;
+    r[2] = 0x51;
+    r[3] = 0x01;
+    r[4] = 48 + len - 5;
+    r[5] = 0x20;
+    r[7] = number;
+    r[13] = 0x01;
+    r[24] = m;
+    r[47] = 0xC0 | len;
+    memcpy(r + 48, name, len);
+    f->sdr_len[id] = 48 + len;
+}
+
+#define SNAPSHOT_TEST_KEY 0x5EED0001
+
+static int
+ipmi_snapshot_test(fake_ipmi_t* f, onlp_ipmi_t* ipmi)
+{
+    onlp_ipmi_snapshot_config_t config = { SNAPSHOT_TEST_KEY, 60000, ipmi };
+    onlp_ipmi_snapshot_t *writer = NULL, *reader = NULL;
+    onlp_ipmi_snapshot_fru_t fru;
+    onlp_ipmi_sensor_t sensor;
+    char str[32];
+    int i, sent, rv = -1;
+
+    if(onlp_ipmi_snapshot_open(&config, &writer) < 0) {
+        printf("ipmi snapshot: open failed.\n");
+        return -1;
+    }
+    if(onlp_ipmi_snapshot_refresh(writer, 1) < 0 ||
+       onlp_ipmi_snapshot_generation(writer) == 0) {
+        printf("ipmi snapshot: refresh failed.\n");
+        goto done;
+    }
+
+    /* A second handle uses the shared table without refreshing it. */
+    config.ipmi = NULL;
+    onlp_ipmi_snapshot_open(&config, &reader);
+    sent = f->sent;
+
+    for(i = 0; i < 2; i++) {
+        onlp_ipmi_snapshot_t* s = i ? reader : writer;
+        if(onlp_ipmi_snapshot_sensor_get(s, "Temp_L0", &sensor) < 0 ||
+           !(sensor.flags & ONLP_IPMI_SENSOR_F_VALID) || sensor.value != 35 ||
+           sensor.thresholds != (1 << ONLP_IPMI_THRESHOLD_UCR) ||
+           sensor.threshold[ONLP_IPMI_THRESHOLD_UCR] != 90) {
+            printf("ipmi snapshot: Temp_L0 failed.\n");
+            goto done;
+        }
+        if(onlp_ipmi_snapshot_sensor_get_number(s, 2, &sensor) < 0 ||
+           strcmp(sensor.name, "FanPWM_0") || sensor.value != 12000) {
+            printf("ipmi snapshot: sensor 2 failed.\n");
+            goto done;
+        }
+        if(onlp_ipmi_snapshot_sensor_get(s, "Temp_L9", &sensor) !=
+           ONLP_STATUS_E_MISSING) {
+            printf("ipmi snapshot: missing sensor found.\n");
+            goto done;
+        }
+        if(onlp_ipmi_snapshot_fru_get(s, "FRU_PSU1", &fru) < 0 || fru.id != 5 ||
+           onlp_ipmi_fru_board_get(fru.data, fru.size,
+                                   ONLP_IPMI_FRU_BOARD_CUSTOM,
+                                   str, sizeof(str)) < 0 ||
+           strcmp(str, "F2B")) {
+            printf("ipmi snapshot: FRU_PSU1 failed.\n");
+            goto done;
+        }
+    }
+
+    if(f->sent != sent) {
+        printf("ipmi snapshot: lookups talked to the BMC.\n");
+        goto done;
+    }
+    rv = 0;
+
+ done:
+    onlp_ipmi_snapshot_close(reader);
+    onlp_ipmi_snapshot_close(writer);
+    shmctl(shmget(SNAPSHOT_TEST_KEY, 0, 0), IPC_RMID, NULL);
+    shmctl(shmget(SNAPSHOT_TEST_KEY + 1, 0, 0), IPC_RMID, NULL);
+    return rv;
+}
+
+static int
+ipmi_test(void)
+{
+    fake_ipmi_t f;
+    onlp_ipmi_t* ipmi;
+    uint8_t echo[] = { 0xE0, 0x05, 0x01 }, resp[8];
+    uint8_t fru[64];
+    char str[32];
+    double value;
+    int rv = -1;
+
+    memset(&f, 0, sizeof(f));
+    if(pipe(f.pipe) < 0) {
+        return -1;
+    }
+
+    fake_sdr__(&f, 0, 1, 1, "Temp_L0");
+    /* An OEM record, which is skipped. */
+    f.sdr[1][0] = 1;
+    f.sdr[1][3] = 0xC0;
+    f.sdr[1][4] = 3;
+    f.sdr_len[1] = 8;
+    fake_sdr__(&f, 2, 2, 100, "FanPWM_0");
+    /* A FRU device locator for FRU 5. */
+    uint8_t locator[] = {
+        3, 0, 0x51, 0x11, 24 - 5, 0x20, 5, 0x80,
+        0, 0, 0x10, 0, 0x0A, 1, 0, 0xC8,
+        'F', 'R', 'U', '_', 'P', 'S', 'U', '1',
+    };
+    memcpy(f.sdr[3], locator, sizeof(locator));
+    f.sdr_len[3] = sizeof(locator);
+
+    /* FRU with a product area at offset 8. "DELTA" is 6-bit packed. */
+    uint8_t product[] = {
+        0x01, 0x06, 0x00,
+        0x84, 0x64, 0xC9, 0xD2, 0x21,
+        0xCA, 'D', 'P', 'S', '-', '1', '6', '0', '0', 'A', 'B',
+        0xC0, 0xC0,
+        0xC6, 'A', 'B', 'C', '1', '2', '3',
+        0xC1,
+    };
+    f.fru[0] = 0x01;
+    f.fru[4] = 1;
+    memcpy(f.fru + 8, product, sizeof(product));
+
+    /* Board area at offset 40, with one custom field. */
+    uint8_t board[] = {
+        0x01, 0x03, 0x00, 0x00, 0x00, 0x00,
+        0xC3, 'C', 'L', 'S',
+        0xC0,
+        0xC2, 'S', '1',
+        0xC0, 0xC0,
+        0xC3, 'F', '2', 'B',
+        0xC1,
+    };
+    f.fru[3] = 5;
+    memcpy(f.fru + 40, board, sizeof(board));
+
+    onlp_ipmi_open_transport(&fake_transport__, &f, &ipmi);
+
+    if(onlp_ipmi_raw(ipmi, 0x3C, 0x01, echo, sizeof(echo),
+                     resp, sizeof(resp)) != 3 || memcmp(resp, echo, 3)) {
+        printf("ipmi: raw request failed.\n");
+        goto done;
+    }
+
+    if(onlp_ipmi_sensor_get(ipmi, "Temp_L0", &value) < 0 || value != 35) {
+        printf("ipmi: Temp_L0 failed.\n");
+        goto done;
+    }
+    if(onlp_ipmi_sensor_get(ipmi, "FanPWM_0", &value) < 0 || value != 12000) {
+        printf("ipmi: FanPWM_0 failed.\n");
+        goto done;
+    }
+    if(onlp_ipmi_sensor_get(ipmi, "Temp_L9", &value) != ONLP_STATUS_E_MISSING) {
+        printf("ipmi: missing sensor found.\n");
+        goto done;
+    }
+
+    f.max_outstanding = 0;
+    if(onlp_ipmi_fru_read(ipmi, 1, fru, sizeof(fru)) != sizeof(fru) ||
+       memcmp(fru, f.fru, sizeof(fru))) {
+        printf("ipmi: FRU read failed.\n");
+        goto done;
+    }
+    if(f.max_outstanding < 2) {
+        printf("ipmi: FRU chunks were not pipelined.\n");
+        goto done;
+    }
+
+    if(onlp_ipmi_fru_product_get(fru, sizeof(fru),
+                                 ONLP_IPMI_FRU_PRODUCT_MANUFACTURER,
+                                 str, sizeof(str)) < 0 ||
+       strcmp(str, "DELTA") ||
+       onlp_ipmi_fru_product_get(fru, sizeof(fru), ONLP_IPMI_FRU_PRODUCT_NAME,
+                                 str, sizeof(str)) < 0 ||
+       strcmp(str, "DPS-1600AB") ||
+       onlp_ipmi_fru_product_get(fru, sizeof(fru), ONLP_IPMI_FRU_PRODUCT_SERIAL,
+                                 str, sizeof(str)) < 0 ||
+       strcmp(str, "ABC123")) {
+        printf("ipmi: FRU product fields failed.\n");
+        goto done;
+    }
+    if(onlp_ipmi_fru_board_get(fru, sizeof(fru), ONLP_IPMI_FRU_BOARD_SERIAL,
+                               str, sizeof(str)) < 0 ||
+       strcmp(str, "S1") ||
+       onlp_ipmi_fru_board_get(fru, sizeof(fru), ONLP_IPMI_FRU_BOARD_CUSTOM,
+                               str, sizeof(str)) < 0 ||
+       strcmp(str, "F2B")) {
+        printf("ipmi: FRU board fields failed.\n");
+        goto done;
+    }
+
+    if(ipmi_snapshot_test(&f, ipmi) < 0) {
+        goto done;
+    }
+
+    printf("ipmi: %d requests, at most %d outstanding.\n",
+           f.sent, f.max_outstanding);
+    rv = 0;
+
+ done:
+    onlp_ipmi_close(ipmi);
+    close(f.pipe[0]);
+    close(f.pipe[1]);
+    return rv;
+}
+
+#endif /* ONLPLIB_CONFIG_INCLUDE_IPMI */
+
+#include <AIM/aim_time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static int
+file_write__(const char* path, const char* value)
+{
+    FILE* fp = fopen(path, "w");
+    if(fp == NULL) {
+        return -1;
+    }
+    fputs(value, fp);
+    fclose(fp);
+    return 0;
+}
+
+#if ONLPLIB_CONFIG_FILE_INCLUDE_CACHE == 1
+
+/*
+ * File cache test.
+ *
+ * A filename containing '*' must follow its file when it moves,
+ * and sysfs attributes must read the same with and without the
+ * cache. Reports the cost of repeated sysfs reads.
+ */
+#define FILE_CACHE_READS 1000
+
+static int
+file_cache_sysfs__(const char* path, int cache)
+{
+    int i, v;
+    uint64_t start;
+    onlp_file_stats_t stats;
+
+    onlp_file_cache_enable(cache);
+    onlp_file_stats_get(&stats, 1);
+    start = aim_time_monotonic();
+    for(i = 0; i < FILE_CACHE_READS; i++) {
+        if(onlp_file_read_int(&v, "%s", path) < 0) {
+            return -1;
+        }
+    }
+    onlp_file_stats_get(&stats, 1);
+    printf("file cache %s: %d reads of %s, %.2f us/read, opens=%"PRIu64" rereads=%"PRIu64"\n",
+           cache ? "on" : "off", FILE_CACHE_READS, path,
+           (aim_time_monotonic() - start) / (double)FILE_CACHE_READS,
+           stats.opens, stats.rereads);
+    return 0;
+}
+
+static int
+file_cache_test(void)
+{
+    char root[] = "/tmp/onlplib-utest-XXXXXX";
+    char path[256];
+    int v = 0, rv = -1;
+    onlp_file_stats_t stats;
+    const char* sysfs = "/sys/devices/system/cpu/kernel_max";
+
+    if(mkdtemp(root) == NULL) {
+        printf("file cache: mkdtemp failed\n");
+        return -1;
+    }
+    snprintf(path, sizeof(path), "%s/a", root);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/b", root);
+    mkdir(path, 0755);
+
+    /* Found by search, then from the cache. */
+    onlp_file_cache_enable(1);
+    onlp_file_stats_get(&stats, 1);
+    snprintf(path, sizeof(path), "%s/a/temp1_input", root);
+    file_write__(path, "41000\n");
+    if(onlp_file_read_int(&v, "%s/*temp1_input", root) < 0 || v != 41000 ||
+       onlp_file_read_int(&v, "%s/*temp1_input", root) < 0 || v != 41000) {
+        printf("file cache: search read failed (%d)\n", v);
+        goto done;
+    }
+    onlp_file_stats_get(&stats, 1);
+    if(stats.searches != 1) {
+        printf("file cache: %"PRIu64" searches, expected 1\n", stats.searches);
+        goto done;
+    }
+
+    /* The file moves, the next read must find it again. */
+    unlink(path);
+    snprintf(path, sizeof(path), "%s/b/temp1_input", root);
+    file_write__(path, "42000\n");
+    if(onlp_file_read_int(&v, "%s/*temp1_input", root) < 0 || v != 42000) {
+        printf("file cache: moved file not found (%d)\n", v);
+        goto done;
+    }
+
+    /* Gone entirely. */
+    unlink(path);
+    if(onlp_file_read_int(&v, "%s/*temp1_input", root) != ONLP_STATUS_E_MISSING) {
+        printf("file cache: removed file still read\n");
+        goto done;
+    }
+
+    if(access(sysfs, R_OK) == 0) {
+        int a = 0, b = 0;
+        onlp_file_cache_enable(0);
+        onlp_file_read_int(&a, "%s", sysfs);
+        onlp_file_cache_enable(1);
+        onlp_file_read_int(&b, "%s", sysfs);
+        onlp_file_read_int(&b, "%s", sysfs);
+        if(a != b) {
+            printf("file cache: sysfs reads differ (%d != %d)\n", a, b);
+            goto done;
+        }
+        if(file_cache_sysfs__(sysfs, 0) < 0 ||
+           file_cache_sysfs__(sysfs, 1) < 0) {
+            printf("file cache: sysfs read failed\n");
+            goto done;
+        }
+    }
+    else {
+        printf("file cache: %s not readable (sysfs benchmark skipped)\n", sysfs);
+    }
+    rv = 0;
+
+ done:
+    onlp_file_cache_enable(1);
+    snprintf(path, sizeof(path), "%s/a", root);
+    rmdir(path);
+    snprintf(path, sizeof(path), "%s/b", root);
+    rmdir(path);
+    rmdir(root);
+    return rv;
+}
+
+#endif /* ONLPLIB_CONFIG_FILE_INCLUDE_CACHE */
+
+/*
+ * Attribute vector benchmark.
+ *
+ * Builds a fake sysfs tree (32 module_present, 8 fan and 8 temp
+ * attributes) in tmpfs and polls it with onlp_file_read_int() per
+ * attribute and with one onlp_file_vec_read().
+ */
+#define FILE_VEC_PORTS 32
+#define FILE_VEC_FANS 8
+#define FILE_VEC_TEMPS 8
+#define FILE_VEC_ATTRS (FILE_VEC_PORTS + FILE_VEC_FANS + FILE_VEC_TEMPS)
+#define FILE_VEC_SWEEPS 200
+
+static void
+file_vec_attr__(const char* root, int i, char* path, int size)
+{
+    if(i < FILE_VEC_PORTS) {
+        snprintf(path, size, "%s/module_present_%d", root, i + 1);
+    }
+    else if(i < FILE_VEC_PORTS + FILE_VEC_FANS) {
+        snprintf(path, size, "%s/fan%d_input", root, i - FILE_VEC_PORTS + 1);
+    }
+    else {
+        snprintf(path, size, "%s/temp%d_input", root,
+                 i - FILE_VEC_PORTS - FILE_VEC_FANS + 1);
+    }
+}
+
+static int
+file_vec_test(void)
+{
+    char root[64];
+    char path[256];
+    char value[32];
+    int i, n, v, rv = -1;
+    uint64_t start;
+    onlp_file_vec_t* vec = NULL;
+    onlp_file_vec_result_t results[FILE_VEC_ATTRS + 1];
+    onlp_file_stats_t stats;
+
+    snprintf(root, sizeof(root), "%s/onlplib-utest-XXXXXX",
+             access("/dev/shm", W_OK) == 0 ? "/dev/shm" : "/tmp");
+    if(mkdtemp(root) == NULL) {
+        printf("file vec: mkdtemp failed\n");
+        return -1;
+    }
+
+    onlp_file_vec_create(&vec);
+    for(i = 0; i < FILE_VEC_ATTRS; i++) {
+        file_vec_attr__(root, i, path, sizeof(path));
+        snprintf(value, sizeof(value), "%d\n", i * 100);
+        file_write__(path, value);
+        if(onlp_file_vec_add(vec, ONLP_FILE_VEC_TYPE_INT, "%s", path) != i) {
+            printf("file vec: add failed\n");
+            goto done;
+        }
+    }
+
+    onlp_file_stats_get(&stats, 1);
+    start = aim_time_monotonic();
+    for(n = 0; n < FILE_VEC_SWEEPS; n++) {
+        for(i = 0; i < FILE_VEC_ATTRS; i++) {
+            file_vec_attr__(root, i, path, sizeof(path));
+            if(onlp_file_read_int(&v, "%s", path) < 0 || v != i * 100) {
+                printf("file vec: read of %s failed\n", path);
+                goto done;
+            }
+        }
+    }
+    onlp_file_stats_get(&stats, 1);
+    printf("file vec: %d attributes, per attribute reads %.2f us/sweep, opens=%"PRIu64"\n",
+           FILE_VEC_ATTRS,
+           (aim_time_monotonic() - start) / (double)FILE_VEC_SWEEPS, stats.opens);
+
+    start = aim_time_monotonic();
+    for(n = 0; n < FILE_VEC_SWEEPS; n++) {
+        if(onlp_file_vec_read(vec, results) != FILE_VEC_ATTRS) {
+            printf("file vec: vector read failed\n");
+            goto done;
+        }
+    }
+    onlp_file_stats_get(&stats, 1);
+    printf("file vec: %d attributes, vector read %.2f us/sweep, opens=%"PRIu64" rereads=%"PRIu64"\n",
+           FILE_VEC_ATTRS,
+           (aim_time_monotonic() - start) / (double)FILE_VEC_SWEEPS,
+           stats.opens, stats.rereads);
+
+    for(i = 0; i < FILE_VEC_ATTRS; i++) {
+        if(results[i].status < 0 || results[i].value != i * 100) {
+            printf("file vec: attribute %d read %d\n", i, results[i].value);
+            goto done;
+        }
+    }
+
+    /*
+     * A value changes in place, and an attribute which did not exist
+     * when it was added (e.g. a PSU inserted later) shows up.
+     */
+    file_vec_attr__(root, 0, path, sizeof(path));
+    file_write__(path, "7\n");
+    snprintf(path, sizeof(path), "%s/psu_present", root);
+    if(onlp_file_vec_add(vec, ONLP_FILE_VEC_TYPE_STR, "%s", path) != FILE_VEC_ATTRS ||
+       onlp_file_vec_read(vec, results) != FILE_VEC_ATTRS ||
+       results[0].value != 7 ||
+       results[FILE_VEC_ATTRS].status != ONLP_STATUS_E_MISSING) {
+        printf("file vec: update or missing attribute not seen\n");
+        goto done;
+    }
+    file_write__(path, "yes\n");
+    if(onlp_file_vec_read(vec, results) != FILE_VEC_ATTRS + 1 ||
+       strcmp(results[FILE_VEC_ATTRS].str, "yes")) {
+        printf("file vec: new attribute not read\n");
+        goto done;
+    }
+    rv = 0;
+
+ done:
+    onlp_file_vec_destroy(vec);
+    for(i = 0; i < FILE_VEC_ATTRS; i++) {
+        file_vec_attr__(root, i, path, sizeof(path));
+        unlink(path);
+    }
+    snprintf(path, sizeof(path), "%s/psu_present", root);
+    unlink(path);
+    rmdir(root);
+    return rv;
+}
 
 int aim_main(int argc, char* argv[])
 {
-    printf("onlplib Utest Is Empty\n");
     onlplib_config_show(&aim_pvs_stdout);
+
+#if ONLPLIB_CONFIG_INCLUDE_I2C == 1
+    if(i2c_mux_sweep_benchmark() < 0) {
+        return 1;
+    }
+#if ONLPLIB_CONFIG_I2C_INCLUDE_FD_CACHE == 1
+    if(i2c_fd_cache_test() < 0) {
+        return 1;
+    }
+#endif
+#endif
+#if ONLPLIB_CONFIG_INCLUDE_BMC == 1
+    if(bmc_session_test() < 0) {
+        return 1;
+    }
+#endif
+#if ONLPLIB_CONFIG_INCLUDE_IPMI == 1
+    if(ipmi_test() < 0) {
+        return 1;
+    }
+#endif
+#if ONLPLIB_CONFIG_FILE_INCLUDE_CACHE == 1
+    if(file_cache_test() < 0) {
+        return 1;
+    }
+#endif
+    if(file_vec_test() < 0) {
+        return 1;
+    }
     return 0;
 }
 
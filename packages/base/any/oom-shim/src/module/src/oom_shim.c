@@ -43,6 +43,7 @@ void __oom_shim_module_init__(void) {
 int oom_get_portlist(oom_port_t portlist[], int listsize){
     
     int port,i=0;
+    int rv;
     oom_port_t* pptr;
     
 
@@ -58,27 +59,26 @@ int oom_get_portlist(oom_port_t portlist[], int listsize){
             return AIM_BITMAP_COUNT(&bitmap);
     }
 
+    /* One presence scan for all ports */
+    onlp_sfp_bitmap_t present;
+    onlp_sfp_bitmap_t_init(&present);
+    rv = onlp_sfp_presence_bitmap_get(&present);
+    if(rv < 0){
+        aim_printf(&aim_pvs_stdout, "Error reading presence: %{onlp_status}\n", rv);
+    }
+
     AIM_BITMAP_ITER(&bitmap, port){
-        int rv;
-        
         pptr = &portlist[i];
         pptr->handle = (void *)(uintptr_t)port+1;
         pptr->oom_class = OOM_PORT_CLASS_SFF; 
         sprintf(pptr->name, "port%d", port+1);
         i++;
         
-        rv = onlp_sfp_is_present(port);
-        if(rv == 0){
+        if(rv < 0 || !AIM_BITMAP_GET(&present, port)){
             /* aim_printf(&aim_pvs_stdout, "module %d is not present\n", port);*/
             pptr->oom_class = OOM_PORT_CLASS_UNKNOWN;
             continue;
         }
-
-        if(rv < 0){
-            aim_printf(&aim_pvs_stdout, "%4d  Error %{onlp_status}\n", port, rv);
-            pptr->oom_class = OOM_PORT_CLASS_UNKNOWN;
-            continue;
-        }
     }
     return 0;
 }
@@ -87,36 +87,26 @@ int oom_get_portlist(oom_port_t portlist[], int listsize){
 int oom_get_memory_sff(oom_port_t* port, int address, int page, int offset, int len, uint8_t* data){
     int rv;
     unsigned int port_num; 
-    uint8_t* idprom = NULL;
 
     port_num = (unsigned int)(uintptr_t)port->handle;
     port_num -= 1;
 
-    if (offset >= 256)
+    if (offset < 0 || len < 0 || offset + len > 256)
         return -1;  /* out of range */
 
-    /** 
-     * place holder implementation until onlp_sfp_eeprom_read() 
-     * can be improved to handle partial page gets
-     **/
-
-    if (address == 0xa0) {
-        rv = onlp_sfp_eeprom_read(port_num, &idprom);
-    } else if (address == 0xa2) {
-        rv = onlp_sfp_dom_read(port_num, &idprom);
-    } else {
+    if (address != 0xa0 && address != 0xa2) {
         aim_printf(&aim_pvs_stdout, "Error invalid address: 0x%02x\n", address);
         return -EINVAL;
     }
 
+    /* OOM uses 8-bit addresses (0xa0/0xa2), ONLP uses 7-bit (0x50/0x51) */
+    rv = onlp_sfp_memory_read(port_num, address >> 1, 0, page, offset, len, data);
     if(rv < 0) {
-        aim_printf(&aim_pvs_stdout, "Error reading eeprom: %{onlp_status}\n");
+        aim_printf(&aim_pvs_stdout, "Error reading eeprom: %{onlp_status}\n", rv);
         return -1;
     }
-    memcpy(data, &idprom[offset], len); 
-    aim_free(idprom);
     
-    return 0;
+    return len;
 }
 
 int oom_get_function(oom_port_t* port, oom_functions_t function, int* rv){
@@ -130,8 +120,27 @@ int oom_get_memory_cfp(oom_port_t* port, int address, int len, uint16_t* data){
 }
 
 int oom_set_memory_sff(oom_port_t* port, int address, int page, int offset, int len, uint8_t* data){
-    //not implemented
-    return -1;
+    int rv;
+    unsigned int port_num;
+
+    port_num = (unsigned int)(uintptr_t)port->handle;
+    port_num -= 1;
+
+    if (offset < 0 || len < 0 || offset + len > 256)
+        return -1;  /* out of range */
+
+    if (address != 0xa0 && address != 0xa2) {
+        aim_printf(&aim_pvs_stdout, "Error invalid address: 0x%02x\n", address);
+        return -EINVAL;
+    }
+
+    rv = onlp_sfp_memory_write(port_num, address >> 1, 0, page, offset, len, data);
+    if(rv < 0) {
+        aim_printf(&aim_pvs_stdout, "Error writing eeprom: %{onlp_status}\n", rv);
+        return -1;
+    }
+
+    return len;
 }
 
 int oom_set_function(oom_port_t* port, oom_functions_t function, int value){
@@ -25,6 +25,7 @@
  ***********************************************************/
 #include <onlp/platformi/fani.h>
 #include <onlplib/mmap.h>
+#include <onlplib/file.h>
 #include <fcntl.h>
 #include <limits.h>
 #include "platform_lib.h"
@@ -121,16 +122,82 @@ onlp_fan_info_t linfo[] = {
         }                                       \
     } while(0)
 
-#define OPEN_READ_FILE(fd,fullpath,data,nbytes,len) \
-    DEBUG_PRINT("[Debug][%s][%d][openfile: %s]\n", __FUNCTION__, __LINE__, fullpath); \
-    if ((fd = open(fullpath, O_RDONLY)) == -1)  \
-       return ONLP_STATUS_E_INTERNAL;           \
-    if ((len = read(fd, r_data, nbytes)) <= 0){ \
-        close(fd);                              \
-        return ONLP_STATUS_E_INTERNAL;}         \
-    DEBUG_PRINT("[Debug][%s][%d][read data: %s]\n", __FUNCTION__, __LINE__, r_data); \
-    if (close(fd) == -1)                        \
-        return ONLP_STATUS_E_INTERNAL
+/*
+ * The attributes of each fan are read together in one vector.
+ * Results are in this order.
+ */
+enum fan_attr_e
+{
+    FAN_ATTR_PRESENT,
+    FAN_ATTR_FAULT,
+    FAN_ATTR_DIRECTION,
+    FAN_ATTR_SPEED,
+    FAN_ATTR_R_SPEED,
+    FAN_ATTR_COUNT
+};
+
+enum psu_fan_attr_e
+{
+    PSU_FAN_ATTR_FAULT,
+    PSU_FAN_ATTR_SPEED,
+    PSU_FAN_ATTR_COUNT
+};
+
+/* Built by onlp_fani_init(), read only afterwards. */
+static onlp_file_vec_t* fan_vec__[AIM_ARRAYSIZE(fan_path)];
+
+static int
+_onlp_fani_vec_create(int local_id, onlp_file_vec_t** rv)
+{
+    int i, n;
+    int err = 0;
+    onlp_file_vec_t* vec;
+    fan_path_T* fp = &fan_path[local_id];
+    const char* prefix;
+    const char* attrs[FAN_ATTR_COUNT];
+
+    switch (local_id)
+    {
+        case FAN_1_ON_PSU1:
+        case FAN_1_ON_PSU2:
+            prefix = PREFIX_PATH_ON_PSU;
+            attrs[PSU_FAN_ATTR_FAULT] = fp->status;
+            attrs[PSU_FAN_ATTR_SPEED] = fp->speed;
+            n = PSU_FAN_ATTR_COUNT;
+            break;
+        default:
+            prefix = PREFIX_PATH_ON_MAIN_BOARD;
+            attrs[FAN_ATTR_PRESENT] = fp->present;
+            attrs[FAN_ATTR_FAULT] = fp->status;
+            attrs[FAN_ATTR_DIRECTION] = fp->direction;
+            attrs[FAN_ATTR_SPEED] = fp->speed;
+            attrs[FAN_ATTR_R_SPEED] = fp->r_speed;
+            n = FAN_ATTR_COUNT;
+            break;
+    }
+
+    if (onlp_file_vec_create(&vec) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    for (i = 0; i < n && err == 0; i++) {
+        err = onlp_file_vec_add(vec, ONLP_FILE_VEC_TYPE_INT, "%s%s", prefix, attrs[i]);
+    }
+
+    if (err < 0) {
+        onlp_file_vec_destroy(vec);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    *rv = vec;
+    return ONLP_STATUS_OK;
+}
+
+#define FAN_ATTR_READ(r,attr)                   \
+    do {                                        \
+        if ((r)[attr].status < 0)               \
+            return ONLP_STATUS_E_INTERNAL;      \
+    } while(0)
 
 static uint32_t
 _onlp_fani_info_get_psu_fan_direction(void)
@@ -170,48 +237,44 @@ _onlp_fani_info_get_psu_fan_direction(void)
 static int
 _onlp_fani_info_get_fan(int local_id, onlp_fan_info_t* info)
 {
-    int   fd, len, nbytes = 10;
-    char  r_data[10]   = {0};
-    char  fullpath[PATH_MAX] = {0};
+    onlp_file_vec_result_t r[FAN_ATTR_COUNT];
+
+    if (onlp_file_vec_read(fan_vec__[local_id], r) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
 
     /* check if fan is present
      */
-    sprintf(fullpath, "%s%s", PREFIX_PATH_ON_MAIN_BOARD, fan_path[local_id].present);
-    OPEN_READ_FILE(fd,fullpath,r_data,nbytes,len);
-    if (atoi(r_data) == 0) {
+    FAN_ATTR_READ(r, FAN_ATTR_PRESENT);
+    if (r[FAN_ATTR_PRESENT].value == 0) {
         return ONLP_STATUS_OK;
     }
     info->status |= ONLP_FAN_STATUS_PRESENT;
 
     /* get fan fault status (turn on when any one fails)
      */
-    sprintf(fullpath, "%s%s", PREFIX_PATH_ON_MAIN_BOARD, fan_path[local_id].status);
-    OPEN_READ_FILE(fd,fullpath,r_data,nbytes,len);
-    if (atoi(r_data) > 0) {
+    FAN_ATTR_READ(r, FAN_ATTR_FAULT);
+    if (r[FAN_ATTR_FAULT].value > 0) {
         info->status |= ONLP_FAN_STATUS_FAILED;
         return ONLP_STATUS_OK;
     }
 
     /* get fan/fanr direction (both : the same)
      */
-    sprintf(fullpath, "%s%s", PREFIX_PATH_ON_MAIN_BOARD, fan_path[local_id].direction);
-    OPEN_READ_FILE(fd,fullpath,r_data,nbytes,len);
-
-    if (atoi(r_data) == 0) /*B2F*/
+    FAN_ATTR_READ(r, FAN_ATTR_DIRECTION);
+    if (r[FAN_ATTR_DIRECTION].value == 0) /*B2F*/
         info->status |= ONLP_FAN_STATUS_B2F;
     else
         info->status |= ONLP_FAN_STATUS_F2B;
 
     /* get fan speed (take the min from two speeds)
      */
-    sprintf(fullpath, "%s%s", PREFIX_PATH_ON_MAIN_BOARD, fan_path[local_id].speed);
-    OPEN_READ_FILE(fd,fullpath,r_data,nbytes,len);
-    info->rpm = atoi(r_data);
-
-    sprintf(fullpath, "%s%s", PREFIX_PATH_ON_MAIN_BOARD, fan_path[local_id].r_speed);
-    OPEN_READ_FILE(fd,fullpath,r_data,nbytes,len);
-    if (info->rpm > atoi(r_data)) {
-        info->rpm = atoi(r_data);
+    FAN_ATTR_READ(r, FAN_ATTR_SPEED);
+    info->rpm = r[FAN_ATTR_SPEED].value;
+
+    FAN_ATTR_READ(r, FAN_ATTR_R_SPEED);
+    if (info->rpm > r[FAN_ATTR_R_SPEED].value) {
+        info->rpm = r[FAN_ATTR_R_SPEED].value;
     }
 
     /* get speed percentage from rpm */
@@ -223,25 +286,25 @@ _onlp_fani_info_get_fan(int local_id, onlp_fan_info_t* info)
 static int
 _onlp_fani_info_get_fan_on_psu(int local_id, onlp_fan_info_t* info)
 {
-    int   fd, len, nbytes = 10;
-    char  r_data[10]   = {0};
-    char  fullpath[PATH_MAX] = {0};
+    onlp_file_vec_result_t r[PSU_FAN_ATTR_COUNT];
 
     /* get fan direction
      */
     info->status |= _onlp_fani_info_get_psu_fan_direction();
 
+    if (onlp_file_vec_read(fan_vec__[local_id], r) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
     /* get fan fault status
      */
-    sprintf(fullpath, "%s%s", PREFIX_PATH_ON_PSU, fan_path[local_id].status);
-    OPEN_READ_FILE(fd,fullpath,r_data,nbytes,len);
-    info->status |= (atoi(r_data) > 0) ? ONLP_FAN_STATUS_FAILED : 0;
+    FAN_ATTR_READ(r, PSU_FAN_ATTR_FAULT);
+    info->status |= (r[PSU_FAN_ATTR_FAULT].value > 0) ? ONLP_FAN_STATUS_FAILED : 0;
 
     /* get fan speed
      */
-    sprintf(fullpath, "%s%s", PREFIX_PATH_ON_PSU, fan_path[local_id].speed);
-    OPEN_READ_FILE(fd,fullpath,r_data,nbytes,len);
-    info->rpm = atoi(r_data);
+    FAN_ATTR_READ(r, PSU_FAN_ATTR_SPEED);
+    info->rpm = r[PSU_FAN_ATTR_SPEED].value;
 
     /* get speed percentage from rpm */
     info->percentage = (info->rpm * 100) / MAX_PSU_FAN_SPEED;
@@ -256,6 +319,15 @@ _onlp_fani_info_get_fan_on_psu(int local_id, onlp_fan_info_t* info)
 int
 onlp_fani_init(void)
 {
+    int i;
+
+    for (i = FAN_1_ON_MAIN_BOARD; i <= FAN_1_ON_PSU2; i++) {
+        if (fan_vec__[i] == NULL && _onlp_fani_vec_create(i, &fan_vec__[i]) < 0) {
+            AIM_LOG_ERROR("Unable to create the attribute vector for fan %d", i);
+            return ONLP_STATUS_E_INTERNAL;
+        }
+    }
+
     return ONLP_STATUS_OK;
 }
 
@@ -27,6 +27,7 @@
 
 #include <onlplib/i2c.h>
 #include <onlplib/file.h>
+#include <onlplib/sfp.h>
 #include "platform_lib.h"
 
 #define MUX_START_INDEX 18
@@ -152,6 +153,35 @@ onlp_sfpi_eeprom_read(int port, uint8_t data[256])
     return ONLP_STATUS_OK;
 }
 
+/*
+ * Paged access goes through optoe, which owns the page select
+ * register of the module. Every port is a QSFP bound to optoe1,
+ * which has no 0x51 space.
+ */
+int
+onlp_sfpi_memory_read(int port, uint8_t devaddr, int bank, int page,
+                      int offset, int len, uint8_t* data)
+{
+    char fname[64];
+    if(devaddr != 0x50) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    snprintf(fname, sizeof(fname), PORT_FORMAT, PORT_BUS_INDEX(port), "eeprom");
+    return onlplib_sfp_memory_read_file(fname, devaddr, bank, page, offset, len, data);
+}
+
+int
+onlp_sfpi_memory_write(int port, uint8_t devaddr, int bank, int page,
+                       int offset, int len, uint8_t* data)
+{
+    char fname[64];
+    if(devaddr != 0x50) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    snprintf(fname, sizeof(fname), PORT_FORMAT, PORT_BUS_INDEX(port), "eeprom");
+    return onlplib_sfp_memory_write_file(fname, devaddr, bank, page, offset, len, data);
+}
+
 int
 onlp_sfpi_dev_readb(int port, uint8_t devaddr, uint8_t addr)
 {
@@ -180,6 +210,16 @@ onlp_sfpi_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value)
     return onlp_i2c_writew(bus, devaddr, addr, value, ONLP_I2C_F_FORCE);
 }
 
+int
+onlp_sfpi_port_bus_get(int port, int* bus)
+{
+    if(port < 0 || port >= NUM_OF_SFP_PORT) {
+        return ONLP_STATUS_E_INVALID;
+    }
+    *bus = PORT_BUS_INDEX(port);
+    return ONLP_STATUS_OK;
+}
+
 int
 onlp_sfpi_denit(void)
 {
@@ -69,6 +69,40 @@ static char* cpu_coretemp_files[] =
         NULL,
     };
 
+/* All CPU core sensors are read together */
+static onlp_file_vec_t* cpu_coretemp_vec__ = NULL;
+
+static int
+cpu_coretemp_read__(int* mcelsius)
+{
+    char** s;
+    int i, n;
+    onlp_file_vec_result_t r[AIM_ARRAYSIZE(cpu_coretemp_files)];
+
+    if(cpu_coretemp_vec__ == NULL) {
+        onlp_file_vec_create(&cpu_coretemp_vec__);
+        for(s = cpu_coretemp_files; *s; s++) {
+            onlp_file_vec_add(cpu_coretemp_vec__, ONLP_FILE_VEC_TYPE_INT, "%s", *s);
+        }
+    }
+
+    n = onlp_file_vec_count(cpu_coretemp_vec__);
+    if(onlp_file_vec_read(cpu_coretemp_vec__, r) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    *mcelsius = 0;
+    for(i = 0; i < n; i++) {
+        if(r[i].status < 0) {
+            return r[i].status;
+        }
+        if(*mcelsius < r[i].value) {
+            *mcelsius = r[i].value;
+        }
+    }
+    return ONLP_STATUS_OK;
+}
+
 /* Static values */
 static onlp_thermal_info_t linfo[] = {
 	{ }, /* Not used */
@@ -133,8 +167,7 @@ onlp_thermali_info_get(onlp_oid_t id, onlp_thermal_info_t* info)
     *info = linfo[local_id];
 
     if(local_id == THERMAL_CPU_CORE) {
-        int rv = onlp_file_read_int_max(&info->mcelsius, cpu_coretemp_files);
-        return rv;
+        return cpu_coretemp_read__(&info->mcelsius);
     }
 
     return onlp_file_read_int(&info->mcelsius, devfiles__[local_id]);
@@ -23,210 +23,79 @@
  *
  ***********************************************************/
 #include <termios.h>
-#include <sys/file.h>
-#include <fcntl.h>
 #include <onlplib/file.h>
+#include <onlplib/bmc.h>
 #include <onlp/onlp.h>
 #include "platform_lib.h"
 
 #define TTY_DEVICE                      "/dev/ttyACM0"
 #define TTY_PROMPT                      "@bmc-oob:"
 #define TTY_USER                        "root"
-#define TTY_I2C_WAIT_REPLY              200000
-#define TTY_BMC_LOGIN_TIMEOUT           1000000
-#define TTY_BMC_LOGIN_INTERVAL          50000
-#define TTY_LOGIN_RETRY                 (20)
-#define TTY_RETRY_INTERVAL              100000
-#define TTY_RETRY                       PLATFOTM_H_TTY_RETRY
-
-static bool global_logged_in = false;
-
-static int tty_open(int *fd)
+#define TTY_PASSWORD                    "0penBmc"
+#define TTY_BMC_LOGIN_TIMEOUT_MS        1000
+#define TTY_COMMAND_TIMEOUT_MS          5000
+#define TTY_CACHE_MS                    1000
+
+static onlp_bmc_session_t* bmc_session = NULL;
+
+/*
+ * The console session is opened on first use and kept open,
+ * so the BMC login is only done once per process.
+ */
+static onlp_bmc_session_t* bmc_session_get(void)
 {
-    int ret;
-    int i = 20;
-    struct termios attr;
-
-    if (*fd > -1) {
-        return ONLP_STATUS_OK;
+    onlp_bmc_config_t config = {
+        .device = TTY_DEVICE,
+        .speed = B57600,
+        .prompt = TTY_PROMPT,
+        .user = TTY_USER,
+        .password = TTY_PASSWORD,
+        .login_timeout_ms = TTY_BMC_LOGIN_TIMEOUT_MS,
+        .command_timeout_ms = TTY_COMMAND_TIMEOUT_MS,
+        .cache_ms = TTY_CACHE_MS,
+    };
+
+    if (bmc_session == NULL &&
+            onlp_bmc_session_open(&config, &bmc_session) < 0) {
+        AIM_LOG_ERROR("ERROR: Cannot open TTY device\n");
+        bmc_session = NULL;
     }
-
-    do {
-        if ((*fd = open(TTY_DEVICE, O_RDWR | O_NOCTTY | O_NDELAY)) > -1) {
-            ret = flock(*fd, LOCK_EX | LOCK_NB);
-            if (ret == -1 && errno != EWOULDBLOCK) {
-                AIM_LOG_ERROR("ERROR: Cannot flock TTY device\n");
-                return ONLP_STATUS_E_INTERNAL;
-            } else {
-                tcgetattr(*fd, &attr);
-                attr.c_cflag = B57600 | CS8 | CLOCAL | CREAD;
-                attr.c_iflag = IGNPAR;
-                attr.c_oflag = 0;
-                attr.c_lflag = 0;
-                attr.c_cc[VMIN] = (unsigned char)
-                                  ((MAXIMUM_TTY_STRING_LENGTH > 0xFF) ?  0xFF : MAXIMUM_TTY_STRING_LENGTH);
-                attr.c_cc[VTIME] = 0;
-                cfsetospeed(&attr, B57600);
-                cfsetispeed(&attr, B57600);
-                tcsetattr(*fd, TCSANOW, &attr);
-                return ONLP_STATUS_OK;
-            }
-        }
-        i--;
-    } while (i > 0);
-    return ONLP_STATUS_E_GENERIC;
+    return bmc_session;
 }
 
-static int tty_close(int *fd)
+/* Commands are sent without the line terminator. */
+static void bmc_cmd_strip(const char *cmd, char *buf, int max_size)
 {
-    if (flock(*fd, LOCK_UN) == -1) {
-        AIM_LOG_ERROR("ERROR: Cannot unlock TTY device file\n");
-        return ONLP_STATUS_E_INTERNAL;
-    }
-    close(*fd);
-    *fd = -1;
-    return 0;
-}
-
-static int tty_clear_rxbuf(int fd, char* buf, int max_size) {
-    int ret, i;
+    int len;
 
-    if (!buf || fd < 0) {
-        return ONLP_STATUS_E_PARAM;
+    aim_strlcpy(buf, cmd, max_size);
+    len = strlen(buf);
+    while (len > 0 && (buf[len-1] == '\r' || buf[len-1] == '\n')) {
+        buf[--len] = '\0';
     }
-    do {
-        ret = read(fd, buf, max_size);
-        memset(buf, 0, max_size);
-        i++;
-    } while (ret > 0 && i < TTY_RETRY);
-    return ret;
 }
 
-static int tty_write_and_read( int fd, const char *cmd,
-                               uint32_t udelay, char *buf, int buf_size)
+static int bmc_run(const char *cmd, char *resp, int max_size, int cache)
 {
-    int ret, len, retry;
+    char cmds[128];
+    onlp_bmc_request_t r = { cmds, resp, max_size, cache, 0 };
 
-    if (fd < 0 || !cmd) {
-        return ONLP_STATUS_E_PARAM;
-    }
-    tty_clear_rxbuf(fd, buf, buf_size);
-    len = strlen(cmd) + 1;
-    retry = 0;
-    do {
-        ret = write(fd, cmd, len);
-        retry++ ;
-    } while(ret != len && retry < TTY_RETRY && usleep(TTY_RETRY_INTERVAL*retry));
-
-    DEBUG_PRINT("sent cmd:%s\n",cmd);
-    usleep(udelay);
-    memset(buf, 0, buf_size);
-    ret = read(fd, buf, buf_size);
-    DEBUG_PRINT("Read %d bytes, \"%s\", \n", ret, buf);
-    return ret;
-}
-
-static int tty_access_and_match( int fd, const char *cmd,
-                                 uint32_t udelay, const char *keywd)
-{
-    int num;
-    char resp[256] = {0};
-
-    num = tty_write_and_read(fd, cmd, udelay, resp, sizeof(resp));
-    if (num <= 0) {
+    bmc_cmd_strip(cmd, cmds, sizeof(cmds));
+    if (bmc_request(&r, 1) < 0 || r.status < 0) {
+        DEBUG_PRINT("Unable to send command to bmc(%s)\r\n", cmds);
         return ONLP_STATUS_E_GENERIC;
     }
-    return (strstr(resp, keywd) != NULL) ?
-           ONLP_STATUS_OK : ONLP_STATUS_E_GENERIC;
-}
-
-static bool is_logged_in(int fd, char *resp, int max_size)
-{
-    int num;
-    char *p;
-
-    if (global_logged_in == true) {
-        return true;
-    }
-
-    num = tty_write_and_read(fd, "\r\r", TTY_BMC_LOGIN_TIMEOUT, resp, max_size);
-    if (num <= 0) {
-        return false;
-    }
-    p = strstr(resp, TTY_PROMPT);
-    if (p != NULL ) {
-        global_logged_in = true;
-        return true;
-    } else {
-        return false;
-    }
-}
-
-static int tty_login(int fd, char *buf, int buf_size)
-{
-    int i;
-
-    for (i = 0; i < TTY_LOGIN_RETRY; i++) {
-        if (is_logged_in(fd, buf, buf_size)) {
-            DEBUG_PRINT("Been logged in!\n");
-            return ONLP_STATUS_OK;
-        }
-
-        DEBUG_PRINT("Try to login, @%d!\n", i);
-        if (strstr(buf, "bmc") != NULL &&
-                (strstr(buf, "login:") != NULL))
-        {
-            if (!tty_access_and_match(fd, TTY_USER"\r",TTY_BMC_LOGIN_TIMEOUT, "Password:")) {
-                if (!tty_access_and_match(fd, "0penBmc\r", TTY_BMC_LOGIN_TIMEOUT, TTY_PROMPT)) {
-                    return ONLP_STATUS_OK;
-                }
-
-            }
-        }
-        usleep(TTY_BMC_LOGIN_INTERVAL*i);
-    }
-
-    return ONLP_STATUS_E_GENERIC;
+    return ONLP_STATUS_OK;
 }
 
-static int
-tty_transaction(const char *cmd, uint32_t udelay, char *resp, int max_size)
+int bmc_request(onlp_bmc_request_t *requests, int count)
 {
-    char *buf;
-    int  tty_fd = -1;
-    int  num, ret = ONLP_STATUS_OK;
-    int  buf_size = MAXIMUM_TTY_BUFFER_LENGTH;
-
-    if (!cmd || !resp || !max_size)
-        return ONLP_STATUS_E_PARAM;
-
-    if (tty_open(&tty_fd) != ONLP_STATUS_OK) {
-        AIM_LOG_ERROR("ERROR: Cannot open TTY device\n");
-        return ONLP_STATUS_E_GENERIC;
-    }
+    onlp_bmc_session_t *s = bmc_session_get();
 
-    buf = (char *)calloc(buf_size, sizeof(char));
-    if (buf == NULL)
-    {
-        AIM_LOG_ERROR("ERROR: Cannot allocate memory\n");
-        goto exit;
-    }
-    ret = tty_login(tty_fd, buf, buf_size);
-    if (ret != ONLP_STATUS_OK) {
-        AIM_LOG_ERROR("ERROR: Cannot login TTY device\n");
-        goto exit;
-    }
-    num = tty_write_and_read(tty_fd, cmd, udelay, buf, buf_size);
-    if (num <= 0)
-    {
-        AIM_LOG_ERROR("ERROR: Cannot read/write TTY device\n");
-        goto exit;
+    if (s == NULL) {
+        return ONLP_STATUS_E_INTERNAL;
     }
-    aim_strlcpy(resp, buf, max_size);
-exit:
-    free(buf);
-    tty_close(&tty_fd);
-    return ret;
+    return onlp_bmc_request(s, requests, count);
 }
 
 static int chk_numeric_char(char *data, int base)
@@ -287,100 +156,41 @@ static int chk_numeric_char(char *data, int base)
     return 0;
 }
 
-static int strip_off_prompt(char *buf, int max_size)
-{
-    char *p;
-
-    p = strstr(buf, TTY_USER TTY_PROMPT);
-    if (p != NULL && p < (buf+max_size)) {
-        *p = '\0';
-    }
-    return  ONLP_STATUS_OK;
-}
-
+/*
+ * The reply is delimited by the session, so udelay is no longer needed.
+ */
 int bmc_reply_pure(char *cmd, uint32_t udelay, char *resp, int max_size)
 {
-    int i, ret = 0;
-    char *p;
-    char cmdr[128];
-
-    /*In case, caller forgets put the "enter" at the very end of cmd.*/
-    snprintf(cmdr, sizeof(cmdr), "%s%s", cmd, "\r");
-
-    for (i = 1; i <= TTY_RETRY; i++) {
-        ret = tty_transaction(cmdr, udelay, resp, max_size);
-        if (ret != ONLP_STATUS_OK) {
-            usleep(100000*i);
-            continue;
-        }
-
-        strip_off_prompt(resp, max_size);
-        /*Find if cmd is inside the response.*/
-        p = strstr(resp, cmd);
-        if (p != NULL) {
-            memcpy(resp, p+strlen(cmdr), max_size);
-            return ONLP_STATUS_OK;
-        }
-        DEBUG_PRINT("Resp: [%s]\n", resp);
+    if (bmc_run(cmd, resp, max_size, 0) != ONLP_STATUS_OK) {
+        AIM_LOG_ERROR("Unable to send command to bmc(%s)\r\n", cmd);
+        return ONLP_STATUS_E_GENERIC;
     }
-    AIM_LOG_ERROR("Unable to send command to bmc(%s)\r\n", cmd);
-    return ONLP_STATUS_E_GENERIC;
+    return ONLP_STATUS_OK;
 }
 
 int bmc_reply(char *cmd, char *resp, int max_size)
 {
-    int i, ret = 0;
-
-    for (i = 1; i <= TTY_RETRY; i++) {
-        ret = tty_transaction(cmd, TTY_I2C_WAIT_REPLY, resp, max_size);
-        if (ret != ONLP_STATUS_OK) {
-            continue;
-        }
-        if (strstr(resp, TTY_PROMPT) == NULL) {
-            continue;
-        }
-        return ONLP_STATUS_OK;
-    }
-    DEBUG_PRINT("Unable to send command to bmc(%s)\r\n", cmd);
-    return ONLP_STATUS_E_GENERIC;
+    return bmc_run(cmd, resp, max_size, 0);
 }
 
-int
-bmc_command_read_int(int *value, char *cmd, int base)
+static int
+bmc_command_read_int(int *value, char *cmd, int base, int cache)
 {
-    int len;
-    int i;
     char resp[256];
-    char *prev_str = NULL;
-    char *current_str= NULL;
 
-    if (bmc_reply(cmd, resp, sizeof(resp)) != ONLP_STATUS_OK) {
+    if (bmc_run(cmd, resp, sizeof(resp), cache) != ONLP_STATUS_OK) {
         return ONLP_STATUS_E_INTERNAL;
     }
 
-    len = (int)strlen(cmd);
-    prev_str = strstr(resp, cmd);
-    if (prev_str == NULL) {
-        return -1;
-    }
-    for (i = 1; i <= TTY_RETRY; i++) {
-        current_str = strstr(prev_str + len, cmd);
-        if(current_str == NULL) {
-            if (base == 16) {
-                if (sscanf(prev_str + len, "%x", value)!= 1) {
-                    return -1;
-                }
-            } else {
-                if( !chk_numeric_char(prev_str + len, base) ) {
-                    return -1;
-                }
-                *value = strtoul(prev_str + len, NULL, base);
-            }
-            break;
-        } else {
-            prev_str = current_str;
-            continue;
+    if (base == 16) {
+        if (sscanf(resp, "%x", value) != 1) {
+            return -1;
+        }
+    } else {
+        if( !chk_numeric_char(resp, base) ) {
+            return -1;
         }
+        *value = strtoul(resp, NULL, base);
     }
     return 0;
 }
@@ -390,8 +200,8 @@ int
 bmc_file_read_int(int* value, char *file, int base)
 {
     char cmd[128] = {0};
-    snprintf(cmd, sizeof(cmd), "cat %s\r\n", file);
-    return bmc_command_read_int(value, cmd, base);
+    snprintf(cmd, sizeof(cmd), "cat %s", file);
+    return bmc_command_read_int(value, cmd, base, 1);
 }
 
 int
@@ -400,8 +210,8 @@ bmc_i2c_readb(uint8_t bus, uint8_t devaddr, uint8_t addr)
     int ret = 0, value;
     char cmd[128] = {0};
 
-    snprintf(cmd, sizeof(cmd), "i2cget -f -y %d 0x%x 0x%02x\r\n", bus, devaddr, addr);
-    ret = bmc_command_read_int(&value, cmd, 16);
+    snprintf(cmd, sizeof(cmd), "i2cget -f -y %d 0x%x 0x%02x", bus, devaddr, addr);
+    ret = bmc_command_read_int(&value, cmd, 16, 0);
     return (ret < 0) ? ret : value;
 }
 
@@ -410,7 +220,7 @@ bmc_i2c_writeb(uint8_t bus, uint8_t devaddr, uint8_t addr, uint8_t value)
 {
     char cmd[128] = {0};
     char resp[128];
-    snprintf(cmd, sizeof(cmd), "i2cset -f -y %d 0x%x 0x%02x 0x%x\r\n", bus, devaddr, addr, value);
+    snprintf(cmd, sizeof(cmd), "i2cset -f -y %d 0x%x 0x%02x 0x%x", bus, devaddr, addr, value);
     return bmc_reply(cmd, resp, sizeof(resp));
 }
 
@@ -420,8 +230,8 @@ bmc_i2c_readw(uint8_t bus, uint8_t devaddr, uint8_t addr, uint16_t *data)
     int ret = 0, value;
     char cmd[128] = {0};
 
-    snprintf(cmd, sizeof(cmd), "i2cget -f -y %d 0x%x 0x%02x w\r\n", bus, devaddr, addr);
-    ret = bmc_command_read_int(&value, cmd, 16);
+    snprintf(cmd, sizeof(cmd), "i2cget -f -y %d 0x%x 0x%02x w", bus, devaddr, addr);
+    ret = bmc_command_read_int(&value, cmd, 16, 0);
     *data = value;
     return ret;
 }
@@ -433,7 +243,7 @@ bmc_i2c_readraw(uint8_t bus, uint8_t devaddr, uint8_t addr, char* data, int data
     char cmd[128] = {0};
     char resp[256];
     char *str = NULL;
-    snprintf(cmd, sizeof(cmd), "i2craw -w 0x%x -r 0 %d 0x%02x\r\n", addr, bus, devaddr);
+    snprintf(cmd, sizeof(cmd), "i2craw -w 0x%x -r 0 %d 0x%02x", addr, bus, devaddr);
 
     if (bmc_reply(cmd, resp, sizeof(resp)) < 0) {
         AIM_LOG_ERROR("Unable to send command to bmc(%s)\r\n", cmd);
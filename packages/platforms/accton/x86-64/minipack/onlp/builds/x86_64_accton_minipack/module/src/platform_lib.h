@@ -32,6 +32,7 @@
 #include <onlp/oids.h>
 #include <onlplib/file.h>
 #include <onlplib/shlocks.h>
+#include <onlplib/bmc.h>
 
 #include "x86_64_accton_minipack_log.h"
 
@@ -108,6 +109,7 @@ enum onlp_thermal_id
 #define PLATFOTM_NUM_OF_PIM  (8)
 
 
+int bmc_request(onlp_bmc_request_t *requests, int count);
 int bmc_reply_pure(char *cmd, uint32_t udelay, char *resp, int max_size);
 int bmc_reply(char *cmd, char *resp, int max_size);
 int bmc_file_read_int(int* value, char *file, int base);
@@ -60,7 +60,6 @@ typedef struct {
 
 
 #define PMBUS_PATH_STR "/sys/bus/platform/devices/minipack_psensor/%s%d_input"
-#define TTY_INTERVAL        (300000) /*in useconds*/
 #define PSU_POLL_INTERVAL       (24) /*in seconds*/
 #define SEM_LOCK    do {sem_wait(&global_psui_st->mutex);} while(0)
 #define SEM_UNLOCK  do {sem_post(&global_psui_st->mutex);} while(0)
@@ -133,47 +132,48 @@ onlp_psui_rm_special_char(char* in, char* out, int max)
 static int
 onlp_psui_get_BMC_info(int pid, onlp_psu_info_t* info)
 {
-    char cmd[128] = {0};
-    char resp[128] = {0};
+    char model_cmd[128] = {0};
+    char serial_cmd[128] = {0};
+    char model_resp[128] = {0};
+    char serial_resp[128] = {0};
+    onlp_bmc_request_t req[] = {
+        { model_cmd, model_resp, sizeof(model_resp), 0, 0 },
+        { serial_cmd, serial_resp, sizeof(serial_resp), 0, 0 },
+    };
 
     int i2c_addr[][2] = {{49, 0x59},{48, 0x58},{57, 0x59},{56, 0x58}};
     int model  = 0x9a;
     int serial = 0x9e;
-    int bus, addr, offset;
+    int bus, addr;
     char *bcmd = "i2cdump -y -f %d 0x%x s 0x%x|tail -n +2|cut -c56-";
 
     bus = i2c_addr[pid-1][0];
     addr = i2c_addr[pid-1][1];
 
-    /* PSU is present if its model name can be retrieved.*/
-    offset = model;
-    sprintf(cmd, bcmd, bus, addr, offset);
+    /* Both strings are read in one BMC round trip. */
+    sprintf(model_cmd, bcmd, bus, addr, model);
+    sprintf(serial_cmd, bcmd, bus, addr, serial);
     memset(info->model, 0, sizeof(info->model));
-    if (bmc_reply_pure(cmd, TTY_INTERVAL, resp, sizeof(resp)) < 0) {
-        DEBUG_PRINT("Unable to send command to bmc(%s)\r\n", cmd);
+    memset(info->serial, 0, sizeof(info->serial));
+
+    /* PSU is present if its model name can be retrieved.*/
+    if (bmc_request(req, AIM_ARRAYSIZE(req)) < 0 ||
+            req[0].status < 0 || req[1].status < 0) {
+        DEBUG_PRINT("Unable to send command to bmc(%s)\r\n", model_cmd);
         info->status &= ~ONLP_PSU_STATUS_PRESENT;
         return ONLP_STATUS_OK;
     }
 
     /*i2cdump return "failed" when slave is not present.*/
-    if (strstr(resp, "failed") != NULL) {
+    if (strstr(model_resp, "failed") != NULL) {
         info->status &= ~ONLP_PSU_STATUS_PRESENT;
         return ONLP_STATUS_OK;
     }
 
     info->status |= ONLP_PSU_STATUS_PRESENT;
     info->caps = ONLP_PSU_CAPS_AC;
-    onlp_psui_rm_special_char(resp, info->model, sizeof(info->model)-1);
-
-    offset = serial;
-    sprintf(cmd, bcmd, bus, addr, offset);
-    memset(info->serial, 0, sizeof(info->serial));
-    if (bmc_reply_pure(cmd, TTY_INTERVAL, resp, sizeof(resp)) < 0) {
-        DEBUG_PRINT("Unable to send command to bmc(%s)\r\n", cmd);
-        info->status &= ~ONLP_PSU_STATUS_PRESENT;
-        return ONLP_STATUS_OK;
-    }
-    onlp_psui_rm_special_char(resp, info->serial, sizeof(info->serial)-1);
+    onlp_psui_rm_special_char(model_resp, info->model, sizeof(info->model)-1);
+    onlp_psui_rm_special_char(serial_resp, info->serial, sizeof(info->serial)-1);
     return ONLP_STATUS_OK;
 }
 
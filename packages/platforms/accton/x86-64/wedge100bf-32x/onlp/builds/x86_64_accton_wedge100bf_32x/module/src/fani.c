@@ -67,6 +67,27 @@ onlp_fan_info_t finfo[] = {
     CHASSIS_FAN_INFO(5)
 };
 
+/*
+ * Read the fan tray status and all rotor speeds in one BMC round trip.
+ * The results are cached for a short time, so the reads below and the
+ * calls for the other fans do not touch the console.
+ */
+static void
+fan_prefetch(void)
+{
+    int  i;
+    char path[CHASSIS_FAN_COUNT*2 + 1][64];
+    char *files[CHASSIS_FAN_COUNT*2 + 1];
+
+    sprintf(path[0], "%s""fantray_present", FAN_BOARD_PATH);
+    files[0] = path[0];
+    for (i = 1; i <= CHASSIS_FAN_COUNT*2; i++) {
+        sprintf(path[i], "%s""fan%d_input", FAN_BOARD_PATH, i);
+        files[i] = path[i];
+    }
+    bmc_file_prefetch(files, AIM_ARRAYSIZE(files));
+}
+
 /*
  * This function will be called prior to all of onlp_fani_* functions.
  */
@@ -85,6 +106,7 @@ onlp_fani_info_get(onlp_oid_t id, onlp_fan_info_t* info)
 
     fid = ONLP_OID_ID_GET(id);
     *info = finfo[fid];
+    fan_prefetch();
 
     /* get fan present status
      */
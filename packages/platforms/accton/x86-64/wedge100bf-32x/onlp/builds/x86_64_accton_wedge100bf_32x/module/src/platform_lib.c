@@ -26,187 +26,131 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <onlplib/file.h>
+#include <onlplib/bmc.h>
 #include <onlp/onlp.h>
 #include "platform_lib.h"
 
 #define TTY_DEVICE                      "/dev/ttyACM0"
 #define TTY_PROMPT                      "@bmc:"
-#define TTY_I2C_TIMEOUT                 55000
-#define TTY_BMC_LOGIN_TIMEOUT            1000000
-#define TTY_RETRY                       10
+#define TTY_USER                        "root"
+#define TTY_PASSWORD                    "0penBmc"
+#define TTY_BMC_LOGIN_TIMEOUT_MS        1000
+#define TTY_COMMAND_TIMEOUT_MS          5000
+#define TTY_CACHE_MS                    1000
 #define MAXIMUM_TTY_BUFFER_LENGTH       1024
-#define MAXIMUM_TTY_STRING_LENGTH       (MAXIMUM_TTY_BUFFER_LENGTH - 1)
+#define MAXIMUM_RESP_LENGTH             64
 
-static int  tty_fd = -1;
-static char tty_buf[MAXIMUM_TTY_BUFFER_LENGTH] = {0};
+static onlp_bmc_session_t* bmc_session = NULL;
 
-static int tty_open(void)
+int bmc_tty_init(void)
 {
-    int i = 20;
-    struct termios attr;
-
-    if (tty_fd > -1) {
+    onlp_bmc_config_t config = {
+        .device = TTY_DEVICE,
+        .speed = B57600,
+        .prompt = TTY_PROMPT,
+        .user = TTY_USER,
+        .password = TTY_PASSWORD,
+        .login_timeout_ms = TTY_BMC_LOGIN_TIMEOUT_MS,
+        .command_timeout_ms = TTY_COMMAND_TIMEOUT_MS,
+        .cache_ms = TTY_CACHE_MS,
+    };
+
+    if (bmc_session != NULL) {
         return 0;
     }
 
-    do {
-        if ((tty_fd = open(TTY_DEVICE, O_RDWR | O_NOCTTY | O_NDELAY)) > -1) {
-            tcgetattr(tty_fd, &attr);
-            attr.c_cflag = B57600 | CS8 | CLOCAL | CREAD;
-            attr.c_iflag = IGNPAR;
-            attr.c_oflag = 0;
-            attr.c_lflag = 0;
-            attr.c_cc[VMIN] = (unsigned char)
-                ((MAXIMUM_TTY_STRING_LENGTH > 0xFF) ?  0xFF : MAXIMUM_TTY_STRING_LENGTH);
-            attr.c_cc[VTIME] = 0;
-            cfsetospeed(&attr, B57600);
-            cfsetispeed(&attr, B57600);
-            tcsetattr(tty_fd, TCSANOW, &attr);
-            return 0;
-        }
-
-        i--;
-        usleep(100000);
-    } while (i > 0);
-
-    return -1;
-}
-
-static int tty_close(void)
-{
-    close(tty_fd);
-    tty_fd = -1;
-    return 0;
-}
-
-static int tty_exec_buf(unsigned long udelay, const char *str)
-{
-    if (tty_fd < 0)
+    if (onlp_bmc_session_open(&config, &bmc_session) < 0) {
+        AIM_LOG_ERROR("Unable to init bmc tty\r\n");
+        bmc_session = NULL;
         return -1;
-
-    write(tty_fd, tty_buf, strlen(tty_buf)+1);
-    usleep(udelay);
-    memset(tty_buf, 0, MAXIMUM_TTY_BUFFER_LENGTH);
-    read(tty_fd, tty_buf, MAXIMUM_TTY_BUFFER_LENGTH);
-    return (strstr(tty_buf, str) != NULL) ? 0 : -1;
+    }
+    return 0;
 }
 
-static int tty_login(void)
+int bmc_tty_deinit(void)
 {
-    int i = 10;
-
-    for (i = 1; i <= TTY_RETRY; i++) {
-        snprintf(tty_buf, MAXIMUM_TTY_BUFFER_LENGTH, "\r\r");
-        if (!tty_exec_buf(TTY_BMC_LOGIN_TIMEOUT, TTY_PROMPT)) {
-            return 0;
+        if( bmc_session != NULL ){
+                onlp_bmc_session_close(bmc_session);
+                bmc_session = NULL;
         }
-
-        if (strstr(tty_buf, "bmc login:") != NULL)
-        {
-            snprintf(tty_buf, MAXIMUM_TTY_BUFFER_LENGTH, "root\r");
-            
-            if (!tty_exec_buf(TTY_BMC_LOGIN_TIMEOUT, "Password:")) {
-                snprintf(tty_buf, MAXIMUM_TTY_BUFFER_LENGTH, "0penBmc\r");
-                if (!tty_exec_buf(TTY_BMC_LOGIN_TIMEOUT, TTY_PROMPT)) {
-                    return 0;
-                }
-
-            }
+        else{
+                AIM_LOG_ERROR("ERROR: TTY not open\n");
         }
-        usleep(50000);
-    }
-
-    return -1;
+        return 0;
 }
 
-int bmc_tty_init(void)
+static int bmc_run(char *cmd, char *resp, int max_size, int cache)
 {
-    int i;
-    if (tty_fd >= 0){
-        return 0;
-    }
+    int ret;
 
-    for (i = 1; i <= TTY_RETRY; i++) {
-        if (tty_open() != 0) {
-            AIM_LOG_ERROR("ERROR: Cannot open TTY device\n");
-            continue;
-        }
-        if (tty_login() != 0) {
-            AIM_LOG_ERROR("ERROR: Cannot login TTY device\n");
-            tty_close();
-            continue;
-        }
-
-        return 0;
+    if (bmc_tty_init() != 0) {
+        return -1;
     }
 
-    AIM_LOG_ERROR("Unable to init bmc tty\r\n");
-    return -1;
+    ret = cache ? onlp_bmc_read(bmc_session, cmd, resp, max_size) :
+                  onlp_bmc_command(bmc_session, cmd, resp, max_size);
+    if (ret < 0) {
+        AIM_LOG_ERROR("Unable to send command to bmc(%s)\r\n", cmd);
+        return -1;
+    }
+    return 0;
 }
 
-int bmc_tty_deinit(void)
+int bmc_send_command(char *cmd)
 {
-        if( tty_fd != -1 ){
-                tty_close();
-        }
-        else{
-                AIM_LOG_ERROR("ERROR: TTY not open\n");
-        }
-        return 0;
+    return bmc_run(cmd, NULL, 0, 0);
 }
 
-int bmc_send_command(char *cmd)
+int bmc_file_prefetch(char **files, int count)
 {
-    int i, ret = 0;
-    
-    for (i = 1; i <= TTY_RETRY; i++) {
-        snprintf(tty_buf, MAXIMUM_TTY_BUFFER_LENGTH, "%s", cmd);
-        ret = tty_exec_buf(TTY_I2C_TIMEOUT, TTY_PROMPT);
-        if (ret != 0) {
-//            AIM_LOG_ERROR("ERROR: bmc_send_command(%s) timed out\n", cmd);
-            continue;
-        }
+    int i, ret;
+    onlp_bmc_request_t *req;
+    char (*cmds)[88];
+    char (*resps)[MAXIMUM_RESP_LENGTH];
 
-        return 0;
+    if (bmc_tty_init() != 0) {
+        return -1;
     }
 
-    AIM_LOG_ERROR("Unable to send command to bmc(%s)\r\n", cmd);
-    return -1;
+    req = aim_zmalloc(count * sizeof(*req));
+    cmds = aim_zmalloc(count * sizeof(*cmds));
+    resps = aim_zmalloc(count * sizeof(*resps));
+
+    for (i = 0; i < count; i++) {
+        snprintf(cmds[i], sizeof(cmds[i]), "cat %s", files[i]);
+        req[i].cmd = cmds[i];
+        req[i].resp = resps[i];
+        req[i].size = sizeof(resps[i]);
+        req[i].cache = 1;
+    }
+
+    ret = onlp_bmc_request(bmc_session, req, count);
+
+    aim_free(resps);
+    aim_free(cmds);
+    aim_free(req);
+    return (ret < 0) ? -1 : 0;
 }
 
 int bmc_file_read_str(char *file, char *result, int slen)
 {
-    char *curr = NULL;
     char cmd[88] = {0};
-    char *delimit="^@\r\n";
-    int flag = 0, ret = 0;
+    char resp[MAXIMUM_TTY_BUFFER_LENGTH] = {0};
+    char *delimit = "\r\n";
+    int ret = 0;
 
-    ret = snprintf(cmd, sizeof(cmd), "cat %s\r\n", file);
+    ret = snprintf(cmd, sizeof(cmd), "cat %s", file);
     if( ret >= sizeof(cmd) ){
         AIM_LOG_ERROR("cmd size overwrite (%d,%d)\r\n", ret, sizeof(cmd));
         return ONLP_STATUS_E_INTERNAL;
     }
-    bmc_send_command(cmd);
-
-    strtok(tty_buf, delimit);
-    flag = 0;
-    while( (curr = strtok(NULL, delimit)) != NULL ){
-        switch (*curr) {
-        case '\n':
-        case '\r':
-        case '@':
-        case '^':
-            break;
-        default:
-            flag = 1;
-            break;
-        }
-        if( flag ){
-            break;
-        }
+    if (bmc_run(cmd, resp, sizeof(resp), 1) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
     }
 
-    ret = snprintf(result, slen-1, "%s", curr);
+    /* Only the first line is returned. */
+    resp[strcspn(resp, delimit)] = '\0';
+    ret = snprintf(result, slen-1, "%s", resp);
     if( ret >= (slen-1) ){
         AIM_LOG_ERROR("result size overwrite (%d,%d)\r\n", ret, slen-1);
         return ONLP_STATUS_E_INTERNAL;
@@ -271,34 +215,18 @@ int chk_numeric_char(char *data, int base)
     return 0;
 }
 
-int
-bmc_command_read_int(int* value, char *cmd, int base)
+static int
+bmc_command_read_int(int* value, char *cmd, int base, int cache)
 {
-    int len;
-    int i;
-    char *prev_str = NULL;
-    char *current_str= NULL;
-    if (bmc_send_command(cmd) < 0) {
+    char resp[MAXIMUM_RESP_LENGTH] = {0};
+
+    if (bmc_run(cmd, resp, sizeof(resp), cache) < 0) {
         return ONLP_STATUS_E_INTERNAL;
     }
-    len = (int)strlen(cmd);
-    prev_str = strstr(tty_buf, cmd);
-    if (prev_str == NULL) {
+    if( !chk_numeric_char(resp, base) ){
         return -1;
     }
-    for (i = 1; i <= TTY_RETRY; i++) {
-        current_str = strstr(prev_str + len, cmd);
-        if(current_str == NULL) {
-            if( !chk_numeric_char(prev_str + len, base) ){
-                return -1;
-            }
-            *value = strtoul(prev_str + len, NULL, base);
-            break;
-        }else {
-            prev_str = current_str;
-            continue;
-        }
-    }
+    *value = strtoul(resp, NULL, base);
     return 0;
 }
 
@@ -306,9 +234,9 @@ bmc_command_read_int(int* value, char *cmd, int base)
 int
 bmc_file_read_int(int* value, char *file, int base)
 {
-    char cmd[64] = {0};
-    snprintf(cmd, sizeof(cmd), "cat %s\r\n", file);
-    return bmc_command_read_int(value, cmd, base);
+    char cmd[88] = {0};
+    snprintf(cmd, sizeof(cmd), "cat %s", file);
+    return bmc_command_read_int(value, cmd, base, 1);
 }
 
 int
@@ -317,8 +245,8 @@ bmc_i2c_readb(uint8_t bus, uint8_t devaddr, uint8_t addr)
     int ret = 0, value;
     char cmd[64] = {0};
 
-    snprintf(cmd, sizeof(cmd), "i2cget -f -y %d 0x%x 0x%02x\r\n", bus, devaddr, addr);
-    ret = bmc_command_read_int(&value, cmd, 16);
+    snprintf(cmd, sizeof(cmd), "i2cget -f -y %d 0x%x 0x%02x", bus, devaddr, addr);
+    ret = bmc_command_read_int(&value, cmd, 16, 0);
     return (ret < 0) ? ret : value;
 }
 
@@ -326,7 +254,7 @@ int
 bmc_i2c_writeb(uint8_t bus, uint8_t devaddr, uint8_t addr, uint8_t value)
 {
     char cmd[64] = {0};
-    snprintf(cmd, sizeof(cmd), "i2cset -f -y %d 0x%x 0x%02x 0x%x\r\n", bus, devaddr, addr, value);
+    snprintf(cmd, sizeof(cmd), "i2cset -f -y %d 0x%x 0x%02x 0x%x", bus, devaddr, addr, value);
     return bmc_send_command(cmd);
 }
 
@@ -334,7 +262,7 @@ int
 bmc_i2c_write_quick_mode(uint8_t bus, uint8_t devaddr, uint8_t value)
 {
     char cmd[64] = {0};
-    snprintf(cmd, sizeof(cmd), "i2cset -f -y %d 0x%x 0x%x\r\n", bus, devaddr, value);
+    snprintf(cmd, sizeof(cmd), "i2cset -f -y %d 0x%x 0x%x", bus, devaddr, value);
     return bmc_send_command(cmd);
 }
 
@@ -344,8 +272,8 @@ bmc_i2c_readw(uint8_t bus, uint8_t devaddr, uint8_t addr)
     int ret = 0, value;
     char cmd[64] = {0};
 
-    snprintf(cmd, sizeof(cmd), "i2cget -f -y %d 0x%x 0x%02x w\r\n", bus, devaddr, addr);
-    ret = bmc_command_read_int(&value, cmd, 16);
+    snprintf(cmd, sizeof(cmd), "i2cget -f -y %d 0x%x 0x%02x w", bus, devaddr, addr);
+    ret = bmc_command_read_int(&value, cmd, 16, 0);
     return (ret < 0) ? ret : value;
 }
 
@@ -354,15 +282,15 @@ bmc_i2c_readraw(uint8_t bus, uint8_t devaddr, uint8_t addr, char* data, int data
 {
     int data_len, i = 0;
     char cmd[64] = {0};
+    char resp[MAXIMUM_TTY_BUFFER_LENGTH] = {0};
     char *str = NULL;
-    snprintf(cmd, sizeof(cmd), "i2craw -w 0x%x -r 0 %d 0x%02x\r\n", addr, bus, devaddr);
+    snprintf(cmd, sizeof(cmd), "i2craw -w 0x%x -r 0 %d 0x%02x", addr, bus, devaddr);
 
-    if (bmc_send_command(cmd) < 0) {
-        AIM_LOG_ERROR("Unable to send command to bmc(%s)\r\n", cmd);
+    if (bmc_run(cmd, resp, sizeof(resp), 0) < 0) {
         return ONLP_STATUS_E_INTERNAL;
     }
 
-    str = strstr(tty_buf, "Received:\r\n  ");
+    str = strstr(resp, "Received:\r\n  ");
     if (str == NULL) {
         return -1;
     }
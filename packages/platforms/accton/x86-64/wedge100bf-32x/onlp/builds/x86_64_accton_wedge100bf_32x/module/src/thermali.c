@@ -87,6 +87,35 @@ static onlp_thermal_info_t linfo[] = {
     },
 };
 
+static void
+thermal_path_get(int tid, char *path)
+{
+    if (THERMAL_CPU_CORE == tid) {
+        sprintf(path, THERMAL_CPU_CORE_PATH_FORMAT, directory[tid]);
+    }else {
+        sprintf(path, THERMAL_PATH_FORMAT, directory[tid]);
+    }
+}
+
+/*
+ * Read all sensors in one BMC round trip. The results are cached
+ * for a short time, so the calls for the other sensors do not
+ * touch the console.
+ */
+static void
+thermal_prefetch(void)
+{
+    int  i;
+    char path[CHASSIS_THERMAL_COUNT][64];
+    char *files[CHASSIS_THERMAL_COUNT];
+
+    for (i = 0; i < CHASSIS_THERMAL_COUNT; i++) {
+        thermal_path_get(i+1, path[i]);
+        files[i] = path[i];
+    }
+    bmc_file_prefetch(files, CHASSIS_THERMAL_COUNT);
+}
+
 /*
  * This will be called to intiialize the thermali subsystem.
  */
@@ -119,12 +148,9 @@ onlp_thermali_info_get(onlp_oid_t id, onlp_thermal_info_t* info)
     *info = linfo[tid];
     
     /* get path */
-    if (THERMAL_CPU_CORE == tid) {
-        sprintf(path, THERMAL_CPU_CORE_PATH_FORMAT, directory[tid]);
-    }else {
-        sprintf(path, THERMAL_PATH_FORMAT, directory[tid]);
-    }
-    
+    thermal_path_get(tid, path);
+    thermal_prefetch();
+
     if (bmc_file_read_int(&info->mcelsius, path, 10) < 0) {
         AIM_LOG_ERROR("Unable to read status from file (%s)\r\n", path);
         return ONLP_STATUS_E_INTERNAL;
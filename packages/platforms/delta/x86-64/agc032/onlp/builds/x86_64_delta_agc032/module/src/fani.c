@@ -48,9 +48,9 @@ int onlp_fani_info_get(onlp_oid_t oid, onlp_fan_info_t *info)
     }
     *info = onlp_fan_info[id];
 
-    void *busDrv = (void *)vendor_find_driver_by_name(fan_dev_list[id].bus_drv_name);
+    void *busDrv = fan_dev_list[id].bus_drv;
     fan_dev_driver_t *fan =
-        (fan_dev_driver_t *)vendor_find_driver_by_name(fan_dev_list[id].dev_drv_name);
+        (fan_dev_driver_t *)fan_dev_list[id].dev_drv;
 
     rv = onlp_fani_status_get(oid, &info->status);
     if (rv < 0)
@@ -147,9 +147,9 @@ int onlp_fani_rpm_set(onlp_oid_t oid, int rpm)
     //AIM_LOG_ERROR("Function: %s, instance: %d", __FUNCTION__, ONLP_OID_ID_GET(oid) - 1);
     int id = ONLP_OID_ID_GET(oid) - 1, fail = 0;
 
-    void *busDrv = (void *)vendor_find_driver_by_name(fan_dev_list[id].bus_drv_name);
+    void *busDrv = fan_dev_list[id].bus_drv;
     fan_dev_driver_t *fan =
-        (fan_dev_driver_t *)vendor_find_driver_by_name(fan_dev_list[id].dev_drv_name);
+        (fan_dev_driver_t *)fan_dev_list[id].dev_drv;
 
     vendor_dev_do_oc(fan_o_list[id]);
     if (fan->rpm_set(
@@ -180,9 +180,9 @@ int onlp_fani_percentage_set(onlp_oid_t oid, int p)
     //AIM_LOG_ERROR("Function: %s, instance: %d", __FUNCTION__, ONLP_OID_ID_GET(oid) - 1);
     int id = ONLP_OID_ID_GET(oid) - 1, fail = 0, rpm = 0;
 
-    void *busDrv = (void *)vendor_find_driver_by_name(fan_dev_list[id].bus_drv_name);
+    void *busDrv = fan_dev_list[id].bus_drv;
     fan_dev_driver_t *fan =
-        (fan_dev_driver_t *)vendor_find_driver_by_name(fan_dev_list[id].dev_drv_name);
+        (fan_dev_driver_t *)fan_dev_list[id].dev_drv;
 
     rpm = (fan_dev_data_list[id].fan_max_speed / 100) * p;
 
@@ -119,6 +119,8 @@ typedef struct vendor_dev_s
     int bus;
     uint8_t dev;
     int id;
+    void *bus_drv; /* Resolved from bus_drv_name by vendor_driver_init() */
+    void *dev_drv; /* Resolved from dev_drv_name by vendor_driver_init() */
 } vendor_dev_t;
 
 typedef struct vendor_dev_oc_s
@@ -131,6 +133,7 @@ typedef struct vendor_dev_oc_s
     uint8_t value; /* FOR CPLD & MUX */
     uint8_t mask;  /* FOR CPLD */
     uint8_t match; /* FOR CPLD */
+    void *bus_drv; /* Resolved from bus_drv_name by vendor_driver_init() */
 } vendor_dev_oc_t;
 
 typedef struct vendor_dev_io_pin_s
@@ -143,6 +146,7 @@ typedef struct vendor_dev_io_pin_s
     uint8_t addr;
     uint8_t mask;
     uint8_t match;
+    void *bus_drv; /* Resolved from bus_drv_name by vendor_driver_init() */
 } vendor_dev_io_pin_t;
 
 typedef struct vendor_dev_led_pin_s
@@ -155,6 +159,7 @@ typedef struct vendor_dev_led_pin_s
     uint8_t mask;
     uint8_t match;
     onlp_led_mode_t mode;
+    void *bus_drv; /* Resolved from bus_drv_name by vendor_driver_init() */
 } vendor_dev_led_pin_t;
 
 typedef enum vendor_bmc_device_type_e
@@ -172,12 +177,6 @@ typedef struct vendor_driver_s
     void *dev_driver;
 } vendor_driver_t;
 
-typedef struct vendor_driver_node_s
-{
-    void *node;
-    vendor_driver_t *driver_hdl;
-} vendor_driver_node_t;
-
 typedef struct i2c_bus_driver_s
 {
     int (*get)(int bus, uint8_t dev, uint16_t addr, uint8_t alen, uint16_t *data, uint8_t dlen);
@@ -312,7 +311,12 @@ int vendor_system_call_get(char *cmd, char *data);
 int vendor_system_call_set(char *cmd);
 int vendor_driver_init();
 void *vendor_find_driver_by_name(const char *driver_name);
+
+/* Drivers used on every status and control call, resolved by vendor_driver_init() */
+extern cpld_dev_driver_t *vendor_cpld_drv;
+extern status_get_driver_t *vendor_bmc_stat_drv;
 int vendor_dev_do_oc(vendor_dev_oc_t *dev_oc);
 int vendor_get_status(vendor_dev_io_pin_t *present_info, int *present);
+int vendor_driver_bench(aim_pvs_t *pvs, int iterations);
 
 #endif /* __VENDOR_DRIVER_POOL_H__ */
\ No newline at end of file
@@ -49,9 +49,9 @@ int onlp_psui_info_get(onlp_oid_t oid, onlp_psu_info_t *info)
     }
     *info = onlp_psu_info[id];
 
-    void *busDrv = (void *)vendor_find_driver_by_name(psu_dev_list[id].bus_drv_name);
+    void *busDrv = psu_dev_list[id].bus_drv;
     psu_dev_driver_t *psu =
-        (psu_dev_driver_t *)vendor_find_driver_by_name(psu_dev_list[id].dev_drv_name);
+        (psu_dev_driver_t *)psu_dev_list[id].dev_drv;
 
     rv = onlp_psui_status_get(oid, &info->status);
     if (rv < 0)
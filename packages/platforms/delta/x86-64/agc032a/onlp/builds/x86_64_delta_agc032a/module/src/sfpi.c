@@ -138,9 +138,9 @@ int onlp_sfpi_eeprom_read(int port, uint8_t data[256])
     //AIM_LOG_ERROR("Function: %s, instance: %d", __FUNCTION__, port);
 
     int id = port, fail = 0;
-    void *busDrv = (void *)vendor_find_driver_by_name(sfp_dev_list[id].bus_drv_name);
+    void *busDrv = sfp_dev_list[id].bus_drv;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     vendor_dev_do_oc(sfp_o_list[id]);
     if (sfp->eeprom_load(
@@ -173,9 +173,9 @@ int onlp_sfpi_dev_readb(int port, uint8_t devaddr, uint8_t addr)
     int id = port, fail = 0;
     ;
     uint8_t data = 0;
-    void *busDrv = (void *)vendor_find_driver_by_name(sfp_dev_list[id].bus_drv_name);
+    void *busDrv = sfp_dev_list[id].bus_drv;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     vendor_dev_do_oc(sfp_o_list[id]);
     if (sfp->eeprom_readb(
@@ -204,9 +204,9 @@ int onlp_sfpi_dev_writeb(int port, uint8_t devaddr, uint8_t addr, uint8_t value)
     //AIM_LOG_ERROR("Function: %s, instance: %d", __FUNCTION__, port);
 
     int id = port, fail = 0;
-    void *busDrv = (void *)vendor_find_driver_by_name(sfp_dev_list[id].bus_drv_name);
+    void *busDrv = sfp_dev_list[id].bus_drv;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     vendor_dev_do_oc(sfp_o_list[id]);
     if (sfp->eeprom_writeb(
@@ -241,9 +241,9 @@ int onlp_sfpi_dev_readw(int port, uint8_t devaddr, uint8_t addr)
     int id = port, fail = 0;
     ;
     uint16_t data = 0;
-    void *busDrv = (void *)vendor_find_driver_by_name(sfp_dev_list[id].bus_drv_name);
+    void *busDrv = sfp_dev_list[id].bus_drv;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     vendor_dev_do_oc(sfp_o_list[id]);
     if (sfp->eeprom_readw(
@@ -272,9 +272,9 @@ int onlp_sfpi_dev_writew(int port, uint8_t devaddr, uint8_t addr, uint16_t value
     //AIM_LOG_ERROR("Function: %s, instance: %d", __FUNCTION__, port);
 
     int id = port, fail = 0;
-    void *busDrv = (void *)vendor_find_driver_by_name(sfp_dev_list[id].bus_drv_name);
+    void *busDrv = sfp_dev_list[id].bus_drv;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     vendor_dev_do_oc(sfp_o_list[id]);
     if (sfp->eeprom_writew(
@@ -306,9 +306,9 @@ int onlp_sfpi_dev_read(int port, uint8_t devaddr, uint8_t addr,
     //AIM_LOG_ERROR("Function: %s, instance: %d", __FUNCTION__, port);
 
     int id = port, fail = 0;
-    void *busDrv = (void *)vendor_find_driver_by_name(sfp_dev_list[id].bus_drv_name);
+    void *busDrv = sfp_dev_list[id].bus_drv;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     if (size > 256)
     {
@@ -344,9 +344,9 @@ int onlp_sfpi_dev_write(int port, uint8_t devaddr, uint8_t addr, uint8_t *data,
     //AIM_LOG_ERROR("Function: %s, instance: %d", __FUNCTION__, port);
 
     int id = port, fail = 0;
-    void *busDrv = (void *)vendor_find_driver_by_name(sfp_dev_list[id].bus_drv_name);
+    void *busDrv = sfp_dev_list[id].bus_drv;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     if (size > 256)
     {
@@ -384,9 +384,9 @@ int onlp_sfpi_dom_read(int port, uint8_t data[256])
     //AIM_LOG_ERROR("Function: %s, instance: %d", __FUNCTION__, port);
 
     int id = port, fail = 0;
-    void *busDrv = (void *)vendor_find_driver_by_name(sfp_dev_list[id].bus_drv_name);
+    void *busDrv = sfp_dev_list[id].bus_drv;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     vendor_dev_do_oc(sfp_o_list[id]);
     if (sfp->eeprom_dom_load(
@@ -432,7 +432,7 @@ int onlp_sfpi_control_supported(int port, onlp_sfp_control_t control, int *rv)
 
     int id = port;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     if (sfp->control_is_support(control, (uint8_t *)rv) != ONLP_STATUS_OK)
     {
@@ -454,11 +454,10 @@ int onlp_sfpi_control_set(int port, onlp_sfp_control_t control, int value)
 
     int rv = 0, id = port, cpld_idx = 0, fail = 0;
     uint8_t curr_data = 0;
-    void *busDrv = (void *)vendor_find_driver_by_name(sfp_dev_list[id].bus_drv_name);
-    cpld_dev_driver_t *cpld =
-        (cpld_dev_driver_t *)vendor_find_driver_by_name("CPLD");
+    void *busDrv = sfp_dev_list[id].bus_drv;
+    cpld_dev_driver_t *cpld = vendor_cpld_drv;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     switch (control)
     {
@@ -583,11 +582,10 @@ int onlp_sfpi_control_get(int port, onlp_sfp_control_t control, int *value)
     uint8_t curr_data = 0;
     int *eeprom_data = calloc(1, sizeof(int));
 
-    void *busDrv = (void *)vendor_find_driver_by_name(sfp_dev_list[id].bus_drv_name);
-    cpld_dev_driver_t *cpld =
-        (cpld_dev_driver_t *)vendor_find_driver_by_name("CPLD");
+    void *busDrv = sfp_dev_list[id].bus_drv;
+    cpld_dev_driver_t *cpld = vendor_cpld_drv;
     sfp_dev_driver_t *sfp =
-        (sfp_dev_driver_t *)vendor_find_driver_by_name(sfp_dev_list[id].dev_drv_name);
+        (sfp_dev_driver_t *)sfp_dev_list[id].dev_drv;
 
     switch (control)
     {
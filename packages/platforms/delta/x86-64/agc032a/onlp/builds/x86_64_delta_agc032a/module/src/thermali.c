@@ -73,9 +73,9 @@ int onlp_thermali_info_get(onlp_oid_t oid, onlp_thermal_info_t *info)
     }
     *info = onlp_thermal_info[id];
 
-    void *busDrv = (void *)vendor_find_driver_by_name(thermal_dev_list[id].bus_drv_name);
+    void *busDrv = thermal_dev_list[id].bus_drv;
     thermal_dev_driver_t *thermal =
-        (thermal_dev_driver_t *)vendor_find_driver_by_name(thermal_dev_list[id].dev_drv_name);
+        (thermal_dev_driver_t *)thermal_dev_list[id].dev_drv;
 
     vendor_dev_do_oc(thermal_o_list[id]);
     if (thermal->temp_get(
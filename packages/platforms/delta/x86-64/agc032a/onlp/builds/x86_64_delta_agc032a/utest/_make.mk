@@ -0,0 +1,8 @@
+###############################################################################
+#
+# x86_64_delta_agc032a Unit Test Makefile.
+#
+###############################################################################
+UMODULE := x86_64_delta_agc032a
+UMODULE_SUBDIR := $(dir $(lastword $(MAKEFILE_LIST)))
+include $(BUILDER)/utest.mk
@@ -29,6 +29,8 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <AIM/aim.h>
+#include <AIM/aim_time.h>
+#include <onlplib/ipmi.h>
 #include "vendor_driver_pool.h"
 #include "vendor_i2c_device_list.h"
 
@@ -38,8 +40,6 @@
 #include "CyUSBSerial.h"
 #endif
 
-static int vendor_driver_add(vendor_driver_t *driver);
-
 /*
     Two I2C bus driver here:
         SMBUS: using onlp i2c driver
@@ -144,15 +144,6 @@ static i2c_bus_driver_t smbus_functions = {
     VENDOR_DRV_SMBUS_Write_I2C_Block,
     VENDOR_DRV_SMBUS_Probe};
 
-static int smbus_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "I2C", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &smbus_functions;
-
-    return vendor_driver_add(driver);
-}
 
 /*================ internal function ================*/
 
@@ -775,26 +766,83 @@ int VENDOR_DRV_I2C_SMBUS_Probe(uint8_t bus, uint8_t dev)
     return 0;
 }
 
+/*
+    IPMI NATIVE TRANSPORT START:
+
+    Requests go straight to /dev/ipmi0 and the device stays open.
+    When the device is not available, ipmitool is used instead.
+*/
+static onlp_ipmi_t *ipmi_native_hdl = NULL;
+static int ipmi_native_unavailable = 0;
+
+static onlp_ipmi_t *ipmi_native_get()
+{
+    if (ipmi_native_hdl == NULL && !ipmi_native_unavailable)
+    {
+        if (onlp_ipmi_open(NULL, &ipmi_native_hdl) < 0)
+        {
+            AIM_LOG_INFO("IPMI device is not available, using ipmitool.");
+            ipmi_native_unavailable = 1;
+        }
+    }
+    return ipmi_native_hdl;
+}
+
+/*
+ * Returns the response length, a negative ONLP status on failure, or
+ * ONLP_STATUS_E_UNSUPPORTED if ipmitool must be used.
+ */
+static int ipmi_native_raw(uint8_t netfn, uint8_t cmd, uint8_t *data, int len, uint8_t *resp, int size)
+{
+    onlp_ipmi_t *ipmi = ipmi_native_get();
+
+    if (ipmi == NULL)
+        return ONLP_STATUS_E_UNSUPPORTED;
+
+    return onlp_ipmi_raw(ipmi, netfn, cmd, data, len, resp, size);
+}
+
+/*
+    IPMI NATIVE TRANSPORT END:
+*/
+
 static int ipmb_readb(int bus, uint8_t dev, uint16_t addr, uint8_t alen, uint16_t *data, uint8_t dlen)
 {
     int rv = 0, idx = 0;
     char ipmi_cmd[80], rv_char[256], *delim = " ", *tmp;
     uint16_t rv_data[32] = {0};
+    uint8_t req[4] = {bus, dev, addr, dlen}, resp[32];
 
-    sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x01 %d %d %d %d", bus, dev, addr, dlen);
-    if (vendor_system_call_get(ipmi_cmd, rv_char) != 0)
+    rv = ipmi_native_raw(0x3c, 0x01, req, sizeof(req), resp, sizeof(resp));
+    if (rv >= 0)
+    {
+        for (idx = 0; idx < rv; idx++)
+            rv_data[idx] = resp[idx];
+        rv = 0;
+    }
+    else if (rv != ONLP_STATUS_E_UNSUPPORTED)
     {
-        AIM_LOG_ERROR("IPMITOOL command: \"%s\": Get Data Failed (ret: %d)", ipmi_cmd);
+        AIM_LOG_ERROR("IPMI raw 0x3c 0x01 %d %d %d %d: Get Data Failed", bus, dev, addr, dlen);
         return ONLP_STATUS_E_INTERNAL;
     }
+    else
+    {
+        rv = 0;
+        sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x01 %d %d %d %d", bus, dev, addr, dlen);
+        if (vendor_system_call_get(ipmi_cmd, rv_char) != 0)
+        {
+            AIM_LOG_ERROR("IPMITOOL command: \"%s\": Get Data Failed (ret: %d)", ipmi_cmd);
+            return ONLP_STATUS_E_INTERNAL;
+        }
 
-    tmp = strtok(rv_char, delim);
+        tmp = strtok(rv_char, delim);
 
-    while (tmp != NULL)
-    {
-        rv_data[idx] = strtol(tmp, NULL, 16);
-        tmp = strtok(NULL, delim);
-        idx++;
+        while (tmp != NULL)
+        {
+            rv_data[idx] = strtol(tmp, NULL, 16);
+            tmp = strtok(NULL, delim);
+            idx++;
+        }
     }
 
     switch (dlen)
@@ -820,6 +868,17 @@ static int ipmb_writeb(int bus, uint8_t dev, uint16_t addr, uint8_t alen, uint16
 {
     int rv = 0;
     char ipmi_cmd[80];
+    uint8_t req[5] = {bus, dev, addr, dlen, data};
+
+    rv = ipmi_native_raw(0x3c, 0x02, req, sizeof(req), NULL, 0);
+    if (rv >= 0)
+        return 0;
+    if (rv != ONLP_STATUS_E_UNSUPPORTED)
+    {
+        AIM_LOG_ERROR("IPMI raw 0x3c 0x02 %d %d %d %d %d: Set Data Failed.", bus, dev, addr, dlen, data);
+        return ONLP_STATUS_E_INTERNAL;
+    }
+    rv = 0;
 
     sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x02 %d %d %d %d %d > /dev/null", bus, dev, addr, dlen, data);
     if (vendor_system_call_set(ipmi_cmd) != 0)
@@ -840,7 +899,7 @@ static int ipmb_block_read(int bus, uint8_t dev, uint16_t addr, uint8_t *rdata,
 {
     int rv = 0, idx = 0;
     char ipmi_cmd[80], rv_char[256], *delim = " ", *tmp;
-    uint8_t rv_data[32] = {0};
+    uint8_t rv_data[65] = {0};
 
     if (size > 64)
     {
@@ -848,20 +907,36 @@ static int ipmb_block_read(int bus, uint8_t dev, uint16_t addr, uint8_t *rdata,
         return ONLP_STATUS_E_INTERNAL;
     }
 
-    sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x01 %d %d %d %d", bus, dev, addr, size + 1);
-    if (vendor_system_call_get(ipmi_cmd, rv_char) != 0)
+    uint8_t req[4] = {bus, dev, addr, size + 1};
+
+    rv = ipmi_native_raw(0x3c, 0x01, req, sizeof(req), rv_data, sizeof(rv_data));
+    if (rv >= 0)
+    {
+        rv = 0;
+    }
+    else if (rv != ONLP_STATUS_E_UNSUPPORTED)
     {
-        AIM_LOG_ERROR("IPMITOOL command: \"%s\": Block read Failed.", ipmi_cmd);
+        AIM_LOG_ERROR("IPMI raw 0x3c 0x01 %d %d %d %d: Block read Failed.", bus, dev, addr, size + 1);
         return ONLP_STATUS_E_INTERNAL;
     }
+    else
+    {
+        rv = 0;
+        sprintf(ipmi_cmd, "ipmitool raw 0x3c 0x01 %d %d %d %d", bus, dev, addr, size + 1);
+        if (vendor_system_call_get(ipmi_cmd, rv_char) != 0)
+        {
+            AIM_LOG_ERROR("IPMITOOL command: \"%s\": Block read Failed.", ipmi_cmd);
+            return ONLP_STATUS_E_INTERNAL;
+        }
 
-    tmp = strtok(rv_char, delim);
+        tmp = strtok(rv_char, delim);
 
-    while (tmp != NULL)
-    {
-        rv_data[idx] = strtol(tmp, NULL, 16);
-        tmp = strtok(NULL, delim);
-        idx++;
+        while (tmp != NULL)
+        {
+            rv_data[idx] = strtol(tmp, NULL, 16);
+            tmp = strtok(NULL, delim);
+            idx++;
+        }
     }
 
     for (idx = 0; idx < size; idx++)
@@ -877,15 +952,6 @@ static i2c_bus_driver_t ipmb_functions = {
     ipmb_writeb,
     ipmb_block_read};
 
-static int ipmb_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "IPMB", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &ipmb_functions;
-
-    return vendor_driver_add(driver);
-}
 
 #ifdef CYPRESS
 // CYPRESS I2C DRIVER START
@@ -1191,15 +1257,6 @@ static i2c_bus_driver_t cypress_i2c_functions = {
     cypress_i2c_get_by_block_read,
     cypress_i2c_set_by_block_write};
 
-static int cypress_i2c_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "CYPRESSI2C", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &cypress_i2c_functions;
-
-    return vendor_driver_add(driver);
-}
 // CYPRESS I2C DRIVER END
 #endif
 
@@ -1219,9 +1276,26 @@ static int ipmi_get(int bus, char *cmd, char *filter, char *data, uint32_t dlen)
     {
     }
 
+    char native[1024];
+    int rv;
+
     if (!cmd || !filter)
         return 0;
 
+    if ((rv = onlp_ipmi_tool_exec(ipmi_native_get(), cmd, native, sizeof(native))) == 0)
+        rv = onlp_ipmi_tool_filter(native, filter, rv_char, sizeof(rv_char));
+    if (rv == 0)
+    {
+        snprintf(data, dlen, "%s", rv_char);
+        return 0;
+    }
+    if (rv != ONLP_STATUS_E_UNSUPPORTED)
+    {
+        /* ipmitool prints nothing when the command fails. */
+        data[0] = '\0';
+        return 0;
+    }
+
     sprintf(sys_cmd, "ipmitool %s %s", cmd, filter);
     if (vendor_system_call_get(sys_cmd, rv_char) != 0)
         return 0;
@@ -1240,9 +1314,15 @@ static int ipmi_set(int bus, char *cmd, char *filter)
     {
     }
 
+    char native[1024];
+    int rv;
+
     if (!cmd || !filter)
         return 0;
 
+    if ((rv = onlp_ipmi_tool_exec(ipmi_native_get(), cmd, native, sizeof(native))) != ONLP_STATUS_E_UNSUPPORTED)
+        return (rv == 0) ? 0 : -1;
+
     sprintf(sys_cmd, "ipmitool %s %s > /dev/null", cmd, filter);
 
     return vendor_system_call_set(sys_cmd);
@@ -1252,15 +1332,6 @@ ipmi_bus_driver_t ipmi_functions = {
     ipmi_get,
     ipmi_set};
 
-static int ipmi_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "IPMI", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &ipmi_functions;
-
-    return vendor_driver_add(driver);
-}
 
 /*
     IPMI BUS DRIVER END:
@@ -1301,15 +1372,6 @@ static cpld_dev_driver_t cpld_functions = {
     cpld_read,
     cpld_write};
 
-static int cpld_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "CPLD", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &cpld_functions;
-
-    return vendor_driver_add(driver);
-}
 
 /* CPLD DEVICE END*/
 
@@ -1423,15 +1485,6 @@ static eeprom_dev_driver_t eeprom_functions = {
     eeprom_load,
 };
 
-static int eeprom_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "EEPROM", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &eeprom_functions;
-
-    return vendor_driver_add(driver);
-}
 /* EEPROM DEVICE END*/
 
 /* FAN DEVICE EMC2305 START*/
@@ -1508,15 +1561,6 @@ static fan_dev_driver_t emc2305_functions = {
     emc2305_rpm_get,
     emc2305_rpm_set};
 
-static int emc2305_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "EMC2305", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &emc2305_functions;
-
-    return vendor_driver_add(driver);
-}
 /* FAN DEVICE EMC2305 END*/
 
 /* FAN DEVICE PFM0812 START*/
@@ -1592,15 +1636,6 @@ static fan_dev_driver_t pfm0812_functions = {
     pfm0812_rpm_get,
     pfm0812_rpm_set};
 
-static int pfm0812_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "PFM0812", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &pfm0812_functions;
-
-    return vendor_driver_add(driver);
-}
 
 /* FAN DEVICE PFM0812 END*/
 
@@ -1694,15 +1729,6 @@ static thermal_dev_driver_t tmp75_functions = {
     tmp75_limit_get,
     tmp75_limit_set};
 
-static int tmp75_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "TMP75", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &tmp75_functions;
-
-    return vendor_driver_add(driver);
-}
 /*THERMAL DEVICE TMP75 END*/
 
 /*THERMAL DEVICE TMP461 START*/
@@ -1824,15 +1850,6 @@ static thermal_dev_driver_t tmp461_functions = {
     tmp461_limit_get,
     tmp461_limit_set};
 
-static int tmp461_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "TMP461", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &tmp461_functions;
-
-    return vendor_driver_add(driver);
-}
 /*THERMAL DEVICE TMP461 END*/
 
 /*THERMAL DEVICE LM75 START*/
@@ -1933,15 +1950,6 @@ static thermal_dev_driver_t lm75_functions = {
     lm75_limit_get,
     lm75_limit_set};
 
-static int lm75_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "LM75", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &lm75_functions;
-
-    return vendor_driver_add(driver);
-}
 /*THERMAL DEVICE LM75 END*/
 
 /*THERMAL DEVICE ADM1032 START*/
@@ -2101,15 +2109,6 @@ static thermal_dev_driver_t adm1032_functions = {
     adm1032_limit_get,
     adm1032_limit_set};
 
-static int adm1032_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "ADM1032", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &adm1032_functions;
-
-    return vendor_driver_add(driver);
-}
 /*THERMAL DEVICE ADM1032 START*/
 
 /*PSU DEVICE PMBUS START*/
@@ -2536,25 +2535,7 @@ static fan_dev_driver_t pmbus_fan_functions = {
     pmbus_fan_rpm_set,
 };
 
-static int pmbus_psu_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "PMBUS_PSU", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &pmbus_psu_functions;
-
-    return vendor_driver_add(driver);
-}
 
-static int pmbus_fan_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "PMBUS_FAN", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &pmbus_fan_functions;
-
-    return vendor_driver_add(driver);
-}
 
 /*PSU DEVICE PMBUS END*/
 
@@ -3141,21 +3122,6 @@ static sfp_dev_driver_t sff8636_functions =
         sff8636_control_get,
         sff8636_control_set};
 
-static int sff8636_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "SFF8636", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &sff8636_functions;
-    vendor_driver_add(driver);
-
-    driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-    strncpy(driver->name, "SFF8436", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &sff8636_functions;
-    vendor_driver_add(driver);
-
-    return 0;
-}
 /*SFP DEVICE SFF8636 END*/
 
 /*SFP DEVICE SFF8472 START*/
@@ -3630,16 +3596,6 @@ static sfp_dev_driver_t sff8472_functions =
         sff8472_control_get,
         sff8472_control_set};
 
-static int sff8472_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "SFF8472", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &sff8472_functions;
-    vendor_driver_add(driver);
-
-    return 0;
-}
 /*SFP DEVICE SFF8472 END*/
 
 /*BMC DEVICE START*/
@@ -4254,55 +4210,10 @@ static thermal_dev_driver_t bmc_thrml_functions = {
 static status_get_driver_t bmc_stat_functions = {
     bmc_present_get};
 
-int bmc_psu_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "BMC_PSU", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &bmc_psu_functions;
-
-    return vendor_driver_add(driver);
-}
-
-int bmc_fan_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "BMC_FAN", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &bmc_fan_functions;
-
-    return vendor_driver_add(driver);
-}
 
-int bmc_psu_fan_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
 
-    strncpy(driver->name, "BMC_PSU_FAN", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &bmc_fan_psu_functions;
 
-    return vendor_driver_add(driver);
-}
 
-int bmc_thrml_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "BMC_TMP", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &bmc_thrml_functions;
-
-    return vendor_driver_add(driver);
-}
-
-int bmc_present_get_driver_init()
-{
-    vendor_driver_t *driver = (vendor_driver_t *)calloc(1, sizeof(vendor_driver_t));
-
-    strncpy(driver->name, "BMC_STAT", VENDOR_MAX_NAME_SIZE);
-    driver->dev_driver = &bmc_stat_functions;
-
-    return vendor_driver_add(driver);
-}
 /*BMC DEVICE END*/
 
 /*
@@ -4329,7 +4240,7 @@ int vendor_dev_do_oc(vendor_dev_oc_t *dev_oc)
 
     while (dev_oc->type != 0)
     {
-        i2c = (i2c_bus_driver_t *)vendor_find_driver_by_name(dev_oc->bus_drv_name);
+        i2c = (i2c_bus_driver_t *)dev_oc->bus_drv;
 
         if (dev_oc->type == 1)
         {
@@ -4392,8 +4303,8 @@ int vendor_get_status(vendor_dev_io_pin_t *io_pin, int *active)
             return 0;
         }
 
-        busDrv = (void *)vendor_find_driver_by_name(io_pin->bus_drv_name);
-        pg = (status_get_driver_t *)vendor_find_driver_by_name("CPLD");
+        busDrv = io_pin->bus_drv;
+        pg = (status_get_driver_t *)vendor_cpld_drv;
 
         cpld_idx = vendor_find_cpld_idx_by_name(io_pin->name);
         if (cpld_idx < 0)
@@ -4403,8 +4314,8 @@ int vendor_get_status(vendor_dev_io_pin_t *io_pin, int *active)
     }
     else if (io_pin->type == BMC_DEV)
     {
-        busDrv = (void *)vendor_find_driver_by_name(io_pin->bus_drv_name);
-        pg = (status_get_driver_t *)vendor_find_driver_by_name("BMC_STAT");
+        busDrv = io_pin->bus_drv;
+        pg = vendor_bmc_stat_drv;
     }
     else
     {
@@ -4475,81 +4386,305 @@ void vendor_remove_unbind_eeprom()
     }
 }
 
-static vendor_driver_node_t *driver_list_head, *driver_list_curr;
+/*
+    All drivers, by the names used in vendor_i2c_device_list.c.
+*/
+static vendor_driver_t vendor_drivers[] =
+{
+    {"I2C", &smbus_functions},
+    {"IPMI", &ipmi_functions},
+    {"CPLD", &cpld_functions},
+    {"EEPROM", &eeprom_functions},
+    {"EMC2305", &emc2305_functions},
+    {"PFM0812", &pfm0812_functions},
+    {"TMP75", &tmp75_functions},
+    {"TMP461", &tmp461_functions},
+    {"LM75", &lm75_functions},
+    {"ADM1032", &adm1032_functions},
+    {"PMBUS_PSU", &pmbus_psu_functions},
+    {"PMBUS_FAN", &pmbus_fan_functions},
+    {"SFF8636", &sff8636_functions},
+    {"SFF8436", &sff8636_functions},
+    {"SFF8472", &sff8472_functions},
+    {"IPMB", &ipmb_functions},
+    {"BMC_PSU", &bmc_psu_functions},
+    {"BMC_FAN", &bmc_fan_functions},
+    {"BMC_PSU_FAN", &bmc_fan_psu_functions},
+    {"BMC_TMP", &bmc_thrml_functions},
+    {"BMC_STAT", &bmc_stat_functions},
+#ifdef CYPRESS
+    {"CYPRESSI2C", &cypress_i2c_functions},
+#endif
+};
+
+#define VENDOR_DRIVER_COUNT (sizeof(vendor_drivers) / sizeof(vendor_drivers[0]))
+
+/* Open addressing index into vendor_drivers, 0 marks an empty slot.
+   Keep it at least twice the number of drivers. */
+#define VENDOR_DRIVER_HASH_SIZE 64
+static uint8_t vendor_driver_hash[VENDOR_DRIVER_HASH_SIZE];
+static int vendor_driver_hash_ready;
 
-static int vendor_driver_add(vendor_driver_t *driver)
+static uint32_t vendor_driver_name_hash(const char *name)
 {
-    vendor_driver_node_t *newnode =
-        (vendor_driver_node_t *)calloc(1, sizeof(vendor_driver_node_t));
+    uint32_t h = 2166136261u;
+    int i;
+
+    for (i = 0; i < VENDOR_MAX_NAME_SIZE && name[i]; i++)
+    {
+        h ^= (uint8_t)name[i];
+        h *= 16777619u;
+    }
 
-    newnode->driver_hdl = driver;
+    return h;
+}
+
+static void vendor_driver_hash_build()
+{
+    uint32_t h;
+    int i;
 
-    if (!driver_list_head)
+    memset(vendor_driver_hash, 0, sizeof(vendor_driver_hash));
+    for (i = 0; i < (int)VENDOR_DRIVER_COUNT; i++)
     {
-        driver_list_head = driver_list_curr = newnode;
+        h = vendor_driver_name_hash(vendor_drivers[i].name);
+        while (vendor_driver_hash[h & (VENDOR_DRIVER_HASH_SIZE - 1)])
+            h++;
+        vendor_driver_hash[h & (VENDOR_DRIVER_HASH_SIZE - 1)] = i + 1;
     }
-    else
+
+    vendor_driver_hash_ready = 1;
+}
+
+static void *vendor_driver_lookup(const char *driver_name)
+{
+    uint32_t h;
+    uint8_t slot;
+
+    if (driver_name == NULL)
+        return NULL;
+
+    if (!vendor_driver_hash_ready)
+        vendor_driver_hash_build();
+
+    h = vendor_driver_name_hash(driver_name);
+    while ((slot = vendor_driver_hash[h & (VENDOR_DRIVER_HASH_SIZE - 1)]) != 0)
     {
-        driver_list_curr->node = newnode;
-        driver_list_curr = newnode;
+        if (strncmp(vendor_drivers[slot - 1].name, driver_name, VENDOR_MAX_NAME_SIZE) == 0)
+            return vendor_drivers[slot - 1].dev_driver;
+        h++;
     }
 
-    return 0;
+    return NULL;
 }
 
 void *vendor_find_driver_by_name(const char *driver_name)
 {
-    vendor_driver_node_t *driver_node = driver_list_head;
+    void *driver = vendor_driver_lookup(driver_name);
+
+    if (driver == NULL)
+        AIM_LOG_ERROR("Function: %s, Cannot find driver %s.", __FUNCTION__, driver_name);
+
+    return driver;
+}
 
-    while (driver_node)
+/*
+    Resolve the driver names in the device lists once, so the
+    per-call paths can use the bus_drv and dev_drv pointers directly.
+    Unused entries are named "NULL" and are left unresolved.
+*/
+static void *vendor_driver_resolve(const char *driver_name)
+{
+    if (driver_name == NULL || strcmp(driver_name, "NULL") == 0)
+        return NULL;
+
+    return vendor_find_driver_by_name(driver_name);
+}
+
+static void vendor_dev_list_resolve(vendor_dev_t *list, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
     {
-        if (strncmp(
-                ((vendor_driver_t *)((vendor_driver_node_t *)driver_node->driver_hdl))->name,
-                driver_name,
-                VENDOR_MAX_NAME_SIZE) == 0)
-        {
-            return (void *)(driver_node->driver_hdl->dev_driver);
-        }
-        driver_node = driver_node->node;
+        list[i].bus_drv = vendor_driver_resolve(list[i].bus_drv_name);
+        list[i].dev_drv = vendor_driver_resolve(list[i].dev_drv_name);
     }
+}
 
-    AIM_LOG_ERROR("Function: %s, Cannot find driver %s.", __FUNCTION__, driver_name);
+static void vendor_dev_oc_list_resolve(vendor_dev_oc_t **list, int size)
+{
+    vendor_dev_oc_t *dev_oc;
+    int i;
 
-    return NULL;
+    for (i = 0; i < size; i++)
+    {
+        for (dev_oc = list[i]; dev_oc && dev_oc->type != 0; dev_oc++)
+            dev_oc->bus_drv = vendor_driver_resolve(dev_oc->bus_drv_name);
+    }
+}
+
+static void vendor_dev_io_pin_list_resolve(vendor_dev_io_pin_t *list, int size)
+{
+    int i;
+
+    for (i = 0; i < size; i++)
+    {
+        if (list[i].type != 0)
+            list[i].bus_drv = vendor_driver_resolve(list[i].bus_drv_name);
+    }
+}
+
+static void vendor_dev_led_pin_list_resolve(vendor_dev_led_pin_t **list, int size)
+{
+    vendor_dev_led_pin_t *led_pin;
+    int i;
+
+    for (i = 0; i < size; i++)
+    {
+        for (led_pin = list[i]; led_pin && (int)led_pin->mode != -1; led_pin++)
+            led_pin->bus_drv = vendor_driver_resolve(led_pin->bus_drv_name);
+    }
+}
+
+cpld_dev_driver_t *vendor_cpld_drv = NULL;
+status_get_driver_t *vendor_bmc_stat_drv = NULL;
+
+static void vendor_dev_resolve()
+{
+    vendor_cpld_drv = (cpld_dev_driver_t *)vendor_find_driver_by_name("CPLD");
+    vendor_bmc_stat_drv = (status_get_driver_t *)vendor_find_driver_by_name("BMC_STAT");
+
+    vendor_dev_list_resolve(cpld_dev_list, cpld_list_size);
+    vendor_dev_list_resolve(eeprom_dev_list, eeprom_list_size);
+    vendor_dev_list_resolve(thermal_dev_list, thermal_list_size);
+    vendor_dev_list_resolve(fan_dev_list, fan_list_size);
+    vendor_dev_list_resolve(led_dev_list, led_list_size);
+    vendor_dev_list_resolve(psu_dev_list, psu_list_size);
+    vendor_dev_list_resolve(sfp_dev_list, sfp_list_size);
+
+    vendor_dev_oc_list_resolve(cpld_o_list, cpld_list_size);
+    vendor_dev_oc_list_resolve(cpld_c_list, cpld_list_size);
+    vendor_dev_oc_list_resolve(eeprom_o_list, eeprom_list_size);
+    vendor_dev_oc_list_resolve(eeprom_c_list, eeprom_list_size);
+    vendor_dev_oc_list_resolve(thermal_o_list, thermal_list_size);
+    vendor_dev_oc_list_resolve(thermal_c_list, thermal_list_size);
+    vendor_dev_oc_list_resolve(fan_o_list, fan_list_size);
+    vendor_dev_oc_list_resolve(fan_c_list, fan_list_size);
+    vendor_dev_oc_list_resolve(psu_o_list, psu_list_size);
+    vendor_dev_oc_list_resolve(psu_c_list, psu_list_size);
+    vendor_dev_oc_list_resolve(sfp_o_list, sfp_list_size);
+    vendor_dev_oc_list_resolve(sfp_c_list, sfp_list_size);
+
+    vendor_dev_io_pin_list_resolve(cpld_version_list, cpld_list_size);
+    vendor_dev_io_pin_list_resolve(fan_present_list, fan_list_size);
+    vendor_dev_io_pin_list_resolve(psu_present_list, psu_list_size);
+    vendor_dev_io_pin_list_resolve(psu_power_good_list, psu_list_size);
+    vendor_dev_io_pin_list_resolve(sfp_present_list, sfp_list_size);
+    vendor_dev_io_pin_list_resolve(sfp_lpmode_list, sfp_list_size);
+    vendor_dev_io_pin_list_resolve(sfp_reset_list, sfp_list_size);
+
+    vendor_dev_led_pin_list_resolve(led_color_list, led_list_size);
 }
 
 int vendor_driver_init()
 {
-    smbus_driver_init();
-    ipmi_driver_init();
-    cpld_driver_init();
-    eeprom_driver_init();
-    emc2305_driver_init();
-    pfm0812_driver_init();
-    tmp75_driver_init();
-    tmp461_driver_init();
-    lm75_driver_init();
-    adm1032_driver_init();
-    pmbus_psu_driver_init();
-    pmbus_fan_driver_init();
-    sff8636_driver_init();
-    sff8472_driver_init();
-    ipmb_driver_init();
-    bmc_psu_driver_init();
-    bmc_fan_driver_init();
-    bmc_psu_fan_driver_init();
-    bmc_thrml_driver_init();
-    bmc_present_get_driver_init();
+    vendor_driver_hash_build();
+    vendor_dev_resolve();
 
     vendor_remove_unbind_eeprom();
 
 #ifdef CYPRESS
-    cypress_i2c_driver_init();
     CyLibraryInit();
 #endif
 
     return 0;
 }
+
+/*
+    The lookup vendor_find_driver_by_name() used before the hash index:
+    a strncmp() walk over every registered driver. Kept as the baseline
+    for vendor_driver_bench().
+*/
+static void *vendor_driver_scan(const char *driver_name)
+{
+    int i;
+
+    for (i = 0; i < (int)VENDOR_DRIVER_COUNT; i++)
+    {
+        if (strncmp(vendor_drivers[i].name, driver_name, VENDOR_MAX_NAME_SIZE) == 0)
+            return vendor_drivers[i].dev_driver;
+    }
+
+    return NULL;
+}
+
+/*
+    Time the driver lookups of one sweep over all SFP ports (bus, device,
+    CPLD and BMC status drivers): by linear scan, by hashed name and
+    through the resolved pointers. No device is accessed.
+*/
+int vendor_driver_bench(aim_pvs_t *pvs, int iterations)
+{
+    void *volatile sink;
+    uint64_t start, scanned, hashed, resolved;
+    int i, port;
+
+    if (iterations <= 0 || sfp_list_size <= 0)
+        return ONLP_STATUS_E_PARAM;
+
+    vendor_driver_hash_build();
+    vendor_dev_resolve();
+
+    start = aim_time_monotonic();
+    for (i = 0; i < iterations; i++)
+    {
+        for (port = 0; port < sfp_list_size; port++)
+        {
+            sink = vendor_driver_scan(sfp_dev_list[port].bus_drv_name);
+            sink = vendor_driver_scan(sfp_dev_list[port].dev_drv_name);
+            sink = vendor_driver_scan("CPLD");
+            sink = vendor_driver_scan("BMC_STAT");
+        }
+    }
+    scanned = aim_time_monotonic() - start;
+
+    start = aim_time_monotonic();
+    for (i = 0; i < iterations; i++)
+    {
+        for (port = 0; port < sfp_list_size; port++)
+        {
+            sink = vendor_driver_lookup(sfp_dev_list[port].bus_drv_name);
+            sink = vendor_driver_lookup(sfp_dev_list[port].dev_drv_name);
+            sink = vendor_driver_lookup("CPLD");
+            sink = vendor_driver_lookup("BMC_STAT");
+        }
+    }
+    hashed = aim_time_monotonic() - start;
+
+    start = aim_time_monotonic();
+    for (i = 0; i < iterations; i++)
+    {
+        for (port = 0; port < sfp_list_size; port++)
+        {
+            sink = sfp_dev_list[port].bus_drv;
+            sink = sfp_dev_list[port].dev_drv;
+            sink = vendor_cpld_drv;
+            sink = vendor_bmc_stat_drv;
+        }
+    }
+    resolved = aim_time_monotonic() - start;
+    (void)sink;
+
+    aim_printf(pvs, "%d ports, %d sweeps\n", sfp_list_size, iterations);
+    aim_printf(pvs, "scanned:  %llu ns/sweep\n",
+               (unsigned long long)(scanned * 1000 / iterations));
+    aim_printf(pvs, "hashed:   %llu ns/sweep\n",
+               (unsigned long long)(hashed * 1000 / iterations));
+    aim_printf(pvs, "resolved: %llu ns/sweep\n",
+               (unsigned long long)(resolved * 1000 / iterations));
+    return ONLP_STATUS_OK;
+}
 /*
     VENDOR DRIVER FUNCTION END
 */
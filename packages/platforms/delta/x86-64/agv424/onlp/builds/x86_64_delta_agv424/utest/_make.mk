@@ -0,0 +1,8 @@
+###############################################################################
+#
+# x86_64_delta_agv424 Unit Test Makefile.
+#
+###############################################################################
+UMODULE := x86_64_delta_agv424
+UMODULE_SUBDIR := $(dir $(lastword $(MAKEFILE_LIST)))
+include $(BUILDER)/utest.mk
@@ -47,9 +47,9 @@ int onlp_ledi_info_get(onlp_oid_t oid, onlp_led_info_t *info)
     }
     *info = onlp_led_info[id];
 
-    void *busDrv = (void *)vendor_find_driver_by_name(led_color_list[id]->bus_drv_name);
+    void *busDrv = led_color_list[id]->bus_drv;
     cpld_dev_driver_t *cpld =
-        (cpld_dev_driver_t *)vendor_find_driver_by_name(led_dev_list[id].dev_drv_name);
+        (cpld_dev_driver_t *)led_dev_list[id].dev_drv;
 
     cpld_idx = vendor_find_cpld_idx_by_name(led_color_list[id]->name);
     if (cpld_idx < 0)
@@ -135,9 +135,9 @@ int onlp_ledi_mode_set(onlp_oid_t oid, onlp_led_mode_t mode)
     uint8_t curr_data = 0;
     vendor_dev_led_pin_t *led_node;
 
-    void *busDrv = (void *)vendor_find_driver_by_name(led_color_list[id]->bus_drv_name);
+    void *busDrv = led_color_list[id]->bus_drv;
     cpld_dev_driver_t *cpld =
-        (cpld_dev_driver_t *)vendor_find_driver_by_name(led_dev_list[id].dev_drv_name);
+        (cpld_dev_driver_t *)led_dev_list[id].dev_drv;
 
     led_node = led_color_list[id];
 
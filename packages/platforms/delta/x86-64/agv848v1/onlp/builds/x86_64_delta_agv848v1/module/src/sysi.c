@@ -127,9 +127,9 @@ int onlp_sysi_onie_data_get(uint8_t **data, int *size)
     uint8_t *rdata = aim_zmalloc(256);
     *size = 256;
 
-    void *busDrv = (void *)vendor_find_driver_by_name(eeprom_dev_list[id].bus_drv_name);
+    void *busDrv = eeprom_dev_list[id].bus_drv;
     eeprom_dev_driver_t *eeprom =
-        (eeprom_dev_driver_t *)vendor_find_driver_by_name(eeprom_dev_list[id].dev_drv_name);
+        (eeprom_dev_driver_t *)eeprom_dev_list[id].dev_drv;
 
     vendor_dev_do_oc(eeprom_o_list[id]);
     rv = eeprom->load(
@@ -168,9 +168,9 @@ int onlp_sysi_onie_info_get(onlp_onie_info_t *onie)
 {
     uint8_t data[256] = {0};
     int rv = 0, id = 0;
-    void *busDrv = (void *)vendor_find_driver_by_name(eeprom_dev_list[id].bus_drv_name);
+    void *busDrv = eeprom_dev_list[id].bus_drv;
     eeprom_dev_driver_t *eeprom =
-        (eeprom_dev_driver_t *)vendor_find_driver_by_name(eeprom_dev_list[id].dev_drv_name);
+        (eeprom_dev_driver_t *)eeprom_dev_list[id].dev_drv;
 
     if (onie == NULL)
         return 0;
@@ -479,14 +479,14 @@ int onlp_sysi_platform_info_get(onlp_platform_info_t *pi)
     char buffer[256] = "";
 
     void *busDrv = NULL;
-    cpld_dev_driver_t *cpld = (cpld_dev_driver_t *)vendor_find_driver_by_name("CPLD");
+    cpld_dev_driver_t *cpld = vendor_cpld_drv;
 
     for (cpld_idx = 0; cpld_idx < cpld_list_size; cpld_idx++)
     {
         if (cpld_version_list[cpld_idx].type == 0)
             continue;
 
-        busDrv = (void *)vendor_find_driver_by_name(cpld_version_list[cpld_idx].bus_drv_name);
+        busDrv = cpld_version_list[cpld_idx].bus_drv;
         vendor_dev_do_oc(cpld_o_list[cpld_idx]);
         rv = cpld->readb(
             busDrv,
@@ -520,5 +520,8 @@ void onlp_sysi_platform_info_free(onlp_platform_info_t *pi)
  */
 int onlp_sysi_debug(aim_pvs_t *pvs, int argc, char **argv)
 {
+    if (argc >= 1 && strcmp(argv[0], "bench") == 0)
+        return vendor_driver_bench(pvs, (argc >= 2) ? atoi(argv[1]) : 100000);
+
     return ONLP_STATUS_E_UNSUPPORTED;
 }
@@ -0,0 +1,21 @@
+/**************************************************************************//**
+ *
+ *
+ *
+ *****************************************************************************/
+#include <x86_64_delta_agv848v1/x86_64_delta_agv848v1_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <AIM/aim.h>
+#include <onlp/platformi/sysi.h>
+
+int aim_main(int argc, char* argv[])
+{
+    /* Driver lookup micro-benchmark. No device is accessed. */
+    char* bench[] = { "bench", "100000" };
+
+    x86_64_delta_agv848v1_config_show(&aim_pvs_stdout);
+    return onlp_sysi_debug(&aim_pvs_stdout, AIM_ARRAYSIZE(bench), bench);
+}
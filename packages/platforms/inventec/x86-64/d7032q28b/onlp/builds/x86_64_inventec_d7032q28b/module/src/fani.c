@@ -80,16 +80,29 @@ onlp_fan_info_t linfo[FAN_MAX] = {
         }                                       \
     } while(0)
 
+/* The GPI and speed of each chassis fan are read together */
+static onlp_file_vec_t* fan_vec__[FAN_MAX];
+
 static int
 _onlp_fani_info_get_fan(int fid, onlp_fan_info_t* info)
 {
-    int   value, ret;
+    int   value;
+    onlp_file_vec_result_t r[2];
+
+    if (fan_vec__[fid] == NULL) {
+        onlp_file_vec_create(&fan_vec__[fid]);
+        onlp_file_vec_add(fan_vec__[fid], ONLP_FILE_VEC_TYPE_INT, FAN_GPI_ON_MAIN_BOARD);
+        onlp_file_vec_add(fan_vec__[fid], ONLP_FILE_VEC_TYPE_INT, "%s", devfiles__[fid]);
+    }
+    if (onlp_file_vec_read(fan_vec__[fid], r) < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
 
     /* get fan present status */
-    ret = onlp_file_read_int(&value, FAN_GPI_ON_MAIN_BOARD);
-    if (ret < 0) {
+    if (r[0].status < 0) {
         return ONLP_STATUS_E_INTERNAL;
     }
+    value = r[0].value;
     if (value & (1 << (fid-1))) {
 	info->status |= ONLP_FAN_STATUS_FAILED;
     }
@@ -99,11 +112,10 @@ _onlp_fani_info_get_fan(int fid, onlp_fan_info_t* info)
     }
 
     /* get front fan speed */
-    ret = onlp_file_read_int(&value, devfiles__[fid]);
-    if (ret < 0) {
+    if (r[1].status < 0) {
         return ONLP_STATUS_E_INTERNAL;
     }
-    info->rpm = value;
+    info->rpm = r[1].value;
     info->percentage = (info->rpm * 100) / MAX_PSU_FAN_SPEED;
 
     snprintf(info->model, ONLP_CONFIG_INFO_STR_MAX, "NA");
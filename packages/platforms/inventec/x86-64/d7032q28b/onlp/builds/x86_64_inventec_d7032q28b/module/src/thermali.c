@@ -87,6 +87,9 @@ static onlp_thermal_info_t linfo[THERMAL_MAX] = {
         },
 };
 
+/* The label and input of each CPU core sensor are read together */
+static onlp_file_vec_t* cpu_core_vec__[THERMAL_MAX];
+
 /*
  * This will be called to intiialize the thermali subsystem.
  */
@@ -118,15 +121,30 @@ onlp_thermali_info_get(onlp_oid_t id, onlp_thermal_info_t* info)
     *info = linfo[local_id];
 
     if(local_id >= THERMAL_CPU_CORE_FIRST && local_id <= THERMAL_CPU_CORE_LAST) {
-	char desc[32], *dp = &desc[0];
-        int rv = onlp_file_read_str(&dp, devfiles__[local_id], "label");
-        if (rv > 0) {
+        onlp_file_vec_t* vec = cpu_core_vec__[local_id];
+        onlp_file_vec_result_t r[2];
+
+        if (vec == NULL) {
+            onlp_file_vec_create(&vec);
+            onlp_file_vec_add(vec, ONLP_FILE_VEC_TYPE_STR, devfiles__[local_id], "label");
+            onlp_file_vec_add(vec, ONLP_FILE_VEC_TYPE_INT, devfiles__[local_id], "input");
+            cpu_core_vec__[local_id] = vec;
+        }
+        if (onlp_file_vec_read(vec, r) < 0) {
+            return ONLP_STATUS_E_INTERNAL;
+        }
+
+        if (r[0].status >= 0 && r[0].str[0]) {
             memset (info->hdr.description, 0, ONLP_OID_DESC_SIZE);
-            aim_strlcpy(info->hdr.description, dp, rv);
+            aim_strlcpy(info->hdr.description, r[0].str, ONLP_OID_DESC_SIZE);
         }
 
         /* Set the onlp_oid_hdr_t and capabilities */
-        return onlp_file_read_int(&info->mcelsius, devfiles__[local_id], "input");
+        if (r[1].status < 0) {
+            return r[1].status;
+        }
+        info->mcelsius = r[1].value;
+        return ONLP_STATUS_OK;
     }
     return onlp_file_read_int(&info->mcelsius, devfiles__[local_id]);
 }
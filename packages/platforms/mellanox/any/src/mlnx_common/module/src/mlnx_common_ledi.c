@@ -222,6 +222,41 @@ static int driver_to_onlp_led_mode(int id, char* driver_led_mode)
     return ONLP_STATUS_OK;
 }
 
+/*
+ * Compose the driver LED mode ("<color>", "<color>_blink" or "none")
+ * from the per-color nodes used on kernels >= 4.9.30. This is what
+ * the hw-management "<led>_state" script writes to the LED node.
+ */
+static void led_state_read(int id, char* driver_led_mode, int size)
+{
+    const char* fname = get_platform_info()->led_fnames[id];
+    int i, nsize = sizeof(led_map)/sizeof(led_map[0]);
+
+    aim_strlcpy(driver_led_mode, LED_MODE_OFF, size);
+
+    for (i = 0; i < nsize; i++)
+    {
+        const char* color = led_map[i].driver_led_mode;
+        int brightness = 0, delay_on = 0;
+
+        if (id != led_map[i].id || strchr(color, '_') ||
+            !strcmp(color, LED_MODE_OFF) || !strcmp(color, LED_MODE_AUTO))
+            continue;
+
+        /* delay_on only exists while the color is blinking. */
+        if (onlp_file_read_int(&delay_on, "%s%s_%s_delay_on",
+                               prefix_path, fname, color) == 0 && delay_on > 0) {
+            snprintf(driver_led_mode, size, "%s_blink", color);
+            return;
+        }
+        if (onlp_file_read_int(&brightness, "%s%s_%s",
+                               prefix_path, fname, color) == 0 && brightness > 0) {
+            aim_strlcpy(driver_led_mode, color, size);
+            return;
+        }
+    }
+}
+
 static char* onlp_to_driver_led_mode(int id, onlp_led_mode_t onlp_led_mode)
 {
     int i, nsize = sizeof(led_map)/sizeof(led_map[0]);
@@ -311,16 +346,10 @@ onlp_ledi_info_get(onlp_oid_t id, onlp_led_info_t* info)
 
     /* Get LED mode */
     if (mc_get_kernel_ver() >= KERNEL_VERSION(4,9,30)) {
-        char* cmd = aim_fstrdup("%s%s_state", prefix_path, mlnx_platform_info->led_fnames[local_id]);
-        if(system(cmd) != 0) {
-            aim_free(cmd);
-            return ONLP_STATUS_E_INTERNAL;
-        }
-        aim_free(cmd);
+        led_state_read(local_id, (char*)data, sizeof(data));
     }
-
-    if (onlp_file_read(data, sizeof(data), &len, "%s%s",
-                       prefix_path, mlnx_platform_info->led_fnames[local_id]) != 0) {
+    else if (onlp_file_read(data, sizeof(data), &len, "%s%s",
+                            prefix_path, mlnx_platform_info->led_fnames[local_id]) != 0) {
         return ONLP_STATUS_E_INTERNAL;
     }
 
@@ -354,14 +383,15 @@ onlp_ledi_set(onlp_oid_t id, int on_or_off)
             return onlp_ledi_mode_set(id, ONLP_LED_MODE_OFF);
         else {
             int i, nsize = sizeof(led_colors_map)/sizeof(led_colors_map[0]);
+            int local_id = ONLP_OID_ID_GET(id);
             for (i = 0; i < nsize; i++)
             {
-                if (id == led_colors_map[i].id)
+                if (local_id == led_colors_map[i].id)
                     break;
             }
-            if (led_colors_map[i].color)
+            if (i < nsize && led_colors_map[i].color)
                 onlp_file_write((uint8_t*)LED_OFF, LED_MODE_LEN,
-                                "%s%s_%s", prefix_path, mlnx_platform_info->led_fnames[id], led_colors_map[i].color);
+                                "%s%s_%s", prefix_path, mlnx_platform_info->led_fnames[local_id], led_colors_map[i].color);
         }
     }
 
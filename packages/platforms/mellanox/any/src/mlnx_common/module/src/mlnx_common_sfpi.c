@@ -31,6 +31,12 @@
 #include <onlplib/i2c.h>
 #include <onlplib/sfp.h>
 #include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <net/if.h>
+#include <linux/ethtool.h>
+#include <linux/sockios.h>
+#include <errno.h>
+#include <pthread.h>
 #include "mlnx_common_log.h"
 #include "mlnx_common_int.h"
 
@@ -40,38 +46,118 @@ static char sfp_node_path[MAX_SFP_PATH] = {0};
 
 int get_sfp_port_num(void);
 
+/*
+ * Resolved once in mc_sfp_init__().
+ */
+static struct {
+    /* Status node values for the running kernel. */
+    const char* present;
+    const char* not_present;
+
+    /* Socket for SIOCETHTOOL requests. */
+    int fd;
+} sfp_ctrl__ = { NULL, NULL, -1 };
+
+static void
+mc_sfp_init__(void)
+{
+    if (mc_get_kernel_ver() >= KERNEL_VERSION(4,9,30)) {
+        sfp_ctrl__.present = "1";
+        sfp_ctrl__.not_present = "0";
+    } else {
+        sfp_ctrl__.present = "good";
+        sfp_ctrl__.not_present = "not_connected";
+    }
+
+    sfp_ctrl__.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sfp_ctrl__.fd < 0) {
+        AIM_LOG_ERROR("Unable to open the ethtool socket: %{errno}", errno);
+    }
+}
+
+static void
+mc_sfp_init_once__(void)
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, mc_sfp_init__);
+}
+
+/*
+ * Issue an ethtool request against the port's netdev (sfp<port>).
+ */
+static int
+mc_sfp_ethtool(int port, void* request)
+{
+    struct ifreq ifr;
+
+    mc_sfp_init_once__();
+    if (sfp_ctrl__.fd < 0) {
+        return ONLP_STATUS_E_INTERNAL;
+    }
+
+    memset(&ifr, 0, sizeof(ifr));
+    snprintf(ifr.ifr_name, sizeof(ifr.ifr_name), "sfp%d", port);
+    ifr.ifr_data = request;
+
+    if (ioctl(sfp_ctrl__.fd, SIOCETHTOOL, &ifr) < 0) {
+        /* No netdev for the port, or no module in the cage. */
+        return (errno == ENODEV) ? ONLP_STATUS_E_INVALID : ONLP_STATUS_E_MISSING;
+    }
+    return ONLP_STATUS_OK;
+}
+
+/*
+ * Get the module type and EEPROM length. Fails with
+ * ONLP_STATUS_E_MISSING if no module is plugged in.
+ */
+static int
+mc_sfp_module_info_get(int port, struct ethtool_modinfo* info)
+{
+    memset(info, 0, sizeof(*info));
+    info->cmd = ETHTOOL_GMODULEINFO;
+    return mc_sfp_ethtool(port, info);
+}
+
+/*
+ * Read the module EEPROM through ETHTOOL_GMODULEEEPROM.
+ *
+ * The offset is linear, as in "ethtool -m":
+ *   SFF-8472:      0-255 is A0h, 256-511 is A2h.
+ *   SFF-8436/8636: 0-127 is the lower page, upper page N
+ *                  starts at 128 * (N + 1).
+ */
+static int
+mc_sfp_module_eeprom_read(int port, int offset, int len, uint8_t* data)
+{
+    struct ethtool_eeprom* ee;
+    int rv;
+
+    ee = aim_zmalloc(sizeof(*ee) + len);
+    ee->cmd = ETHTOOL_GMODULEEEPROM;
+    ee->offset = offset;
+    ee->len = len;
+
+    if ((rv = mc_sfp_ethtool(port, ee)) == ONLP_STATUS_OK) {
+        memcpy(data, ee->data, len);
+    }
+    aim_free(ee);
+    return rv;
+}
+
 static int
 mc_sfp_node_read_int(char *node_path, int *value)
 {
     int  data_len = 0, ret = 0;
     char buf[SFP_SYSFS_VALUE_LEN] = {0};
     *value = -1;
-    char sfp_present_status[16];
-    char sfp_not_present_status[16];
-    char bash_keyword[] = "#!/bin/bash";
-    FILE * cmd;
 
-    if (mc_get_kernel_ver() >= KERNEL_VERSION(4,9,30)) {
-        strcpy(sfp_present_status, "1");
-        strcpy(sfp_not_present_status, "0");
-    } else {
-        strcpy(sfp_present_status, "good");
-        strcpy(sfp_not_present_status, "not_connected");
-    }
-    ret = onlp_file_read((uint8_t*)buf, sizeof(buf), &data_len, node_path);
-    if (ret == 0) {
-        if (!strncmp(buf, bash_keyword, strlen(bash_keyword))){
-            cmd = popen(node_path, "r");
-            if (fgets(buf, sizeof(buf), cmd) == NULL)
-                ret = ONLP_STATUS_E_INTERNAL;
-            pclose(cmd);
-        }
-    }
+    mc_sfp_init_once__();
 
+    ret = onlp_file_read((uint8_t*)buf, sizeof(buf), &data_len, node_path);
     if (ret == 0) {
-        if (!strncmp(buf, sfp_present_status, strlen(sfp_present_status))) {
+        if (!strncmp(buf, sfp_ctrl__.present, strlen(sfp_ctrl__.present))) {
             *value = 1;
-        } else if (!strncmp(buf, sfp_not_present_status, strlen(sfp_not_present_status))) {
+        } else if (!strncmp(buf, sfp_ctrl__.not_present, strlen(sfp_ctrl__.not_present))) {
             *value = 0;
         }
     }
@@ -89,27 +175,6 @@ mc_sfp_get_port_path(int port, char *node_name)
     return sfp_node_path;
 }
 
-static char*
-mc_sfp_convert_i2c_path(int port, int devaddr)
-{
-    sprintf(sfp_node_path, "%s/sfp%d", SFP_PATH, port);
-    return sfp_node_path;
-}
-
-static int
-mc_sfp_prepare_eeprom_dump(int port, const char* path)
-{
-    char* cmd = aim_fstrdup("ethtool -m sfp%d raw on length 256 > %s", port, path);
-
-    if(system(cmd) != 0) {
-        aim_free(cmd);
-        return ONLP_STATUS_E_INTERNAL;
-    }
-    aim_free(cmd);
-
-	return ONLP_STATUS_OK;
-}
-
 /************************************************************
  *
  * SFPI Entry Points
@@ -118,7 +183,7 @@ mc_sfp_prepare_eeprom_dump(int port, const char* path)
 int
 onlp_sfpi_init(void)
 {
-    /* Called at initialization time */
+    mc_sfp_init_once__();
     return ONLP_STATUS_OK;
 }
 
@@ -147,12 +212,31 @@ onlp_sfpi_is_present(int port)
      */
     int present = -1;
     char* path = mc_sfp_get_port_path(port, "_status");
+    struct ethtool_modinfo info;
 
     if (mc_sfp_node_read_int(path, &present) != 0) {
         AIM_LOG_ERROR("Unable to read present status from port(%d)\r\n", port);
         return ONLP_STATUS_E_INTERNAL;
     }
 
+    if (present < 0) {
+        /*
+         * Some hw-management releases install the status node as a
+         * script wrapping ethtool. Ask the driver directly instead.
+         */
+        switch (mc_sfp_module_info_get(port, &info)) {
+        case ONLP_STATUS_OK:
+            present = 1;
+            break;
+        case ONLP_STATUS_E_MISSING:
+            present = 0;
+            break;
+        default:
+            AIM_LOG_ERROR("Unable to read present status from port(%d)\r\n", port);
+            return ONLP_STATUS_E_INTERNAL;
+        }
+    }
+
     return present;
 }
 
@@ -174,78 +258,139 @@ onlp_sfpi_presence_bitmap_get(onlp_sfp_bitmap_t* dst)
 int
 onlp_sfpi_eeprom_read(int port, uint8_t data[256])
 {
-    char* path = mc_sfp_get_port_path(port, NULL);
-
-	if (mc_sfp_prepare_eeprom_dump(port, path) != ONLP_STATUS_OK) {
-            AIM_LOG_ERROR("Unable to prepare sfp%d eeprom dump\r\n", port);
-            return ONLP_STATUS_E_INTERNAL;
-	}
     /*
      * Read the SFP eeprom into data[]
      *
      * Return MISSING if SFP is missing.
      * Return OK if eeprom is read
      */
+    int rv;
+
     memset(data, 0, 256);
 
-    if (onlplib_sfp_eeprom_read_file(path, data) != 0) {
+    if ((rv = mc_sfp_module_eeprom_read(port, 0, 256, data)) != ONLP_STATUS_OK) {
         AIM_LOG_ERROR("Unable to read eeprom from port(%d)\r\n", port);
-        return ONLP_STATUS_E_INTERNAL;
+        return (rv == ONLP_STATUS_E_MISSING) ? rv : ONLP_STATUS_E_INTERNAL;
     }
 
     return ONLP_STATUS_OK;
 }
 
 int
-onlp_sfpi_dev_readb(int port, uint8_t devaddr, uint8_t addr)
+onlp_sfpi_dom_read(int port, uint8_t data[256])
 {
-    char* path = mc_sfp_convert_i2c_path(port, devaddr);
-    uint8_t data;
-    int fd;
-    int nrd;
+    struct ethtool_modinfo info;
+    int rv;
 
-    if (!path)
-		return ONLP_STATUS_E_MISSING;
+    if ((rv = mc_sfp_module_info_get(port, &info)) != ONLP_STATUS_OK) {
+        return rv;
+    }
 
-    fd = open(path, O_RDONLY);
-    if (fd < 0)
-		return ONLP_STATUS_E_MISSING;
+    /* Only SFF-8472 modules have a separate A2h device. */
+    if (info.type != ETH_MODULE_SFF_8472 || info.eeprom_len < 512) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
 
-    lseek(fd, addr, SEEK_SET);
-    nrd = read(fd, &data, 1);
-    close(fd);
+    return mc_sfp_module_eeprom_read(port, 256, 256, data);
+}
 
-    if (nrd != 1) {
-		AIM_LOG_INTERNAL("Failed to read EEPROM file '%s'", path);
-		return ONLP_STATUS_E_INTERNAL;
+/*
+ * Map (devaddr, page, offset) to the linear ethtool offset.
+ * offset and len must not cross the lower/upper page boundary.
+ */
+static int
+mc_sfp_linear_offset(const struct ethtool_modinfo* info,
+                     uint8_t devaddr, int page, int offset, int len)
+{
+    int linear;
+
+    if (devaddr == 0x51) {
+        if (info->type != ETH_MODULE_SFF_8472 || page != 0) {
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+        linear = 256 + offset;
     }
-    return data;
+    else if (devaddr != 0x50) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    else if (offset < 128) {
+        linear = offset;
+    }
+    else if (info->type == ETH_MODULE_SFF_8472) {
+        if (page != 0) {
+            return ONLP_STATUS_E_UNSUPPORTED;
+        }
+        linear = offset;
+    }
+    else {
+        linear = 128 * (page + 1) + (offset - 128);
+    }
+
+    if (linear + len > info->eeprom_len) {
+        return ONLP_STATUS_E_UNSUPPORTED;
+    }
+    return linear;
 }
 
 int
-onlp_sfpi_dev_readw(int port, uint8_t devaddr, uint8_t addr)
+onlp_sfpi_memory_read(int port, uint8_t devaddr, int bank, int page,
+                      int offset, int len, uint8_t* data)
 {
-    char* path = mc_sfp_convert_i2c_path(port, devaddr);
-    uint16_t data;
-    int fd;
-    int nrd;
+    struct ethtool_modinfo info;
+    int rv;
 
-    if (!path){
-		return ONLP_STATUS_E_MISSING;
+    if (bank != 0) {
+        return ONLP_STATUS_E_UNSUPPORTED;
     }
 
-    fd = open(path, O_RDONLY);
-    if (fd < 0) {
-		return ONLP_STATUS_E_MISSING;
+    if ((rv = mc_sfp_module_info_get(port, &info)) != ONLP_STATUS_OK) {
+        return rv;
+    }
+
+    while (len > 0) {
+        /* Split at the lower/upper page boundary. */
+        int chunk = (offset < 128 && offset + len > 128) ? 128 - offset : len;
+        int linear = mc_sfp_linear_offset(&info, devaddr, page, offset, chunk);
+
+        if (linear < 0) {
+            return linear;
+        }
+        if ((rv = mc_sfp_module_eeprom_read(port, linear, chunk, data)) != ONLP_STATUS_OK) {
+            return rv;
+        }
+        offset += chunk;
+        data += chunk;
+        len -= chunk;
     }
 
-    lseek(fd, addr, SEEK_SET);
-    nrd = read(fd, &data, 2);
-    close(fd);
+    return ONLP_STATUS_OK;
+}
+
+int
+onlp_sfpi_dev_readb(int port, uint8_t devaddr, uint8_t addr)
+{
+    uint8_t data;
+    int rv = onlp_sfpi_memory_read(port, devaddr, 0, 0, addr, 1, &data);
+
+    if (rv < 0) {
+        return rv;
+    }
+    return data;
+}
+
+int
+onlp_sfpi_dev_readw(int port, uint8_t devaddr, uint8_t addr)
+{
+    uint16_t data;
+    int rv;
+
+    if (addr == 0xFF) {
+        return ONLP_STATUS_E_PARAM;
+    }
 
-    if (nrd != 2) {
-		AIM_LOG_INTERNAL("Failed to read EEPROM file '%s'", path);
-		return ONLP_STATUS_E_INTERNAL;
+    rv = onlp_sfpi_memory_read(port, devaddr, 0, 0, addr, 2, (uint8_t*)&data);
+    if (rv < 0) {
+        return rv;
     }
     return data;
 }
@@ -34,6 +34,7 @@
 #include <onlplib/file.h>
 #include <onlp/onlp.h>
 #include <sys/mman.h>
+#include <pthread.h>
 #include "mlnx_common_log.h"
 #include "mlnx_common_int.h"
 
@@ -125,16 +126,20 @@ psu_read_eeprom(int psu_index, onlp_psu_info_t* psu_info)
     return ONLP_STATUS_OK;
 }
 
-int
-mc_get_kernel_ver()
+static int kernel_ver__ = 0;
+
+static void
+mc_kernel_ver_init__(void)
 {
     struct utsname buff;
-    char ver[4];
+    int ver[3] = { 0 };
     char *p;
     int i = 0;
 
-    if (uname(&buff) != 0)
-        return ONLP_STATUS_E_INTERNAL;
+    if (uname(&buff) != 0) {
+        kernel_ver__ = ONLP_STATUS_E_INTERNAL;
+        return;
+    }
 
     p = buff.release;
 
@@ -149,5 +154,17 @@ mc_get_kernel_ver()
         }
     }
 
-    return KERNEL_VERSION(ver[0], ver[1], ver[2]);
+    kernel_ver__ = KERNEL_VERSION(ver[0], ver[1], ver[2]);
+}
+
+/*
+ * The running kernel does not change. Resolve it once so the
+ * kernel-version branches in the hot paths cost a compare.
+ */
+int
+mc_get_kernel_ver()
+{
+    static pthread_once_t once = PTHREAD_ONCE_INIT;
+    pthread_once(&once, mc_kernel_ver_init__);
+    return kernel_ver__;
 }